@@ -21,16 +21,41 @@
  * v4.2
  *  Created by Todd Morton
  *  Modified to fix bug in BOIGetStrg() so a BS can be the first character pressed.
+ * v4.3
+ *  Transmit is queued in a ring drained by the UART2 TX interrupt once the kernel runs.
+ *  Receive is buffered by the UART2 RX interrupt and BIOGetChar() pends on it.
+ *  tools/uarttest.c runs this file on a host against a model of UART2.
  *******************************************************************************************
 * Project master header file
 ********************************************************************/
 #include "MCUType.h"
+#include "os.h"
 #include "BasicIO.h"
 #include "math.h"
 
 /*******************************************************************************************
 * Private Resources
 *******************************************************************************************/
+#define BIO_TX_RING_MASK    (BIO_TX_RING_SIZE - 1)
+#define BIO_TX_SPACE_POST   (BIO_TX_RING_SIZE/4)    //Free bytes before a waiting writer runs
+
+//Transmit ring. Writers move bioTxHead, the TX interrupt moves bioTxTail. Empty when equal.
+static INT8U bioTxRing[BIO_TX_RING_SIZE];
+static volatile INT16U bioTxHead = 0;
+static volatile INT16U bioTxTail = 0;
+static volatile INT8U bioTxWaiting = 0;
+static OS_SEM bioTxSpace;
+
+//Receive ring. The RX interrupt moves bioRxHead, readers move bioRxTail.
+static INT8U bioRxRing[BIO_RX_RING_SIZE];
+static volatile INT16U bioRxHead = 0;
+static volatile INT16U bioRxTail = 0;
+static OS_TCB *volatile bioRxTaskPtr = (OS_TCB *)0;  //Task pending in BIOGetChar()
+static BIO_RX_ERR_T bioRxErr = {0, 0};
+
+static void bioTxDrain(void);
+static INT16U bioTxFree(void);
+static void bioRxFill(void);
 static INT8C bioHtoA(INT8U hnib);   //Convert nibble to ascii
 static INT8U bioIsHex(INT8C c);
 static INT8U bioHtoB(INT8C c);
@@ -43,8 +68,13 @@ static INT8U bioHtoB(INT8C c);
  *  BIO_BIT_RATE_38400
  *  BIO_BIT_RATE_57600
  *  BIO_BIT_RATE_115200
+ *  BIO_BIT_RATE_230400
+ *  BIO_BIT_RATE_460800
+ *  BIO_BIT_RATE_921600
+ * SBR and BRFA are for the 60MHz UART2 clock. 921600 is 0.16% fast.
  ******************************************************************************************/
 void BIOOpen(INT8U rate){
+    OS_ERR os_err;
 
     SIM->SCGC5 |= SIM_SCGC5_PORTE(1); /* Enable clock gate for PORTE */
     SIM->SCGC4 |= SIM_SCGC4_UART2(1); //enables UART2 clock (60MHz)
@@ -77,6 +107,21 @@ void BIOOpen(INT8U rate){
         UART2->BDL = 0x20U;
         UART2->C4 = 0x12U;
         break;
+    case(BIO_BIT_RATE_230400):
+        UART2->BDH = 0x00U;
+        UART2->BDL = 0x10U;
+        UART2->C4 = 0x09U;
+        break;
+    case(BIO_BIT_RATE_460800):
+        UART2->BDH = 0x00U;
+        UART2->BDL = 0x08U;
+        UART2->C4 = 0x04U;
+        break;
+    case(BIO_BIT_RATE_921600):
+        UART2->BDH = 0x00U;
+        UART2->BDL = 0x04U;
+        UART2->C4 = 0x02U;
+        break;
     default:    //Default to 9600bps
         UART2->BDH = 0x01U;
         UART2->BDL = 0x86U;
@@ -86,43 +131,237 @@ void BIOOpen(INT8U rate){
     UART2->C2 |= UART_C2_TE_MASK;    //enables transmission
     UART2->C2 |= UART_C2_RE_MASK;    //enables receive
 
+    OSSemCreate(&bioTxSpace, "BIO Tx Space", 0, &os_err);
+    UART2->C2 |= UART_C2_RIE_MASK;   //RX interrupt, TIE is set only while the TX ring is not empty
+    NVIC_ClearPendingIRQ(UART2_RX_TX_IRQn);
+    NVIC_EnableIRQ(UART2_RX_TX_IRQn);
 }
 
 /*******************************************************************************************
 * BIORead() - Checks for a character received
+*    Takes the oldest character from the receive ring. Before OSStart() the RX interrupt
+*    is not serviced by the kernel yet, so the UART is polled into the ring first.
 *    MCU: K65, UART2
 *    return: ASCII character received or 0 if no character received
 *******************************************************************************************/
 INT8C BIORead(void){
     INT8C c;
-    if ((UART2->S1 & UART_S1_RDRF_MASK) != 0){   //check if char received
-        c = UART2->D;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    if(OSRunning != OS_STATE_OS_RUNNING){
+        bioRxFill();
+    }else{
+    }
+    if (bioRxHead != bioRxTail){            //check if char received
+        c = (INT8C)bioRxRing[bioRxTail];
+        bioRxTail = (bioRxTail + 1) & (BIO_RX_RING_SIZE - 1);
     }else{
         c = '\0';                           //If not return 0
     }
+    CPU_CRITICAL_EXIT();
     return (c);
 }
 /*******************************************************************************************
 * BIOGetChar() - Blocks until character is received
+*    A task pends on its task semaphore, which the RX interrupt posts. Where a task cannot
+*    pend (before OSStart(), in an ISR or with the scheduler locked) it polls.
 *    return: INT8C ASCII character
 *******************************************************************************************/
 INT8C BIOGetChar(void){
     INT8C c;
-    do{
+    OS_ERR os_err;
+    CPU_SR_ALLOC();
+
+    c = BIORead();
+    while(c == '\0'){
+        if((OSRunning == OS_STATE_OS_RUNNING) && (OSIntNestingCtr == 0) &&
+           (OSSchedLockNestingCtr == 0)){
+            CPU_CRITICAL_ENTER();
+            bioRxTaskPtr = OSTCBCurPtr;
+            CPU_CRITICAL_EXIT();
+            if(bioRxHead == bioRxTail){         //Read a character that beat the pointer
+                (void)OSTaskSemPend(0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+            }else{
+            }
+            bioRxTaskPtr = (OS_TCB *)0;
+        }else{
+            CPU_CRITICAL_ENTER();
+            bioRxFill();
+            CPU_CRITICAL_EXIT();
+        }
         c = BIORead();
-    }while(c == '\0');
+    }
     return c;
 }
 
+/*******************************************************************************************
+* BIORxErrGet() - Copies the receive overrun and dropped character counts
+*******************************************************************************************/
+void BIORxErrGet(BIO_RX_ERR_T *rx_err){
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    *rx_err = bioRxErr;
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* BIORxErrReset() - Clears the receive error counts
+*******************************************************************************************/
+void BIORxErrReset(void){
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    bioRxErr.overruns = 0;
+    bioRxErr.dropped = 0;
+    CPU_CRITICAL_EXIT();
+}
+
 /*******************************************************************************************
 * BIOWrite() - Sends an ASCII character
-*              Blocks as much as one character time
+*              Queues c in the transmit ring and enables the TX interrupt. When the ring is
+*              full the task pends until the interrupt has freed BIO_TX_SPACE_POST bytes.
+*              Where a task cannot pend (before OSStart(), in an ISR or with the scheduler
+*              locked) it drains the ring itself by polling TDRE.
 *    MCU: K65, UART2
 *    parameter: c is the ASCII character to be sent
 *******************************************************************************************/
 void BIOWrite(INT8C c){
-    while ((UART2->S1 & UART_S1_TDRE_MASK)==0){} //waits until transmission
-    UART2->D = (INT8U)c;                             //is ready
+    OS_ERR os_err;
+    CPU_SR_ALLOC();
+
+    if(OSRunning != OS_STATE_OS_RUNNING){
+        while ((UART2->S1 & UART_S1_TDRE_MASK)==0){} //waits until transmission
+        UART2->D = (INT8U)c;                             //is ready
+        return;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    while(bioTxFree() == 0){
+        if((OSIntNestingCtr == 0) && (OSSchedLockNestingCtr == 0)){
+            bioTxWaiting = 1;
+            CPU_CRITICAL_EXIT();
+            OSSemPend(&bioTxSpace, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+            CPU_CRITICAL_ENTER();
+        }else{
+            bioTxDrain();
+        }
+    }
+    bioTxRing[bioTxHead] = (INT8U)c;
+    bioTxHead = (bioTxHead + 1) & BIO_TX_RING_MASK;
+    UART2->C2 |= UART_C2_TIE_MASK;
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* BIOTxFlush() - Waits until the transmit ring is empty. The last character may still be
+*                in the UART shifter.
+*******************************************************************************************/
+void BIOTxFlush(void){
+    OS_ERR os_err;
+    CPU_SR_ALLOC();
+
+    while(bioTxHead != bioTxTail){
+        if((OSRunning == OS_STATE_OS_RUNNING) && (OSIntNestingCtr == 0) &&
+           (OSSchedLockNestingCtr == 0)){
+            OSTimeDly(1, OS_OPT_TIME_DLY, &os_err);
+        }else{
+            CPU_CRITICAL_ENTER();
+            bioTxDrain();
+            CPU_CRITICAL_EXIT();
+        }
+    }
+}
+
+/*******************************************************************************************
+* UART2 receive/transmit interrupt. Moves a received character into the receive ring and
+* wakes the task pending in BIOGetChar(). Refills the transmitter from the transmit ring and
+* disables TIE once it is empty. A writer waiting on a full ring is released when a quarter
+* of the ring is free, so it is not woken for every character.
+*******************************************************************************************/
+void UART2_RX_TX_IRQHandler(void){
+    OS_ERR os_err;
+    OS_TCB *rx_task;
+    INT16U rx_head;
+    CPU_SR_ALLOC();
+
+    OSIntEnter();
+    CPU_CRITICAL_ENTER();
+    rx_head = bioRxHead;
+    bioRxFill();
+    rx_task = bioRxTaskPtr;
+    if((rx_head != bioRxHead) && (rx_task != (OS_TCB *)0)){
+        bioRxTaskPtr = (OS_TCB *)0;
+    }else{
+        rx_task = (OS_TCB *)0;
+    }
+    bioTxDrain();
+    if((bioTxWaiting != 0) && (bioTxFree() >= BIO_TX_SPACE_POST)){
+        bioTxWaiting = 0;
+        CPU_CRITICAL_EXIT();
+        (void)OSSemPost(&bioTxSpace, OS_OPT_POST_ALL, &os_err);
+    }else{
+        CPU_CRITICAL_EXIT();
+    }
+    if(rx_task != (OS_TCB *)0){
+        (void)OSTaskSemPost(rx_task, OS_OPT_POST_NONE, &os_err);
+    }else{
+    }
+    OSIntExit();
+}
+
+/*******************************************************************************************
+* bioRxFill() - Moves a received character from UART2 to the receive ring. Reading S1 then
+*               D clears RDRF and OR. Counts hardware overruns and characters lost to a full
+*               ring. Call with interrupts disabled.
+*******************************************************************************************/
+static void bioRxFill(void){
+    INT8U status;
+    INT8U c;
+    INT16U next;
+
+    status = UART2->S1;
+    if((status & (UART_S1_RDRF_MASK | UART_S1_OR_MASK)) != 0){
+        c = UART2->D;
+        if((status & UART_S1_OR_MASK) != 0){
+            bioRxErr.overruns++;
+        }else{
+        }
+        if((status & UART_S1_RDRF_MASK) != 0){
+            next = (bioRxHead + 1) & (BIO_RX_RING_SIZE - 1);
+            if(next != bioRxTail){
+                bioRxRing[bioRxHead] = c;
+                bioRxHead = next;
+            }else{
+                bioRxErr.dropped++;
+            }
+        }else{
+        }
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* bioTxDrain() - Moves characters from the ring to UART2 while it can take them and turns
+*                the TX interrupt off when the ring is empty. Call with interrupts disabled.
+*******************************************************************************************/
+static void bioTxDrain(void){
+    while((bioTxHead != bioTxTail) && ((UART2->S1 & UART_S1_TDRE_MASK) != 0)){
+        UART2->D = bioTxRing[bioTxTail];
+        bioTxTail = (bioTxTail + 1) & BIO_TX_RING_MASK;
+    }
+    if(bioTxHead == bioTxTail){
+        UART2->C2 &= (INT8U)~UART_C2_TIE_MASK;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* bioTxFree() - Free bytes in the transmit ring. One slot is kept empty.
+*******************************************************************************************/
+static INT16U bioTxFree(void){
+    return (INT16U)((bioTxTail - bioTxHead - 1) & BIO_TX_RING_MASK);
 }
 
 /*******************************************************************************************
@@ -21,6 +21,9 @@
  * v4.2
  *  Created by Todd Morton
  *  Modified to fix bug in BOIGetStrg() so a BS can be the first character pressed.
+ * v4.3
+ *  Transmit is queued in a ring drained by the UART2 TX interrupt once the kernel runs.
+ *  Receive is buffered by the UART2 RX interrupt and BIOGetChar() pends on it.
 ********************************************************************/
 #ifndef BIO_INCL
 #define BIO_INCL
@@ -33,6 +36,28 @@
 #define BIO_BIT_RATE_38400  2
 #define BIO_BIT_RATE_57600  3
 #define BIO_BIT_RATE_115200 4
+#define BIO_BIT_RATE_230400 5
+#define BIO_BIT_RATE_460800 6
+#define BIO_BIT_RATE_921600 7
+
+/******************************************************************************************
+ * Transmit ring. BIOWrite() queues characters and the UART2 TX interrupt sends them, so a
+ * writer only waits when the ring is full. Must be a power of two.
+ ******************************************************************************************/
+#define BIO_TX_RING_SIZE    1024
+
+/******************************************************************************************
+ * Receive ring. The UART2 RX interrupt stores characters here and wakes the task pending in
+ * BIOGetChar() with its task semaphore. Must be a power of two.
+ ******************************************************************************************/
+#define BIO_RX_RING_SIZE    256
+
+//Receive errors. An overrun is a character the UART lost because the RX interrupt was held
+//off too long, a dropped character arrived with the receive ring full.
+typedef struct{
+    INT32U overruns;
+    INT32U dropped;
+} BIO_RX_ERR_T;
 
 /*************************************************************************
 * Enumerated type for mode parameter in BIOOutDecWord()
@@ -50,12 +75,16 @@ typedef enum {
 ********************************************************************/
 /********************************************************************
 * BIOOpen() - Initialization routine for BasicIO()
+* Call after OSInit(), it creates the transmit ring semaphore.
 * Acceptable rates:
 *  BIO_BIT_RATE_9600
 *  BIO_BIT_RATE_19200
 *  BIO_BIT_RATE_38400
 *  BIO_BIT_RATE_57600
 *  BIO_BIT_RATE_115200
+*  BIO_BIT_RATE_230400
+*  BIO_BIT_RATE_460800
+*  BIO_BIT_RATE_921600
 ********************************************************************/
 void BIOOpen(INT8U rate);
 
@@ -67,10 +96,19 @@ INT8C BIORead(void);     /* Reads received character, 0 if none */
 
 /********************************************************************
 * BIOGetChar() - Blocks until character is received
+*    The calling task pends on its task semaphore, so it uses no CPU
+*    while waiting.
 *    return: ASCII character
 ********************************************************************/
 INT8C BIOGetChar(void);  /* Blocks until a character is received */
 
+/********************************************************************
+* BIORxErrGet() - Copies the receive error counts
+* BIORxErrReset() - Clears them
+********************************************************************/
+void BIORxErrGet(BIO_RX_ERR_T *rx_err);
+void BIORxErrReset(void);
+
 /********************************************************************
 * BIOGetStrg() - Inputs a string and stores it into an array.
 *
@@ -90,11 +128,17 @@ INT8U BIOGetStrg(INT8U strglen,INT8C *const strg); /*input a string */
 
 /********************************************************************
 * BIOWrite() - Sends an ASCII character
-*              Blocks as much as one character time
+*              Queues c in the transmit ring. Pends only while the ring
+*              is full. Before OSStart() it waits on the UART instead.
 *    parameter: c is the ASCII character to be sent
 ********************************************************************/
 void BIOWrite(INT8C c);  /* Send an ascii character */
 
+/********************************************************************
+* BIOTxFlush() - Waits until the transmit ring is empty.
+********************************************************************/
+void BIOTxFlush(void);
+
 /********************************************************************
 * BIOPutStrg() - Sends a C string
 *    parameter: strg is a pointer to the string
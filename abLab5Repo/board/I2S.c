@@ -6,6 +6,8 @@
 * Generates a 12MHz MCLK for the CODEC. The CODEC then generates the BCLK and WCLK's.
 * Based mostly on Aaron's code.
 * To change sample size, both the CODEC and the I2S module must be set to the correct size.
+* A frame has num_slots words. Two is the stereo CODEC, more is a TDM frame that the DMA moves one
+* frame per request, so the FIFO watermarks are moved to leave room for a whole frame.
 * 09/03/2015 Todd Morton
 *****************************************************************************************************/
 /*****************************************************************************************************
@@ -14,20 +16,31 @@
 #include "MCUType.h"
 #include "I2S.h"
 /*****************************************************************************************************
-* void I2SInit(INT32U u32TxFIFOWm, INT32U u32RxFIFOWm)
+* Private variables
+*****************************************************************************************************/
+static INT8U i2sNumSlots = I2S_STEREO_SLOTS;
+/*****************************************************************************************************
+* void I2SInit(INT8U size_code, INT8U num_slots)
 * Based mostly on Aaron's code.
 *  PARAMETERS: sizecode:
 *   0x00: 16-bit samples
 *   0x01: 20-bit samples
 *   0x10: 24-bit samples
 *   0x11: 32-bit samples
+*              num_slots: words per frame, 2 for stereo, up to I2S_FIFO_DEPTH for TDM.
+*   TDM slots are always 32 bits with the frame sync a one bit pulse, active high, one bit
+*   before the first slot, as the CODEC DSP mode sends it. size_code is ignored for TDM. The
+*   CODEC packs its words back to back in DSP mode, so it must stay at 32-bit samples too;
+*   DSPSampleSizeSet() and CODECSetSampleSize() keep it there.
 *
 * 09/03/2015 Todd Morton
 * 04/03/2019 Todd Morton Added sample size parameter
 *****************************************************************************************************/
-void I2SInit(INT8U size_code){
+void I2SInit(INT8U size_code, INT8U num_slots){
 
     INT8U i2s_word_size;
+    INT8U tx_wm = FIFO_TX_WM;
+    INT8U rx_wm = FIFO_RX_WM;
 
     switch(size_code){
     case 0x0:
@@ -46,6 +59,20 @@ void I2SInit(INT8U size_code){
         i2s_word_size = 31;
         break;
     }
+    i2sNumSlots = num_slots;
+    if(num_slots > I2S_STEREO_SLOTS){
+        i2s_word_size = 31;
+    }else{
+    }
+    //A transmit request needs room for a frame and a receive request a whole frame
+    if(tx_wm > (I2S_FIFO_DEPTH - num_slots)){
+        tx_wm = I2S_FIFO_DEPTH - num_slots;
+    }else{
+    }
+    if(rx_wm < (num_slots - 1)){
+        rx_wm = num_slots - 1;
+    }else{
+    }
 
     SIM->SCGC6 |= SIM_SCGC6_I2S_MASK;   //enable I2S clock gate
 
@@ -74,7 +101,7 @@ void I2SInit(INT8U size_code){
 	/****************************************************************************
 	 * I2S Transmitter Initialization
 	 ****************************************************************************/
-	I2S0->TCR1 |= I2S_TCR1_TFW(FIFO_TX_WM);
+	I2S0->TCR1 |= I2S_TCR1_TFW(tx_wm);
 
     // For using TX BLCK and FS CLK in synch mode, TX must be Asynch and Rx synch. BCLK generated externally
     I2S0->TCR2 |= I2S_TCR2_SYNC(0)  |        // master mode(Async mode)
@@ -84,11 +111,14 @@ void I2SInit(INT8U size_code){
 	/*transmit data channel 0 enabled */
 	I2S0->TCR3 |= I2S_TCR3_WDFL(0)|I2S_TCR3_TCE(1);
 //
-	I2S0->TCR4 |= I2S_TCR4_FRSZ(1)  |     // 2 (1+1) words in a frame
+	I2S0->TCR4 |= I2S_TCR4_FRSZ(num_slots - 1)  |     // num_slots words in a frame
 	            I2S_TCR4_SYWD(i2s_word_size) |     // bits in a word
 	            I2S_TCR4_MF_MASK  |     // MSB First
-	            I2S_TCR4_FSE_MASK |     // one bit early
-	            I2S_TCR4_FSP_MASK;      // frame active low
+	            I2S_TCR4_FSE_MASK;      // one bit early
+	if(num_slots == I2S_STEREO_SLOTS){
+	    I2S0->TCR4 |= I2S_TCR4_FSP_MASK;    // frame active low
+	}else{
+	}
 
 //	/*24-bit first and following words */
 	I2S0->TCR5 |= I2S_TCR5_WNW(i2s_word_size) |      // word N width, 32 bits
@@ -101,15 +131,18 @@ void I2SInit(INT8U size_code){
     /****************************************************************************
      * I2S Receiver Initialization
      ****************************************************************************/
-	I2S0->RCR1 |= I2S_RCR1_RFW(FIFO_RX_WM);
+	I2S0->RCR1 |= I2S_RCR1_RFW(rx_wm);
 	I2S0->RCR2 |= I2S_RCR2_SYNC(1);   //Rx synch with Tx
 	I2S0->RCR3 |= I2S_RCR3_WDFL(0)|I2S_RCR3_RCE(1);
 
-    I2S0->RCR4 |= I2S_RCR4_FRSZ(1)  |     // 2 words in a frame
+    I2S0->RCR4 |= I2S_RCR4_FRSZ(num_slots - 1)  |     // num_slots words in a frame
                 I2S_RCR4_SYWD(i2s_word_size) |     // 32 bits in a word
                 I2S_RCR4_MF_MASK  |     // MSB
-                I2S_RCR4_FSE_MASK |     // one bit early
-                I2S_RCR4_FSP_MASK;      // frame active low
+                I2S_RCR4_FSE_MASK;      // one bit early
+    if(num_slots == I2S_STEREO_SLOTS){
+        I2S0->RCR4 |= I2S_RCR4_FSP_MASK;    // frame active low
+    }else{
+    }
 
     I2S0->RCR5 |= I2S_RCR5_WNW(i2s_word_size) |      // word N width, 32 bits
                 I2S_RCR5_W0W(i2s_word_size) |      // word 0 width, 32 bits
@@ -118,9 +151,16 @@ void I2SInit(INT8U size_code){
 	I2S0->RCSR |= I2S_RCSR_FRDE_MASK|I2S_RCSR_FR_MASK;
 }
 
+/*****************************************************************************************************
+* I2SWordSizeSet - Changes the word size to match the CODEC. TDM slots stay 32 bits.
+*****************************************************************************************************/
 void I2SWordSizeSet(INT8U size_code){
     INT8U i2s_word_size;
 
+    if(i2sNumSlots > I2S_STEREO_SLOTS){
+        return;
+    }else{
+    }
     switch(size_code){
     case 0x0:
         i2s_word_size = 15; //for 16-bit words
@@ -19,6 +19,8 @@
 *****************************************************************************************************/
 #define FIFO_TX_WM          4       //I2S transmit FIFO watermark
 #define FIFO_RX_WM          4       //I2S receive FIFO watermark
+#define I2S_FIFO_DEPTH      8       //Words in each transmit and receive FIFO
+#define I2S_STEREO_SLOTS    2       //More slots per frame is TDM
 
 #define I2S_TX_ENABLE()	    (I2S0->TCSR |= I2S_TCSR_TE_MASK)
 #define I2S_TX_DISABLE()	(I2S0->TCSR &= ~I2S_TCSR_TE_MASK)
@@ -33,5 +35,5 @@
 /*****************************************************************************************************
 * Declaration of module wide FUNCTIONs - NOT for use in other modules
 *****************************************************************************************************/
-void I2SInit(INT8U size_code);
+void I2SInit(INT8U size_code, INT8U num_slots);
 void I2SWordSizeSet(INT8U size_code);
@@ -1,7 +1,9 @@
 /*******************************************************************************************
  * K65DMA.c
  * This version sets up the DMA for input and output based on DSP_IN_EN and DSP_OUT_EN.
- * Currently set up for ping-pong buffers on both inputs and outputs, only one channel.
+ * Both streams run through a ring of num_blocks blocks (2 is the classic ping-pong). Each
+ * block has its own TCD in RAM and the TCDs are linked by scatter/gather, so the engine
+ * moves from block to block with no CPU help and the input interrupts once per block.
  * 04/06/2017 Todd Morton
  ******************************************************************************************/
 
@@ -19,13 +21,35 @@
 *******************************************************************************************/
 #define DMA_IN_CH            2
 #define DMA_OUT_CH           0
-#define DMA_BYTES_PER_BLOCK      (DSP_SAMPLES_PER_BLOCK*DSP_BUFFER_BYTES_PER_SAMPLE)
-#define DMA_BYTES_PER_BUFFER     (DSP_NUM_BLOCKS*DSP_NUM_IN_CHANNELS*DMA_BYTES_PER_BLOCK)
-#define DMA_IN_CHANNEL_OFFSET    (DSP_NUM_BLOCKS*DMA_BYTES_PER_BLOCK)
-#define DMA_OUT_CHANNEL_OFFSET    (DSP_NUM_BLOCKS*DMA_BYTES_PER_BLOCK)
+//Buffer geometry for a block size of n samples and a ring of b blocks. One minor loop moves
+//one I2S frame, a sample of every channel, so the FIFO watermarks must leave room for a frame.
+#define DMA_BYTES_PER_BLOCK(n)          ((n)*DSP_BUFFER_BYTES_PER_SAMPLE)
+#define DMA_IN_BYTES_PER_BUFFER(n,b)    ((b)*DSP_NUM_IN_CHANNELS*DMA_BYTES_PER_BLOCK(n))
+#define DMA_OUT_BYTES_PER_BUFFER(n,b)   ((b)*DSP_NUM_OUT_CHANNELS*DMA_BYTES_PER_BLOCK(n))
+#define DMA_IN_CHANNEL_OFFSET(n,b)      ((b)*DMA_BYTES_PER_BLOCK(n))
+#define DMA_OUT_CHANNEL_OFFSET(n,b)     ((b)*DMA_BYTES_PER_BLOCK(n))
+
+//TCD image in RAM, same layout as DMA0->TCD[]. Scatter/gather needs 32 byte alignment.
+typedef struct{
+    INT32U saddr;
+    INT16U soff;
+    INT16U attr;
+    INT32U nbytes;
+    INT32U slast;
+    INT32U daddr;
+    INT16U doff;
+    INT16U citer;
+    INT32U dlast_sga;
+    INT16U csr;
+    INT16U biter;
+} DMA_TCD_T;
 
 typedef struct{
-    INT8U index;
+    INT8U index;                    //Newest full block
+    INT8U ready;                    //Full blocks not yet taken by DMAInPend()
+    INT8U num_blocks;
+    INT8U dropped;                  //Blocks lost to a full ring since the last DMAInPend()
+    INT32U seq;                     //Blocks finished
     OS_SEM flag;
 }DMA_BLOCK_RDY;
 /*******************************************************************************************
@@ -33,6 +57,11 @@ typedef struct{
 *******************************************************************************************/
 DMA_BLOCK_RDY dmaInBlockRdy;
 DMA_BLOCK_RDY dmaOutBlockRdy;
+static DMA_TCD_T dmaInTcd[DSP_NUM_BLOCKS_MAX] __attribute__((aligned(32)));
+static DMA_TCD_T dmaOutTcd[DSP_NUM_BLOCKS_MAX] __attribute__((aligned(32)));
+static void dmaTcdSet(q31_t *dsp_in_buf, q31_t *dsp_out_buf, INT32U block_size,
+                      INT8U num_blocks);
+static void dmaTcdLoad(INT8U ch, const DMA_TCD_T *tcd);
 /*******************************************************************************************
 * Global Variables
 *******************************************************************************************/
@@ -40,22 +69,26 @@ DMA_BLOCK_RDY dmaOutBlockRdy;
 * Function Code
 ********************************************************************************************
 DMAInInit
-    Initializes DMA for an input stream from ADC0 to ping-pong buffers
-    Parameters: none
+    Initializes DMA for an input stream from ADC0 to a ring of blocks
+    Parameters: dsp_in_buf, dsp_out_buf - buffers laid out as in AppDSP.h
+                block_size - samples per block
+                num_blocks - blocks in the ring
     Return: none
 *******************************************************************************************/
-void DMAInit(DSP_BLOCK_T *dsp_in_buf, DSP_BLOCK_T *dsp_out_buf){
+void DMAInit(q31_t *dsp_in_buf, q31_t *dsp_out_buf, INT32U block_size, INT8U num_blocks){
     OS_ERR os_err;
 
     OSSemCreate(&dmaInBlockRdy.flag, "Block Ready", 0, &os_err);
 
-    // dmaInBlockRdy.index indicates the buffer currently not being used by the DMA in the Ping-Pong scheme.
-    // It uses the DONE bit in the CSR to determine where the DMA is at. If DONE is 1, the DMA just finished
-    // the [1] block and will start filling the [0] block. So, when DONE is one, we want the processing to use
-    // the [1] block to avoid collisions with the DMA.
-    // Since the DMA starts with the [0] block, initialize the index to the [1] block.
+    // dmaInBlockRdy.index is the newest block the DMA has finished and dmaInBlockRdy.ready
+    // is how many finished blocks the processing has not taken yet. The DMA starts with
+    // the [0] block, so initialize the index to the last block.
 
-    dmaInBlockRdy.index = 1;
+    dmaInBlockRdy.num_blocks = num_blocks;
+    dmaInBlockRdy.index = num_blocks - 1;
+    dmaInBlockRdy.ready = 0;
+    dmaInBlockRdy.dropped = 0;
+    dmaInBlockRdy.seq = 0;
 
     //enable DMA clocks
     SIM->SCGC6 |= (SIM_SCGC6_DMAMUX_MASK);
@@ -63,86 +96,12 @@ void DMAInit(DSP_BLOCK_T *dsp_in_buf, DSP_BLOCK_T *dsp_out_buf){
 
     //Make sure DMAMUX is disabled
     DMAMUX->CHCFG[DMA_IN_CH] |= DMAMUX_CHCFG_ENBL(0)|DMAMUX_CHCFG_TRIG(0);
+    DMAMUX->CHCFG[DMA_OUT_CH] |= DMAMUX_CHCFG_ENBL(0)|DMAMUX_CHCFG_TRIG(0);
 
     //Minor Loop Mapping Enabled, Round Robin Arbitration, Debug enabled
     DMA0->CR = DMA_CR_EMLM(1) | DMA_CR_ERCA(1) | DMA_CR_ERGA(1) | DMA_CR_EDBG(1);
 
-    /**** START: DMA config for Input DMA  */
-
-    //source address is I2S receive data register
-    DMA0->TCD[DMA_IN_CH].SADDR = DMA_SADDR_SADDR(&I2S0->RDR[0]);
-
-    //No offset for source data address.  Always read RDR
-    DMA0->TCD[DMA_IN_CH].SOFF = DMA_SOFF_SOFF(0);
-
-    //Source and destination data size
-    DMA0->TCD[DMA_IN_CH].ATTR = DMA_ATTR_SMOD(0) | DMA_ATTR_SSIZE(2) | DMA_ATTR_DMOD(0) | DMA_ATTR_DSIZE(2);
-
-    //Destination Minor Loop Offset is enabled.  After each minor loop, the destination
-    //pointer jumps back to the next sample in the first channel buffer
-    // NBYTES = channels*bytes per sample.
-    DMA0->TCD[DMA_IN_CH].NBYTES_MLOFFYES= DMA_NBYTES_MLOFFYES_DMLOE(1) | DMA_NBYTES_MLOFFYES_SMLOE(0)
-                                        | DMA_NBYTES_MLOFFYES_MLOFF(-(DMA_BYTES_PER_BUFFER)+DSP_BUFFER_BYTES_PER_SAMPLE)
-                                        | DMA_NBYTES_MLOFFYES_NBYTES(DSP_NUM_IN_CHANNELS*DSP_BUFFER_BYTES_PER_SAMPLE);
-
-    //No adjustment to source address at end of major loop.
-    DMA0->TCD[DMA_IN_CH].SLAST = DMA_SLAST_SLAST(0);
-
-    //destination buffer address
-    DMA0->TCD[DMA_IN_CH].DADDR = DMA_DADDR_DADDR(dsp_in_buf);
-
-    DMA0->TCD[DMA_IN_CH].DOFF = DMA_DOFF_DOFF(DMA_IN_CHANNEL_OFFSET);
-
-    //Set minor loop iteration counters to number of minor loops in the major loop
-    DMA0->TCD[DMA_IN_CH].CITER_ELINKNO = DMA_CITER_ELINKNO_ELINK(0)|DMA_CITER_ELINKNO_CITER(DSP_NUM_BLOCKS*DSP_SAMPLES_PER_BLOCK);
-    DMA0->TCD[DMA_IN_CH].BITER_ELINKNO = DMA_BITER_ELINKNO_ELINK(0)|DMA_BITER_ELINKNO_BITER(DSP_NUM_BLOCKS*DSP_SAMPLES_PER_BLOCK);
-
-    //After Major loop, jump back to the beginning of each channel buffer
-    DMA0->TCD[DMA_IN_CH].DLAST_SGA = DMA_DLAST_SGA_DLASTSGA(-(DMA_IN_CHANNEL_OFFSET+DMA_BYTES_PER_BUFFER-DSP_BUFFER_BYTES_PER_SAMPLE));
-
-	//Enable interrupt at half filled Rx buffer and end of major loop.
-	//This allows "ping-pong" buffer processing.
-	DMA0->TCD[DMA_IN_CH].CSR = DMA_CSR_BWC(3) | DMA_CSR_INTHALF(1) | DMA_CSR_INTMAJOR(1);
-
-
-    /**** START: DMA config for DMA Out  */
-
-    DMAMUX->CHCFG[DMA_OUT_CH] |= DMAMUX_CHCFG_ENBL(0)|DMAMUX_CHCFG_TRIG(0);
-
-    //source address
-    DMA0->TCD[DMA_OUT_CH].SADDR = DMA_SADDR_SADDR(dsp_out_buf);
-
-    //No offset for single channel
-    DMA0->TCD[DMA_OUT_CH].SOFF = DMA_SOFF_SOFF(DMA_OUT_CHANNEL_OFFSET);
-
-    //Source data size
-    DMA0->TCD[DMA_OUT_CH].ATTR = DMA_ATTR_SMOD(0) | DMA_ATTR_SSIZE(2) | DMA_ATTR_DMOD(0) | DMA_ATTR_DSIZE(2);
-
-    //Destination Minor Loop Offset is enabled.  After each minor loop, the destination
-    //pointer jumps back to the next sample in the first channel buffer
-    // NBYTES = channels*bytes per sample.
-    DMA0->TCD[DMA_OUT_CH].NBYTES_MLOFFYES= DMA_NBYTES_MLOFFYES_DMLOE(0) | DMA_NBYTES_MLOFFYES_SMLOE(1)
-                                        | DMA_NBYTES_MLOFFYES_MLOFF(-(DMA_BYTES_PER_BUFFER)+DSP_BUFFER_BYTES_PER_SAMPLE)
-                                        | DMA_NBYTES_MLOFFYES_NBYTES(DSP_NUM_IN_CHANNELS*DSP_BUFFER_BYTES_PER_SAMPLE);
-
-    //No adjustment to destination address at end of major loop.
-    DMA0->TCD[DMA_OUT_CH].DLAST_SGA = DMA_DLAST_SGA_DLASTSGA(0);
-
-    DMA0->TCD[DMA_OUT_CH].DOFF = DMA_DOFF_DOFF(0);
-
-    //Source buffer address
-    DMA0->TCD[DMA_OUT_CH].DADDR = DMA_DADDR_DADDR(&I2S0->TDR[0]);
-
-    //Set minor loop iteration counters to number of minor loops in the major loop
-    DMA0->TCD[DMA_OUT_CH].CITER_ELINKNO = DMA_CITER_ELINKNO_ELINK(0)|DMA_CITER_ELINKNO_CITER(DSP_NUM_BLOCKS*DSP_SAMPLES_PER_BLOCK);
-    DMA0->TCD[DMA_OUT_CH].BITER_ELINKNO = DMA_BITER_ELINKNO_ELINK(0)|DMA_BITER_ELINKNO_BITER(DSP_NUM_BLOCKS*DSP_SAMPLES_PER_BLOCK);
-
-    //After Major loop, jump back to the beginning of each channel buffer
-    DMA0->TCD[DMA_OUT_CH].SLAST = DMA_SLAST_SLAST(-(DMA_IN_CHANNEL_OFFSET+DMA_BYTES_PER_BUFFER-DSP_BUFFER_BYTES_PER_SAMPLE));
-
-    //No output channel interrupts
-    DMA0->TCD[DMA_OUT_CH].CSR = DMA_CSR_BWC(3);
-
+    dmaTcdSet(dsp_in_buf, dsp_out_buf, block_size, num_blocks);
 
     //Output channel mux I2S0-TX (13)
     DMAMUX->CHCFG[DMA_OUT_CH] = DMAMUX_CHCFG_ENBL(1)|DMAMUX_CHCFG_SOURCE(13);
@@ -163,40 +122,110 @@ void DMAInit(DSP_BLOCK_T *dsp_in_buf, DSP_BLOCK_T *dsp_out_buf){
 
 /****************************************************************************************
  * DMA Interrupt Handler for the sample stream
+ * At the end of a block the engine has already loaded the TCD of the next block, whose
+ * DLAST_SGA points at the TCD after that. So the finished block is two behind the TCD
+ * in DLAST_SGA. Reading it from the hardware keeps the index right even if interrupts
+ * were merged; the ready count then grows by the number of blocks finished since the
+ * last interrupt. It stops at num_blocks-1, the most the ring can hold before the DMA
+ * refills the oldest one. Blocks beyond that were overwritten and count as dropped.
  * 08/30/2015 TDM
  ***************************************************************************************/
 void DMA2_DMA18_IRQHandler(void){
     OS_ERR os_err;
+    INT8U num_blocks = dmaInBlockRdy.num_blocks;
+    INT8U sga_index;
+    INT8U done;
+    INT8U new_blocks;
     OSIntEnter();
     DB1_TURN_ON();
-    DMA0->CINT = DMA_CINT_CINT(2);
-    if((DMA0->TCD[DMA_IN_CH].CSR & DMA_CSR_DONE_MASK) != 0){
-        dmaInBlockRdy.index = 1;      //set buffer index to opposite of DMA
+    DMA0->CINT = DMA_CINT_CINT(DMA_IN_CH);
+    sga_index = (INT8U)((DMA0->TCD[DMA_IN_CH].DLAST_SGA - (INT32U)&dmaInTcd[0])/sizeof(DMA_TCD_T));
+    done = (INT8U)((sga_index + num_blocks - 2) % num_blocks);
+    new_blocks = (INT8U)((done + num_blocks - dmaInBlockRdy.index) % num_blocks);
+    if(new_blocks == 0){
+        new_blocks = num_blocks;                    //A whole lap, the ring is full
     }else{
-        dmaInBlockRdy.index = 0;
+    }
+    dmaInBlockRdy.index = done;
+    dmaInBlockRdy.seq += new_blocks;
+    if((dmaInBlockRdy.ready + new_blocks) < num_blocks){
+        dmaInBlockRdy.ready += new_blocks;
+    }else{
+        if(dmaInBlockRdy.dropped < (0xFF - num_blocks)){
+            dmaInBlockRdy.dropped += (INT8U)(dmaInBlockRdy.ready + new_blocks - (num_blocks - 1));
+        }else{
+        }
+        dmaInBlockRdy.ready = num_blocks - 1;
     }
     OSSemPost(&(dmaInBlockRdy.flag),OS_OPT_POST_1,&os_err);
     DB1_TURN_OFF();
     OSIntExit();
 }
 /****************************************************************************************
- * DMA signal when full or half full
+ * DMA signal when a block is full
+ * Returns the oldest full block not yet taken, so blocks are processed in order even
+ * when the task falls behind by up to num_blocks-1 blocks. If info is not null it gets
+ * the sequence number of the block, the backlog and the blocks dropped.
  * 08/30/2015 TDM
  ***************************************************************************************/
-INT8U DMAInPend(OS_TICK tout, OS_ERR *os_err_ptr){
-
-    OSSemPend(&(dmaInBlockRdy.flag), tout, OS_OPT_PEND_BLOCKING,(void *)0, os_err_ptr);
+INT8U DMAInPend(OS_TICK tout, DMA_IN_INFO_T *info, OS_ERR *os_err_ptr){
+    INT8U index;
+    CPU_SR_ALLOC();
+
+    *os_err_ptr = OS_ERR_NONE;
+    while(*os_err_ptr == OS_ERR_NONE){
+        CPU_CRITICAL_ENTER();
+        if(dmaInBlockRdy.ready != 0){
+            index = (INT8U)((dmaInBlockRdy.index + dmaInBlockRdy.num_blocks + 1 - dmaInBlockRdy.ready)
+                            % dmaInBlockRdy.num_blocks);
+            if(info != (void *)0){
+                info->seq = dmaInBlockRdy.seq + 1 - dmaInBlockRdy.ready;
+                info->backlog = dmaInBlockRdy.ready;
+                info->dropped = dmaInBlockRdy.dropped;
+            }else{
+            }
+            dmaInBlockRdy.dropped = 0;
+            dmaInBlockRdy.ready--;
+            CPU_CRITICAL_EXIT();
+            return index;
+        }else{
+        }
+        CPU_CRITICAL_EXIT();
+        OSSemPend(&(dmaInBlockRdy.flag), tout, OS_OPT_PEND_BLOCKING,(void *)0, os_err_ptr);
+    }
     return dmaInBlockRdy.index;
 }
 /****************************************************************************************
- * DMA stop at end of major block
+ * DMAInSeqGet
+ * Returns the number of blocks the input has finished. A block with sequence number s
+ * is refilled by the input, and played by the output, once this reaches
+ * s + num_blocks - 1.
+ ***************************************************************************************/
+INT32U DMAInSeqGet(void){
+    return dmaInBlockRdy.seq;
+}
+/****************************************************************************************
+ * DMAInReadyGet
+ * Returns the number of full blocks waiting to be processed
+ ***************************************************************************************/
+INT8U DMAInReadyGet(void){
+    return dmaInBlockRdy.ready;
+}
+/****************************************************************************************
+ * DMA stop at end of the ring
  * By using this, the DMA will stop filling the buffer when the DMA finishes with the
- * last sample in the block.
+ * last sample in the last block. The request is set in the TCD image of the last block
+ * and, if that block is already running, in the channel too.
  * 04/16/2020 TDM
  ***************************************************************************************/
 void DMAStopFull(void){
+    INT8U last = dmaInBlockRdy.num_blocks - 1;
 
-    DMA0->TCD[DMA_IN_CH].CSR |= DMA_CSR_DREQ_MASK;
+    dmaInTcd[last].csr |= DMA_CSR_DREQ_MASK;
+    if(DMA0->TCD[DMA_IN_CH].DLAST_SGA == (INT32U)&dmaInTcd[0]){
+        DMA0->TCD[DMA_IN_CH].CSR |= DMA_CSR_DREQ_MASK;
+    }else{
+    }
 
 }
 /****************************************************************************************
@@ -207,6 +236,7 @@ void DMAStopFull(void){
  ***************************************************************************************/
 void DMAStart(void){
 
+    dmaInTcd[dmaInBlockRdy.num_blocks - 1].csr &= ~DMA_CSR_DREQ_MASK;
     DMA0->TCD[DMA_IN_CH].CSR &= ~DMA_CSR_DREQ_MASK;
     I2S0->RCSR |= I2S_RCSR_SEF_MASK|I2S_RCSR_FEF_MASK;
 
@@ -215,4 +245,155 @@ void DMAStart(void){
     DMA0->SERQ = DMA_SERQ_SERQ(DMA_OUT_CH);
 
 }
+/****************************************************************************************
+ * DMAHalt
+ * Stops both channels at once, wherever they are in the ring, and masks the block
+ * interrupt. Used before DMARingSet().
+ ***************************************************************************************/
+void DMAHalt(void){
+
+    NVIC_DisableIRQ(DMA_IN_CH);
+    DMA0->CERQ = DMA_CERQ_CERQ(DMA_IN_CH);
+    DMA0->CERQ = DMA_CERQ_CERQ(DMA_OUT_CH);
+    while(((DMA0->TCD[DMA_IN_CH].CSR & DMA_CSR_ACTIVE_MASK) != 0) ||
+          ((DMA0->TCD[DMA_OUT_CH].CSR & DMA_CSR_ACTIVE_MASK) != 0)){
+    }
 
+}
+/****************************************************************************************
+ * DMARingSet
+ * Reprograms the halted channels for a new block size, ring depth and buffers and
+ * restarts them at block [0]. Any block ready signal from the old layout is discarded.
+ * The I2S FIFO error flags are cleared because the FIFOs ran dry while the DMA was
+ * halted.
+ ***************************************************************************************/
+void DMARingSet(q31_t *dsp_in_buf, q31_t *dsp_out_buf, INT32U block_size, INT8U num_blocks){
+    OS_ERR os_err;
+
+    dmaTcdSet(dsp_in_buf, dsp_out_buf, block_size, num_blocks);
+    OSSemSet(&dmaInBlockRdy.flag, 0, &os_err);
+    dmaInBlockRdy.num_blocks = num_blocks;
+    dmaInBlockRdy.index = num_blocks - 1;
+    dmaInBlockRdy.ready = 0;
+    dmaInBlockRdy.dropped = 0;
+    DMA0->CINT = DMA_CINT_CINT(DMA_IN_CH);
+    NVIC_ClearPendingIRQ(DMA_IN_CH);
+    NVIC_EnableIRQ(DMA_IN_CH);
+
+    I2S0->RCSR |= I2S_RCSR_SEF_MASK|I2S_RCSR_FEF_MASK;
+    I2S0->TCSR |= I2S_TCSR_SEF_MASK|I2S_TCSR_FEF_MASK;
+    DMA0->SERQ = DMA_SERQ_SERQ(DMA_IN_CH);
+    DMA0->SERQ = DMA_SERQ_SERQ(DMA_OUT_CH);
+}
+
+/****************************************************************************************
+ * dmaTcdSet
+ * Builds one input and one output TCD per block, linked in a ring by scatter/gather,
+ * and loads the [0] block TCDs into the channels. Every input TCD interrupts at the end
+ * of its block.
+ ***************************************************************************************/
+static void dmaTcdSet(q31_t *dsp_in_buf, q31_t *dsp_out_buf, INT32U block_size,
+                      INT8U num_blocks){
+    INT8U b;
+    INT8U next;
+
+    for(b=0;b<num_blocks;b++){
+        next = (INT8U)((b + 1) % num_blocks);
+
+        /**** START: DMA config for Input DMA  */
+
+        //source address is I2S receive data register
+        dmaInTcd[b].saddr = DMA_SADDR_SADDR(&I2S0->RDR[0]);
+
+        //No offset for source data address.  Always read RDR
+        dmaInTcd[b].soff = DMA_SOFF_SOFF(0);
+
+        //Source and destination data size
+        dmaInTcd[b].attr = DMA_ATTR_SMOD(0) | DMA_ATTR_SSIZE(2) | DMA_ATTR_DMOD(0) | DMA_ATTR_DSIZE(2);
+
+        //Destination Minor Loop Offset is enabled.  After each minor loop, the destination
+        //pointer jumps back to the next sample in the first channel buffer
+        // NBYTES = channels*bytes per sample, one word per TDM slot.
+        dmaInTcd[b].nbytes = DMA_NBYTES_MLOFFYES_DMLOE(1) | DMA_NBYTES_MLOFFYES_SMLOE(0)
+                           | DMA_NBYTES_MLOFFYES_MLOFF(-(DMA_IN_BYTES_PER_BUFFER(block_size,num_blocks))+DSP_BUFFER_BYTES_PER_SAMPLE)
+                           | DMA_NBYTES_MLOFFYES_NBYTES(DSP_NUM_IN_CHANNELS*DSP_BUFFER_BYTES_PER_SAMPLE);
+
+        //No adjustment to source address at end of major loop.
+        dmaInTcd[b].slast = DMA_SLAST_SLAST(0);
+
+        //destination is block b of the first channel buffer
+        dmaInTcd[b].daddr = DMA_DADDR_DADDR(&dsp_in_buf[b*block_size]);
+
+        dmaInTcd[b].doff = DMA_DOFF_DOFF(DMA_IN_CHANNEL_OFFSET(block_size,num_blocks));
+
+        //One block per major loop
+        dmaInTcd[b].citer = DMA_CITER_ELINKNO_ELINK(0)|DMA_CITER_ELINKNO_CITER(block_size);
+        dmaInTcd[b].biter = DMA_BITER_ELINKNO_ELINK(0)|DMA_BITER_ELINKNO_BITER(block_size);
+
+        //After the major loop, load the TCD of the next block
+        dmaInTcd[b].dlast_sga = (INT32U)&dmaInTcd[next];
+
+        //Interrupt at the end of every block
+        dmaInTcd[b].csr = DMA_CSR_BWC(3) | DMA_CSR_ESG(1) | DMA_CSR_INTMAJOR(1);
+
+
+        /**** START: DMA config for DMA Out  */
+
+        //source is block b of the first channel buffer
+        dmaOutTcd[b].saddr = DMA_SADDR_SADDR(&dsp_out_buf[b*block_size]);
+
+        //Source offset jumps to the same sample of the next channel
+        dmaOutTcd[b].soff = DMA_SOFF_SOFF(DMA_OUT_CHANNEL_OFFSET(block_size,num_blocks));
+
+        //Source data size
+        dmaOutTcd[b].attr = DMA_ATTR_SMOD(0) | DMA_ATTR_SSIZE(2) | DMA_ATTR_DMOD(0) | DMA_ATTR_DSIZE(2);
+
+        //Source Minor Loop Offset is enabled.  After each minor loop, the source
+        //pointer jumps back to the next sample in the first channel buffer
+        // NBYTES = channels*bytes per sample, one word per TDM slot.
+        dmaOutTcd[b].nbytes = DMA_NBYTES_MLOFFYES_DMLOE(0) | DMA_NBYTES_MLOFFYES_SMLOE(1)
+                            | DMA_NBYTES_MLOFFYES_MLOFF(-(DMA_OUT_BYTES_PER_BUFFER(block_size,num_blocks))+DSP_BUFFER_BYTES_PER_SAMPLE)
+                            | DMA_NBYTES_MLOFFYES_NBYTES(DSP_NUM_OUT_CHANNELS*DSP_BUFFER_BYTES_PER_SAMPLE);
+
+        //The next TCD sets its own source address
+        dmaOutTcd[b].slast = DMA_SLAST_SLAST(0);
+
+        //Destination is the I2S transmit data register
+        dmaOutTcd[b].daddr = DMA_DADDR_DADDR(&I2S0->TDR[0]);
+
+        dmaOutTcd[b].doff = DMA_DOFF_DOFF(0);
+
+        //One block per major loop
+        dmaOutTcd[b].citer = DMA_CITER_ELINKNO_ELINK(0)|DMA_CITER_ELINKNO_CITER(block_size);
+        dmaOutTcd[b].biter = DMA_BITER_ELINKNO_ELINK(0)|DMA_BITER_ELINKNO_BITER(block_size);
+
+        //After the major loop, load the TCD of the next block
+        dmaOutTcd[b].dlast_sga = (INT32U)&dmaOutTcd[next];
+
+        //No output channel interrupts
+        dmaOutTcd[b].csr = DMA_CSR_BWC(3) | DMA_CSR_ESG(1);
+    }
+    dmaTcdLoad(DMA_IN_CH, &dmaInTcd[0]);
+    dmaTcdLoad(DMA_OUT_CH, &dmaOutTcd[0]);
+}
+
+/****************************************************************************************
+ * dmaTcdLoad
+ * Copies a TCD image into a stopped channel. CSR is written last, which also clears
+ * DONE so scatter/gather can be enabled.
+ ***************************************************************************************/
+static void dmaTcdLoad(INT8U ch, const DMA_TCD_T *tcd){
+
+    DMA0->TCD[ch].CSR = 0;
+    DMA0->TCD[ch].SADDR = tcd->saddr;
+    DMA0->TCD[ch].SOFF = tcd->soff;
+    DMA0->TCD[ch].ATTR = tcd->attr;
+    DMA0->TCD[ch].NBYTES_MLOFFYES = tcd->nbytes;
+    DMA0->TCD[ch].SLAST = tcd->slast;
+    DMA0->TCD[ch].DADDR = tcd->daddr;
+    DMA0->TCD[ch].DOFF = tcd->doff;
+    DMA0->TCD[ch].CITER_ELINKNO = tcd->citer;
+    DMA0->TCD[ch].DLAST_SGA = tcd->dlast_sga;
+    DMA0->TCD[ch].BITER_ELINKNO = tcd->biter;
+    DMA0->TCD[ch].CSR = tcd->csr;
+}
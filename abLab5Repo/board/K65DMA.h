@@ -12,6 +12,12 @@
 /*****************************************************************************************************
 * Definition of sample stream macros/constants
 *****************************************************************************************************/
+//What DMAInPend() knows about the block it returns
+typedef struct{
+    INT32U seq;                     //Sequence number of the block, counts every block finished
+    INT8U backlog;                  //Full blocks waiting, this one included
+    INT8U dropped;                  //Blocks overwritten before they were taken since the last pend
+} DMA_IN_INFO_T;
 
 /*****************************************************************************************************
 * Definition of global VARIABLES
@@ -21,8 +27,12 @@
 * Declaration of public functions
 *****************************************************************************************************/
 void DMA2_DMA18_IRQHandler(void);
-void DMAInit(DSP_BLOCK_T *dsp_in_buf, DSP_BLOCK_T *dsp_out_buf);
-INT8U DMAInPend(OS_TICK tout, OS_ERR *os_err_ptr);
+void DMAInit(q31_t *dsp_in_buf, q31_t *dsp_out_buf, INT32U block_size, INT8U num_blocks);
+void DMAHalt(void);
+void DMARingSet(q31_t *dsp_in_buf, q31_t *dsp_out_buf, INT32U block_size, INT8U num_blocks);
+INT8U DMAInPend(OS_TICK tout, DMA_IN_INFO_T *info, OS_ERR *os_err_ptr);
+INT32U DMAInSeqGet(void);
+INT8U DMAInReadyGet(void);
 void DMAStopFull(void);
 void DMAStart(void);
 
@@ -14,6 +14,7 @@
 
 //#include <stdint.h>
 #include "MCUType.h"
+#include "cpu_core.h"
 #include "K65TWR_ClkCfg.h"
 
 /****************************************************************************************
@@ -248,3 +249,24 @@ void K65TWR_BootClock(void){
     }
 #endif
 }
+
+/****************************************************************************************
+ * CPU_TS_TmrInit() - uC/CPU timestamp timer for the K65. The DWT cycle counter runs at
+ * the core clock and is a free running 32-bit up counter, as uC/CPU requires. It is not
+ * cleared here so other modules can keep timing with it across this call.
+ * Called from CPU_Init().
+ ***************************************************************************************/
+#if (CPU_CFG_TS_TMR_EN == DEF_ENABLED)
+void CPU_TS_TmrInit(void){
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    CPU_TS_TmrFreqSet((CPU_TS_TMR_FREQ)SYSTEM_CLOCK);
+}
+
+/****************************************************************************************
+ * CPU_TS_TmrRd() - Returns the DWT cycle count as the uC/CPU timestamp timer count.
+ ***************************************************************************************/
+CPU_TS_TMR CPU_TS_TmrRd(void){
+    return (CPU_TS_TMR)DWT->CYCCNT;
+}
+#endif
@@ -305,4 +305,9 @@
  ***************************************************************************************/
 void K65TWR_BootClock(void);
 
+/****************************************************************************************
+ * The uC/CPU timestamp timer, CPU_TS_TmrInit() and CPU_TS_TmrRd(), is defined in
+ * K65TWR_ClkCfg.c on the DWT cycle counter. Prototypes are in cpu_core.h.
+ ***************************************************************************************/
+
 #endif  /* #if !defined(K65TWR_CLKCFG_H_) */
@@ -66,6 +66,8 @@ static const INT8U headPhoneOutOn[] = {
     0x0F
 };
 
+static INT8U codecAsiMode = CODEC_ASI_MODE_LJ;     //Register 9 without the sample size
+
 /********************************************************************
 * Function Definitions
 *********************************************************************
@@ -401,9 +403,18 @@ INT8U CODECSetSampleRate(INT8U rateCode){
 *  Notes: TODO: This needs to be modified so it uses read-modify-write.
 *         To change the sample size the CODEC and the I2S word size
 *         must be changed.
+*         In DSP mode the words are sent back to back, so the right
+*         word only lands in the second 32-bit TDM slot at 32 bits.
+*         A TDM frame always gets 32-bit samples.
 ********************************************************************/
 INT8U CODECSetSampleSize(INT8U sizeCode){
-    INT8U sampleSizeData[] = {0x09,((0xC|sizeCode)<<4)};   //Register 9
+    INT8U sampleSizeData[] = {0x09,0x00};   //Register 9
+
+    if(codecAsiMode == CODEC_ASI_MODE_DSP_256){
+        sizeCode = CODEC_SSIZE_CODE_32BIT;
+    }else{
+    }
+    sampleSizeData[1] = codecAsiMode|(sizeCode<<4);
 
     I2CSendStart();
     if(!I2CSendBlock(sampleSizeData,2)){
@@ -414,6 +425,49 @@ INT8U CODECSetSampleSize(INT8U sizeCode){
     return 1;   //data transmit successful, ACK received.
 }
 
+/*********************************************************************
+* CODECSetTdm(INT8U enable) - Public
+*
+*  PARAMETERS: enable - 0 for the left-justified stereo frame,
+*                       1 for a TDM frame.
+*
+*  RETURN:  INT8U - 0=NAK from slave.  1=ACK.
+*  DESCRIPTION: A TDM frame uses DSP mode with 256 bit clocks per frame,
+*  eight 32-bit slots, the CODEC in the first two. The frame sync is a
+*  one clock pulse just before the first slot, so the data offset is 0.
+*  A 4-slot I2S frame leaves the last four slots of it unused.
+*  TDM also sets 32-bit samples to fill the slots, see
+*  CODECSetSampleSize(). Back to stereo, read-modify-write keeps the
+*  sample size.
+********************************************************************/
+INT8U CODECSetTdm(INT8U enable){
+    INT8U asiData1[] = {0x09, 0x00};    //Register 9
+    INT8U asiData2[] = {0x0A, 0x01};    //Register 10, data offset
+
+    if(enable != 0){
+        codecAsiMode = CODEC_ASI_MODE_DSP_256;
+        asiData1[1] = codecAsiMode|(CODEC_SSIZE_CODE_32BIT<<4);
+        asiData2[1] = 0x00;
+    }else{
+        codecAsiMode = CODEC_ASI_MODE_LJ;
+        asiData1[1] = codecAsiMode|(CODECReadRegister(0, 0x09) & CODEC_ASI_SIZE_MASK);
+    }
+
+    I2CSendStart();
+    if(!I2CSendBlock(asiData1,2)){
+        return 0;   //failed I2C transmit
+    }
+    I2CSendStop();
+
+    I2CSendStart();
+    if(!I2CSendBlock(asiData2,2)){
+        return 0;   //failed I2C transmit
+    }
+    I2CSendStop();
+
+    return 1;
+}
+
 /*********************************************************************
 * CODECConfigPLL(void) - Public
 *
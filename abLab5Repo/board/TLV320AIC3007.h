@@ -14,6 +14,7 @@ INT8U CODECDisableClassD(void);
 INT8U CODECHeadphoneOutOn(void);
 INT8U CODECSetSampleRate(INT8U rateCode);
 INT8U CODECSetSampleSize(INT8U sizeCode);
+INT8U CODECSetTdm(INT8U enable);
 void CODECEnable(void);
 void CODECDisable(void);
 // TODO: The following functions have not been completed.
@@ -63,3 +64,8 @@ INT8U CODECConfigLeftLOP(void);
 #define CODEC_SSIZE_CODE_24BIT            0x2
 #define CODEC_SSIZE_CODE_32BIT            0x3
 
+//Audio serial interface modes, register 9
+#define CODEC_ASI_MODE_LJ                 0xC0    //Left-justified, stereo
+#define CODEC_ASI_MODE_DSP_256            0x48    //DSP mode, 256-clock frame, TDM
+#define CODEC_ASI_SIZE_MASK               0x30
+
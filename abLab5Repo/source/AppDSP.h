@@ -14,21 +14,62 @@
 * DSP configuration constants.
 * Here a buffer is the complete data object, which may be comprised of multiple blocks. For example,
 * when using a ping-pong buffer, there are two blocks.
+* Each I2S frame carries DSP_TDM_SLOTS words, one per channel. 2 is the stereo CODEC, 4 or 8 is a
+* TDM frame with the CODEC in the first two slots and other devices on the bus in the rest. The DMA
+* de-interleaves every slot into its own channel buffer.
+* A TDM frame has 32-bit slots and the CODEC stays at 32-bit samples in it, DSPSampleSizeSet() refuses
+* other sizes. TDM has not been run on hardware. To bring it up, build with 4 or 8 slots and:
+*   dsp_n           reports the CODEC register check, DSPTdmCheck(): register 9 must be 0x78 (DSP
+*                   mode, 256 clocks, 32 bits) and register 10 0x00 (no data offset).
+*   scope           FS is a one BCLK high pulse every 256 BCLKs, one BCLK before the left MSB.
+*   dsp_lat         with the line out looped to the line in, l_in and r_in must each find a peak.
+*                   A swapped or missing peak means the slots are off by one.
 *****************************************************************************************************/
-#define DSP_NUM_BLOCKS                  2
-#define DSP_SAMPLES_PER_BLOCK           512
+#define DSP_TDM_SLOTS                   2       //Words per I2S frame, 2, 4 or 8
+#define DSP_NUM_BLOCKS                  2       //DMA ring depth at start up, 2 is ping-pong
+#define DSP_NUM_BLOCKS_MIN              2       //Runtime ring depth limits
+#define DSP_NUM_BLOCKS_MAX              8
+#define DSP_SAMPLES_PER_BLOCK           (DSP_RING_SAMPLES_MAX/(2*DSP_NUM_BLOCKS))  //Block size at start up
+#define DSP_BLOCK_SIZE_MIN              32      //Runtime block size limits, powers of two
+#define DSP_BLOCK_SIZE_MAX              1024
 #define DSP_BUFFER_BYTES_PER_SAMPLE     4
-#define DSP_NUM_IN_CHANNELS             2
-#define DSP_NUM_OUT_CHANNELS            2
-#define DSP_LEFT_CH                     0
+#define DSP_NUM_IN_CHANNELS             DSP_TDM_SLOTS
+#define DSP_NUM_OUT_CHANNELS            DSP_TDM_SLOTS
+#define DSP_LEFT_CH                     0       //The CODEC slots
 #define DSP_RIGHT_CH                    1
 
+#if (DSP_TDM_SLOTS != 2) && (DSP_TDM_SLOTS != 4) && (DSP_TDM_SLOTS != 8)
+#error "DSP_TDM_SLOTS must be 2, 4 or 8"
+#endif
+
 /*****************************************************************************************************
-* DSP global sample blocks, typedef
+* DSP sample buffers
+* The buffers are carved out of a fixed arena of DSP_RING_SAMPLES_MAX samples per channel. For a
+* block size of N and a ring of B blocks, channel ch block b starts at sample (ch*B + b)*N of its
+* arena, so N*B may not be more than DSP_RING_SAMPLES_MAX. The arena memory is the same for any
+* number of slots, so more channels get shorter rings.
 *****************************************************************************************************/
-typedef struct{
-    q31_t samples[DSP_SAMPLES_PER_BLOCK];
-} DSP_BLOCK_T;
+#define DSP_RING_SAMPLES_MAX            ((4*DSP_BLOCK_SIZE_MAX)/DSP_TDM_SLOTS)
+#define DSP_ARENA_SAMPLES(channels)     ((channels)*DSP_RING_SAMPLES_MAX)
+
+//Snapshot arena. A snapshot is a run of consecutive blocks of one buffer copied by dspTask.
+#define DSP_SNAP_SAMPLES_MAX            (4*DSP_BLOCK_SIZE_MAX)
+#define DSP_SNAP_TOUT                   2000    //Ticks, covers DSP_SNAP_SAMPLES_MAX at 8kHz
+
+//DSPBlockLayoutSet() error codes
+#define DSP_BLOCK_ERR_NONE          0
+#define DSP_BLOCK_ERR_SIZE          1
+#define DSP_BLOCK_ERR_COUNT         2
+#define DSP_BLOCK_ERR_ARENA         3       //Blocks do not fit in the arena
+
+//DSPSampleSizeSet() error codes
+#define DSP_SSIZE_ERR_NONE          0
+#define DSP_SSIZE_ERR_TDM           1       //TDM slots are fixed at 32 bits
+
+//DSPTdmCheck() error codes
+#define DSP_TDM_ERR_NONE            0
+#define DSP_TDM_ERR_ASI             1       //CODEC register 9 is not DSP mode, 32 bits
+#define DSP_TDM_ERR_OFFSET          2       //CODEC register 10 data offset is not 0
 
 //Sample size codes
 #define DSP_SSIZE_CODE_16BIT        CODEC_SSIZE_CODE_16BIT
@@ -55,17 +96,57 @@ typedef struct{
 } DSP_PARAMS_T;
 
 typedef enum{LEFT_IN, RIGHT_IN, LEFT_OUT, RIGHT_OUT} BUFF_ID_T;
+
+//Block processing time in CPU cycles. cycles_deadline is one block period at the current rate.
+typedef struct{
+    INT32U cycles_last;
+    INT32U cycles_max;
+    INT32U cycles_deadline;
+    INT32U blocks;
+} DSP_BENCH_T;
+
+//Block handoff errors. An overrun is a block the DMA refilled before dspTask took it, an
+//underrun is a block dspTask finished after the output had started to play it. A late block
+//was taken with more blocks waiting behind it, which the DMA ring absorbed.
+#define DSP_XRUN_LOG_LEN        8
+#define DSP_XRUN_OVERRUN        0
+#define DSP_XRUN_UNDERRUN       1
+
+typedef struct{
+    INT32U overruns;
+    INT32U underruns;
+    INT32U late;
+    INT8U backlog_max;                      //Most full blocks waiting at once
+} DSP_XRUN_T;
+
+typedef struct{
+    INT8U type;                             //DSP_XRUN_OVERRUN or DSP_XRUN_UNDERRUN
+    INT8U count;                            //Blocks involved
+    INT32U seq;                             //DMA block sequence number
+    OS_TICK tick;                           //OSTimeGet() when detected
+} DSP_XRUN_EVENT_T;
 /*****************************************************************************************************
 * Declaration of project wide FUNCTIONS
 *****************************************************************************************************/
 void DSPInit(void);
-void DSPSampleSizeSet(INT8U ssize_code);
+INT8U DSPSampleSizeSet(INT8U ssize_code);
+INT8U DSPTdmCheck(void);
 void DSPSampleRateSet(INT8U rate_code);
 INT8U DSPSampleSizeGet(void);
 INT16U DSPSampleRateGet(void);
-void DSPStartReq(void);
-void DSPStopReq(void);
-void DSPStopFullPend(OS_TICK tout, OS_ERR *os_err_ptr);
-INT32S *DSPBufferGet(BUFF_ID_T buff_id);
+void DSPBlockProcess(INT8U buffer_index);
+INT8U DSPBlockLayoutSet(INT16U block_size, INT8U num_blocks);
+INT8U DSPBlockSizeSet(INT16U block_size);
+INT16U DSPBlockSizeGet(void);
+INT8U DSPBlockCountSet(INT8U num_blocks);
+INT8U DSPBlockCountGet(void);
+void DSPBenchGet(DSP_BENCH_T *bench);
+void DSPBenchReset(void);
+INT8U DSPIirDefaultAdd(INT8U ch);
+void DSPXrunGet(DSP_XRUN_T *xrun);
+INT8U DSPXrunLogGet(DSP_XRUN_EVENT_T *events);
+void DSPXrunReset(void);
+INT8U DSPSnapshotReq(BUFF_ID_T buff_id, INT32U num_samples);
+const q31_t *DSPSnapshotPend(OS_TICK tout, INT32U *num_samples, OS_ERR *os_err_ptr);
 
 #endif
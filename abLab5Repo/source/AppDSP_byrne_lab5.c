@@ -19,55 +19,63 @@
 #include "K65TWR_GPIO.h"
 #include "AppDSP.h"
 #include "K65DMA.h"
+#include "K65TWR_ClkCfg.h"
+#include "DSPProf.h"
+#include "DSPDesign.h"
+#include "DSPChain.h"
+#include "DSPNco.h"
+#include "DSPSpectrum.h"
+#include "DSPTone.h"
+#include "DSPLatency.h"
+#include "DSPCapture.h"
 /*****************************************************************************************************
 * Defined constants for processing
 *****************************************************************************************************/
-#define FFT_LENGTH      512
-//Supported Lengths: 32, 64, 128, 256, 512, 1024, 2048
-                                //Must be <= DSP_SAMPLES_PER_BLOCK unless zero padded
 #define NUM_STAGES        4
 #define SAMPLE_RATE_HZ  48000
-//#define FREQ_BIN_SIZE   SAMPLE_RATE_HZ/FFT_LENGTH
 /******************************************************************************************/
-static DSP_BLOCK_T dspInBuffer[DSP_NUM_IN_CHANNELS][DSP_NUM_BLOCKS];
-static DSP_BLOCK_T dspOutBuffer[DSP_NUM_OUT_CHANNELS][DSP_NUM_BLOCKS];
-static INT8U dspStopReqFlag = 0;
-static OS_SEM dspFullStop;
+//Sample buffer arenas, laid out for the current block size as described in AppDSP.h
+static q31_t dspInArena[DSP_ARENA_SAMPLES(DSP_NUM_IN_CHANNELS)];
+static q31_t dspOutArena[DSP_ARENA_SAMPLES(DSP_NUM_OUT_CHANNELS)];
+static INT16U dspBlockSize = DSP_SAMPLES_PER_BLOCK;
+static INT8U dspNumBlocks = DSP_NUM_BLOCKS;
+
+//Snapshot of consecutive blocks of one buffer, filled by dspTask for the shell
+static q31_t dspSnapArena[DSP_SNAP_SAMPLES_MAX];
+static BUFF_ID_T dspSnapBuffId = LEFT_IN;
+static INT32U dspSnapLen = 0;                   //Samples requested, 0 when no request
+static INT32U dspSnapFill = 0;
+static OS_SEM dspSnapDone;
 
 /*****************************************************************************************************
 * Public Function Prototypes
 *****************************************************************************************************/
-//IIR variables
-static  arm_biquad_casd_df1_inst_f32  IIRLeft;
-static  arm_biquad_casd_df1_inst_f32  IIRRight;
-static  arm_biquad_casd_df1_inst_q31  IIRLeft_q31;
-static  arm_biquad_casd_df1_inst_q31  IIRRight_q31;
-//Each biquad IIR stage has 4 state variables.
-//Each filter of 4 Biquad stages has 4*4=16 state variables.
-static float32_t LeftState[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-static float32_t RightState[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-static q31_t LeftState_q31[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-static q31_t RightState_q31[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-
-static q31_t iirCoeffQ31[NUM_STAGES*5];
-static q31_t iirCoeffQ31Scaled[NUM_STAGES*5];
-
-static float32_t iirCoeffF32[] = {
-		0.866091276638422,	-0.715205228839432,	0.866091276638422,	//b values for stage 1
-		0.715205228839433,	-0.732182553276844,						//a for stage 1
-		0.866091276638422,	-0.715205228839432,	0.866091276638422,	//b values for stage 2
-		0.715205228839433,	-0.732182553276844,						//a for stage 2
-		0.866091276638422,	-0.715205228839432,	0.866091276638422,	//b values for stage 3
-		0.715205228839433,	-0.732182553276844,						//a for stage 3
-		0.866091276638422,	-0.715205228839432,	0.866091276638422,	//b values for stage 3
-		0.715205228839433,	-0.732182553276844,						//a for stage 4
+//IIR design. The filter instances and state live in the DSPChain biquad stages.
+//The MATLAB notch cascade, four RBJ notches at 8748 Hz with Q 2.945. Kept as design
+//parameters so the notch stays at 8748 Hz when the sample rate changes.
+static const DSP_DESIGN_T iirDesign[NUM_STAGES] = {
+    {DSP_DESIGN_NOTCH, 8748.444f, 2.945359f, 0.0f},
+    {DSP_DESIGN_NOTCH, 8748.444f, 2.945359f, 0.0f},
+    {DSP_DESIGN_NOTCH, 8748.444f, 2.945359f, 0.0f},
+    {DSP_DESIGN_NOTCH, 8748.444f, 2.945359f, 0.0f}
 };
 
-static float32_t cosineVals[DSP_SAMPLES_PER_BLOCK];
+//Block processing benchmark, DWT cycle counts
+static DSP_BENCH_T dspBench;
+
+//Block handoff errors and the last DSP_XRUN_LOG_LEN of them
+static DSP_XRUN_T dspXrun;
+static DSP_XRUN_EVENT_T dspXrunLog[DSP_XRUN_LOG_LEN];
+static INT8U dspXrunLogHead = 0;                //Next entry to write
+static INT8U dspXrunLogCount = 0;
 /*******************************************************************************************
 * Private Function Prototypes
 *******************************************************************************************/
 static void  dspTask(void *p_arg);
+static void  dspBenchInit(void);
+static void  dspXrunCheck(const DMA_IN_INFO_T *in_info);
+static void  dspXrunLogAdd(INT8U type, INT8U count, INT32U seq);
+static void  dspSnapshotUpdate(INT8U buffer_index, const DMA_IN_INFO_T *in_info);
 static CPU_STK dspTaskStk[APP_CFG_DSP_TASK_STK_SIZE];
 static OS_TCB dspTaskTCB;
 static DSP_PARAMS_T dspParams;
@@ -84,22 +92,18 @@ void DSPInit(void){
     //float32_t V1;
     //int Q = (NUM_TAPS-1)/2;
 
-    for(int i=0;i<DSP_SAMPLES_PER_BLOCK;i++){
-    	cosineVals[i] = arm_cos_f32(2*PI*i*20000/48000);
-    }
-
-    //initialize IIR filter instance for both channels
-    //arm_biquad_cascade_df1_init_f32(&IIRLeft,NUM_STAGES,&iirCoeffF32[0],&LeftState[0]);
-    //arm_biquad_cascade_df1_init_f32(&IIRRight,NUM_STAGES,&iirCoeffF32[0],&RightState[0]);
-
-
-    //convert IIR filter coefficients to Q31
-    arm_float_to_q31(&iirCoeffF32[0],&iirCoeffQ31[0],(NUM_STAGES*5));
-    //scale to get TOO LARGE coefficients
-    //arm_scale_q31(&iirCoeffQ31[0],1,4,&iirCoeffQ31Scaled[0],(NUM_STAGES*5));
-    //initialize IIR filter instance for both channels
-    arm_biquad_cascade_df1_init_q31(&IIRLeft_q31,NUM_STAGES,&iirCoeffQ31[0],&LeftState_q31[0],0);
-    arm_biquad_cascade_df1_init_q31(&IIRRight_q31,NUM_STAGES,&iirCoeffQ31[0],&RightState_q31[0],0);
+    //default processing chain, the IIR cascade on both channels in q31 DF1. The stages
+    //are added once the sample rate is set, since they are designed for it.
+    DSPChainInit();
+    DSPChainBiquadModeSet(DSP_BIQUAD_MODE_Q31);
+    //spectrum analyzer, off until enabled from the shell
+    DSPSpectrumInit();
+    //tone detector bank, off until enabled from the shell
+    DSPToneInit();
+    //latency self-test, idle until started from the shell
+    DSPLatencyInit();
+    //binary capture stream, off until started from the shell
+    DSPCaptureInit();
 
     OSTaskCreate(&dspTaskTCB,
                 "DSP Task ",
@@ -115,12 +119,19 @@ void DSPInit(void){
                 (OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
                 &os_err);
 
-    OSSemCreate(&dspFullStop, "DMA Stopped", 0, &os_err);
+    OSSemCreate(&dspSnapDone, "Snapshot Done", 0, &os_err);
+    dspBenchInit();
     CODECInit();
-    I2SInit(DSP_SSIZE_CODE_32BIT);
+    if(DSP_TDM_SLOTS > I2S_STEREO_SLOTS){
+        (void)CODECSetTdm(1);
+    }else{
+    }
+    I2SInit(DSP_SSIZE_CODE_32BIT, DSP_TDM_SLOTS);
     DSPSampleRateSet(CODEC_SRATE_CODE_48K);
-    DSPSampleSizeSet(DSP_SSIZE_CODE_32BIT);
-    DMAInit(&dspInBuffer[0][0], &dspOutBuffer[0][0]);
+    (void)DSPSampleSizeSet(DSP_SSIZE_CODE_32BIT);
+    (void)DSPIirDefaultAdd(DSP_LEFT_CH);
+    (void)DSPIirDefaultAdd(DSP_RIGHT_CH);
+    DMAInit(&dspInArena[0], &dspOutArena[0], dspBlockSize, dspNumBlocks);
     I2S_RX_ENABLE();
     I2S_TX_ENABLE();
 }
@@ -131,43 +142,303 @@ void DSPInit(void){
 static void dspTask(void *p_arg){
     OS_ERR os_err;
     INT8U buffer_index;
+    INT32U start_cycles;
+    INT32U block_cycles;
+    DMA_IN_INFO_T in_info;
     (void)p_arg;
     while(1){
         DB0_TURN_OFF();                             /* Turn off debug bit while waiting */
-        buffer_index = DMAInPend(0, &os_err);
+        buffer_index = DMAInPend(0, &in_info, &os_err);
         DB0_TURN_ON();
-        // DSP code goes here.
-/*
-        //convert the input signal from Q31 to floating-point
-        arm_q31_to_float(&dspInBuffer[DSP_LEFT_CH][buffer_index].samples[0],&InBufferLeft[0],DSP_SAMPLES_PER_BLOCK);
-        arm_q31_to_float(&dspInBuffer[DSP_RIGHT_CH][buffer_index].samples[0],&InBufferRight[0],DSP_SAMPLES_PER_BLOCK);
-        // IIR floating-point filtering process
-        arm_biquad_cascade_df1_f32(&IIRLeft,&InBufferLeft[0],&OutBufferLeft[0],DSP_SAMPLES_PER_BLOCK);
-        arm_biquad_cascade_df1_f32(&IIRRight,&InBufferRight[0],&OutBufferRight[0],DSP_SAMPLES_PER_BLOCK);
-        //convert the output signal from floating-point to Q31
-        arm_float_to_q31(&OutBufferLeft[0],&dspOutBuffer[DSP_LEFT_CH][buffer_index].samples[0],DSP_SAMPLES_PER_BLOCK);
-        arm_float_to_q31(&OutBufferRight[0],&dspOutBuffer[DSP_RIGHT_CH][buffer_index].samples[0],DSP_SAMPLES_PER_BLOCK);
-*/
-        // IIR floating-point filtering process
-        arm_biquad_cascade_df1_q31(&IIRLeft_q31,&dspInBuffer[DSP_LEFT_CH][buffer_index].samples[0],&dspOutBuffer[DSP_LEFT_CH][buffer_index].samples[0],DSP_SAMPLES_PER_BLOCK);
-        arm_biquad_cascade_df1_q31(&IIRRight_q31,&dspInBuffer[DSP_RIGHT_CH][buffer_index].samples[0],&dspOutBuffer[DSP_RIGHT_CH][buffer_index].samples[0],DSP_SAMPLES_PER_BLOCK);
-
-
-        if((buffer_index == 1)&&(dspStopReqFlag == 1)){
-            OSSemPost(&dspFullStop,OS_OPT_POST_1,&os_err);
+        start_cycles = DWT->CYCCNT;
+        DSPBlockProcess(buffer_index);
+        block_cycles = DWT->CYCCNT - start_cycles;
+
+        dspBench.cycles_last = block_cycles;
+        if(block_cycles > dspBench.cycles_max){
+            dspBench.cycles_max = block_cycles;
+        }else{
         }
+        dspBench.blocks++;
+        DSPProfBlockAdd(block_cycles);
+        dspXrunCheck(&in_info);
+        dspSnapshotUpdate(buffer_index, &in_info);
+    }
+}
+
+/*******************************************************************************************
+* DSPBlockProcess
+* Runs the processing for one block of every channel. The in and out blocks used are
+* block buffer_index of each channel in the arenas, the same ring layout the DMA fills
+* and drains. Kept separate from dspTask() so the processing can be
+* driven and timed without the DMA, as tools/dsphost.c does on a Linux host.
+* Each output channel runs its DSPChain stage list, a latency measurement replaces the
+* output while it runs, then the optional analysis stages run.
+*******************************************************************************************/
+void DSPBlockProcess(INT8U buffer_index){
+    q31_t *in_blocks[DSP_NUM_IN_CHANNELS];
+    q31_t *out_blocks[DSP_NUM_OUT_CHANNELS];
+    INT32U block_size = dspBlockSize;
+    INT32U num_blocks = dspNumBlocks;
+    INT8U ch;
+
+    for(ch=0;ch<DSP_NUM_IN_CHANNELS;ch++){
+        in_blocks[ch] = &dspInArena[(ch*num_blocks + buffer_index)*block_size];
+    }
+    for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+        out_blocks[ch] = &dspOutArena[(ch*num_blocks + buffer_index)*block_size];
+    }
+    DSPChainProcess(in_blocks,out_blocks,block_size);
+    DSPLatencyProcess(in_blocks,out_blocks,block_size);
+    DSPSpectrumProcess(in_blocks,out_blocks,block_size);
+    DSPToneProcess(in_blocks,out_blocks,block_size);
+    DSPCaptureProcess(in_blocks,out_blocks,block_size);
+}
+
+/*******************************************************************************************
+* DSPBlockLayoutSet
+* Changes the samples per block and the number of blocks in the DMA ring.
+* block_size is a power of two from DSP_BLOCK_SIZE_MIN to DSP_BLOCK_SIZE_MAX. Small blocks
+* lower the latency, large blocks lower the per block overhead.
+* num_blocks is DSP_NUM_BLOCKS_MIN to DSP_NUM_BLOCKS_MAX. With B blocks dspTask may fall up
+* to B-1 blocks behind before the DMA overwrites a block it has not processed, at a cost of
+* B blocks of buffering latency.
+* The DMA is halted, the buffers are laid out again in the same arenas, the stages that
+* depend on the block size are rebuilt and the DMA restarts with the new TCDs. Audio drops
+* out for about one block. Call from a task, not an ISR.
+*******************************************************************************************/
+INT8U DSPBlockLayoutSet(INT16U block_size, INT8U num_blocks){
+    if((block_size < DSP_BLOCK_SIZE_MIN) || (block_size > DSP_BLOCK_SIZE_MAX) ||
+       ((block_size & (block_size - 1)) != 0)){
+        return DSP_BLOCK_ERR_SIZE;
+    }else if((num_blocks < DSP_NUM_BLOCKS_MIN) || (num_blocks > DSP_NUM_BLOCKS_MAX)){
+        return DSP_BLOCK_ERR_COUNT;
+    }else if(((INT32U)block_size*num_blocks) > DSP_RING_SAMPLES_MAX){
+        return DSP_BLOCK_ERR_ARENA;
+    }else{
+    }
+    DMAHalt();
+    dspBlockSize = block_size;
+    dspNumBlocks = num_blocks;
+    arm_fill_q31(0, &dspOutArena[0], DSP_ARENA_SAMPLES(DSP_NUM_OUT_CHANNELS));
+    DSPChainBlockSizeSet(block_size);
+    DSPSpectrumReset();
+    DSPLatencyCancel();
+    DSPBenchReset();
+    DSPChainCyclesReset();
+    DSPXrunReset();
+    dspSnapFill = 0;
+    DMARingSet(&dspInArena[0], &dspOutArena[0], block_size, num_blocks);
+    return DSP_BLOCK_ERR_NONE;
+}
+
+/*******************************************************************************************
+* DSPBlockSizeSet
+* Changes the samples per block and keeps the ring depth. See DSPBlockLayoutSet().
+*******************************************************************************************/
+INT8U DSPBlockSizeSet(INT16U block_size){
+    return DSPBlockLayoutSet(block_size, dspNumBlocks);
+}
+
+/*******************************************************************************************
+* DSPBlockCountSet
+* Changes the ring depth and keeps the samples per block. See DSPBlockLayoutSet().
+*******************************************************************************************/
+INT8U DSPBlockCountSet(INT8U num_blocks){
+    return DSPBlockLayoutSet(dspBlockSize, num_blocks);
+}
+
+/*******************************************************************************************
+* DSPBlockCountGet
+* To read the number of blocks in the DMA ring
+*******************************************************************************************/
+INT8U DSPBlockCountGet(void){
+    return dspNumBlocks;
+}
+
+/*******************************************************************************************
+* DSPBlockSizeGet
+* To read the current samples per block
+*******************************************************************************************/
+INT16U DSPBlockSizeGet(void){
+    return dspBlockSize;
+}
+
+/*******************************************************************************************
+* dspBenchInit
+* Enables the DWT cycle counter used to time each block and clears the results. The
+* counter is not cleared since it is also the uC/CPU timestamp timer.
+*******************************************************************************************/
+static void dspBenchInit(void){
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    DSPBenchReset();
+}
+
+/*******************************************************************************************
+* DSPBenchGet
+* Copies the block timing results and fills in the deadline for the current sample rate.
+* The deadline is the number of CPU cycles in one block period, SYSTEM_CLOCK*N/fs.
+*******************************************************************************************/
+void DSPBenchGet(DSP_BENCH_T *bench){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    *bench = dspBench;
+    CPU_CRITICAL_EXIT();
+    bench->cycles_deadline = (INT32U)(((INT64U)SYSTEM_CLOCK*dspBlockSize)/dspParams.srate);
+}
+
+/*******************************************************************************************
+* DSPBenchReset
+* Clears the block timing results and the block profile
+*******************************************************************************************/
+void DSPBenchReset(void){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    dspBench.cycles_last = 0;
+    dspBench.cycles_max = 0;
+    dspBench.blocks = 0;
+    CPU_CRITICAL_EXIT();
+    DSPProfBlockReset();
+}
+
+/*******************************************************************************************
+* dspXrunCheck
+* Called by dspTask after each block. Blocks the DMA dropped are overruns. If the input
+* has moved on by num_blocks-1 blocks since this block was filled, the output has already
+* started to play it, so the block finished too late and is an underrun.
+*******************************************************************************************/
+static void dspXrunCheck(const DMA_IN_INFO_T *in_info){
+    INT32U blocks_since;
+    CPU_SR_ALLOC();
+
+    blocks_since = DMAInSeqGet() - in_info->seq;
+    CPU_CRITICAL_ENTER();
+    if(in_info->backlog > 1){
+        dspXrun.late++;
+    }else{
+    }
+    if(in_info->backlog > dspXrun.backlog_max){
+        dspXrun.backlog_max = in_info->backlog;
+    }else{
+    }
+    if(in_info->dropped != 0){
+        dspXrun.overruns += in_info->dropped;
+        dspXrunLogAdd(DSP_XRUN_OVERRUN, in_info->dropped, in_info->seq);
+    }else{
+    }
+    if(blocks_since >= (INT32U)(dspNumBlocks - 1)){
+        dspXrun.underruns++;
+        dspXrunLogAdd(DSP_XRUN_UNDERRUN, 1, in_info->seq);
+    }else{
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* dspXrunLogAdd
+* Writes one event over the oldest. Called in a critical section.
+*******************************************************************************************/
+static void dspXrunLogAdd(INT8U type, INT8U count, INT32U seq){
+    OS_ERR os_err;
+
+    dspXrunLog[dspXrunLogHead].type = type;
+    dspXrunLog[dspXrunLogHead].count = count;
+    dspXrunLog[dspXrunLogHead].seq = seq;
+    dspXrunLog[dspXrunLogHead].tick = OSTimeGet(&os_err);
+    dspXrunLogHead = (INT8U)((dspXrunLogHead + 1) % DSP_XRUN_LOG_LEN);
+    if(dspXrunLogCount < DSP_XRUN_LOG_LEN){
+        dspXrunLogCount++;
+    }else{
     }
 }
 
+/*******************************************************************************************
+* DSPXrunGet
+* Copies the overrun and underrun counters
+*******************************************************************************************/
+void DSPXrunGet(DSP_XRUN_T *xrun){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    *xrun = dspXrun;
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* DSPXrunLogGet
+* Copies the logged events, newest first, into events[DSP_XRUN_LOG_LEN] and returns how
+* many there are
+*******************************************************************************************/
+INT8U DSPXrunLogGet(DSP_XRUN_EVENT_T *events){
+    INT8U count;
+    INT8U i;
+    INT8U entry;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    count = dspXrunLogCount;
+    entry = dspXrunLogHead;
+    for(i=0;i<count;i++){
+        entry = (INT8U)((entry + DSP_XRUN_LOG_LEN - 1) % DSP_XRUN_LOG_LEN);
+        events[i] = dspXrunLog[entry];
+    }
+    CPU_CRITICAL_EXIT();
+    return count;
+}
+
+/*******************************************************************************************
+* DSPXrunReset
+* Clears the counters and the event log
+*******************************************************************************************/
+void DSPXrunReset(void){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    dspXrun.overruns = 0;
+    dspXrun.underruns = 0;
+    dspXrun.late = 0;
+    dspXrun.backlog_max = 0;
+    dspXrunLogHead = 0;
+    dspXrunLogCount = 0;
+    CPU_CRITICAL_EXIT();
+}
+
 /*******************************************************************************************
 * DSPSampleSizeSet
 * To set sample size you must set word size on both the CODEC and I2S
 * Note: Does not change DMA or buffer word size which can be changed independently.
+* A TDM frame has 32-bit slots and the CODEC in DSP mode packs its right word straight after
+* the left, so a shorter CODEC word would put it in the wrong slot. TDM builds stay at 32 bits
+* and return DSP_SSIZE_ERR_TDM for any other size.
 *******************************************************************************************/
-void DSPSampleSizeSet(INT8U size_code){
+INT8U DSPSampleSizeSet(INT8U size_code){
+    if((DSP_TDM_SLOTS > I2S_STEREO_SLOTS) && (size_code != DSP_SSIZE_CODE_32BIT)){
+        return DSP_SSIZE_ERR_TDM;
+    }else{
+    }
     (void)CODECSetSampleSize(size_code);
     I2SWordSizeSet(size_code);
     dspParams.ssize = dspCodeToSize[size_code];
+    return DSP_SSIZE_ERR_NONE;
+}
+/*******************************************************************************************
+* DSPTdmCheck
+* TDM bring-up check. Reads back the CODEC audio serial interface registers CODECSetTdm()
+* wrote: register 9 must be DSP mode with 256-clock frames and 32-bit words, register 10 a
+* data offset of 0. Does nothing in a stereo build. Reads the CODEC over I2C, so call it from
+* a task, not from dspTask.
+*******************************************************************************************/
+INT8U DSPTdmCheck(void){
+    if(DSP_TDM_SLOTS == I2S_STEREO_SLOTS){
+        return DSP_TDM_ERR_NONE;
+    }else{
+    }
+    if(CODECReadRegister(0, 0x09) != (CODEC_ASI_MODE_DSP_256|(CODEC_SSIZE_CODE_32BIT<<4))){
+        return DSP_TDM_ERR_ASI;
+    }else if(CODECReadRegister(0, 0x0A) != 0x00){
+        return DSP_TDM_ERR_OFFSET;
+    }else{
+        return DSP_TDM_ERR_NONE;
+    }
 }
 /*******************************************************************************************
 * DSPSampleSizeGet
@@ -185,62 +456,108 @@ INT16U DSPSampleRateGet(void){
 }
 /*******************************************************************************************
 * DSPSampleRateSet
-* To set sample rate you set the rate on the CODEC
+* To set sample rate you set the rate on the CODEC. Designed biquad sections are
+* recomputed for the new rate, NCOs and detector tones keep their frequency.
 *******************************************************************************************/
 void DSPSampleRateSet(INT8U rate_code){
     (void)CODECSetSampleRate(rate_code);
     dspParams.srate = dspCodeToRate[rate_code];
+    DSPChainBiquadRedesign();
+    DSPNcoRateSet(dspParams.srate);
+    DSPToneRateSet(dspParams.srate);
 }
-/*******************************************************************************************
-* DSPStart
-* Enable DMA to fill block with samples
-*******************************************************************************************/
-void DSPStartReq(void){
-
-    dspStopReqFlag = 0;
-    DMAStart();
-    CODECEnable();
-    CODECSetPage(0x00);
-    CODECDefaultConfig();
-    CODECHeadphoneOutOn();
+/****************************************************************************************
+ * Append the default IIR cascade to channel ch, designed for the current sample rate.
+ * Returns a DSP_CHAIN_ERR code.
+ ***************************************************************************************/
 
+INT8U DSPIirDefaultAdd(INT8U ch){
+    return DSPChainBiquadDesignAdd(ch, &iirDesign[0], NUM_STAGES);
 }
 /*******************************************************************************************
-* DSPStop
-* Disable DA after input/output buffers are full
+* dspSnapshotUpdate
+* Called by dspTask after each block. Appends the block of the requested buffer to the
+* snapshot. If the DMA dropped a block the snapshot would have a gap, so it starts over.
 *******************************************************************************************/
-void DSPStopReq(void){
-
-    dspStopReqFlag = 1;
-    DMAStopFull();
+static void dspSnapshotUpdate(INT8U buffer_index, const DMA_IN_INFO_T *in_info){
+    OS_ERR os_err;
+    q31_t *block;
+    INT32U count;
+    INT32U ch;
 
+    if(dspSnapLen == 0){
+        return;
+    }else{
+    }
+    if(in_info->dropped != 0){
+        dspSnapFill = 0;
+    }else{
+    }
+    if((dspSnapBuffId == LEFT_IN) || (dspSnapBuffId == RIGHT_IN)){
+        ch = (dspSnapBuffId == LEFT_IN) ? DSP_LEFT_CH : DSP_RIGHT_CH;
+        block = &dspInArena[(ch*dspNumBlocks + buffer_index)*dspBlockSize];
+    }else{
+        ch = (dspSnapBuffId == LEFT_OUT) ? DSP_LEFT_CH : DSP_RIGHT_CH;
+        block = &dspOutArena[(ch*dspNumBlocks + buffer_index)*dspBlockSize];
+    }
+    count = dspSnapLen - dspSnapFill;
+    if(count > dspBlockSize){
+        count = dspBlockSize;
+    }else{
+    }
+    arm_copy_q31(block, &dspSnapArena[dspSnapFill], count);
+    dspSnapFill += count;
+    if(dspSnapFill >= dspSnapLen){
+        dspSnapLen = 0;
+        (void)OSSemPost(&dspSnapDone, OS_OPT_POST_1, &os_err);
+    }else{
+    }
 }
-/****************************************************************************************
- * DSP signal when buffer is full and DMA stopped
- * 04/16/2020 TDM
- ***************************************************************************************/
 
-void DSPStopFullPend(OS_TICK tout, OS_ERR *os_err_ptr){
-    OSSemPend(&dspFullStop, tout, OS_OPT_PEND_BLOCKING,(void *)0, os_err_ptr);
-}
-/****************************************************************************************
- * Return a pointer to the requested buffer
- * 04/16/2020 TDM
- ***************************************************************************************/
+/*******************************************************************************************
+* DSPSnapshotReq
+* Asks dspTask to copy the next num_samples samples of buff_id, starting at a block
+* boundary, into the snapshot arena. Audio keeps running. Collect the snapshot with
+* DSPSnapshotPend(). Returns 1 if num_samples is 0 or more than DSP_SNAP_SAMPLES_MAX.
+*******************************************************************************************/
+INT8U DSPSnapshotReq(BUFF_ID_T buff_id, INT32U num_samples){
+    OS_ERR os_err;
+    CPU_SR_ALLOC();
 
-INT32S *DSPBufferGet(BUFF_ID_T buff_id){
-    INT32S *buf_ptr = (void*)0;
-    if(buff_id == LEFT_IN){
-        buf_ptr = (INT32S *)&dspInBuffer[DSP_LEFT_CH][0];
-    }else if(buff_id == RIGHT_IN){
-        buf_ptr = (INT32S *)&dspInBuffer[DSP_RIGHT_CH][0];
-    }else if(buff_id == RIGHT_OUT){
-        buf_ptr = (INT32S *)&dspOutBuffer[DSP_RIGHT_CH][0];
-    }else if(buff_id == LEFT_OUT){
-        buf_ptr = (INT32S *)&dspOutBuffer[DSP_LEFT_CH][0];
+    if((num_samples == 0) || (num_samples > DSP_SNAP_SAMPLES_MAX)){
+        return 1;
     }else{
     }
-    return buf_ptr;
+    CPU_CRITICAL_ENTER();
+    dspSnapLen = 0;
+    CPU_CRITICAL_EXIT();
+    OSSemSet(&dspSnapDone, 0, &os_err);
+    CPU_CRITICAL_ENTER();
+    dspSnapBuffId = buff_id;
+    dspSnapFill = 0;
+    dspSnapLen = num_samples;
+    CPU_CRITICAL_EXIT();
+    return 0;
 }
 
+/*******************************************************************************************
+* DSPSnapshotPend
+* Waits for the snapshot asked for with DSPSnapshotReq(). Returns the snapshot and its
+* length, or a null pointer and the OSSemPend() error if it timed out, in which case the
+* request is cancelled. The snapshot stays valid until the next request.
+*******************************************************************************************/
+const q31_t *DSPSnapshotPend(OS_TICK tout, INT32U *num_samples, OS_ERR *os_err_ptr){
+    CPU_SR_ALLOC();
 
+    OSSemPend(&dspSnapDone, tout, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, os_err_ptr);
+    if(*os_err_ptr != OS_ERR_NONE){
+        CPU_CRITICAL_ENTER();
+        dspSnapLen = 0;
+        CPU_CRITICAL_EXIT();
+        *num_samples = 0;
+        return (const q31_t *)0;
+    }else{
+        *num_samples = dspSnapFill;
+        return &dspSnapArena[0];
+    }
+}
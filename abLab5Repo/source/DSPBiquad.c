@@ -0,0 +1,94 @@
+/*******************************************************************************************
+* DSPBiquad.c
+* Biquad kernels used by the processing chain in addition to the CMSIS-DSP filters.
+*
+* DSPBiquadStereoQ31() runs two q31 DF1 cascades that share one coefficient table in a
+* single pass. Each coefficient of a section is loaded once for both channels, and both
+* channels' four state words stay in locals for the whole block. The arithmetic is the
+* same as arm_biquad_cascade_df1_q31(): a 64-bit multiply-accumulate of the five products,
+* shifted right by (31 - postShift) and truncated, so the output is bit-exact with two
+* separate CMSIS calls. It is plain C so it also builds for a host; tools/biquadtest.c
+* checks it against the CMSIS kernel. The chain only uses it after DSPChainStereoSet().
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "DSPBiquad.h"
+
+/*******************************************************************************************
+* DSPBiquadStereoQ31 - Filters a left and right block through two q31 DF1 cascades.
+* left and right must have the same numStages, postShift and coefficient values; only
+* left->pCoeffs is read. Each instance keeps its own state. The sources and destinations
+* may be the same buffer (in place).
+*******************************************************************************************/
+void DSPBiquadStereoQ31(const arm_biquad_casd_df1_inst_q31 *left,
+                        const arm_biquad_casd_df1_inst_q31 *right,
+                        const q31_t *left_src, q31_t *left_dst,
+                        const q31_t *right_src, q31_t *right_dst,
+                        INT32U block_size){
+    const q31_t *coeffs = left->pCoeffs;
+    q31_t *l_state = left->pState;
+    q31_t *r_state = right->pState;
+    const q31_t *l_in = left_src;
+    const q31_t *r_in = right_src;
+    INT32U shift = 31u - (INT32U)left->postShift;
+    INT32U stage = left->numStages;
+    q31_t b0, b1, b2, a1, a2;
+    q31_t lx1, lx2, ly1, ly2;
+    q31_t rx1, rx2, ry1, ry2;
+    q31_t lx, rx;
+    q63_t l_acc, r_acc;
+    INT32U n;
+
+    do{
+        b0 = coeffs[0];
+        b1 = coeffs[1];
+        b2 = coeffs[2];
+        a1 = coeffs[3];
+        a2 = coeffs[4];
+        coeffs += 5;
+
+        lx1 = l_state[0];
+        lx2 = l_state[1];
+        ly1 = l_state[2];
+        ly2 = l_state[3];
+        rx1 = r_state[0];
+        rx2 = r_state[1];
+        ry1 = r_state[2];
+        ry2 = r_state[3];
+
+        for(n=0;n<block_size;n++){
+            lx = l_in[n];
+            rx = r_in[n];
+            l_acc = (q63_t)b0*lx + (q63_t)b1*lx1 + (q63_t)b2*lx2 + (q63_t)a1*ly1 + (q63_t)a2*ly2;
+            r_acc = (q63_t)b0*rx + (q63_t)b1*rx1 + (q63_t)b2*rx2 + (q63_t)a1*ry1 + (q63_t)a2*ry2;
+            lx2 = lx1;
+            lx1 = lx;
+            ly2 = ly1;
+            ly1 = (q31_t)(l_acc >> shift);
+            rx2 = rx1;
+            rx1 = rx;
+            ry2 = ry1;
+            ry1 = (q31_t)(r_acc >> shift);
+            left_dst[n] = ly1;
+            right_dst[n] = ry1;
+        }
+
+        l_state[0] = lx1;
+        l_state[1] = lx2;
+        l_state[2] = ly1;
+        l_state[3] = ly2;
+        r_state[0] = rx1;
+        r_state[1] = rx2;
+        r_state[2] = ry1;
+        r_state[3] = ry2;
+        l_state += 4;
+        r_state += 4;
+
+        //Following sections work in place on the destination
+        l_in = left_dst;
+        r_in = right_dst;
+        stage--;
+    }while(stage > 0u);
+}
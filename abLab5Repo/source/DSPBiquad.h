@@ -0,0 +1,21 @@
+/*****************************************************************************************************
+* DSPBiquad.h
+* Biquad kernels used by the processing chain in addition to the CMSIS-DSP filters.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_BIQUAD_PRESENT
+#define  DSP_BIQUAD_PRESENT
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPBiquadStereoQ31(const arm_biquad_casd_df1_inst_q31 *left,
+                        const arm_biquad_casd_df1_inst_q31 *right,
+                        const q31_t *left_src, q31_t *left_dst,
+                        const q31_t *right_src, q31_t *right_dst,
+                        INT32U block_size);
+
+#endif
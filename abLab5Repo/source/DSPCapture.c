@@ -0,0 +1,314 @@
+/*******************************************************************************************
+* DSPCapture.c
+* Continuous binary capture of the sample buffers over the debug UART. dspTask packs each
+* block of the selected buffers into frames, as described in DSPCapture.h, and queues them
+* in a word ring. A low priority capture task sends the frames and adds the CRC.
+* dspTask never waits for the UART. When the ring is full the frame is dropped and counted,
+* and its sequence number is skipped, so the host can fill the gap with silence.
+* The ring has one writer, dspTask, and one reader, the capture task, so the head and tail
+* need no lock. Frame lengths are whole words and the CRC is not queued, so every frame
+* starts on a word.
+* The UART must carry (16 + 4 + n*b*32)*fs/32 bytes/s for n buffers of b bytes per sample.
+* At 115200 bit/s that is about one q15 buffer at 8kHz, see TERMINAL_SERIAL_CFG_BIT_RATE
+* in terminal_cfg.h for faster rates. Shell output while capturing lands between frame
+* bytes and costs those frames their CRC, the host skips them.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "BasicIO.h"
+#include "DSPCapture.h"
+/******************************************************************************************
+* Defined constants
+*******************************************************************************************/
+#define DSP_CAP_RING_WORDS      (DSP_CAP_RING_BYTES/4)
+#define DSP_CAP_HEADER_WORDS    (DSP_CAP_HEADER_BYTES/4)
+#define DSP_CAP_CRC_POLY        0xEDB88320u         //IEEE 802.3, reflected
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static INT32U dspCapRing[DSP_CAP_RING_WORDS];
+static volatile INT32U dspCapHead = 0;          //Next word to write, only dspTask writes it
+static volatile INT32U dspCapTail = 0;          //Next word to send, only the task writes it
+static volatile INT8U dspCapEnabled = 0;
+static INT8U dspCapMask = DSP_CAP_MASK(LEFT_IN);
+static INT8U dspCapFmt = DSP_CAP_FMT_Q15;
+static INT32U dspCapSeq = 0;
+static INT32U dspCapSkipped = 0;                //Frames dropped since the last one queued
+static INT32U dspCapFramesSent = 0;
+static INT32U dspCapFramesDropped = 0;
+static INT32U dspCapCrcTable[256];
+static OS_SEM dspCapReady;
+static CPU_STK dspCapTaskStk[APP_CFG_CAP_TASK_STK_SIZE];
+static OS_TCB dspCapTaskTCB;
+/*******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static void dspCapTask(void *p_arg);
+static INT32U dspCapPayloadWords(INT8U mask, INT8U fmt);
+static INT32U dspCapCrcWord(INT32U crc, INT32U word);
+static void dspCapWriteWord(INT32U word);
+
+/*******************************************************************************************
+* DSPCaptureInit - Builds the CRC table and creates the capture task. Capture starts off.
+*******************************************************************************************/
+void DSPCaptureInit(void){
+    OS_ERR os_err;
+    INT32U crc;
+    INT32U i;
+    INT8U bit;
+
+    for(i=0;i<256;i++){
+        crc = i;
+        for(bit=0;bit<8;bit++){
+            if((crc & 1u) != 0){
+                crc = (crc >> 1) ^ DSP_CAP_CRC_POLY;
+            }else{
+                crc = crc >> 1;
+            }
+        }
+        dspCapCrcTable[i] = crc;
+    }
+    dspCapEnabled = 0;
+    OSSemCreate(&dspCapReady, "Capture Ready", 0, &os_err);
+    OSTaskCreate(&dspCapTaskTCB,
+                "Capture Task ",
+                dspCapTask,
+                (void *) 0,
+                APP_CFG_CAP_TASK_PRIO,
+                &dspCapTaskStk[0],
+                (APP_CFG_CAP_TASK_STK_SIZE / 10u),
+                APP_CFG_CAP_TASK_STK_SIZE,
+                0,
+                0,
+                (void *) 0,
+                (OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
+                &os_err);
+}
+
+/*******************************************************************************************
+* DSPCaptureProcess - Queues one block of the selected buffers as block_size/
+* DSP_CAP_FRAME_SAMPLES frames. in[] and out[] are the block pointers passed to the chain.
+* Called by dspTask after the chain so the outputs are final.
+*******************************************************************************************/
+void DSPCaptureProcess(q31_t *const in[], q31_t *const out[], INT32U block_size){
+    q31_t *src[RIGHT_OUT + 1];
+    INT32U frame_words;
+    INT32U head;
+    INT32U start;
+    INT32U i;
+    INT32U pair;
+    INT32U skipped;
+    INT16U srate;
+    INT8U mask;
+    INT8U fmt;
+    INT8U num_src;
+    INT8U k;
+    INT8U queued = 0;
+    OS_ERR os_err;
+    CPU_SR_ALLOC();
+
+    if(dspCapEnabled == 0){
+        return;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    mask = dspCapMask;
+    fmt = dspCapFmt;
+    CPU_CRITICAL_EXIT();
+    srate = DSPSampleRateGet();
+    //BUFF_ID_T order is the CODEC inputs then the CODEC outputs
+    num_src = 0;
+    for(k=LEFT_IN;k<=RIGHT_OUT;k++){
+        if((mask & DSP_CAP_MASK(k)) != 0){
+            src[num_src] = (k <= RIGHT_IN) ? in[k - LEFT_IN] : out[k - LEFT_OUT];
+            num_src++;
+        }else{
+        }
+    }
+    frame_words = DSP_CAP_HEADER_WORDS + dspCapPayloadWords(mask, fmt);
+
+    for(start=0;start<block_size;start+=DSP_CAP_FRAME_SAMPLES){
+        head = dspCapHead;
+        if((DSP_CAP_RING_WORDS - (head - dspCapTail)) < frame_words){
+            dspCapSkipped++;
+            CPU_CRITICAL_ENTER();
+            dspCapFramesDropped++;
+            CPU_CRITICAL_EXIT();
+        }else{
+            skipped = (dspCapSkipped > 0xFFFFu) ? 0xFFFFu : dspCapSkipped;
+            dspCapRing[head++ % DSP_CAP_RING_WORDS] = DSP_CAP_SYNC;
+            dspCapRing[head++ % DSP_CAP_RING_WORDS] = dspCapSeq;
+            dspCapRing[head++ % DSP_CAP_RING_WORDS] = (INT32U)srate | ((INT32U)fmt << 16) |
+                                                      ((INT32U)mask << 24);
+            dspCapRing[head++ % DSP_CAP_RING_WORDS] = (INT32U)DSP_CAP_FRAME_SAMPLES | (skipped << 16);
+            if(fmt == DSP_CAP_FMT_Q31){
+                for(i=start;i<(start + DSP_CAP_FRAME_SAMPLES);i++){
+                    for(k=0;k<num_src;k++){
+                        dspCapRing[head++ % DSP_CAP_RING_WORDS] = (INT32U)src[k][i];
+                    }
+                }
+            }else{
+                //Two q15 samples to a word, the first in the low half
+                pair = 0;
+                for(i=start;i<(start + DSP_CAP_FRAME_SAMPLES);i++){
+                    for(k=0;k<num_src;k++){
+                        if((pair & 0xFFFF0000u) == 0){
+                            pair = ((INT32U)src[k][i] >> 16) | 0xFFFF0000u;
+                        }else{
+                            dspCapRing[head++ % DSP_CAP_RING_WORDS] = (pair & 0xFFFFu) |
+                                                                      ((INT32U)src[k][i] & 0xFFFF0000u);
+                            pair = 0;
+                        }
+                    }
+                }
+            }
+            dspCapHead = head;
+            dspCapSkipped = 0;
+            queued = 1;
+        }
+        dspCapSeq++;
+    }
+    if(queued != 0){
+        (void)OSSemPost(&dspCapReady, OS_OPT_POST_1, &os_err);
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* DSPCaptureStart - Starts capturing the buffers in mask, a DSP_CAP_MASK() combination, in
+* fmt. If capture is running the change takes effect at the next block.
+*******************************************************************************************/
+INT8U DSPCaptureStart(INT8U mask, INT8U fmt){
+    CPU_SR_ALLOC();
+
+    if((mask == 0) || ((mask & ~DSP_CAP_MASK_ALL) != 0)){
+        return DSP_CAP_ERR_MASK;
+    }else if((fmt != DSP_CAP_FMT_Q31) && (fmt != DSP_CAP_FMT_Q15)){
+        return DSP_CAP_ERR_FMT;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    dspCapMask = mask;
+    dspCapFmt = fmt;
+    if(dspCapEnabled == 0){
+        dspCapFramesSent = 0;
+        dspCapFramesDropped = 0;
+    }else{
+    }
+    CPU_CRITICAL_EXIT();
+    dspCapEnabled = 1;
+    return DSP_CAP_ERR_NONE;
+}
+
+/*******************************************************************************************
+* DSPCaptureStop - Stops queuing frames. Frames already queued are still sent.
+*******************************************************************************************/
+void DSPCaptureStop(void){
+    dspCapEnabled = 0;
+}
+
+/*******************************************************************************************
+* DSPCaptureStatusGet - Copies the capture settings and counts, and the UART rate in bytes
+* per second the current settings need.
+*******************************************************************************************/
+void DSPCaptureStatusGet(DSP_CAP_STATUS_T *status){
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    status->enabled = dspCapEnabled;
+    status->mask = dspCapMask;
+    status->fmt = dspCapFmt;
+    status->frames_sent = dspCapFramesSent;
+    status->frames_dropped = dspCapFramesDropped;
+    CPU_CRITICAL_EXIT();
+    status->bytes_per_s = ((INT32U)DSPSampleRateGet()*
+                           ((DSP_CAP_HEADER_WORDS + dspCapPayloadWords(status->mask, status->fmt))*4 +
+                            DSP_CAP_CRC_BYTES))/DSP_CAP_FRAME_SAMPLES;
+}
+
+/*******************************************************************************************
+* dspCapTask - Sends queued frames, each followed by its CRC, then waits for dspTask to
+* queue more. BIOWrite() pends while the UART transmit ring is full, so the task only uses
+* the CPU to fill the ring. It runs below the shell so shell output is not held up.
+*******************************************************************************************/
+static void dspCapTask(void *p_arg){
+    OS_ERR os_err;
+    INT32U tail;
+    INT32U end;
+    INT32U word;
+    INT32U crc;
+    CPU_SR_ALLOC();
+    (void)p_arg;
+
+    while(1){
+        OSSemPend(&dspCapReady, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+        while(dspCapTail != dspCapHead){
+            tail = dspCapTail;
+            word = dspCapRing[(tail + 2) % DSP_CAP_RING_WORDS];
+            end = tail + DSP_CAP_HEADER_WORDS +
+                  dspCapPayloadWords((INT8U)(word >> 24), (INT8U)((word >> 16) & 0xFFu));
+            crc = 0xFFFFFFFFu;
+            while(tail != end){
+                word = dspCapRing[tail % DSP_CAP_RING_WORDS];
+                crc = dspCapCrcWord(crc, word);
+                dspCapWriteWord(word);
+                tail++;
+            }
+            dspCapWriteWord(crc ^ 0xFFFFFFFFu);
+            dspCapTail = tail;
+            CPU_CRITICAL_ENTER();
+            dspCapFramesSent++;
+            CPU_CRITICAL_EXIT();
+        }
+    }
+}
+
+/*******************************************************************************************
+* dspCapPayloadWords - Returns the sample words in one frame
+*******************************************************************************************/
+static INT32U dspCapPayloadWords(INT8U mask, INT8U fmt){
+    INT32U num_src = 0;
+    INT8U k;
+
+    for(k=LEFT_IN;k<=RIGHT_OUT;k++){
+        if((mask & DSP_CAP_MASK(k)) != 0){
+            num_src++;
+        }else{
+        }
+    }
+    if(fmt == DSP_CAP_FMT_Q31){
+        return num_src*DSP_CAP_FRAME_SAMPLES;
+    }else{
+        return (num_src*DSP_CAP_FRAME_SAMPLES)/2;
+    }
+}
+
+/*******************************************************************************************
+* dspCapCrcWord - Adds the four bytes of word, low byte first, to a CRC-32
+*******************************************************************************************/
+static INT32U dspCapCrcWord(INT32U crc, INT32U word){
+    INT8U i;
+
+    for(i=0;i<4;i++){
+        crc = dspCapCrcTable[(crc ^ word) & 0xFFu] ^ (crc >> 8);
+        word = word >> 8;
+    }
+    return crc;
+}
+
+/*******************************************************************************************
+* dspCapWriteWord - Sends a word low byte first
+*******************************************************************************************/
+static void dspCapWriteWord(INT32U word){
+    INT8U i;
+
+    for(i=0;i<4;i++){
+        BIOWrite((INT8C)(word & 0xFFu));
+        word = word >> 8;
+    }
+}
@@ -0,0 +1,64 @@
+/*****************************************************************************************************
+* DSPCapture.h
+* Continuous binary capture. Selected input and output buffers are streamed out of the debug
+* UART as CRC checked frames while audio runs, so minutes of audio can be recorded on a host
+* and turned into a WAV file with tools/dspcap2wav.c.
+*
+* Frame layout, all fields little-endian:
+*   offset  size
+*     0      4    sync, DSP_CAP_SYNC ("DCAP")
+*     4      4    frame sequence number, counts dropped frames too
+*     8      2    sample rate in Hz
+*    10      1    sample format, DSP_CAP_FMT_Q31 or DSP_CAP_FMT_Q15
+*    11      1    buffer mask, bit n set for BUFF_ID_T n (l_in, r_in, l_out, r_out)
+*    12      2    samples per buffer
+*    14      2    frames dropped since the last frame sent, saturates at 0xFFFF
+*    16      n    samples, interleaved in buffer mask bit order
+*   16+n     4    CRC-32 (IEEE 802.3) of the header and samples
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_CAPTURE_PRESENT
+#define  DSP_CAPTURE_PRESENT
+
+/*****************************************************************************************************
+* Capture configuration constants
+*****************************************************************************************************/
+#define DSP_CAP_FRAME_SAMPLES   DSP_BLOCK_SIZE_MIN  //Samples per buffer in one frame
+#define DSP_CAP_RING_BYTES      16384               //Frames waiting for the UART, power of two
+#define DSP_CAP_HEADER_BYTES    16
+#define DSP_CAP_CRC_BYTES       4
+#define DSP_CAP_SYNC            0x50414344u         //"DCAP" in byte order
+
+#define DSP_CAP_FMT_Q31         0
+#define DSP_CAP_FMT_Q15         1
+
+#define DSP_CAP_MASK_ALL        0x0Fu
+#define DSP_CAP_MASK(buff_id)   (1u << (buff_id))
+
+//Capture error codes
+#define DSP_CAP_ERR_NONE        0
+#define DSP_CAP_ERR_MASK        1
+#define DSP_CAP_ERR_FMT         2
+
+typedef struct{
+    INT8U enabled;
+    INT8U mask;
+    INT8U fmt;
+    INT32U frames_sent;
+    INT32U frames_dropped;
+    INT32U bytes_per_s;                     //UART rate the capture needs at the current fs
+} DSP_CAP_STATUS_T;
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPCaptureInit(void);
+void DSPCaptureProcess(q31_t *const in[], q31_t *const out[], INT32U block_size);
+INT8U DSPCaptureStart(INT8U mask, INT8U fmt);
+void DSPCaptureStop(void);
+void DSPCaptureStatusGet(DSP_CAP_STATUS_T *status);
+
+#endif
@@ -0,0 +1,1309 @@
+/*******************************************************************************************
+* DSPChain.c
+* Runtime processing chain for dspTask. Each output channel has an ordered list of stages
+* (biquad cascade, FIR, FFT convolution, gain, mix, dynamics, NCO modulator, bypass) that is
+* run in place on the output block. The chain is built at DSPInit() and may be edited from
+* the shell while audio runs. Edits and block processing are serialized with a mutex so a
+* stage is never run half-built.
+* Matching biquad stages on a left/right pair can be run together by the stereo kernel
+* (DSPChainStereoSet(), off by default), and dynamics stages at the same position on a pair
+* are run stereo-linked.
+* A multirate stage decimates the block, runs one of the sub-chains on the low rate block
+* and interpolates the result back. Sub-chains are edited like channels but are only run
+* from a multirate stage.
+* Biquad stages have two coefficient banks. New coefficients are written to the idle bank
+* and the banks are swapped at the start of a block, keeping the filter state, so a filter
+* can be retuned while audio runs.
+* Biquad sections can also be designed from (type, fc, Q, gain) with DSPDesign. Designed
+* sections keep their parameters and are recomputed for the new rate by
+* DSPChainBiquadRedesign() when the sample rate changes.
+* Each stage keeps the DWT cycles it used in the last block and the maximum, and a cycle
+* profile (DSPProf) with the minimum, mean and a histogram.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPProf.h"
+#include "DSPDesign.h"
+#include "DSPChain.h"
+#include "DSPBiquad.h"
+#include "DSPConv.h"
+#include "DSPMultirate.h"
+#include "DSPDyn.h"
+#include "DSPNco.h"
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static DSP_STAGE_T dspChain[DSP_CHAIN_NUM_ROWS][DSP_CHAIN_MAX_STAGES];
+static INT8U dspChainLen[DSP_CHAIN_NUM_ROWS];
+static q31_t dspChainScratch[DSP_BLOCK_SIZE_MAX];
+static float32_t dspChainScratchF32[DSP_BLOCK_SIZE_MAX];
+static INT8U dspChainBiquadMode = DSP_BIQUAD_MODE_Q31;
+static INT8U dspChainStereo = 0;
+static OS_MUTEX dspChainMutex;
+/*******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static DSP_STAGE_T *dspChainStageNew(INT8U ch, DSP_STAGE_TYPE_T type, INT8U *err);
+static void dspChainStageRun(DSP_STAGE_T *stage, q31_t *const in[], q31_t *out,
+                             INT32U block_size);
+static void dspChainStageTimedRun(DSP_STAGE_T *stage, q31_t *const in[], q31_t *out,
+                                  INT32U block_size);
+static void dspChainCyclesUpdate(DSP_STAGE_T *stage, INT32U cycles);
+static INT8U dspChainStereoCheck(const DSP_STAGE_T *left, const DSP_STAGE_T *right);
+static INT8U dspChainDynPairCheck(const DSP_STAGE_T *left, const DSP_STAGE_T *right);
+static void dspChainBiquadInit(DSP_STAGE_BIQUAD_T *biquad, INT8U num_stages, INT8U post_shift,
+                               INT8U mode);
+static void dspChainBiquadSwap(DSP_STAGE_BIQUAD_T *biquad);
+static DSP_STAGE_BIQUAD_T *dspChainBiquadFind(INT8U ch, INT8U index, INT8U *err);
+static void dspChainBiquadStage(DSP_STAGE_BIQUAD_T *biquad);
+static INT8U dspChainBiquadDesignRun(DSP_STAGE_BIQUAD_T *biquad, q31_t *coeffs, INT8U num_stages,
+                                     INT8U post_shift, INT32U srate);
+static void dspChainRowRedesign(INT8U row);
+static INT32U dspChainRowRate(INT8U row);
+static DSP_STAGE_T *dspChainSubOwnerFind(INT8U row);
+static void dspChainGainToScale(INT32U gain_milli, q31_t *fract, INT8S *shift);
+static void dspChainStageFree(DSP_STAGE_T *stage);
+static void dspChainLock(void);
+static void dspChainUnlock(void);
+
+/*******************************************************************************************
+* DSPChainInit - Creates the chain mutex and empties every channel. Called from DSPInit()
+* before the default chain is built.
+*******************************************************************************************/
+void DSPChainInit(void){
+    OS_ERR os_err;
+    INT8U ch;
+
+    OSMutexCreate(&dspChainMutex, "DSP Chain", &os_err);
+    DSPConvInit();
+    DSPMultirateInit();
+    DSPDynInit();
+    DSPNcoInit();
+    for(ch=0;ch<DSP_CHAIN_NUM_ROWS;ch++){
+        dspChainLen[ch] = 0;
+    }
+}
+
+/*******************************************************************************************
+* DSPChainProcess - Runs the stages of every channel on one block. The input block of each
+* channel is copied to its output block and each enabled stage then works on the output in
+* place. in[] holds the input block of every channel so a mix stage can reach the other
+* channels.
+* Channels are walked in pairs, stage by stage. When the stereo kernel is on and both
+* channels of a pair have a biquad cascade with the same coefficients at the same position,
+* it filters both in one pass and each stage is charged half of its cycles. Dynamics stages
+* at the same position share one gain the same way.
+*******************************************************************************************/
+void DSPChainProcess(q31_t *const in[], q31_t *const out[], INT32U block_size){
+    DSP_STAGE_T *stage;
+    DSP_STAGE_T *pair_stage;
+    INT32U start_cycles;
+    INT32U stage_cycles;
+    INT8U ch;
+    INT8U pair_ch;
+    INT8U pair_len;
+    INT8U i;
+
+    dspChainLock();
+    for(ch=0;ch<DSP_CHAIN_NUM_ROWS;ch++){
+        for(i=0;i<dspChainLen[ch];i++){
+            if((dspChain[ch][i].type == DSP_STAGE_BIQUAD) && (dspChain[ch][i].u.biquad.pending != 0)){
+                dspChainBiquadSwap(&dspChain[ch][i].u.biquad);
+            }else{
+            }
+        }
+    }
+    for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+        arm_copy_q31(in[ch], out[ch], block_size);
+    }
+    for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch+=2){
+        pair_ch = ch + 1;
+        if(pair_ch < DSP_NUM_OUT_CHANNELS){
+            pair_len = dspChainLen[pair_ch];
+        }else{
+            pair_len = 0;
+        }
+        for(i=0;(i<dspChainLen[ch])||(i<pair_len);i++){
+            if((dspChainStereo != 0) && (i < dspChainLen[ch]) && (i < pair_len) &&
+               (dspChainStereoCheck(&dspChain[ch][i], &dspChain[pair_ch][i]) != 0)){
+                stage = &dspChain[ch][i];
+                pair_stage = &dspChain[pair_ch][i];
+                start_cycles = DWT->CYCCNT;
+                DSPBiquadStereoQ31(&stage->u.biquad.inst, &pair_stage->u.biquad.inst,
+                                   out[ch], out[ch], out[pair_ch], out[pair_ch], block_size);
+                stage_cycles = (DWT->CYCCNT - start_cycles)/2;
+                dspChainCyclesUpdate(stage, stage_cycles);
+                dspChainCyclesUpdate(pair_stage, stage_cycles);
+            }else if((i < dspChainLen[ch]) && (i < pair_len) &&
+                     (dspChainDynPairCheck(&dspChain[ch][i], &dspChain[pair_ch][i]) != 0)){
+                stage = &dspChain[ch][i];
+                pair_stage = &dspChain[pair_ch][i];
+                start_cycles = DWT->CYCCNT;
+                DSPDynStereoProcess(stage->u.dyn.inst, pair_stage->u.dyn.inst, out[ch], out[pair_ch],
+                                    block_size);
+                stage_cycles = (DWT->CYCCNT - start_cycles)/2;
+                dspChainCyclesUpdate(stage, stage_cycles);
+                dspChainCyclesUpdate(pair_stage, stage_cycles);
+            }else{
+                if(i < dspChainLen[ch]){
+                    dspChainStageTimedRun(&dspChain[ch][i], in, out[ch], block_size);
+                }else{
+                }
+                if(i < pair_len){
+                    dspChainStageTimedRun(&dspChain[pair_ch][i], in, out[pair_ch], block_size);
+                }else{
+                }
+            }
+        }
+    }
+    dspChainUnlock();
+}
+
+/*******************************************************************************************
+* dspChainStageTimedRun - Runs one stage in place on out if it is enabled and records the
+* cycles used
+*******************************************************************************************/
+static void dspChainStageTimedRun(DSP_STAGE_T *stage, q31_t *const in[], q31_t *out,
+                                  INT32U block_size){
+    INT32U start_cycles;
+
+    start_cycles = DWT->CYCCNT;
+    if(stage->enabled != 0){
+        dspChainStageRun(stage, in, out, block_size);
+    }else{
+    }
+    dspChainCyclesUpdate(stage, DWT->CYCCNT - start_cycles);
+}
+
+/*******************************************************************************************
+* dspChainCyclesUpdate - Records the cycles a stage used in the current block
+*******************************************************************************************/
+static void dspChainCyclesUpdate(DSP_STAGE_T *stage, INT32U cycles){
+    stage->cycles_last = cycles;
+    if(cycles > stage->cycles_max){
+        stage->cycles_max = cycles;
+    }else{
+    }
+    DSPProfAdd(&stage->prof, cycles);
+}
+
+/*******************************************************************************************
+* DSPChainBlockSizeSet - Rebuilds the stages that depend on the block size after it has
+* changed. Called with the DMA halted.
+*******************************************************************************************/
+void DSPChainBlockSizeSet(INT32U block_size){
+    dspChainLock();
+    DSPConvBlockSizeSet(block_size);
+    dspChainUnlock();
+}
+
+/*******************************************************************************************
+* dspChainStereoCheck - Returns 1 if two stages are enabled q31 DF1 biquad cascades with the
+* same section count, post shift and coefficient values, so they can share one pass of
+* DSPBiquadStereoQ31().
+*******************************************************************************************/
+static INT8U dspChainStereoCheck(const DSP_STAGE_T *left, const DSP_STAGE_T *right){
+    INT32U i;
+
+    if((left->type != DSP_STAGE_BIQUAD) || (right->type != DSP_STAGE_BIQUAD) ||
+       (left->enabled == 0) || (right->enabled == 0) ||
+       (left->u.biquad.mode != DSP_BIQUAD_MODE_Q31) || (right->u.biquad.mode != DSP_BIQUAD_MODE_Q31) ||
+       (left->u.biquad.inst.numStages != right->u.biquad.inst.numStages) ||
+       (left->u.biquad.inst.postShift != right->u.biquad.inst.postShift)){
+        return 0;
+    }else{
+    }
+    for(i=0;i<(left->u.biquad.inst.numStages*5);i++){
+        if(left->u.biquad.inst.pCoeffs[i] != right->u.biquad.inst.pCoeffs[i]){
+            return 0;
+        }else{
+        }
+    }
+    return 1;
+}
+
+/*******************************************************************************************
+* dspChainDynPairCheck - Returns 1 if two stages are enabled dynamics stages, to be run
+* stereo-linked
+*******************************************************************************************/
+static INT8U dspChainDynPairCheck(const DSP_STAGE_T *left, const DSP_STAGE_T *right){
+    if((left->type == DSP_STAGE_DYN) && (right->type == DSP_STAGE_DYN) &&
+       (left->enabled != 0) && (right->enabled != 0)){
+        return 1;
+    }else{
+        return 0;
+    }
+}
+
+/*******************************************************************************************
+* dspChainStageRun - Runs one stage in place on out
+*******************************************************************************************/
+static void dspChainStageRun(DSP_STAGE_T *stage, q31_t *const in[], q31_t *out,
+                             INT32U block_size){
+    q31_t *low;
+    INT32U low_size;
+    INT32U sub_size;
+    INT32U k;
+    INT8U i;
+
+    switch(stage->type){
+    case DSP_STAGE_BIQUAD:
+        if(stage->u.biquad.mode == DSP_BIQUAD_MODE_Q31_HP){
+            arm_biquad_cas_df1_32x64_q31(&stage->u.biquad.inst_hp, out, out, block_size);
+        }else if(stage->u.biquad.mode == DSP_BIQUAD_MODE_F32){
+            arm_q31_to_float(out, &dspChainScratchF32[0], block_size);
+            arm_biquad_cascade_df2T_f32(&stage->u.biquad.inst_f32, &dspChainScratchF32[0],
+                                        &dspChainScratchF32[0], block_size);
+            arm_float_to_q31(&dspChainScratchF32[0], out, block_size);
+        }else{
+            arm_biquad_cascade_df1_q31(&stage->u.biquad.inst, out, out, block_size);
+        }
+        break;
+    case DSP_STAGE_FIR:
+        //The state is sized for DSP_CHAIN_FIR_BLOCK, so longer blocks are run in pieces
+        sub_size = (block_size < DSP_CHAIN_FIR_BLOCK) ? block_size : DSP_CHAIN_FIR_BLOCK;
+        for(k=0;k<block_size;k+=sub_size){
+            arm_fir_q31(&stage->u.fir.inst, &out[k], &out[k], sub_size);
+        }
+        break;
+    case DSP_STAGE_GAIN:
+        arm_scale_q31(out, stage->u.gain.fract, stage->u.gain.shift, out, block_size);
+        break;
+    case DSP_STAGE_MIX:
+        arm_scale_q31(in[stage->u.mix.src_ch], stage->u.mix.fract, stage->u.mix.shift,
+                      &dspChainScratch[0], block_size);
+        arm_add_q31(out, &dspChainScratch[0], out, block_size);
+        break;
+    case DSP_STAGE_CONV:
+        DSPConvProcess(stage->u.conv.inst, out, out, block_size);
+        break;
+    case DSP_STAGE_MULTIRATE:
+        low = DSPMultirateDecimate(stage->u.mr.inst, out, block_size);
+        low_size = block_size/DSPMultirateFactorGet(stage->u.mr.inst);
+        for(i=0;i<dspChainLen[stage->u.mr.sub_ch];i++){
+            dspChainStageTimedRun(&dspChain[stage->u.mr.sub_ch][i], in, low, low_size);
+        }
+        DSPMultirateInterpolate(stage->u.mr.inst, out, block_size);
+        break;
+    case DSP_STAGE_DYN:
+        DSPDynProcess(stage->u.dyn.inst, out, block_size);
+        break;
+    case DSP_STAGE_MOD:
+        DSPNcoModProcess(stage->u.mod.inst, out, block_size);
+        break;
+    case DSP_STAGE_BYPASS:
+    default:
+        break;
+    }
+}
+
+/*******************************************************************************************
+* DSPChainClear - Removes every stage from channel ch
+*******************************************************************************************/
+INT8U DSPChainClear(INT8U ch){
+    INT8U i;
+
+    if(ch >= DSP_CHAIN_NUM_ROWS){
+        return DSP_CHAIN_ERR_CH;
+    }else{
+    }
+    dspChainLock();
+    for(i=0;i<dspChainLen[ch];i++){
+        dspChainStageFree(&dspChain[ch][i]);
+    }
+    dspChainLen[ch] = 0;
+    dspChainUnlock();
+    return DSP_CHAIN_ERR_NONE;
+}
+
+/*******************************************************************************************
+* DSPChainBypassAdd - Appends a stage that passes the block through unchanged
+*******************************************************************************************/
+INT8U DSPChainBypassAdd(INT8U ch){
+    INT8U err;
+
+    dspChainLock();
+    (void)dspChainStageNew(ch, DSP_STAGE_BYPASS, &err);
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainBiquadAdd - Appends a biquad cascade. coeffs holds num_stages sets of q31
+* {b0, b1, b2, a1, a2} in the CMSIS order and is copied into the stage. The stage runs in
+* the current biquad precision mode.
+*******************************************************************************************/
+INT8U DSPChainBiquadAdd(INT8U ch, const q31_t *coeffs, INT8U num_stages, INT8U post_shift){
+    DSP_STAGE_T *stage;
+    INT8U err;
+    INT8U i;
+
+    if((num_stages == 0) || (num_stages > DSP_CHAIN_MAX_BIQUADS)){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    dspChainLock();
+    stage = dspChainStageNew(ch, DSP_STAGE_BIQUAD, &err);
+    if(stage != (void *)0){
+        stage->u.biquad.bank = 0;
+        stage->u.biquad.staged = 0;
+        stage->u.biquad.pending = 0;
+        for(i=0;i<DSP_CHAIN_MAX_BIQUADS;i++){
+            stage->u.biquad.design[i].type = DSP_DESIGN_NONE;
+        }
+        arm_copy_q31((q31_t *)coeffs, &stage->u.biquad.coeffs[0][0], num_stages*5);
+        dspChainBiquadInit(&stage->u.biquad, num_stages, post_shift, dspChainBiquadMode);
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainBiquadDesignAdd - Appends a biquad cascade designed from num_stages sets of
+* DSPDesign parameters at the rate the chain runs at. The post shift is chosen to fit the
+* largest coefficient. The stage is retuned when the sample rate changes.
+*******************************************************************************************/
+INT8U DSPChainBiquadDesignAdd(INT8U ch, const DSP_DESIGN_T *designs, INT8U num_stages){
+    DSP_STAGE_T *stage;
+    float32_t coeffs[5];
+    INT32U srate;
+    INT8U err;
+    INT8U i;
+
+    if((num_stages == 0) || (num_stages > DSP_CHAIN_MAX_BIQUADS)){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    dspChainLock();
+    srate = dspChainRowRate(ch);
+    for(i=0;i<num_stages;i++){
+        if(DSPDesignBiquad(&designs[i], srate, &coeffs[0]) != DSP_DESIGN_ERR_NONE){
+            dspChainUnlock();
+            return DSP_CHAIN_ERR_PARAM;
+        }else{
+        }
+    }
+    stage = dspChainStageNew(ch, DSP_STAGE_BIQUAD, &err);
+    if(stage != (void *)0){
+        stage->u.biquad.bank = 0;
+        stage->u.biquad.staged = 0;
+        stage->u.biquad.pending = 0;
+        for(i=0;i<DSP_CHAIN_MAX_BIQUADS;i++){
+            if(i < num_stages){
+                stage->u.biquad.design[i] = designs[i];
+            }else{
+                stage->u.biquad.design[i].type = DSP_DESIGN_NONE;
+            }
+        }
+        i = dspChainBiquadDesignRun(&stage->u.biquad, &stage->u.biquad.coeffs[0][0], num_stages,
+                                    0, srate);
+        dspChainBiquadInit(&stage->u.biquad, num_stages, i, dspChainBiquadMode);
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainFirAdd - Appends a q31 FIR. coeffs is in the CMSIS (time reversed) order and is
+* copied into the stage.
+*******************************************************************************************/
+INT8U DSPChainFirAdd(INT8U ch, const q31_t *coeffs, INT16U num_taps){
+    DSP_STAGE_T *stage;
+    INT8U err;
+
+    if((num_taps == 0) || (num_taps > DSP_CHAIN_MAX_FIR_TAPS)){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    dspChainLock();
+    stage = dspChainStageNew(ch, DSP_STAGE_FIR, &err);
+    if(stage != (void *)0){
+        arm_copy_q31((q31_t *)coeffs, &stage->u.fir.coeffs[0], num_taps);
+        arm_fir_init_q31(&stage->u.fir.inst, num_taps, &stage->u.fir.coeffs[0],
+                         &stage->u.fir.state[0], DSP_CHAIN_FIR_BLOCK);
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainGainAdd - Appends a gain stage. gain_milli is the linear gain x1000.
+*******************************************************************************************/
+INT8U DSPChainGainAdd(INT8U ch, INT32U gain_milli){
+    DSP_STAGE_T *stage;
+    INT8U err;
+
+    dspChainLock();
+    stage = dspChainStageNew(ch, DSP_STAGE_GAIN, &err);
+    if(stage != (void *)0){
+        dspChainGainToScale(gain_milli, &stage->u.gain.fract, &stage->u.gain.shift);
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainMixAdd - Appends a stage that adds input channel src_ch, scaled by gain_milli/1000,
+* to the block.
+*******************************************************************************************/
+INT8U DSPChainMixAdd(INT8U ch, INT8U src_ch, INT32U gain_milli){
+    DSP_STAGE_T *stage;
+    INT8U err;
+
+    if(src_ch >= DSP_NUM_IN_CHANNELS){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    dspChainLock();
+    stage = dspChainStageNew(ch, DSP_STAGE_MIX, &err);
+    if(stage != (void *)0){
+        stage->u.mix.src_ch = src_ch;
+        dspChainGainToScale(gain_milli, &stage->u.mix.fract, &stage->u.mix.shift);
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainConvAdd - Appends a partitioned FFT convolution with the impulse response
+* ir[0..num_taps-1] in normal time order, up to DSP_CONV_MAX_TAPS taps. The partition
+* spectra are computed before the chain is locked; DSPConvCreate() builds them in the new
+* instance only, which dspTask cannot reach until the stage is added. Only channels may
+* hold a convolution stage, since sub-chain blocks are shorter than the partitions.
+*******************************************************************************************/
+INT8U DSPChainConvAdd(INT8U ch, const q31_t *ir, INT16U num_taps){
+    DSP_STAGE_T *stage;
+    INT8U inst;
+    INT8U err;
+
+    if(ch >= DSP_NUM_OUT_CHANNELS){
+        return DSP_CHAIN_ERR_CH;
+    }else if((num_taps == 0) || (num_taps > DSP_CONV_MAX_TAPS)){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    inst = DSPConvCreate(ir, num_taps);
+    if(inst == DSP_CONV_NONE){
+        return DSP_CHAIN_ERR_MEM;
+    }else{
+    }
+    dspChainLock();
+    stage = dspChainStageNew(ch, DSP_STAGE_CONV, &err);
+    if(stage != (void *)0){
+        stage->u.conv.inst = inst;
+    }else{
+        DSPConvFree(inst);
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainMultirateAdd - Appends a stage that decimates by factor (2, 4 or 8), runs
+* sub-chain sub (0 to DSP_CHAIN_NUM_SUB-1) on the low rate block and interpolates back.
+* Only channels may hold a multirate stage, not sub-chains. Mix stages in a sub-chain read
+* the full rate input and should not be used there. A sub-chain is run by one multirate
+* stage only, since its filters are designed for that stage's rate and keep its state;
+* DSP_CHAIN_ERR_PARAM is returned if another stage already runs it.
+*******************************************************************************************/
+INT8U DSPChainMultirateAdd(INT8U ch, INT8U factor, INT8U sub){
+    DSP_STAGE_T *stage;
+    INT8U inst;
+    INT8U err;
+
+    if(ch >= DSP_NUM_OUT_CHANNELS){
+        return DSP_CHAIN_ERR_CH;
+    }else if(sub >= DSP_CHAIN_NUM_SUB){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    dspChainLock();
+    stage = dspChainSubOwnerFind(DSP_CHAIN_SUB_CH(sub));
+    dspChainUnlock();
+    if(stage != (void *)0){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    inst = DSPMultirateCreate(factor);
+    if(inst == DSP_MR_NONE){
+        return DSP_CHAIN_ERR_MEM;
+    }else{
+    }
+    dspChainLock();
+    //Checked again in case another task took the sub-chain meanwhile
+    if(dspChainSubOwnerFind(DSP_CHAIN_SUB_CH(sub)) != (void *)0){
+        stage = (void *)0;
+        err = DSP_CHAIN_ERR_PARAM;
+    }else{
+        stage = dspChainStageNew(ch, DSP_STAGE_MULTIRATE, &err);
+    }
+    if(stage != (void *)0){
+        stage->u.mr.inst = inst;
+        stage->u.mr.sub_ch = DSP_CHAIN_SUB_CH(sub);
+        dspChainRowRedesign(DSP_CHAIN_SUB_CH(sub));
+    }else{
+        DSPMultirateFree(inst);
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainDynAdd - Appends a look-ahead compressor/limiter, see DSPDynCreate(). Put it last
+* so the output cannot clip. It delays the channel by DSP_DYN_SEG samples, so add one to
+* both channels of a pair to keep them aligned; they are then run stereo-linked. Only
+* channels may hold a dynamics stage, since sub-chain blocks can be shorter than a segment.
+*******************************************************************************************/
+INT8U DSPChainDynAdd(INT8U ch, INT8S thresh_db, INT8U ratio, INT8S ceil_db){
+    DSP_STAGE_T *stage;
+    INT8U inst;
+    INT8U err;
+
+    if(ch >= DSP_NUM_OUT_CHANNELS){
+        return DSP_CHAIN_ERR_CH;
+    }else if((thresh_db > 0) || (ceil_db > 0) || (ratio == 1)){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    inst = DSPDynCreate(thresh_db, ratio, ceil_db);
+    if(inst == DSP_DYN_NONE){
+        return DSP_CHAIN_ERR_MEM;
+    }else{
+    }
+    dspChainLock();
+    stage = dspChainStageNew(ch, DSP_STAGE_DYN, &err);
+    if(stage != (void *)0){
+        stage->u.dyn.inst = inst;
+    }else{
+        DSPDynFree(inst);
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainModAdd - Appends an NCO modulator, ring or single sideband (see DSPNco.h), at
+* freq_hz up to half the sample rate. Only channels may hold one, since the NCO runs at
+* the full sample rate.
+*******************************************************************************************/
+INT8U DSPChainModAdd(INT8U ch, INT8U mode, INT32U freq_hz){
+    DSP_STAGE_T *stage;
+    INT8U inst;
+    INT8U err;
+
+    if(ch >= DSP_NUM_OUT_CHANNELS){
+        return DSP_CHAIN_ERR_CH;
+    }else if((mode >= DSP_NCO_NUM_MODS) || (freq_hz > (DSPSampleRateGet()/2u))){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    inst = DSPNcoCreate(mode, freq_hz, DSPSampleRateGet());
+    if(inst == DSP_NCO_NONE){
+        return DSP_CHAIN_ERR_MEM;
+    }else{
+    }
+    dspChainLock();
+    stage = dspChainStageNew(ch, DSP_STAGE_MOD, &err);
+    if(stage != (void *)0){
+        stage->u.mod.inst = inst;
+    }else{
+        DSPNcoFree(inst);
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainModFreqSet - Retunes modulator stage index of channel ch without a phase jump
+*******************************************************************************************/
+INT8U DSPChainModFreqSet(INT8U ch, INT8U index, INT32U freq_hz){
+    INT8U err = DSP_CHAIN_ERR_NONE;
+
+    if(freq_hz > (DSPSampleRateGet()/2u)){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    dspChainLock();
+    if(ch >= DSP_CHAIN_NUM_ROWS){
+        err = DSP_CHAIN_ERR_CH;
+    }else if((index >= dspChainLen[ch]) || (dspChain[ch][index].type != DSP_STAGE_MOD)){
+        err = DSP_CHAIN_ERR_INDEX;
+    }else{
+        DSPNcoFreqSet(dspChain[ch][index].u.mod.inst, freq_hz);
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainDynGainMinGet - Returns the deepest gain of dynamics stage index of channel ch
+* since the last reset, in q31, and restarts it if reset is set
+*******************************************************************************************/
+INT8U DSPChainDynGainMinGet(INT8U ch, INT8U index, q31_t *gain_min, INT8U reset){
+    INT8U err = DSP_CHAIN_ERR_NONE;
+
+    dspChainLock();
+    if(ch >= DSP_CHAIN_NUM_ROWS){
+        err = DSP_CHAIN_ERR_CH;
+    }else if((index >= dspChainLen[ch]) || (dspChain[ch][index].type != DSP_STAGE_DYN)){
+        err = DSP_CHAIN_ERR_INDEX;
+    }else{
+        *gain_min = DSPDynGainMinGet(dspChain[ch][index].u.dyn.inst);
+        if(reset != 0){
+            DSPDynGainMinReset(dspChain[ch][index].u.dyn.inst);
+        }else{
+        }
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainStageEnable - Enables or bypasses stage index of channel ch. A bypassed stage
+* keeps its state and is simply skipped.
+*******************************************************************************************/
+INT8U DSPChainStageEnable(INT8U ch, INT8U index, INT8U enable){
+    INT8U err = DSP_CHAIN_ERR_NONE;
+
+    if(ch >= DSP_CHAIN_NUM_ROWS){
+        return DSP_CHAIN_ERR_CH;
+    }else{
+    }
+    dspChainLock();
+    if(index < dspChainLen[ch]){
+        dspChain[ch][index].enabled = (enable != 0) ? 1 : 0;
+    }else{
+        err = DSP_CHAIN_ERR_INDEX;
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainLenGet - Returns the number of stages in channel ch
+*******************************************************************************************/
+INT8U DSPChainLenGet(INT8U ch){
+    if(ch >= DSP_CHAIN_NUM_ROWS){
+        return 0;
+    }else{
+        return dspChainLen[ch];
+    }
+}
+
+/*******************************************************************************************
+* DSPChainStageInfoGet - Copies the type, enable and cycle counts of one stage
+*******************************************************************************************/
+INT8U DSPChainStageInfoGet(INT8U ch, INT8U index, DSP_STAGE_INFO_T *info){
+    INT8U err = DSP_CHAIN_ERR_NONE;
+
+    if(ch >= DSP_CHAIN_NUM_ROWS){
+        return DSP_CHAIN_ERR_CH;
+    }else{
+    }
+    dspChainLock();
+    if(index < dspChainLen[ch]){
+        info->type = dspChain[ch][index].type;
+        info->enabled = dspChain[ch][index].enabled;
+        info->cycles_last = dspChain[ch][index].cycles_last;
+        info->cycles_max = dspChain[ch][index].cycles_max;
+    }else{
+        err = DSP_CHAIN_ERR_INDEX;
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainStageProfGet - Copies the cycle profile of one stage
+*******************************************************************************************/
+INT8U DSPChainStageProfGet(INT8U ch, INT8U index, DSP_PROF_T *prof){
+    INT8U err = DSP_CHAIN_ERR_NONE;
+
+    if(ch >= DSP_CHAIN_NUM_ROWS){
+        return DSP_CHAIN_ERR_CH;
+    }else{
+    }
+    dspChainLock();
+    if(index < dspChainLen[ch]){
+        *prof = dspChain[ch][index].prof;
+    }else{
+        err = DSP_CHAIN_ERR_INDEX;
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainCyclesReset - Clears the cycle counts and profiles of every stage
+*******************************************************************************************/
+void DSPChainCyclesReset(void){
+    INT8U ch;
+    INT8U i;
+
+    dspChainLock();
+    for(ch=0;ch<DSP_CHAIN_NUM_ROWS;ch++){
+        for(i=0;i<DSP_CHAIN_MAX_STAGES;i++){
+            dspChain[ch][i].cycles_last = 0;
+            dspChain[ch][i].cycles_max = 0;
+            DSPProfReset(&dspChain[ch][i].prof);
+        }
+    }
+    dspChainUnlock();
+}
+
+/*******************************************************************************************
+* DSPChainBiquadModeSet - Selects the precision every biquad stage runs in, now and when
+* added later. Stages are re-initialized with cleared state, so expect a short transient.
+*   DSP_BIQUAD_MODE_Q31     q31 DF1, arm_biquad_cascade_df1_q31()
+*   DSP_BIQUAD_MODE_Q31_HP  q31 DF1 32x64, arm_biquad_cas_df1_32x64_q31()
+*   DSP_BIQUAD_MODE_F32     f32 DF2T, arm_biquad_cascade_df2T_f32() with q31/f32 conversion
+* tools/biquadbench.c measures the modes on the default chain.
+*******************************************************************************************/
+void DSPChainBiquadModeSet(INT8U mode){
+    DSP_STAGE_BIQUAD_T *biquad;
+    INT8U ch;
+    INT8U i;
+
+    if(mode >= DSP_BIQUAD_NUM_MODES){
+        return;
+    }else{
+    }
+    dspChainLock();
+    dspChainBiquadMode = mode;
+    for(ch=0;ch<DSP_CHAIN_NUM_ROWS;ch++){
+        for(i=0;i<dspChainLen[ch];i++){
+            if(dspChain[ch][i].type == DSP_STAGE_BIQUAD){
+                biquad = &dspChain[ch][i].u.biquad;
+                dspChainBiquadInit(biquad, (INT8U)biquad->inst.numStages, biquad->inst.postShift, mode);
+                dspChain[ch][i].cycles_max = 0;
+                DSPProfReset(&dspChain[ch][i].prof);
+            }else{
+            }
+        }
+    }
+    dspChainUnlock();
+}
+
+/*******************************************************************************************
+* DSPChainBiquadModeGet - Returns the current biquad precision mode
+*******************************************************************************************/
+INT8U DSPChainBiquadModeGet(void){
+    return dspChainBiquadMode;
+}
+
+/*******************************************************************************************
+* DSPChainStereoSet - Turns the stereo biquad kernel on or off. When on, matching q31 biquad
+* stages on a left/right pair are run by DSPBiquadStereoQ31() in one pass instead of two
+* arm_biquad_cascade_df1_q31() calls. The output is the same either way; it is off until
+* the M4 cycles, seen with dsp_prof, show it is faster than the CMSIS kernel.
+*******************************************************************************************/
+void DSPChainStereoSet(INT8U enable){
+    dspChainLock();
+    dspChainStereo = (enable != 0) ? 1 : 0;
+    dspChainUnlock();
+}
+
+/*******************************************************************************************
+* DSPChainStereoGet - Returns 1 if the stereo biquad kernel is on
+*******************************************************************************************/
+INT8U DSPChainStereoGet(void){
+    return dspChainStereo;
+}
+
+/*******************************************************************************************
+* dspChainBiquadInit - Initializes the instance for the given mode from the q31
+* coefficients already in the stage and clears the state. For f32 the coefficients are
+* converted once and scaled by 2^post_shift.
+*******************************************************************************************/
+static void dspChainBiquadInit(DSP_STAGE_BIQUAD_T *biquad, INT8U num_stages, INT8U post_shift,
+                               INT8U mode){
+    q31_t *coeffs = &biquad->coeffs[biquad->bank][0];
+
+    biquad->mode = mode;
+    arm_biquad_cascade_df1_init_q31(&biquad->inst, num_stages, coeffs,
+                                    &biquad->state[0], (int8_t)post_shift);
+    if(mode == DSP_BIQUAD_MODE_Q31_HP){
+        arm_biquad_cas_df1_32x64_init_q31(&biquad->inst_hp, num_stages, coeffs,
+                                          &biquad->state_hp[0], post_shift);
+    }else if(mode == DSP_BIQUAD_MODE_F32){
+        arm_q31_to_float(coeffs, &biquad->coeffs_f32[0], num_stages*5);
+        arm_scale_f32(&biquad->coeffs_f32[0], (float32_t)(1u << post_shift),
+                      &biquad->coeffs_f32[0], num_stages*5);
+        arm_biquad_cascade_df2T_init_f32(&biquad->inst_f32, num_stages, &biquad->coeffs_f32[0],
+                                         &biquad->state_f32[0]);
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* DSPChainBiquadLoad - Loads a complete set of q31 coefficients into the idle bank of biquad
+* stage index of channel ch and commits it. The new coefficients take effect at the next
+* block boundary. All sections become loaded sections, so they are no longer retuned.
+*******************************************************************************************/
+INT8U DSPChainBiquadLoad(INT8U ch, INT8U index, const q31_t *coeffs, INT8U num_stages,
+                         INT8U post_shift){
+    DSP_STAGE_BIQUAD_T *biquad;
+    INT8U err;
+    INT8U i;
+
+    if((num_stages == 0) || (num_stages > DSP_CHAIN_MAX_BIQUADS) || (post_shift > 31)){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    dspChainLock();
+    biquad = dspChainBiquadFind(ch, index, &err);
+    if(biquad != (void *)0){
+        for(i=0;i<DSP_CHAIN_MAX_BIQUADS;i++){
+            biquad->design[i].type = DSP_DESIGN_NONE;
+        }
+        arm_copy_q31((q31_t *)coeffs, &biquad->coeffs[biquad->bank ^ 1][0], num_stages*5);
+        biquad->staged_num_stages = num_stages;
+        biquad->staged_post_shift = post_shift;
+        biquad->staged = 1;
+        biquad->pending = 1;
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainBiquadSectionSet - Writes the five coefficients {b0, b1, b2, a1, a2} of one
+* section into the idle bank. They are scaled down by 2^post_shift of the edit and
+* converted to q31, so set the post shift first when it changes. The first edit copies the
+* bank in use so the other sections are kept. Nothing changes in the audio until
+* DSPChainBiquadCommit(). The section becomes a loaded section and is no longer retuned.
+*******************************************************************************************/
+INT8U DSPChainBiquadSectionSet(INT8U ch, INT8U index, INT8U section, const float32_t *coeffs){
+    DSP_STAGE_BIQUAD_T *biquad;
+    float32_t scaled[5];
+    INT8U err;
+
+    dspChainLock();
+    biquad = dspChainBiquadFind(ch, index, &err);
+    if(biquad != (void *)0){
+        dspChainBiquadStage(biquad);
+        if(section < biquad->staged_num_stages){
+            arm_scale_f32((float32_t *)coeffs, 1.0f/(float32_t)(1u << biquad->staged_post_shift),
+                          &scaled[0], 5);
+            arm_float_to_q31(&scaled[0], &biquad->coeffs[biquad->bank ^ 1][section*5], 5);
+            biquad->design[section].type = DSP_DESIGN_NONE;
+        }else{
+            err = DSP_CHAIN_ERR_PARAM;
+        }
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainBiquadShiftSet - Sets the post shift of the edit in the idle bank
+*******************************************************************************************/
+INT8U DSPChainBiquadShiftSet(INT8U ch, INT8U index, INT8U post_shift){
+    DSP_STAGE_BIQUAD_T *biquad;
+    INT8U err;
+
+    if(post_shift > 31){
+        return DSP_CHAIN_ERR_PARAM;
+    }else{
+    }
+    dspChainLock();
+    biquad = dspChainBiquadFind(ch, index, &err);
+    if(biquad != (void *)0){
+        dspChainBiquadStage(biquad);
+        biquad->staged_post_shift = post_shift;
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainBiquadCommit - Requests the swap to the edited bank at the next block boundary
+*******************************************************************************************/
+INT8U DSPChainBiquadCommit(INT8U ch, INT8U index){
+    DSP_STAGE_BIQUAD_T *biquad;
+    INT8U err;
+
+    dspChainLock();
+    biquad = dspChainBiquadFind(ch, index, &err);
+    if((biquad != (void *)0) && (biquad->staged != 0)){
+        biquad->pending = 1;
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainBiquadDesign - Designs one section of biquad stage index of channel ch from the
+* DSPDesign parameters and commits it, with any edit already open in the idle bank. The
+* post shift becomes the smallest that fits every designed section, but is not lowered
+* while the cascade has loaded sections, which are scaled down when it is raised.
+*******************************************************************************************/
+INT8U DSPChainBiquadDesign(INT8U ch, INT8U index, INT8U section, const DSP_DESIGN_T *design){
+    DSP_STAGE_BIQUAD_T *biquad;
+    float32_t coeffs[5];
+    INT32U srate;
+    INT8U err;
+
+    dspChainLock();
+    biquad = dspChainBiquadFind(ch, index, &err);
+    if(biquad != (void *)0){
+        srate = dspChainRowRate(ch);
+        dspChainBiquadStage(biquad);
+        if((section >= biquad->staged_num_stages) ||
+           (DSPDesignBiquad(design, srate, &coeffs[0]) != DSP_DESIGN_ERR_NONE)){
+            err = DSP_CHAIN_ERR_PARAM;
+        }else{
+            biquad->design[section] = *design;
+            biquad->staged_post_shift = dspChainBiquadDesignRun(biquad,
+                                            &biquad->coeffs[biquad->bank ^ 1][0],
+                                            biquad->staged_num_stages, biquad->staged_post_shift,
+                                            srate);
+            biquad->pending = 1;
+        }
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainBiquadDesignGet - Copies the design parameters of one section. The type is
+* DSP_DESIGN_NONE for a section that was loaded as coefficients.
+*******************************************************************************************/
+INT8U DSPChainBiquadDesignGet(INT8U ch, INT8U index, INT8U section, DSP_DESIGN_T *design){
+    DSP_STAGE_BIQUAD_T *biquad;
+    INT8U err;
+
+    dspChainLock();
+    biquad = dspChainBiquadFind(ch, index, &err);
+    if(biquad != (void *)0){
+        if(section < DSP_CHAIN_MAX_BIQUADS){
+            *design = biquad->design[section];
+        }else{
+            err = DSP_CHAIN_ERR_PARAM;
+        }
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* DSPChainBiquadRedesign - Recomputes the designed sections of every biquad stage for the
+* current sample rate and commits them. Called by DSPSampleRateSet().
+*******************************************************************************************/
+void DSPChainBiquadRedesign(void){
+    INT8U row;
+
+    dspChainLock();
+    for(row=0;row<DSP_CHAIN_NUM_ROWS;row++){
+        dspChainRowRedesign(row);
+    }
+    dspChainUnlock();
+}
+
+/*******************************************************************************************
+* DSPChainBiquadGet - Copies the coefficients in use by biquad stage index of channel ch.
+* coeffs must hold DSP_CHAIN_MAX_BIQUADS*5 values.
+*******************************************************************************************/
+INT8U DSPChainBiquadGet(INT8U ch, INT8U index, q31_t *coeffs, INT8U *num_stages,
+                        INT8U *post_shift){
+    DSP_STAGE_BIQUAD_T *biquad;
+    INT8U err;
+
+    dspChainLock();
+    biquad = dspChainBiquadFind(ch, index, &err);
+    if(biquad != (void *)0){
+        *num_stages = (INT8U)biquad->inst.numStages;
+        *post_shift = biquad->inst.postShift;
+        arm_copy_q31(&biquad->coeffs[biquad->bank][0], coeffs, (*num_stages)*5);
+    }else{
+    }
+    dspChainUnlock();
+    return err;
+}
+
+/*******************************************************************************************
+* dspChainBiquadSwap - Switches a biquad stage to the committed bank. Called with the chain
+* locked at the start of a block. The DF1 state of every mode holds past input and output
+* samples, and the post shift only scales the coefficients, so the state of the sections
+* that remain is kept and there is no click from restarting the filter. Sections added at
+* the end start from rest. The f32 DF2T state is kept the same way.
+*******************************************************************************************/
+static void dspChainBiquadSwap(DSP_STAGE_BIQUAD_T *biquad){
+    INT8U num_stages = biquad->staged_num_stages;
+    INT8U post_shift = biquad->staged_post_shift;
+    INT8U old_stages = (INT8U)biquad->inst.numStages;
+    q31_t *coeffs;
+    INT32U i;
+
+    biquad->bank ^= 1;
+    biquad->staged = 0;
+    biquad->pending = 0;
+    coeffs = &biquad->coeffs[biquad->bank][0];
+    for(i=(INT32U)old_stages*4;i<((INT32U)num_stages*4);i++){
+        biquad->state[i] = 0;
+        biquad->state_hp[i] = 0;
+    }
+    for(i=(INT32U)old_stages*2;i<((INT32U)num_stages*2);i++){
+        biquad->state_f32[i] = 0.0f;
+    }
+    biquad->inst.numStages = num_stages;
+    biquad->inst.postShift = post_shift;
+    biquad->inst.pCoeffs = coeffs;
+    if(biquad->mode == DSP_BIQUAD_MODE_Q31_HP){
+        biquad->inst_hp.numStages = num_stages;
+        biquad->inst_hp.postShift = post_shift;
+        biquad->inst_hp.pCoeffs = coeffs;
+    }else if(biquad->mode == DSP_BIQUAD_MODE_F32){
+        arm_q31_to_float(coeffs, &biquad->coeffs_f32[0], num_stages*5);
+        arm_scale_f32(&biquad->coeffs_f32[0], (float32_t)(1u << post_shift),
+                      &biquad->coeffs_f32[0], num_stages*5);
+        biquad->inst_f32.numStages = num_stages;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* dspChainBiquadStage - Opens an edit in the idle bank as a copy of the bank in use, unless
+* one is already open. Must be called with the chain locked.
+*******************************************************************************************/
+static void dspChainBiquadStage(DSP_STAGE_BIQUAD_T *biquad){
+    if(biquad->staged == 0){
+        biquad->staged_num_stages = (INT8U)biquad->inst.numStages;
+        biquad->staged_post_shift = biquad->inst.postShift;
+        arm_copy_q31(&biquad->coeffs[biquad->bank][0], &biquad->coeffs[biquad->bank ^ 1][0],
+                     biquad->staged_num_stages*5);
+        biquad->staged = 1;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* dspChainBiquadDesignRun - Computes the designed sections of the num_stages sections in
+* coeffs for srate. Returns the new post shift: the smallest that fits the designed sections,
+* or post_shift if that is larger and there are loaded sections. Loaded sections are shifted
+* down by the increase. An fc above the new Nyquist limit is held at DSP_DESIGN_FC_MAX*srate
+* so the section keeps its setting for when the rate goes back up. Call with the chain locked.
+*******************************************************************************************/
+static INT8U dspChainBiquadDesignRun(DSP_STAGE_BIQUAD_T *biquad, q31_t *coeffs, INT8U num_stages,
+                                     INT8U post_shift, INT32U srate){
+    static const float32_t pass[5] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    float32_t designed[DSP_CHAIN_MAX_BIQUADS*5];
+    DSP_DESIGN_T design;
+    INT8U new_shift = 0;
+    INT8U loaded = 0;
+    INT8U shift;
+    INT8U s;
+
+    for(s=0;s<num_stages;s++){
+        if(biquad->design[s].type == DSP_DESIGN_NONE){
+            loaded = 1;
+        }else{
+            design = biquad->design[s];
+            if(design.fc > (DSP_DESIGN_FC_MAX*(float32_t)srate)){
+                design.fc = DSP_DESIGN_FC_MAX*(float32_t)srate;
+            }else{
+            }
+            if(DSPDesignBiquad(&design, srate, &designed[s*5]) != DSP_DESIGN_ERR_NONE){
+                arm_copy_f32((float32_t *)pass, &designed[s*5], 5);
+            }else{
+            }
+            shift = DSPDesignShiftGet(&designed[s*5], 5);
+            if(shift > new_shift){
+                new_shift = shift;
+            }else{
+            }
+        }
+    }
+    if((loaded != 0) && (post_shift > new_shift)){
+        new_shift = post_shift;
+    }else{
+    }
+    for(s=0;s<num_stages;s++){
+        if(biquad->design[s].type == DSP_DESIGN_NONE){
+            if(new_shift > post_shift){
+                arm_shift_q31(&coeffs[s*5], -(INT8S)(new_shift - post_shift), &coeffs[s*5], 5);
+            }else{
+            }
+        }else{
+            arm_scale_f32(&designed[s*5], 1.0f/(float32_t)(1u << new_shift), &designed[s*5], 5);
+            arm_float_to_q31(&designed[s*5], &coeffs[s*5], 5);
+        }
+    }
+    return new_shift;
+}
+
+/*******************************************************************************************
+* dspChainRowRedesign - Retunes the biquad stages of one chain row that have designed
+* sections. Call with the chain locked.
+*******************************************************************************************/
+static void dspChainRowRedesign(INT8U row){
+    DSP_STAGE_BIQUAD_T *biquad;
+    INT32U srate = dspChainRowRate(row);
+    INT8U i;
+    INT8U s;
+
+    for(i=0;i<dspChainLen[row];i++){
+        if(dspChain[row][i].type == DSP_STAGE_BIQUAD){
+            biquad = &dspChain[row][i].u.biquad;
+            for(s=0;(s < biquad->inst.numStages) && (biquad->design[s].type == DSP_DESIGN_NONE);s++){
+            }
+            if(s < biquad->inst.numStages){
+                dspChainBiquadStage(biquad);
+                biquad->staged_post_shift = dspChainBiquadDesignRun(biquad,
+                                                &biquad->coeffs[biquad->bank ^ 1][0],
+                                                biquad->staged_num_stages,
+                                                biquad->staged_post_shift, srate);
+                biquad->pending = 1;
+            }else{
+            }
+        }else{
+        }
+    }
+}
+
+/*******************************************************************************************
+* dspChainRowRate - Returns the sample rate a chain row runs at. A sub-chain runs at the
+* rate of the multirate stage that uses it, or the full rate when none does yet. Call with
+* the chain locked.
+*******************************************************************************************/
+static INT32U dspChainRowRate(INT8U row){
+    DSP_STAGE_T *owner;
+    INT32U srate = DSPSampleRateGet();
+
+    if(row >= DSP_NUM_OUT_CHANNELS){
+        owner = dspChainSubOwnerFind(row);
+        if(owner != (void *)0){
+            return srate/DSPMultirateFactorGet(owner->u.mr.inst);
+        }else{
+        }
+    }else{
+    }
+    return srate;
+}
+
+/*******************************************************************************************
+* dspChainSubOwnerFind - Returns the multirate stage that runs sub-chain row, or a null
+* pointer if none does. Call with the chain locked.
+*******************************************************************************************/
+static DSP_STAGE_T *dspChainSubOwnerFind(INT8U row){
+    INT8U ch;
+    INT8U i;
+
+    for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+        for(i=0;i<dspChainLen[ch];i++){
+            if((dspChain[ch][i].type == DSP_STAGE_MULTIRATE) && (dspChain[ch][i].u.mr.sub_ch == row)){
+                return &dspChain[ch][i];
+            }else{
+            }
+        }
+    }
+    return (void *)0;
+}
+
+/*******************************************************************************************
+* dspChainBiquadFind - Returns biquad stage index of channel ch, or a null pointer and sets
+* *err if it does not exist or is not a biquad. Must be called with the chain locked.
+*******************************************************************************************/
+static DSP_STAGE_BIQUAD_T *dspChainBiquadFind(INT8U ch, INT8U index, INT8U *err){
+    if(ch >= DSP_CHAIN_NUM_ROWS){
+        *err = DSP_CHAIN_ERR_CH;
+        return (void *)0;
+    }else if((index >= dspChainLen[ch]) || (dspChain[ch][index].type != DSP_STAGE_BIQUAD)){
+        *err = DSP_CHAIN_ERR_INDEX;
+        return (void *)0;
+    }else{
+    }
+    *err = DSP_CHAIN_ERR_NONE;
+    return &dspChain[ch][index].u.biquad;
+}
+
+/*******************************************************************************************
+* dspChainStageNew - Appends an empty stage of the given type to channel ch.
+* Must be called with the chain locked. Returns a null pointer and sets *err if the channel
+* is invalid or full.
+*******************************************************************************************/
+static DSP_STAGE_T *dspChainStageNew(INT8U ch, DSP_STAGE_TYPE_T type, INT8U *err){
+    DSP_STAGE_T *stage;
+
+    if(ch >= DSP_CHAIN_NUM_ROWS){
+        *err = DSP_CHAIN_ERR_CH;
+        return (void *)0;
+    }else if(dspChainLen[ch] >= DSP_CHAIN_MAX_STAGES){
+        *err = DSP_CHAIN_ERR_FULL;
+        return (void *)0;
+    }else{
+    }
+    stage = &dspChain[ch][dspChainLen[ch]];
+    stage->type = type;
+    stage->enabled = 1;
+    stage->cycles_last = 0;
+    stage->cycles_max = 0;
+    DSPProfReset(&stage->prof);
+    dspChainLen[ch]++;
+    *err = DSP_CHAIN_ERR_NONE;
+    return stage;
+}
+
+/*******************************************************************************************
+* dspChainStageFree - Releases anything a stage holds outside the chain. Must be called
+* with the chain locked.
+*******************************************************************************************/
+static void dspChainStageFree(DSP_STAGE_T *stage){
+    if(stage->type == DSP_STAGE_CONV){
+        DSPConvFree(stage->u.conv.inst);
+    }else if(stage->type == DSP_STAGE_MULTIRATE){
+        DSPMultirateFree(stage->u.mr.inst);
+    }else if(stage->type == DSP_STAGE_DYN){
+        DSPDynFree(stage->u.dyn.inst);
+    }else if(stage->type == DSP_STAGE_MOD){
+        DSPNcoFree(stage->u.mod.inst);
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* dspChainGainToScale - Converts a gain x1000 to the fraction and left shift used by
+* arm_scale_q31(). The fraction is kept below 1.0 by raising the shift.
+*******************************************************************************************/
+static void dspChainGainToScale(INT32U gain_milli, q31_t *fract, INT8S *shift){
+    INT8S sh = 0;
+
+    if(gain_milli > 1000000u){                      /* Limit to x1000 */
+        gain_milli = 1000000u;
+    }else{
+    }
+    while(gain_milli >= (1000u << sh)){
+        sh++;
+    }
+    *fract = (q31_t)(((INT64U)gain_milli << 31)/((INT64U)1000u << sh));
+    *shift = sh;
+}
+
+/*******************************************************************************************
+* dspChainLock/dspChainUnlock - Serialize chain edits with block processing
+*******************************************************************************************/
+static void dspChainLock(void){
+    OS_ERR os_err;
+    OSMutexPend(&dspChainMutex, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+}
+
+static void dspChainUnlock(void){
+    OS_ERR os_err;
+    OSMutexPost(&dspChainMutex, OS_OPT_POST_NONE, &os_err);
+}
@@ -0,0 +1,173 @@
+/*****************************************************************************************************
+* DSPChain.h
+* Runtime processing chain. Each output channel has an ordered list of stages that dspTask runs
+* on every block. The chain is built in DSPInit() and can be changed from the shell while audio
+* runs.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_CHAIN_PRESENT
+#define  DSP_CHAIN_PRESENT
+
+/*****************************************************************************************************
+* Chain configuration constants
+*****************************************************************************************************/
+#define DSP_CHAIN_MAX_STAGES        6       //Stages per channel
+#define DSP_CHAIN_MAX_BIQUADS       4       //Biquad sections in one cascade stage
+#define DSP_CHAIN_MAX_FIR_TAPS      32      //Taps in one FIR stage
+#define DSP_CHAIN_FIR_BLOCK         DSP_BLOCK_SIZE_MIN  //FIR stages run in sub-blocks of this size
+#define DSP_CHAIN_NUM_SUB           2       //Sub-chains run by multirate stages
+
+//Sub-chains are kept after the channels and use these chain numbers
+#define DSP_CHAIN_NUM_ROWS          (DSP_NUM_OUT_CHANNELS+DSP_CHAIN_NUM_SUB)
+#define DSP_CHAIN_SUB_CH(sub)       (DSP_NUM_OUT_CHANNELS+(sub))
+
+/*****************************************************************************************************
+* Stage types and stage object
+*****************************************************************************************************/
+typedef enum{
+    DSP_STAGE_BYPASS,
+    DSP_STAGE_BIQUAD,
+    DSP_STAGE_FIR,
+    DSP_STAGE_GAIN,
+    DSP_STAGE_MIX,
+    DSP_STAGE_CONV,
+    DSP_STAGE_MULTIRATE,
+    DSP_STAGE_DYN,
+    DSP_STAGE_MOD
+} DSP_STAGE_TYPE_T;
+
+//Biquad precision modes
+#define DSP_BIQUAD_MODE_Q31     0           //q31 DF1, 64-bit accumulator
+#define DSP_BIQUAD_MODE_Q31_HP  1           //q31 DF1 with 32x64 (q63) state
+#define DSP_BIQUAD_MODE_F32     2           //f32 transposed DF2 on the FPU
+#define DSP_BIQUAD_NUM_MODES    3
+
+typedef struct{
+    INT8U mode;
+    arm_biquad_casd_df1_inst_q31 inst;
+    arm_biquad_cas_df1_32x64_ins_q31 inst_hp;
+    arm_biquad_cascade_df2T_instance_f32 inst_f32;
+    INT8U bank;                             //Coefficient bank in use
+    INT8U staged;                           //Other bank holds an edit in progress
+    INT8U pending;                          //Swap banks at the next block boundary
+    INT8U staged_num_stages;
+    INT8U staged_post_shift;
+    q31_t coeffs[2][DSP_CHAIN_MAX_BIQUADS*5];
+    q31_t state[DSP_CHAIN_MAX_BIQUADS*4];
+    q63_t state_hp[DSP_CHAIN_MAX_BIQUADS*4];
+    float32_t coeffs_f32[DSP_CHAIN_MAX_BIQUADS*5];
+    float32_t state_f32[DSP_CHAIN_MAX_BIQUADS*2];
+    DSP_DESIGN_T design[DSP_CHAIN_MAX_BIQUADS];    //DSP_DESIGN_NONE for loaded sections
+} DSP_STAGE_BIQUAD_T;
+
+typedef struct{
+    arm_fir_instance_q31 inst;
+    q31_t coeffs[DSP_CHAIN_MAX_FIR_TAPS];
+    q31_t state[DSP_CHAIN_MAX_FIR_TAPS+DSP_CHAIN_FIR_BLOCK-1];
+} DSP_STAGE_FIR_T;
+
+typedef struct{
+    q31_t fract;                            //arm_scale_q31() fraction and shift
+    INT8S shift;
+} DSP_STAGE_GAIN_T;
+
+typedef struct{
+    INT8U src_ch;                           //Input channel added to this channel
+    q31_t fract;
+    INT8S shift;
+} DSP_STAGE_MIX_T;
+
+typedef struct{
+    INT8U inst;                             //DSPConv instance
+} DSP_STAGE_CONV_T;
+
+typedef struct{
+    INT8U inst;                             //DSPMultirate instance
+    INT8U sub_ch;                           //Sub-chain run at the low rate
+} DSP_STAGE_MR_T;
+
+typedef struct{
+    INT8U inst;                             //DSPDyn instance
+} DSP_STAGE_DYN_T;
+
+typedef struct{
+    INT8U inst;                             //DSPNco instance
+} DSP_STAGE_MOD_T;
+
+typedef struct{
+    DSP_STAGE_TYPE_T type;
+    INT8U enabled;
+    INT32U cycles_last;                     //DWT cycles spent in the stage
+    INT32U cycles_max;
+    DSP_PROF_T prof;                        //Cycles per block since the last reset
+    union{
+        DSP_STAGE_BIQUAD_T biquad;
+        DSP_STAGE_FIR_T fir;
+        DSP_STAGE_GAIN_T gain;
+        DSP_STAGE_MIX_T mix;
+        DSP_STAGE_CONV_T conv;
+        DSP_STAGE_MR_T mr;
+        DSP_STAGE_DYN_T dyn;
+        DSP_STAGE_MOD_T mod;
+    } u;
+} DSP_STAGE_T;
+
+//Copy of one stage for reporting
+typedef struct{
+    DSP_STAGE_TYPE_T type;
+    INT8U enabled;
+    INT32U cycles_last;
+    INT32U cycles_max;
+} DSP_STAGE_INFO_T;
+
+//Chain error codes
+#define DSP_CHAIN_ERR_NONE      0
+#define DSP_CHAIN_ERR_CH        1
+#define DSP_CHAIN_ERR_FULL      2
+#define DSP_CHAIN_ERR_INDEX     3
+#define DSP_CHAIN_ERR_PARAM     4
+#define DSP_CHAIN_ERR_MEM       5
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPChainInit(void);
+void DSPChainProcess(q31_t *const in[], q31_t *const out[], INT32U block_size);
+void DSPChainBlockSizeSet(INT32U block_size);
+INT8U DSPChainClear(INT8U ch);
+INT8U DSPChainBypassAdd(INT8U ch);
+INT8U DSPChainBiquadAdd(INT8U ch, const q31_t *coeffs, INT8U num_stages, INT8U post_shift);
+INT8U DSPChainBiquadDesignAdd(INT8U ch, const DSP_DESIGN_T *designs, INT8U num_stages);
+INT8U DSPChainFirAdd(INT8U ch, const q31_t *coeffs, INT16U num_taps);
+INT8U DSPChainGainAdd(INT8U ch, INT32U gain_milli);
+INT8U DSPChainMixAdd(INT8U ch, INT8U src_ch, INT32U gain_milli);
+INT8U DSPChainConvAdd(INT8U ch, const q31_t *ir, INT16U num_taps);
+INT8U DSPChainMultirateAdd(INT8U ch, INT8U factor, INT8U sub);
+INT8U DSPChainDynAdd(INT8U ch, INT8S thresh_db, INT8U ratio, INT8S ceil_db);
+INT8U DSPChainModAdd(INT8U ch, INT8U mode, INT32U freq_hz);
+INT8U DSPChainModFreqSet(INT8U ch, INT8U index, INT32U freq_hz);
+INT8U DSPChainStageEnable(INT8U ch, INT8U index, INT8U enable);
+INT8U DSPChainLenGet(INT8U ch);
+INT8U DSPChainStageInfoGet(INT8U ch, INT8U index, DSP_STAGE_INFO_T *info);
+void DSPChainCyclesReset(void);
+INT8U DSPChainStageProfGet(INT8U ch, INT8U index, DSP_PROF_T *prof);
+void DSPChainBiquadModeSet(INT8U mode);
+INT8U DSPChainBiquadLoad(INT8U ch, INT8U index, const q31_t *coeffs, INT8U num_stages,
+                         INT8U post_shift);
+INT8U DSPChainBiquadSectionSet(INT8U ch, INT8U index, INT8U section, const float32_t *coeffs);
+INT8U DSPChainBiquadShiftSet(INT8U ch, INT8U index, INT8U post_shift);
+INT8U DSPChainBiquadCommit(INT8U ch, INT8U index);
+INT8U DSPChainBiquadDesign(INT8U ch, INT8U index, INT8U section, const DSP_DESIGN_T *design);
+INT8U DSPChainBiquadDesignGet(INT8U ch, INT8U index, INT8U section, DSP_DESIGN_T *design);
+void DSPChainBiquadRedesign(void);
+INT8U DSPChainBiquadGet(INT8U ch, INT8U index, q31_t *coeffs, INT8U *num_stages,
+                        INT8U *post_shift);
+INT8U DSPChainBiquadModeGet(void);
+void DSPChainStereoSet(INT8U enable);
+INT8U DSPChainStereoGet(void);
+INT8U DSPChainDynGainMinGet(INT8U ch, INT8U index, q31_t *gain_min, INT8U reset);
+
+#endif
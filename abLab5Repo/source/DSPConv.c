@@ -0,0 +1,222 @@
+/*******************************************************************************************
+* DSPConv.c
+* Uniformly-partitioned overlap-save convolution.
+*
+* The impulse response is cut into P partitions of L taps, L being the block size. Each
+* partition is zero padded to N = 2L and transformed once when the instance is created,
+* H[p]. The impulse response is kept so the partitions can be rebuilt when the block size
+* changes. The spectra of all partitions take 2*P*L <= 2*DSP_CONV_MAX_TAPS values for
+* any L, so they share one fixed area per instance. For every block the last 2L input samples are transformed, X[0], and
+* pushed into a frequency domain delay line that holds the last P input spectra. Then
+*   Y = sum over p of X[p]*H[p]
+* and the last L samples of the inverse FFT of Y are the output block. The first L samples
+* hold the circular wrap-around and are discarded.
+* The latency is one block, the same as the block processing itself. The cost per block is
+* two N point real FFTs and P*N/2 complex multiply-accumulates, O(log N + P) per sample
+* instead of O(P*L) per sample for direct form.
+*
+* The partitions are transformed in the instance's own delay line, which is cleared after,
+* so an instance can be built while dspTask runs the others. dspConvTime and dspConvAcc
+* are only used by DSPConvProcess().
+*
+* Spectra are in the arm_rfft_fast_f32() packed format: [0] is DC, [1] is Nyquist, then
+* real/imaginary pairs for bins 1 to N/2-1.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPConv.h"
+/******************************************************************************************
+* Private types and variables
+*******************************************************************************************/
+typedef struct{
+    INT8U used;
+    INT8U num_parts;
+    INT8U fdl_head;                                         //Newest spectrum in fdl
+    INT16U num_taps;
+    q31_t ir[DSP_CONV_MAX_TAPS];                            //Impulse response
+    float32_t hist[DSP_BLOCK_SIZE_MAX];                     //Previous input block
+    float32_t h[2*DSP_CONV_MAX_TAPS];                       //Partition spectra, p at p*N
+    float32_t fdl[2*DSP_CONV_MAX_TAPS];                     //Input spectra delay line
+} DSP_CONV_T;
+
+static DSP_CONV_T dspConv[DSP_CONV_NUM_INSTANCES];
+static arm_rfft_fast_instance_f32 dspConvFft;
+static INT32U dspConvPartLen;                               //L, the block size
+static float32_t dspConvTime[DSP_CONV_MAX_FFT_LEN];
+static float32_t dspConvAcc[DSP_CONV_MAX_FFT_LEN];
+/*******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static void dspConvBuild(DSP_CONV_T *conv);
+static void dspConvSpectrumMac(float32_t *acc, const float32_t *x, const float32_t *h,
+                               INT32U fft_len);
+
+/*******************************************************************************************
+* DSPConvInit - Initializes the FFT for the start up block size and frees every instance
+*******************************************************************************************/
+void DSPConvInit(void){
+    INT8U i;
+
+    dspConvPartLen = DSP_SAMPLES_PER_BLOCK;
+    (void)arm_rfft_fast_init_f32(&dspConvFft, (uint16_t)(2*dspConvPartLen));
+    for(i=0;i<DSP_CONV_NUM_INSTANCES;i++){
+        dspConv[i].used = 0;
+    }
+}
+
+/*******************************************************************************************
+* DSPConvCreate - Takes a free instance and loads the impulse response ir[0..num_taps-1],
+* in normal time order. Returns the instance number or DSP_CONV_NONE if there is no free
+* instance or num_taps is out of range. Not for use from an ISR; the partition FFTs take
+* a while. May be called while DSPConvProcess() runs other instances, but not at the same
+* time as DSPConvBlockSizeSet().
+*******************************************************************************************/
+INT8U DSPConvCreate(const q31_t *ir, INT16U num_taps){
+    DSP_CONV_T *conv = (void *)0;
+    INT8U inst;
+    CPU_SR_ALLOC();
+
+    if((num_taps == 0) || (num_taps > DSP_CONV_MAX_TAPS)){
+        return DSP_CONV_NONE;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    for(inst=0;inst<DSP_CONV_NUM_INSTANCES;inst++){
+        if(dspConv[inst].used == 0){
+            dspConv[inst].used = 1;
+            conv = &dspConv[inst];
+            break;
+        }else{
+        }
+    }
+    CPU_CRITICAL_EXIT();
+    if(conv == (void *)0){
+        return DSP_CONV_NONE;
+    }else{
+    }
+
+    conv->num_taps = num_taps;
+    arm_copy_q31((q31_t *)ir, &conv->ir[0], num_taps);
+    dspConvBuild(conv);
+    return inst;
+}
+
+/*******************************************************************************************
+* DSPConvFree - Returns an instance to the pool
+*******************************************************************************************/
+void DSPConvFree(INT8U inst){
+    if(inst < DSP_CONV_NUM_INSTANCES){
+        dspConv[inst].used = 0;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* DSPConvBlockSizeSet - Sets the partition length to the new block size and rebuilds the
+* partitions of every instance in use. The input history is cleared. Not for use while
+* DSPConvProcess() may run.
+*******************************************************************************************/
+void DSPConvBlockSizeSet(INT32U block_size){
+    INT8U i;
+
+    dspConvPartLen = block_size;
+    (void)arm_rfft_fast_init_f32(&dspConvFft, (uint16_t)(2*dspConvPartLen));
+    for(i=0;i<DSP_CONV_NUM_INSTANCES;i++){
+        if(dspConv[i].used != 0){
+            dspConvBuild(&dspConv[i]);
+        }else{
+        }
+    }
+}
+
+/*******************************************************************************************
+* dspConvBuild - Cuts the impulse response into partitions of the current length,
+* transforms them and clears the input history. Each partition is zero padded in its own
+* delay line slot, which arm_rfft_fast_f32() may overwrite, and the slot is cleared after.
+*******************************************************************************************/
+static void dspConvBuild(DSP_CONV_T *conv){
+    INT32U part_len = dspConvPartLen;
+    INT32U fft_len = 2*dspConvPartLen;
+    INT8U p;
+    INT32U taps_left;
+    INT32U part_taps;
+
+    conv->num_parts = (INT8U)((conv->num_taps + part_len - 1)/part_len);
+    conv->fdl_head = 0;
+    arm_fill_f32(0.0f, &conv->hist[0], part_len);
+    taps_left = conv->num_taps;
+    for(p=0;p<conv->num_parts;p++){
+        part_taps = (taps_left > part_len) ? part_len : taps_left;
+        arm_fill_f32(0.0f, &conv->fdl[p*fft_len], fft_len);
+        arm_q31_to_float(&conv->ir[p*part_len], &conv->fdl[p*fft_len], part_taps);
+        arm_rfft_fast_f32(&dspConvFft, &conv->fdl[p*fft_len], &conv->h[p*fft_len], 0);
+        arm_fill_f32(0.0f, &conv->fdl[p*fft_len], fft_len);
+        taps_left -= part_taps;
+    }
+}
+
+/*******************************************************************************************
+* DSPConvProcess - Convolves one block. block_size must be the block size last passed to
+* DSPConvBlockSizeSet(). src and dst may be the same buffer. The output saturates to q31.
+*******************************************************************************************/
+void DSPConvProcess(INT8U inst, q31_t *src, q31_t *dst, INT32U block_size){
+    DSP_CONV_T *conv;
+    INT32U part_len = dspConvPartLen;
+    INT32U fft_len = 2*dspConvPartLen;
+    INT8U p;
+    INT8U slot;
+
+    if((inst >= DSP_CONV_NUM_INSTANCES) || (block_size != part_len)){
+        return;
+    }else{
+    }
+    conv = &dspConv[inst];
+
+    //Input spectrum of the previous and current block into the newest delay line slot
+    conv->fdl_head = (conv->fdl_head == 0) ? (conv->num_parts - 1) : (conv->fdl_head - 1);
+    arm_copy_f32(&conv->hist[0], &dspConvTime[0], part_len);
+    arm_q31_to_float(src, &dspConvTime[part_len], part_len);
+    arm_copy_f32(&dspConvTime[part_len], &conv->hist[0], part_len);
+    arm_rfft_fast_f32(&dspConvFft, &dspConvTime[0], &conv->fdl[conv->fdl_head*fft_len], 0);
+
+    //Y = sum X[p]*H[p], X[p] is the input spectrum from p blocks ago
+    arm_fill_f32(0.0f, &dspConvAcc[0], fft_len);
+    slot = conv->fdl_head;
+    for(p=0;p<conv->num_parts;p++){
+        dspConvSpectrumMac(&dspConvAcc[0], &conv->fdl[slot*fft_len], &conv->h[p*fft_len], fft_len);
+        slot++;
+        if(slot >= conv->num_parts){
+            slot = 0;
+        }else{
+        }
+    }
+
+    //Keep the last L samples of the inverse transform
+    arm_rfft_fast_f32(&dspConvFft, &dspConvAcc[0], &dspConvTime[0], 1);
+    arm_float_to_q31(&dspConvTime[part_len], dst, part_len);
+}
+
+/*******************************************************************************************
+* dspConvSpectrumMac - acc += x*h for two spectra in the packed real FFT format
+*******************************************************************************************/
+static void dspConvSpectrumMac(float32_t *acc, const float32_t *x, const float32_t *h,
+                               INT32U fft_len){
+    INT32U k;
+    float32_t xr, xi, hr, hi;
+
+    acc[0] += x[0]*h[0];                                    //DC
+    acc[1] += x[1]*h[1];                                    //Nyquist
+    for(k=2;k<fft_len;k+=2){
+        xr = x[k];
+        xi = x[k+1];
+        hr = h[k];
+        hi = h[k+1];
+        acc[k] += xr*hr - xi*hi;
+        acc[k+1] += xr*hi + xi*hr;
+    }
+}
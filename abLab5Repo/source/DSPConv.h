@@ -0,0 +1,34 @@
+/*****************************************************************************************************
+* DSPConv.h
+* Uniformly-partitioned overlap-save FFT convolution for long FIR responses. Each instance
+* convolves one channel with an impulse response of up to DSP_CONV_MAX_TAPS taps with a
+* latency of one block.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_CONV_PRESENT
+#define  DSP_CONV_PRESENT
+
+/*****************************************************************************************************
+* Convolution configuration constants
+* The partition length follows the block size and the FFT is twice that, so the number of
+* partitions grows as the block size shrinks. DSP_BLOCK_SIZE_MAX*2 must be a length supported
+* by arm_rfft_fast_f32() (32 to 4096).
+*****************************************************************************************************/
+#define DSP_CONV_NUM_INSTANCES      2
+#define DSP_CONV_MAX_TAPS           2048    //Multiple of DSP_BLOCK_SIZE_MAX
+#define DSP_CONV_MAX_FFT_LEN        (2*DSP_BLOCK_SIZE_MAX)
+#define DSP_CONV_NONE               0xFF
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPConvInit(void);
+INT8U DSPConvCreate(const q31_t *ir, INT16U num_taps);
+void DSPConvFree(INT8U inst);
+void DSPConvBlockSizeSet(INT32U block_size);
+void DSPConvProcess(INT8U inst, q31_t *src, q31_t *dst, INT32U block_size);
+
+#endif
@@ -0,0 +1,126 @@
+/*****************************************************************************************************
+* DSPDesign.c
+* Biquad designer for the RBJ audio EQ cookbook shapes (R. Bristow-Johnson). Each section is
+* designed in f32 and normalized by a0. The a coefficients are negated for the CMSIS DF1 and DF2T
+* kernels, which add a1*y[n-1] + a2*y[n-2]. DSPDesignShiftGet() gives the post shift that makes the
+* section fit in q31.
+*****************************************************************************************************/
+#include "MCUType.h"
+#include "math.h"
+#include "DSPDesign.h"
+
+/*****************************************************************************************************
+* DSPDesignBiquad - Designs one section for the sample rate srate in Hz and writes
+* {b0, b1, b2, a1, a2} to coeffs. Returns a DSP_DESIGN_ERR code and leaves coeffs alone on error.
+*****************************************************************************************************/
+INT8U DSPDesignBiquad(const DSP_DESIGN_T *design, INT32U srate, float32_t *coeffs){
+    float32_t w0;
+    float32_t cos_w0;
+    float32_t alpha;
+    float32_t amp;
+    float32_t sqrt_amp_alpha;
+    float32_t b0, b1, b2, a0, a1, a2;
+
+    if((design->type == DSP_DESIGN_NONE) || (design->type >= DSP_DESIGN_NUM_TYPES)){
+        return DSP_DESIGN_ERR_TYPE;
+    }else if((design->fc <= 0.0f) || (design->fc > (DSP_DESIGN_FC_MAX*(float32_t)srate))){
+        return DSP_DESIGN_ERR_FC;
+    }else if(design->q <= 0.0f){
+        return DSP_DESIGN_ERR_Q;
+    }else{
+    }
+    w0 = 2.0f*PI*design->fc/(float32_t)srate;
+    cos_w0 = arm_cos_f32(w0);
+    alpha = arm_sin_f32(w0)/(2.0f*design->q);
+    amp = powf(10.0f, design->gain_db/40.0f);
+    sqrt_amp_alpha = 2.0f*sqrtf(amp)*alpha;
+
+    switch(design->type){
+    case DSP_DESIGN_LP:
+        b0 = (1.0f - cos_w0)/2.0f;
+        b1 = 1.0f - cos_w0;
+        b2 = b0;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f*cos_w0;
+        a2 = 1.0f - alpha;
+        break;
+    case DSP_DESIGN_HP:
+        b0 = (1.0f + cos_w0)/2.0f;
+        b1 = -(1.0f + cos_w0);
+        b2 = b0;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f*cos_w0;
+        a2 = 1.0f - alpha;
+        break;
+    case DSP_DESIGN_BP:
+        b0 = alpha;
+        b1 = 0.0f;
+        b2 = -alpha;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f*cos_w0;
+        a2 = 1.0f - alpha;
+        break;
+    case DSP_DESIGN_NOTCH:
+        b0 = 1.0f;
+        b1 = -2.0f*cos_w0;
+        b2 = 1.0f;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f*cos_w0;
+        a2 = 1.0f - alpha;
+        break;
+    case DSP_DESIGN_PEAK:
+        b0 = 1.0f + alpha*amp;
+        b1 = -2.0f*cos_w0;
+        b2 = 1.0f - alpha*amp;
+        a0 = 1.0f + alpha/amp;
+        a1 = -2.0f*cos_w0;
+        a2 = 1.0f - alpha/amp;
+        break;
+    case DSP_DESIGN_LSHELF:
+        b0 = amp*((amp + 1.0f) - (amp - 1.0f)*cos_w0 + sqrt_amp_alpha);
+        b1 = 2.0f*amp*((amp - 1.0f) - (amp + 1.0f)*cos_w0);
+        b2 = amp*((amp + 1.0f) - (amp - 1.0f)*cos_w0 - sqrt_amp_alpha);
+        a0 = (amp + 1.0f) + (amp - 1.0f)*cos_w0 + sqrt_amp_alpha;
+        a1 = -2.0f*((amp - 1.0f) + (amp + 1.0f)*cos_w0);
+        a2 = (amp + 1.0f) + (amp - 1.0f)*cos_w0 - sqrt_amp_alpha;
+        break;
+    case DSP_DESIGN_HSHELF:
+    default:
+        b0 = amp*((amp + 1.0f) + (amp - 1.0f)*cos_w0 + sqrt_amp_alpha);
+        b1 = -2.0f*amp*((amp - 1.0f) + (amp + 1.0f)*cos_w0);
+        b2 = amp*((amp + 1.0f) + (amp - 1.0f)*cos_w0 - sqrt_amp_alpha);
+        a0 = (amp + 1.0f) - (amp - 1.0f)*cos_w0 + sqrt_amp_alpha;
+        a1 = 2.0f*((amp - 1.0f) - (amp + 1.0f)*cos_w0);
+        a2 = (amp + 1.0f) - (amp - 1.0f)*cos_w0 - sqrt_amp_alpha;
+        break;
+    }
+    coeffs[0] = b0/a0;
+    coeffs[1] = b1/a0;
+    coeffs[2] = b2/a0;
+    coeffs[3] = -a1/a0;
+    coeffs[4] = -a2/a0;
+    return DSP_DESIGN_ERR_NONE;
+}
+
+/*****************************************************************************************************
+* DSPDesignShiftGet - Returns the smallest post shift that brings every coefficient below 1.0 in
+* magnitude once divided by 2^shift, so they convert to q31 without saturating.
+*****************************************************************************************************/
+INT8U DSPDesignShiftGet(const float32_t *coeffs, INT32U num_coeffs){
+    float32_t max = 0.0f;
+    float32_t limit = 1.0f;
+    INT32U i;
+    INT8U shift = 0;
+
+    for(i=0;i<num_coeffs;i++){
+        if(fabsf(coeffs[i]) > max){
+            max = fabsf(coeffs[i]);
+        }else{
+        }
+    }
+    while((max >= limit) && (shift < 31)){
+        limit *= 2.0f;
+        shift++;
+    }
+    return shift;
+}
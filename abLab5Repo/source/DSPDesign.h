@@ -0,0 +1,48 @@
+/*****************************************************************************************************
+* DSPDesign.h
+* Biquad designer for the RBJ audio EQ cookbook shapes. Computes one section {b0, b1, b2, a1, a2} in
+* the CMSIS order and sign convention for a sample rate, so filters can be set from the shell and
+* retuned when the rate changes.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_DESIGN_PRESENT
+#define  DSP_DESIGN_PRESENT
+
+/*****************************************************************************************************
+* Section types
+*****************************************************************************************************/
+#define DSP_DESIGN_NONE         0           //Coefficients loaded directly, not designed
+#define DSP_DESIGN_LP           1           //Low pass
+#define DSP_DESIGN_HP           2           //High pass
+#define DSP_DESIGN_BP           3           //Band pass, 0 dB peak
+#define DSP_DESIGN_NOTCH        4
+#define DSP_DESIGN_PEAK         5           //Peaking EQ, gain_db at fc
+#define DSP_DESIGN_LSHELF       6           //Low shelf, gain_db below fc
+#define DSP_DESIGN_HSHELF       7           //High shelf, gain_db above fc
+#define DSP_DESIGN_NUM_TYPES    8
+
+#define DSP_DESIGN_FC_MAX       0.49f       //Highest fc as a fraction of the sample rate
+
+//DSPDesignBiquad() error codes
+#define DSP_DESIGN_ERR_NONE     0
+#define DSP_DESIGN_ERR_TYPE     1
+#define DSP_DESIGN_ERR_FC       2           //fc not between 0 and DSP_DESIGN_FC_MAX*srate
+#define DSP_DESIGN_ERR_Q        3
+
+typedef struct{
+    INT8U type;
+    float32_t fc;                           //Hz
+    float32_t q;
+    float32_t gain_db;                      //PEAK, LSHELF and HSHELF only
+} DSP_DESIGN_T;
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+INT8U DSPDesignBiquad(const DSP_DESIGN_T *design, INT32U srate, float32_t *coeffs);
+INT8U DSPDesignShiftGet(const float32_t *coeffs, INT32U num_coeffs);
+
+#endif
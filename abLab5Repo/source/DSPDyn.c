@@ -0,0 +1,314 @@
+/*******************************************************************************************
+* DSPDyn.c
+* Look-ahead compressor/limiter stage for the processing chain.
+*
+* A block is run in three vector passes instead of per-sample log/exp:
+*  - Envelope: the block is rectified with arm_abs_q31() and the peak of each segment of
+*    DSP_DYN_SEG samples is found with arm_max_q31(). Linked channels share the larger peak.
+*  - Gain curve: one gain is computed for the end of each segment from the static curve,
+*    the compressor (threshold, ratio) and the ceiling, with one powf() per segment.
+*  - Apply: the gain is ramped linearly across each segment and multiplied into the signal
+*    delayed by one segment.
+* The gain at the end of a segment is at most the curve gain of both the delayed segment it
+* ends and the segment after it, which has just been seen. The ramp stays between the gains
+* at both ends, so no output sample goes above the ceiling. The gain
+* recovers towards unity with the DSP_DYN_RELEASE_MS time constant.
+* tools/dyntest.c checks the ceiling and the curve on a host and times the stage.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "math.h"
+#include "AppDSP.h"
+#include "DSPDyn.h"
+/******************************************************************************************
+* Private types and variables
+*******************************************************************************************/
+#define DSP_DYN_UNITY           0x7FFFFFFF
+#define DSP_DYN_CEIL_MARGIN     4           //LSBs the ramp and multiply can round up by
+
+typedef struct{
+    INT8U used;
+    q31_t thresh;                           //Compressor threshold, q31 magnitude
+    float32_t slope;                        //1 - 1/ratio, 0 for no compression
+    q31_t ceil;                             //Output ceiling, q31 magnitude
+    q31_t release;                          //Gain recovery per segment, fraction of the gap
+    q31_t gain;                             //Gain at the end of the last segment
+    q31_t need;                             //Curve gain of the delayed segment
+    q31_t gain_min;                         //Lowest gain since the last reset
+    q31_t delay[DSP_DYN_SEG];               //Look-ahead delay line
+} DSP_DYN_T;
+
+static DSP_DYN_T dspDyn[DSP_DYN_NUM_INSTANCES];
+static q31_t dspDynScratch[DSP_BLOCK_SIZE_MAX];
+static q31_t dspDynGains[DSP_BLOCK_SIZE_MAX];
+static q31_t dspDynSegGain[DSP_DYN_MAX_SEGS];     //Segment peaks, then the gain at each end
+static q31_t dspDynRamp[DSP_DYN_SEG];       //(i+1)/DSP_DYN_SEG
+/*******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static void dspDynRun(DSP_DYN_T *const dyn[], q31_t *const data[], INT8U num_ch,
+                      INT32U block_size);
+static q31_t dspDynCurve(const DSP_DYN_T *dyn, q31_t peak);
+static q31_t dspDynDbToQ31(INT8S db);
+
+/*******************************************************************************************
+* DSPDynInit - Frees every instance and builds the gain ramp
+*******************************************************************************************/
+void DSPDynInit(void){
+    INT32U i;
+
+    for(i=0;i<DSP_DYN_NUM_INSTANCES;i++){
+        dspDyn[i].used = 0;
+    }
+    for(i=0;i<(DSP_DYN_SEG-1);i++){
+        dspDynRamp[i] = (q31_t)((i + 1)*(0x80000000u/DSP_DYN_SEG));
+    }
+    dspDynRamp[DSP_DYN_SEG-1] = DSP_DYN_UNITY;
+}
+
+/*******************************************************************************************
+* DSPDynCreate - Takes a free instance. Levels above thresh_db dBFS are reduced by ratio:1,
+* or held at the threshold for DSP_DYN_RATIO_LIMIT, and the output is held under ceil_db
+* dBFS. Both levels must be 0 dBFS or below. Returns the instance number or DSP_DYN_NONE.
+*******************************************************************************************/
+INT8U DSPDynCreate(INT8S thresh_db, INT8U ratio, INT8S ceil_db){
+    DSP_DYN_T *dyn = (void *)0;
+    INT32U srate = DSPSampleRateGet();
+    INT8U inst;
+    CPU_SR_ALLOC();
+
+    if((thresh_db > 0) || (ceil_db > 0) || (ratio == 1)){
+        return DSP_DYN_NONE;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    for(inst=0;inst<DSP_DYN_NUM_INSTANCES;inst++){
+        if(dspDyn[inst].used == 0){
+            dspDyn[inst].used = 1;
+            dyn = &dspDyn[inst];
+            break;
+        }else{
+        }
+    }
+    CPU_CRITICAL_EXIT();
+    if(dyn == (void *)0){
+        return DSP_DYN_NONE;
+    }else{
+    }
+
+    dyn->thresh = dspDynDbToQ31(thresh_db);
+    dyn->slope = (ratio == DSP_DYN_RATIO_LIMIT) ? 1.0f : (1.0f - 1.0f/(float32_t)ratio);
+    dyn->ceil = dspDynDbToQ31(ceil_db) - DSP_DYN_CEIL_MARGIN;
+    if(srate != 0){
+        dyn->release = (q31_t)((1.0f - expf(-(float32_t)DSP_DYN_SEG*1000.0f/
+                                            ((float32_t)DSP_DYN_RELEASE_MS*(float32_t)srate)))*
+                               2147483647.0f);
+    }else{
+        dyn->release = DSP_DYN_UNITY;
+    }
+    dyn->gain = DSP_DYN_UNITY;
+    dyn->need = DSP_DYN_UNITY;
+    dyn->gain_min = DSP_DYN_UNITY;
+    arm_fill_q31(0, &dyn->delay[0], DSP_DYN_SEG);
+    return inst;
+}
+
+/*******************************************************************************************
+* DSPDynFree - Returns an instance to the pool
+*******************************************************************************************/
+void DSPDynFree(INT8U inst){
+    if(inst < DSP_DYN_NUM_INSTANCES){
+        dspDyn[inst].used = 0;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* DSPDynProcess - Runs one instance in place on a block. block_size must be a multiple of
+* DSP_DYN_SEG.
+*******************************************************************************************/
+void DSPDynProcess(INT8U inst, q31_t *data, INT32U block_size){
+    DSP_DYN_T *dyn[1];
+    q31_t *chan[1];
+
+    dyn[0] = &dspDyn[inst];
+    chan[0] = data;
+    dspDynRun(dyn, chan, 1, block_size);
+}
+
+/*******************************************************************************************
+* DSPDynStereoProcess - Runs a left/right pair of instances in place with one gain, so the
+* stereo image does not shift when one channel is reduced.
+*******************************************************************************************/
+void DSPDynStereoProcess(INT8U left, INT8U right, q31_t *left_data, q31_t *right_data,
+                         INT32U block_size){
+    DSP_DYN_T *dyn[2];
+    q31_t *chan[2];
+
+    dyn[0] = &dspDyn[left];
+    dyn[1] = &dspDyn[right];
+    chan[0] = left_data;
+    chan[1] = right_data;
+    dspDynRun(dyn, chan, 2, block_size);
+}
+
+/*******************************************************************************************
+* DSPDynGainMinGet - Returns the lowest gain used since the last reset, the deepest
+* reduction, in q31
+*******************************************************************************************/
+q31_t DSPDynGainMinGet(INT8U inst){
+    return dspDyn[inst].gain_min;
+}
+
+/*******************************************************************************************
+* DSPDynGainMinReset
+*******************************************************************************************/
+void DSPDynGainMinReset(INT8U inst){
+    dspDyn[inst].gain_min = DSP_DYN_UNITY;
+}
+
+/*******************************************************************************************
+* dspDynRun - Runs num_ch linked instances in place, one block of each channel. The gain
+* state of the linked instances is kept the same.
+*******************************************************************************************/
+static void dspDynRun(DSP_DYN_T *const dyn[], q31_t *const data[], INT8U num_ch,
+                      INT32U block_size){
+    INT32U num_segs = block_size/DSP_DYN_SEG;
+    INT32U seg;
+    uint32_t index;
+    q31_t peak;
+    q31_t need;
+    q31_t curve;
+    q31_t gain;
+    q31_t gain_min;
+    q31_t start;
+    q31_t prev;
+    INT8U c;
+
+    //Envelope, the peak of each segment over the linked channels
+    for(seg=0;seg<num_segs;seg++){
+        dspDynSegGain[seg] = 0;
+    }
+    for(c=0;c<num_ch;c++){
+        arm_abs_q31(data[c], &dspDynScratch[0], block_size);
+        for(seg=0;seg<num_segs;seg++){
+            arm_max_q31(&dspDynScratch[seg*DSP_DYN_SEG], DSP_DYN_SEG, &peak, &index);
+            if(peak > dspDynSegGain[seg]){
+                dspDynSegGain[seg] = peak;
+            }else{
+            }
+        }
+    }
+
+    //Gain curve, the gain at the end of each segment. Start from the lowest state of the
+    //linked instances in case they were last run apart.
+    gain = dyn[0]->gain;
+    need = dyn[0]->need;
+    gain_min = dyn[0]->gain_min;
+    for(c=1;c<num_ch;c++){
+        if(dyn[c]->gain < gain){
+            gain = dyn[c]->gain;
+        }else{
+        }
+        if(dyn[c]->need < need){
+            need = dyn[c]->need;
+        }else{
+        }
+        if(dyn[c]->gain_min < gain_min){
+            gain_min = dyn[c]->gain_min;
+        }else{
+        }
+    }
+    start = gain;
+    for(seg=0;seg<num_segs;seg++){
+        peak = dspDynSegGain[seg];
+        prev = need;
+        need = DSP_DYN_UNITY;
+        for(c=0;c<num_ch;c++){
+            curve = dspDynCurve(dyn[c], peak);
+            if(curve < need){
+                need = curve;
+            }else{
+            }
+        }
+        gain += (q31_t)(((INT64S)(DSP_DYN_UNITY - gain)*dyn[0]->release) >> 31);
+        if(prev < gain){
+            gain = prev;
+        }else{
+        }
+        if(need < gain){
+            gain = need;
+        }else{
+        }
+        dspDynSegGain[seg] = gain;
+        if(gain < gain_min){
+            gain_min = gain;
+        }else{
+        }
+    }
+
+    //Per-sample gains, a linear ramp from the gain at the start of each segment to its end
+    prev = start;
+    for(seg=0;seg<num_segs;seg++){
+        arm_scale_q31(&dspDynRamp[0], dspDynSegGain[seg] - prev, 0,
+                      &dspDynGains[seg*DSP_DYN_SEG], DSP_DYN_SEG);
+        arm_offset_q31(&dspDynGains[seg*DSP_DYN_SEG], prev, &dspDynGains[seg*DSP_DYN_SEG],
+                       DSP_DYN_SEG);
+        prev = dspDynSegGain[seg];
+    }
+
+    //Apply to the signal delayed by one segment
+    for(c=0;c<num_ch;c++){
+        arm_copy_q31(data[c], &dspDynScratch[0], block_size);
+        arm_mult_q31(&dyn[c]->delay[0], &dspDynGains[0], data[c], DSP_DYN_SEG);
+        arm_mult_q31(&dspDynScratch[0], &dspDynGains[DSP_DYN_SEG], &data[c][DSP_DYN_SEG],
+                     block_size - DSP_DYN_SEG);
+        arm_copy_q31(&dspDynScratch[block_size - DSP_DYN_SEG], &dyn[c]->delay[0], DSP_DYN_SEG);
+        dyn[c]->gain = gain;
+        dyn[c]->need = need;
+        dyn[c]->gain_min = gain_min;
+    }
+}
+
+/*******************************************************************************************
+* dspDynCurve - Returns the static gain for a segment peak: the compressor gain
+* (thresh/peak)^(1 - 1/ratio) above the threshold, and no more than ceil/peak
+*******************************************************************************************/
+static q31_t dspDynCurve(const DSP_DYN_T *dyn, q31_t peak){
+    q31_t gain = DSP_DYN_UNITY;
+    q31_t comp;
+    float32_t comp_f32;
+
+    if(peak > dyn->ceil){
+        gain = (q31_t)(((INT64U)dyn->ceil << 31)/(INT64U)peak);
+    }else{
+    }
+    if((peak > dyn->thresh) && (dyn->slope > 0.0f)){
+        comp_f32 = powf((float32_t)dyn->thresh/(float32_t)peak, dyn->slope);
+        if(comp_f32 < 1.0f){
+            comp = (q31_t)(comp_f32*2147483648.0f);
+            if(comp < gain){
+                gain = comp;
+            }else{
+            }
+        }else{
+        }
+    }else{
+    }
+    return gain;
+}
+
+/*******************************************************************************************
+* dspDynDbToQ31 - Converts a level at or below 0 dBFS to a q31 magnitude
+*******************************************************************************************/
+static q31_t dspDynDbToQ31(INT8S db){
+    if(db >= 0){
+        return DSP_DYN_UNITY;
+    }else{
+        return (q31_t)(powf(10.0f, (float32_t)db/20.0f)*2147483648.0f);
+    }
+}
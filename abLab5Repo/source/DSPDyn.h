@@ -0,0 +1,38 @@
+/*****************************************************************************************************
+* DSPDyn.h
+* Look-ahead compressor/limiter for the end of the processing chain. The output is held under a
+* ceiling so gain peaks in the filters before it cannot clip. A left/right pair of instances can
+* be run stereo-linked with one gain for both channels.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_DYN_PRESENT
+#define  DSP_DYN_PRESENT
+
+/*****************************************************************************************************
+* Dynamics configuration constants
+* The gain is computed once per segment of DSP_DYN_SEG samples and ramped linearly across it. The
+* signal is delayed by one segment, which is the look-ahead and the attack time.
+*****************************************************************************************************/
+#define DSP_DYN_NUM_INSTANCES   DSP_NUM_OUT_CHANNELS
+#define DSP_DYN_SEG             DSP_BLOCK_SIZE_MIN  //Look-ahead and gain segment, samples
+#define DSP_DYN_MAX_SEGS        (DSP_BLOCK_SIZE_MAX/DSP_DYN_SEG)
+#define DSP_DYN_RELEASE_MS      50          //Time constant of the gain recovery
+#define DSP_DYN_RATIO_LIMIT     0           //Ratio for a limiter at the threshold
+#define DSP_DYN_NONE            0xFF
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPDynInit(void);
+INT8U DSPDynCreate(INT8S thresh_db, INT8U ratio, INT8S ceil_db);
+void DSPDynFree(INT8U inst);
+void DSPDynProcess(INT8U inst, q31_t *data, INT32U block_size);
+void DSPDynStereoProcess(INT8U left, INT8U right, q31_t *left_data, q31_t *right_data,
+                         INT32U block_size);
+q31_t DSPDynGainMinGet(INT8U inst);
+void DSPDynGainMinReset(INT8U inst);
+
+#endif
@@ -0,0 +1,26 @@
+/*****************************************************************************************************
+* DSPFmt.h
+* Integer q31 to decimal text for the sample dumps. The text is the same as converting the sample to
+* FP32, dividing by 2^31 and formatting it with Str_FmtNbr_32(x, 2, 9, '\0', DEF_YES, strg), so
+* MATLAB scripts written for the old dumps still work.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_FMT_PRESENT
+#define  DSP_FMT_PRESENT
+
+/*****************************************************************************************************
+* Format constants
+*****************************************************************************************************/
+#define DSP_FMT_Q31_DP          9           //Decimal places
+#define DSP_FMT_Q31_CHARS_MAX   12          //"-1.000000000", without the NUL
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+INT8U DSPFmtQ31(q31_t sample, CPU_CHAR *strg);
+INT32U DSPFmtQ31Block(const q31_t *samples, INT32U num_samples, CPU_CHAR sep, CPU_CHAR *strg);
+
+#endif
@@ -0,0 +1,193 @@
+/*******************************************************************************************
+* DSPLatency.c
+* Round trip latency self-test. DSPLatencyStart() arms a measurement and the next block
+* starts it. From that block on both outputs play the burst followed by silence, and the
+* selected input is recorded for DSP_LAT_CAPTURE samples. Output sample j and input sample
+* j of the recording belong to the same call of DSPBlockProcess(), so the lag at which the
+* burst shows up in the recording is the input to output latency of the whole system:
+*   lag = num_blocks*block_size + I2S FIFOs + CODEC ADC and DAC filters
+* The ring term follows from the DMA, which plays output block b one lap after dspTask
+* wrote it while the input block b it read is one block old.
+* DSPLatencyResultGet() cross-correlates the recording with the burst in the calling task,
+* about 3600 lags of 511 products for an MLS, and takes the lag of the largest magnitude,
+* so an inverting loopback works too. An MLS spreads the energy over the whole burst and
+* is found well under the noise an impulse would be lost in.
+* The simulated loopback skips the cable and the CODEC and records the burst delayed by
+* exactly the ring, so it checks the measurement and gives the ring term on its own.
+* tools/lattest.c runs the measurement on a host against a simulated DMA and cable.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPLatency.h"
+/******************************************************************************************
+* Private defines
+*******************************************************************************************/
+#define DSP_LAT_STATE_IDLE      0
+#define DSP_LAT_STATE_ARMED     1       //Starts with the next block
+#define DSP_LAT_STATE_RUN       2
+#define DSP_LAT_STATE_DONE      3
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static q31_t dspLatBurst[DSP_LAT_MLS_LEN];
+static q31_t dspLatCapture[DSP_LAT_CAPTURE];
+static INT32U dspLatBurstLen = 0;
+static INT32U dspLatFill = 0;
+static INT32U dspLatRing = 0;
+static INT32U dspLatSimDelay = 0;               //0 records the real input
+static INT8U dspLatInCh = DSP_LEFT_CH;
+static volatile INT8U dspLatState = DSP_LAT_STATE_IDLE;
+
+/*******************************************************************************************
+* DSPLatencyInit - No measurement is running at start up
+*******************************************************************************************/
+void DSPLatencyInit(void){
+    dspLatState = DSP_LAT_STATE_IDLE;
+}
+
+/*******************************************************************************************
+* DSPLatencyStart - Arms a measurement with mode DSP_LAT_MODE_IMPULSE or DSP_LAT_MODE_MLS,
+* recording buff_id, LEFT_IN or RIGHT_IN. sim != 0 uses the simulated loopback. The outputs
+* are muted until DSPLatencyIsDone(), DSP_LAT_CAPTURE samples.
+*******************************************************************************************/
+INT8U DSPLatencyStart(INT8U mode, BUFF_ID_T buff_id, INT8U sim){
+    INT32U lfsr = (1u << DSP_LAT_MLS_BITS) - 1;
+    INT32U i;
+
+    if((dspLatState == DSP_LAT_STATE_ARMED) || (dspLatState == DSP_LAT_STATE_RUN)){
+        return DSP_LAT_ERR_BUSY;
+    }else if((mode > DSP_LAT_MODE_MLS) || ((buff_id != LEFT_IN) && (buff_id != RIGHT_IN))){
+        return DSP_LAT_ERR_ARG;
+    }else{
+    }
+    dspLatState = DSP_LAT_STATE_IDLE;
+    if(mode == DSP_LAT_MODE_MLS){
+        //x^9 + x^5 + 1, maximal length
+        for(i=0;i<DSP_LAT_MLS_LEN;i++){
+            dspLatBurst[i] = ((lfsr & 1u) != 0) ? DSP_LAT_MLS_LEVEL : -DSP_LAT_MLS_LEVEL;
+            lfsr = (lfsr >> 1) | (((lfsr ^ (lfsr >> 4)) & 1u) << (DSP_LAT_MLS_BITS - 1));
+        }
+        dspLatBurstLen = DSP_LAT_MLS_LEN;
+    }else{
+        dspLatBurst[0] = DSP_LAT_IMPULSE_LEVEL;
+        dspLatBurstLen = 1;
+    }
+    dspLatInCh = (buff_id == LEFT_IN) ? DSP_LEFT_CH : DSP_RIGHT_CH;
+    dspLatRing = (INT32U)DSPBlockCountGet()*DSPBlockSizeGet();
+    dspLatSimDelay = (sim != 0) ? dspLatRing : 0;
+    dspLatState = DSP_LAT_STATE_ARMED;
+    return DSP_LAT_ERR_NONE;
+}
+
+/*******************************************************************************************
+* DSPLatencyProcess - Plays and records one block of a running measurement. Called after
+* the chain so the burst replaces the chain output.
+*******************************************************************************************/
+void DSPLatencyProcess(q31_t *const in[], q31_t *const out[], INT32U block_size){
+    INT32U count;
+    INT32U start;
+    INT32U end;
+    INT8U ch;
+
+    if(dspLatState == DSP_LAT_STATE_ARMED){
+        dspLatFill = 0;
+        dspLatState = DSP_LAT_STATE_RUN;
+    }else if(dspLatState != DSP_LAT_STATE_RUN){
+        return;
+    }else{
+    }
+    for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+        arm_fill_q31(0, out[ch], block_size);
+        if(dspLatFill < dspLatBurstLen){
+            count = dspLatBurstLen - dspLatFill;
+            arm_copy_q31(&dspLatBurst[dspLatFill], out[ch], (count < block_size) ? count : block_size);
+        }else{
+        }
+    }
+    count = DSP_LAT_CAPTURE - dspLatFill;
+    if(count > block_size){
+        count = block_size;
+    }else{
+    }
+    if(dspLatSimDelay == 0){
+        arm_copy_q31(in[dspLatInCh], &dspLatCapture[dspLatFill], count);
+    }else{
+        //Record the part of the delayed burst that falls in this block
+        arm_fill_q31(0, &dspLatCapture[dspLatFill], count);
+        start = (dspLatFill > dspLatSimDelay) ? dspLatFill : dspLatSimDelay;
+        end = dspLatFill + count;
+        if(end > (dspLatSimDelay + dspLatBurstLen)){
+            end = dspLatSimDelay + dspLatBurstLen;
+        }else{
+        }
+        if(start < end){
+            arm_copy_q31(&dspLatBurst[start - dspLatSimDelay], &dspLatCapture[start], end - start);
+        }else{
+        }
+    }
+    dspLatFill += count;
+    if(dspLatFill >= DSP_LAT_CAPTURE){
+        dspLatState = DSP_LAT_STATE_DONE;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* DSPLatencyIsDone - Returns 1 once the recording is complete
+*******************************************************************************************/
+INT8U DSPLatencyIsDone(void){
+    return (INT8U)(dspLatState == DSP_LAT_STATE_DONE);
+}
+
+/*******************************************************************************************
+* DSPLatencyResultGet - Finds the burst in a complete recording. Call from a task, the
+* correlation takes a few ms. The next measurement can start afterwards.
+*******************************************************************************************/
+INT8U DSPLatencyResultGet(DSP_LAT_RESULT_T *result){
+    INT32U num_lags = DSP_LAT_CAPTURE - dspLatBurstLen + 1;
+    INT32U lag;
+    q63_t acc;
+    q63_t peak = 0;
+    float32_t sum = 0.0f;
+
+    if(dspLatState != DSP_LAT_STATE_DONE){
+        return DSP_LAT_ERR_BUSY;
+    }else{
+    }
+    result->lag = 0;
+    for(lag=0;lag<num_lags;lag++){
+        arm_dot_prod_q31(&dspLatCapture[lag], &dspLatBurst[0], dspLatBurstLen, &acc);
+        if(acc < 0){
+            acc = -acc;
+        }else{
+        }
+        sum += (float32_t)acc;
+        if(acc > peak){
+            peak = acc;
+            result->lag = lag;
+        }else{
+        }
+    }
+    dspLatState = DSP_LAT_STATE_IDLE;
+    result->ring = dspLatRing;
+    result->sim = (INT8U)(dspLatSimDelay != 0);
+    result->peak_ratio = (sum > 0.0f) ? (INT32U)((float32_t)peak*(float32_t)num_lags/sum) : 0;
+    if((peak == 0) || (result->peak_ratio < DSP_LAT_PEAK_RATIO)){
+        return DSP_LAT_ERR_NO_PEAK;
+    }else{
+        return DSP_LAT_ERR_NONE;
+    }
+}
+
+/*******************************************************************************************
+* DSPLatencyCancel - Stops a measurement and unmutes the outputs
+*******************************************************************************************/
+void DSPLatencyCancel(void){
+    dspLatState = DSP_LAT_STATE_IDLE;
+}
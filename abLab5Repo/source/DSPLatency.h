@@ -0,0 +1,60 @@
+/*****************************************************************************************************
+* DSPLatency.h
+* Round trip latency self-test. Plays an impulse or an MLS burst on both outputs, records one input
+* and finds the burst in the recording by cross-correlation. Needs a cable from the line output to
+* the line input, or the simulated loopback.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_LATENCY_PRESENT
+#define  DSP_LATENCY_PRESENT
+
+/*****************************************************************************************************
+* Measurement configuration constants
+* The recording must hold the ring delay, up to DSP_RING_SAMPLES_MAX, the FIFO and CODEC delay and
+* the burst.
+*****************************************************************************************************/
+#define DSP_LAT_MLS_BITS        9
+#define DSP_LAT_MLS_LEN         ((1u << DSP_LAT_MLS_BITS) - 1)  //511 chips
+#define DSP_LAT_CAPTURE         (DSP_RING_SAMPLES_MAX + 2*DSP_BLOCK_SIZE_MAX)  //Samples recorded
+#define DSP_LAT_MLS_LEVEL       0x20000000                      //-12 dBFS chips
+#define DSP_LAT_IMPULSE_LEVEL   0x40000000                      //-6 dBFS impulse
+#define DSP_LAT_PEAK_RATIO      8       //Correlation peak over its mean for a valid result
+#define DSP_LAT_TOUT            2000    //Ticks, covers DSP_LAT_CAPTURE at 8kHz
+
+//Burst types
+#define DSP_LAT_MODE_IMPULSE    0
+#define DSP_LAT_MODE_MLS        1
+
+//Error codes
+#define DSP_LAT_ERR_NONE        0
+#define DSP_LAT_ERR_BUSY        1       //A measurement is running or has no result yet
+#define DSP_LAT_ERR_ARG         2
+#define DSP_LAT_ERR_NO_PEAK     3       //The burst was not found, check the loopback
+#define DSP_LAT_ERR_XRUN        4       //Blocks were lost during the recording
+#define DSP_LAT_ERR_TOUT        5       //The recording did not finish, is the DSP running?
+
+/*****************************************************************************************************
+* Measurement result. lag is the round trip in samples. ring is the part of it spent in the DMA
+* ring, num_blocks*block_size, the rest is the I2S FIFOs and the CODEC.
+*****************************************************************************************************/
+typedef struct{
+    INT32U lag;
+    INT32U ring;
+    INT32U peak_ratio;                      //Correlation peak over its mean
+    INT8U sim;                              //Measured on the simulated loopback
+} DSP_LAT_RESULT_T;
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPLatencyInit(void);
+INT8U DSPLatencyStart(INT8U mode, BUFF_ID_T buff_id, INT8U sim);
+void DSPLatencyProcess(q31_t *const in[], q31_t *const out[], INT32U block_size);
+INT8U DSPLatencyIsDone(void);
+INT8U DSPLatencyResultGet(DSP_LAT_RESULT_T *result);
+void DSPLatencyCancel(void);
+
+#endif
@@ -0,0 +1,172 @@
+/*******************************************************************************************
+* DSPMultirate.c
+* Decimate -> process -> interpolate support for the processing chain.
+*
+* Each instance is a decimator and interpolator by the same factor M (2, 4 or 8) with a
+* shared linear phase low-pass of M*DSP_MR_TAPS_PER_PHASE taps. The low-pass is a Hamming
+* windowed sinc with its cutoff at 0.45*fs/M, designed in float when the instance is
+* created and normalized to unity DC gain.
+* The CMSIS q31 decimator only computes the kept outputs and the interpolator runs the
+* filter as M polyphase branches, so the cost of the filters is that of the low rate.
+* Both keep their state between calls, so the output is the same as one long run over the
+* whole signal no matter where the block boundaries fall.
+* The interpolator has a DC gain of 1/M from the zero stuffing, which is made up with a
+* saturating left shift of log2(M).
+* The filter states are sized for DSP_MR_SUB_BLOCK samples, so any block size that is a
+* multiple of it is run in pieces with the same result.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPMultirate.h"
+/******************************************************************************************
+* Private types and variables
+*******************************************************************************************/
+typedef struct{
+    INT8U used;
+    INT8U factor;
+    INT8U shift;                                            //log2(factor)
+    arm_fir_decimate_instance_q31 decim;
+    arm_fir_interpolate_instance_q31 interp;
+    q31_t coeffs[DSP_MR_MAX_TAPS];
+    q31_t decim_state[DSP_MR_MAX_TAPS+DSP_MR_SUB_BLOCK-1];
+    q31_t interp_state[DSP_MR_TAPS_PER_PHASE+(DSP_MR_SUB_BLOCK/2)-1];
+    q31_t low[DSP_BLOCK_SIZE_MAX/2];                        //Low rate block
+} DSP_MR_T;
+
+static DSP_MR_T dspMr[DSP_MR_NUM_INSTANCES];
+/*******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static void dspMrLowpassDesign(q31_t *coeffs, INT8U factor);
+
+/*******************************************************************************************
+* DSPMultirateInit - Frees every instance
+*******************************************************************************************/
+void DSPMultirateInit(void){
+    INT8U i;
+
+    for(i=0;i<DSP_MR_NUM_INSTANCES;i++){
+        dspMr[i].used = 0;
+    }
+}
+
+/*******************************************************************************************
+* DSPMultirateCreate - Takes a free instance for factor 2, 4 or 8 and designs its filter.
+* Returns the instance number or DSP_MR_NONE.
+*******************************************************************************************/
+INT8U DSPMultirateCreate(INT8U factor){
+    DSP_MR_T *mr = (void *)0;
+    INT8U inst;
+    INT16U num_taps;
+    CPU_SR_ALLOC();
+
+    if((factor != 2) && (factor != 4) && (factor != 8)){
+        return DSP_MR_NONE;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    for(inst=0;inst<DSP_MR_NUM_INSTANCES;inst++){
+        if(dspMr[inst].used == 0){
+            dspMr[inst].used = 1;
+            mr = &dspMr[inst];
+            break;
+        }else{
+        }
+    }
+    CPU_CRITICAL_EXIT();
+    if(mr == (void *)0){
+        return DSP_MR_NONE;
+    }else{
+    }
+
+    mr->factor = factor;
+    mr->shift = (factor == 2) ? 1 : ((factor == 4) ? 2 : 3);
+    num_taps = (INT16U)factor*DSP_MR_TAPS_PER_PHASE;
+    dspMrLowpassDesign(&mr->coeffs[0], factor);
+    (void)arm_fir_decimate_init_q31(&mr->decim, num_taps, factor, &mr->coeffs[0],
+                                    &mr->decim_state[0], DSP_MR_SUB_BLOCK);
+    (void)arm_fir_interpolate_init_q31(&mr->interp, factor, num_taps, &mr->coeffs[0],
+                                       &mr->interp_state[0], DSP_MR_SUB_BLOCK/factor);
+    return inst;
+}
+
+/*******************************************************************************************
+* DSPMultirateFree - Returns an instance to the pool
+*******************************************************************************************/
+void DSPMultirateFree(INT8U inst){
+    if(inst < DSP_MR_NUM_INSTANCES){
+        dspMr[inst].used = 0;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* DSPMultirateFactorGet
+*******************************************************************************************/
+INT8U DSPMultirateFactorGet(INT8U inst){
+    if(inst < DSP_MR_NUM_INSTANCES){
+        return dspMr[inst].factor;
+    }else{
+        return 1;
+    }
+}
+
+/*******************************************************************************************
+* DSPMultirateDecimate - Low-pass filters and decimates block_size samples from src.
+* Returns the low rate block of block_size/M samples, which the caller may process in
+* place before DSPMultirateInterpolate(). block_size must be a multiple of
+* DSP_MR_SUB_BLOCK.
+*******************************************************************************************/
+q31_t *DSPMultirateDecimate(INT8U inst, q31_t *src, INT32U block_size){
+    DSP_MR_T *mr = &dspMr[inst];
+    INT32U k;
+
+    for(k=0;k<block_size;k+=DSP_MR_SUB_BLOCK){
+        arm_fir_decimate_q31(&mr->decim, &src[k], &mr->low[k/mr->factor], DSP_MR_SUB_BLOCK);
+    }
+    return &mr->low[0];
+}
+
+/*******************************************************************************************
+* DSPMultirateInterpolate - Interpolates the low rate block back to block_size samples
+* into dst
+*******************************************************************************************/
+void DSPMultirateInterpolate(INT8U inst, q31_t *dst, INT32U block_size){
+    DSP_MR_T *mr = &dspMr[inst];
+    INT32U k;
+
+    for(k=0;k<block_size;k+=DSP_MR_SUB_BLOCK){
+        arm_fir_interpolate_q31(&mr->interp, &mr->low[k/mr->factor], &dst[k],
+                                DSP_MR_SUB_BLOCK/mr->factor);
+    }
+    arm_shift_q31(dst, (int8_t)mr->shift, dst, block_size);
+}
+
+/*******************************************************************************************
+* dspMrLowpassDesign - Hamming windowed sinc low-pass, cutoff 0.45*fs/factor, unity DC gain
+*******************************************************************************************/
+static void dspMrLowpassDesign(q31_t *coeffs, INT8U factor){
+    static float32_t h[DSP_MR_MAX_TAPS];
+    INT16U num_taps = (INT16U)factor*DSP_MR_TAPS_PER_PHASE;
+    float32_t fc = 0.45f/(float32_t)factor;
+    float32_t t;
+    float32_t sum = 0.0f;
+    INT16U n;
+
+    for(n=0;n<num_taps;n++){
+        t = (float32_t)n - 0.5f*(float32_t)(num_taps - 1);
+        h[n] = 2.0f*fc*(0.54f - 0.46f*arm_cos_f32(2.0f*PI*n/(num_taps - 1)));
+        if(t != 0.0f){
+            h[n] *= arm_sin_f32(2.0f*PI*fc*t)/(2.0f*PI*fc*t);
+        }else{
+        }
+        sum += h[n];
+    }
+    arm_scale_f32(&h[0], 1.0f/sum, &h[0], num_taps);
+    arm_float_to_q31(&h[0], coeffs, num_taps);
+}
@@ -0,0 +1,34 @@
+/*****************************************************************************************************
+* DSPMultirate.h
+* Polyphase decimator/interpolator pairs used by the chain to run a sub-chain at 1/2, 1/4 or
+* 1/8 of the block rate.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_MULTIRATE_PRESENT
+#define  DSP_MULTIRATE_PRESENT
+
+/*****************************************************************************************************
+* Multirate configuration constants
+*****************************************************************************************************/
+#define DSP_MR_NUM_INSTANCES    2
+#define DSP_MR_MAX_FACTOR       8
+#define DSP_MR_TAPS_PER_PHASE   8           //Anti-alias/image filter taps = factor*8
+#define DSP_MR_MAX_TAPS         (DSP_MR_MAX_FACTOR*DSP_MR_TAPS_PER_PHASE)
+#define DSP_MR_SUB_BLOCK        DSP_BLOCK_SIZE_MIN  //Filters run in sub-blocks of this many
+                                                    //full rate samples
+#define DSP_MR_NONE             0xFF
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPMultirateInit(void);
+INT8U DSPMultirateCreate(INT8U factor);
+void DSPMultirateFree(INT8U inst);
+INT8U DSPMultirateFactorGet(INT8U inst);
+q31_t *DSPMultirateDecimate(INT8U inst, q31_t *src, INT32U block_size);
+void DSPMultirateInterpolate(INT8U inst, q31_t *dst, INT32U block_size);
+
+#endif
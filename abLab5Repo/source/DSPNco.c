@@ -0,0 +1,285 @@
+/*******************************************************************************************
+* DSPNco.c
+* Numerically controlled oscillator and quadrature modulators for the processing chain.
+*
+* The NCO is a 32-bit phase accumulator stepped by freq*2^32/fs each sample. The top
+* DSP_NCO_TABLE_BITS bits of the phase index a q31 sine table and the rest interpolate
+* linearly to the next point, which keeps the error near -107 dB. The cosine is the same
+* table a quarter cycle on. Any frequency up to fs/2 is available to 2^-32*fs, and since
+* only the step changes when the frequency or sample rate changes, the phase is continuous.
+* Ring modulation multiplies by the cosine. Single sideband shifts the spectrum with the
+* phasing method, x*cos -/+ H{x}*sin, where H is a windowed Hilbert FIR and x is delayed by
+* its group delay to match.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "math.h"
+#include "AppDSP.h"
+#include "DSPNco.h"
+/******************************************************************************************
+* Private types and variables
+*******************************************************************************************/
+#define DSP_NCO_QUARTER         0x40000000u             //Quarter cycle of phase
+#define DSP_NCO_FRAC_SHIFT      (32u - DSP_NCO_TABLE_BITS)
+#define DSP_NCO_DELAY           ((DSP_NCO_HILBERT_TAPS-1)/2)  //Hilbert group delay
+#define DSP_NCO_BENCH_RUNS      3
+
+typedef struct{
+    INT8U used;
+    INT8U mode;
+    INT32U freq;                            //Hz
+    INT32U srate;                           //Hz
+    INT32U phase;
+    INT32U incr;                            //Phase step per sample
+    arm_fir_instance_q31 hilbert;
+    q31_t hilbert_state[DSP_NCO_HILBERT_TAPS+DSP_NCO_SUB_BLOCK-1];
+    q31_t delay[DSP_NCO_DELAY];
+} DSP_NCO_T;
+
+static DSP_NCO_T dspNco[DSP_NCO_NUM_INSTANCES];
+static q31_t dspNcoTable[DSP_NCO_TABLE_LEN+1];         //One cycle of sine and the first point
+static q31_t dspNcoHilbertCoeffs[DSP_NCO_HILBERT_TAPS];
+static q31_t dspNcoCos[DSP_BLOCK_SIZE_MAX];
+static q31_t dspNcoSin[DSP_BLOCK_SIZE_MAX];
+static q31_t dspNcoDelayed[DSP_BLOCK_SIZE_MAX];
+static q31_t dspNcoQuad[DSP_BLOCK_SIZE_MAX];            //Hilbert transform of the block
+static q31_t dspNcoBenchOut[DSP_BLOCK_SIZE_MAX];        //Apart from dspTask's buffers
+static float32_t dspNcoBenchF32[DSP_BLOCK_SIZE_MAX];
+/*******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static void dspNcoGen(INT32U *phase, INT32U incr, q31_t *cos_out, q31_t *sin_out,
+                      INT32U num_samples);
+static q31_t dspNcoLookup(INT32U phase);
+static INT32U dspNcoIncrGet(INT32U freq_hz, INT32U srate);
+
+/*******************************************************************************************
+* DSPNcoInit - Frees every instance and builds the sine table and the Hilbert FIR
+*******************************************************************************************/
+void DSPNcoInit(void){
+    INT32U i;
+    INT32S k;
+    float32_t h;
+
+    for(i=0;i<DSP_NCO_NUM_INSTANCES;i++){
+        dspNco[i].used = 0;
+    }
+    for(i=0;i<DSP_NCO_TABLE_LEN;i++){
+        //In double, since 2147483647 rounds up to 2^31 in float and would wrap at the peak
+        dspNcoTable[i] = (q31_t)(sin(2.0*(double)PI*(double)i/(double)DSP_NCO_TABLE_LEN)*2147483647.0);
+    }
+    dspNcoTable[DSP_NCO_TABLE_LEN] = dspNcoTable[0];
+    //h[k] = 2/(pi*k) for odd k about the centre, Hamming windowed. CMSIS wants the taps
+    //time reversed, which for this odd symmetric response is the negated response.
+    for(i=0;i<DSP_NCO_HILBERT_TAPS;i++){
+        k = (INT32S)i - DSP_NCO_DELAY;
+        if((k & 1) != 0){
+            h = (2.0f/(PI*(float32_t)k))*
+                (0.54f - 0.46f*cosf(2.0f*PI*(float32_t)i/(float32_t)(DSP_NCO_HILBERT_TAPS - 1)));
+        }else{
+            h = 0.0f;
+        }
+        dspNcoHilbertCoeffs[i] = (q31_t)(-h*2147483648.0f);
+    }
+}
+
+/*******************************************************************************************
+* DSPNcoCreate - Takes a free instance for modulation mode at freq_hz, up to srate/2, with
+* the phase at zero. Returns the instance number or DSP_NCO_NONE.
+*******************************************************************************************/
+INT8U DSPNcoCreate(INT8U mode, INT32U freq_hz, INT32U srate){
+    DSP_NCO_T *nco = (void *)0;
+    INT8U inst;
+    CPU_SR_ALLOC();
+
+    if((mode >= DSP_NCO_NUM_MODS) || (srate == 0) || (freq_hz > (srate/2))){
+        return DSP_NCO_NONE;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    for(inst=0;inst<DSP_NCO_NUM_INSTANCES;inst++){
+        if(dspNco[inst].used == 0){
+            dspNco[inst].used = 1;
+            nco = &dspNco[inst];
+            break;
+        }else{
+        }
+    }
+    CPU_CRITICAL_EXIT();
+    if(nco == (void *)0){
+        return DSP_NCO_NONE;
+    }else{
+    }
+
+    nco->mode = mode;
+    nco->freq = freq_hz;
+    nco->srate = srate;
+    nco->phase = 0;
+    nco->incr = dspNcoIncrGet(freq_hz, srate);
+    arm_fir_init_q31(&nco->hilbert, DSP_NCO_HILBERT_TAPS, &dspNcoHilbertCoeffs[0],
+                     &nco->hilbert_state[0], DSP_NCO_SUB_BLOCK);
+    arm_fill_q31(0, &nco->delay[0], DSP_NCO_DELAY);
+    return inst;
+}
+
+/*******************************************************************************************
+* DSPNcoFree - Returns an instance to the pool
+*******************************************************************************************/
+void DSPNcoFree(INT8U inst){
+    if(inst < DSP_NCO_NUM_INSTANCES){
+        dspNco[inst].used = 0;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* DSPNcoFreqSet - Retunes an instance. The phase carries on from where it is.
+*******************************************************************************************/
+void DSPNcoFreqSet(INT8U inst, INT32U freq_hz){
+    dspNco[inst].freq = freq_hz;
+    dspNco[inst].incr = dspNcoIncrGet(freq_hz, dspNco[inst].srate);
+}
+
+/*******************************************************************************************
+* DSPNcoRateSet - Recomputes the phase step of every instance for a new sample rate so each
+* keeps its frequency. Called by DSPSampleRateSet().
+*******************************************************************************************/
+void DSPNcoRateSet(INT32U srate){
+    INT8U inst;
+
+    for(inst=0;inst<DSP_NCO_NUM_INSTANCES;inst++){
+        if(dspNco[inst].used != 0){
+            dspNco[inst].srate = srate;
+            dspNco[inst].incr = dspNcoIncrGet(dspNco[inst].freq, srate);
+        }else{
+        }
+    }
+}
+
+/*******************************************************************************************
+* DSPNcoIQ - Writes the next num_samples of the in-phase (cosine) and quadrature (sine)
+* outputs and advances the phase
+*******************************************************************************************/
+void DSPNcoIQ(INT8U inst, q31_t *cos_out, q31_t *sin_out, INT32U num_samples){
+    dspNcoGen(&dspNco[inst].phase, dspNco[inst].incr, cos_out, sin_out, num_samples);
+}
+
+/*******************************************************************************************
+* DSPNcoModProcess - Modulates a block in place with the instance's mode. block_size must
+* be a multiple of DSP_NCO_SUB_BLOCK. SSB output is delayed by the Hilbert group delay.
+*******************************************************************************************/
+void DSPNcoModProcess(INT8U inst, q31_t *data, INT32U block_size){
+    DSP_NCO_T *nco = &dspNco[inst];
+    INT32U k;
+
+    if(nco->mode == DSP_NCO_MOD_RING){
+        dspNcoGen(&nco->phase, nco->incr, &dspNcoCos[0], (void *)0, block_size);
+        arm_mult_q31(data, &dspNcoCos[0], data, block_size);
+    }else{
+        dspNcoGen(&nco->phase, nco->incr, &dspNcoCos[0], &dspNcoSin[0], block_size);
+        for(k=0;k<block_size;k+=DSP_NCO_SUB_BLOCK){
+            arm_fir_q31(&nco->hilbert, &data[k], &dspNcoQuad[k], DSP_NCO_SUB_BLOCK);
+        }
+        arm_copy_q31(&nco->delay[0], &dspNcoDelayed[0], DSP_NCO_DELAY);
+        arm_copy_q31(data, &dspNcoDelayed[DSP_NCO_DELAY], block_size - DSP_NCO_DELAY);
+        arm_copy_q31(&data[block_size - DSP_NCO_DELAY], &nco->delay[0], DSP_NCO_DELAY);
+        arm_mult_q31(&dspNcoDelayed[0], &dspNcoCos[0], &dspNcoDelayed[0], block_size);
+        arm_mult_q31(&dspNcoQuad[0], &dspNcoSin[0], &dspNcoQuad[0], block_size);
+        if(nco->mode == DSP_NCO_MOD_USB){
+            arm_sub_q31(&dspNcoDelayed[0], &dspNcoQuad[0], data, block_size);
+        }else{
+            arm_add_q31(&dspNcoDelayed[0], &dspNcoQuad[0], data, block_size);
+        }
+    }
+}
+
+/*******************************************************************************************
+* DSPNcoBench - Measures the DWT cycles to make num_samples of cosine with the NCO, in q31,
+* and with a call to arm_cos_f32() per sample, for the old 20 kHz at 48 kHz carrier. Each is the
+* best of DSP_NCO_BENCH_RUNS so preemption does not count. num_samples is at most
+* DSP_BLOCK_SIZE_MAX.
+*******************************************************************************************/
+void DSPNcoBench(INT32U num_samples, INT32U *nco_cycles, INT32U *cos_cycles){
+    INT32U phase;
+    INT32U start;
+    INT32U cycles;
+    INT32U i;
+    INT8U run;
+    float32_t angle;
+    const float32_t step = 2.0f*PI*20000.0f/48000.0f;
+
+    *nco_cycles = 0xFFFFFFFF;
+    *cos_cycles = 0xFFFFFFFF;
+    for(run=0;run<DSP_NCO_BENCH_RUNS;run++){
+        phase = 0;
+        start = DWT->CYCCNT;
+        dspNcoGen(&phase, dspNcoIncrGet(20000, 48000), &dspNcoBenchOut[0], (void *)0, num_samples);
+        cycles = DWT->CYCCNT - start;
+        if(cycles < *nco_cycles){
+            *nco_cycles = cycles;
+        }else{
+        }
+
+        angle = 0.0f;
+        start = DWT->CYCCNT;
+        for(i=0;i<num_samples;i++){
+            dspNcoBenchF32[i] = arm_cos_f32(angle);
+            angle += step;
+            if(angle >= (2.0f*PI)){
+                angle -= 2.0f*PI;
+            }else{
+            }
+        }
+        cycles = DWT->CYCCNT - start;
+        if(cycles < *cos_cycles){
+            *cos_cycles = cycles;
+        }else{
+        }
+    }
+}
+
+/*******************************************************************************************
+* dspNcoGen - Steps a phase accumulator num_samples times, writing the cosine and, unless
+* sin_out is a null pointer, the sine
+*******************************************************************************************/
+static void dspNcoGen(INT32U *phase, INT32U incr, q31_t *cos_out, q31_t *sin_out,
+                      INT32U num_samples){
+    INT32U ph = *phase;
+    INT32U i;
+
+    if(sin_out == (void *)0){
+        for(i=0;i<num_samples;i++){
+            cos_out[i] = dspNcoLookup(ph + DSP_NCO_QUARTER);
+            ph += incr;
+        }
+    }else{
+        for(i=0;i<num_samples;i++){
+            cos_out[i] = dspNcoLookup(ph + DSP_NCO_QUARTER);
+            sin_out[i] = dspNcoLookup(ph);
+            ph += incr;
+        }
+    }
+    *phase = ph;
+}
+
+/*******************************************************************************************
+* dspNcoLookup - Returns sin(2*pi*phase/2^32) in q31 by linear interpolation in the table
+*******************************************************************************************/
+static q31_t dspNcoLookup(INT32U phase){
+    INT32U index = phase >> DSP_NCO_FRAC_SHIFT;
+    q31_t frac = (q31_t)((phase << DSP_NCO_TABLE_BITS) >> 1);
+    q31_t y0 = dspNcoTable[index];
+
+    return y0 + (q31_t)(((INT64S)(dspNcoTable[index + 1] - y0)*frac) >> 31);
+}
+
+/*******************************************************************************************
+* dspNcoIncrGet - Returns the phase step freq_hz*2^32/srate
+*******************************************************************************************/
+static INT32U dspNcoIncrGet(INT32U freq_hz, INT32U srate){
+    return (INT32U)(((INT64U)freq_hz << 32)/srate);
+}
@@ -0,0 +1,41 @@
+/*****************************************************************************************************
+* DSPNco.h
+* Phase-accumulator NCO with interpolated sine/cosine lookup and the ring and single sideband
+* modulators built on it. The phase carries over between blocks and sample rate changes.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_NCO_PRESENT
+#define  DSP_NCO_PRESENT
+
+/*****************************************************************************************************
+* NCO configuration constants
+*****************************************************************************************************/
+#define DSP_NCO_NUM_INSTANCES   DSP_NUM_OUT_CHANNELS
+#define DSP_NCO_TABLE_BITS      10          //Sine table of 2^10 points per cycle
+#define DSP_NCO_TABLE_LEN       (1u << DSP_NCO_TABLE_BITS)
+#define DSP_NCO_HILBERT_TAPS    31          //SSB Hilbert transformer, odd
+#define DSP_NCO_SUB_BLOCK       DSP_BLOCK_SIZE_MIN  //Hilbert FIR runs in sub-blocks of this size
+#define DSP_NCO_NONE            0xFF
+
+//Modulation modes
+#define DSP_NCO_MOD_RING        0           //x*cos, both sidebands
+#define DSP_NCO_MOD_USB         1           //Shift up by the NCO frequency
+#define DSP_NCO_MOD_LSB         2           //Shift down, mirrored
+#define DSP_NCO_NUM_MODS        3
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPNcoInit(void);
+INT8U DSPNcoCreate(INT8U mode, INT32U freq_hz, INT32U srate);
+void DSPNcoFree(INT8U inst);
+void DSPNcoFreqSet(INT8U inst, INT32U freq_hz);
+void DSPNcoRateSet(INT32U srate);
+void DSPNcoIQ(INT8U inst, q31_t *cos_out, q31_t *sin_out, INT32U num_samples);
+void DSPNcoModProcess(INT8U inst, q31_t *data, INT32U block_size);
+void DSPNcoBench(INT32U num_samples, INT32U *nco_cycles, INT32U *cos_cycles);
+
+#endif
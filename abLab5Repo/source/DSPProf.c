@@ -0,0 +1,112 @@
+/*******************************************************************************************
+* DSPProf.c
+* Cycle count profile used for whole blocks by dspTask and for each chain stage by
+* DSPChain. Adding a count is a few compares and a CLZ, so it can run on every block.
+* The caller owns a stage profile and keeps readers out while it is updated. The block
+* profile is kept here and guarded with a critical section.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "DSPProf.h"
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static DSP_PROF_T dspProfBlock;                 //Cycles per block in dspTask
+
+/*******************************************************************************************
+* DSPProfReset - Clears a profile
+*******************************************************************************************/
+void DSPProfReset(DSP_PROF_T *prof){
+    INT8U bin;
+
+    prof->min = 0xFFFFFFFFu;
+    prof->max = 0;
+    prof->sum = 0;
+    prof->count = 0;
+    for(bin=0;bin<DSP_PROF_NUM_BINS;bin++){
+        prof->hist[bin] = 0;
+    }
+}
+
+/*******************************************************************************************
+* DSPProfAdd - Adds one cycle count to a profile. The bin is found from the position of
+* the highest set bit.
+*******************************************************************************************/
+void DSPProfAdd(DSP_PROF_T *prof, INT32U cycles){
+    INT32U log2;
+
+    if(cycles < prof->min){
+        prof->min = cycles;
+    }else{
+    }
+    if(cycles > prof->max){
+        prof->max = cycles;
+    }else{
+    }
+    prof->sum += cycles;
+    prof->count++;
+    log2 = 32u - __CLZ(cycles);             //Bits needed to hold cycles
+    if(log2 <= DSP_PROF_BIN_MIN_LOG2){
+        prof->hist[0]++;
+    }else if(log2 >= (DSP_PROF_BIN_MIN_LOG2 + DSP_PROF_NUM_BINS - 1)){
+        prof->hist[DSP_PROF_NUM_BINS - 1]++;
+    }else{
+        prof->hist[log2 - DSP_PROF_BIN_MIN_LOG2]++;
+    }
+}
+
+/*******************************************************************************************
+* DSPProfMeanGet - Returns the mean cycle count, 0 if nothing was added
+*******************************************************************************************/
+INT32U DSPProfMeanGet(const DSP_PROF_T *prof){
+    if(prof->count == 0){
+        return 0;
+    }else{
+        return (INT32U)(prof->sum/prof->count);
+    }
+}
+
+/*******************************************************************************************
+* DSPProfBinLowGet - Returns the smallest cycle count that falls in a bin
+*******************************************************************************************/
+INT32U DSPProfBinLowGet(INT8U bin){
+    if(bin == 0){
+        return 0;
+    }else{
+        return (INT32U)1 << (bin + DSP_PROF_BIN_MIN_LOG2 - 1);
+    }
+}
+
+/*******************************************************************************************
+* DSPProfBlockAdd - Adds the cycles dspTask spent on one block to the block profile
+*******************************************************************************************/
+void DSPProfBlockAdd(INT32U cycles){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    DSPProfAdd(&dspProfBlock, cycles);
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* DSPProfBlockGet - Copies the block profile
+*******************************************************************************************/
+void DSPProfBlockGet(DSP_PROF_T *prof){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    *prof = dspProfBlock;
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* DSPProfBlockReset - Clears the block profile
+*******************************************************************************************/
+void DSPProfBlockReset(void){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    DSPProfReset(&dspProfBlock);
+    CPU_CRITICAL_EXIT();
+}
@@ -0,0 +1,44 @@
+/*****************************************************************************************************
+* DSPProf.h
+* Cycle count profile. Keeps the minimum, maximum and mean of a series of DWT cycle counts and a
+* histogram with one bin per power of two, so the worst case and how often it happens can be read
+* from the shell after a long run.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_PROF_PRESENT
+#define  DSP_PROF_PRESENT
+
+/*****************************************************************************************************
+* Profile configuration constants
+*****************************************************************************************************/
+#define DSP_PROF_NUM_BINS       16          //Histogram bins
+#define DSP_PROF_BIN_MIN_LOG2   8           //Bin 0 holds counts below 2^8
+//Bin b>0 holds counts from 2^(b+DSP_PROF_BIN_MIN_LOG2-1) up to twice that, the last bin
+//holds everything above
+
+/*****************************************************************************************************
+* Profile object
+*****************************************************************************************************/
+typedef struct{
+    INT32U min;
+    INT32U max;
+    INT64U sum;
+    INT32U count;
+    INT32U hist[DSP_PROF_NUM_BINS];
+} DSP_PROF_T;
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPProfReset(DSP_PROF_T *prof);
+void DSPProfAdd(DSP_PROF_T *prof, INT32U cycles);
+INT32U DSPProfMeanGet(const DSP_PROF_T *prof);
+INT32U DSPProfBinLowGet(INT8U bin);
+void DSPProfBlockAdd(INT32U cycles);
+void DSPProfBlockGet(DSP_PROF_T *prof);
+void DSPProfBlockReset(void);
+
+#endif
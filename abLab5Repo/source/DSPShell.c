@@ -19,7 +19,20 @@
 #include "AppDSP.h"
 #include "DSPShell.h"
 #include "TLV320AIC3007.h"
+#include "I2S.h"
 #include "BasicIO.h"
+#include "K65TWR_ClkCfg.h"
+#include "DSPProf.h"
+#include "DSPDesign.h"
+#include "DSPChain.h"
+#include "DSPSpectrum.h"
+#include "DSPConv.h"
+#include "DSPCapture.h"
+#include "DSPFmt.h"
+#include "DSPNco.h"
+#include "DSPTone.h"
+#include "DSPLatency.h"
+#include "math.h"
 
 /*********************************************************************************************
 *                                       LOCAL DEFINES
@@ -30,11 +43,70 @@
 *********************************************************************************************/
 const INT8C dspshCmdMsgNotRec[] = {"Command not recognized: "};
 const INT8C dspshCmdMsgSizeNotRec[] = {"Size not recognized: "};
+const INT8C dspshCmdMsgSizeTdm[] = {"TDM slots are fixed at 32 bits\n\r"};
+const INT8C dspshCmdMsgTdmOk[] = {"TDM check: CODEC registers 9 and 10 ok\n\r"};
+const INT8C dspshCmdMsgTdmAsi[] = {"TDM check: CODEC register 9 is not 0x78, see dsp_codec_rd 0 9\n\r"};
+const INT8C dspshCmdMsgTdmOffset[] = {"TDM check: CODEC register 10 is not 0x00, see dsp_codec_rd 0 10\n\r"};
 const INT8C dspshCmdMsgCRdUsage[] = {"Usage: dsp_codec_rd page reg\n\r"};
 const INT8C dspshCmdMsgCRdPageErr[] = {"Page error, must be 0 or 1\n\r"};
 const INT8C dspshCmdMsgCRdRegErr[] = {"Register error, must be less than 128\n\r"};
 const INT8C dspshCmdMsgCWrUsage[] = {"Usage: dsp_codec_wr page reg value\n\r"};
-const INT8C dspshCmdMsgLoadUsage[] = {"Usage: dsp_load buffer\n\r where buffer is l_in, r_in, l_out, r_out\n\r"};
+const INT8C dspshCmdMsgLoadUsage[] = {"Usage: dsp_load buffer [samples]\n\r where buffer is l_in, r_in, l_out, r_out\n\r samples defaults to one DMA ring, 4096 max\n\r"};
+const INT8C dspshCmdMsgLoadTout[] = {"Snapshot timed out, is the DSP running?\n\r"};
+const INT8C dspshCmdMsgBenchUsage[] = {"Usage: dsp_bench [reset]\n\r"};
+const INT8C dspshCmdMsgChainUsage[] = {"Usage: dsp_chain [reset]\n\r"
+                                       "       dsp_chain ch clear\n\r"
+                                       "       dsp_chain ch add bypass|biquad|fir taps|conv taps|gain g|mix src g\n\r"
+                                       "       dsp_chain ch add rate m sub\n\r"
+                                       "       dsp_chain ch add dyn thresh ratio [ceil]\n\r"
+                                       "       dsp_chain ch add mod ring|usb|lsb freq\n\r"
+                                       "       dsp_chain ch en stage 0|1\n\r"
+                                       " where ch is l, r, a TDM slot 0 to 7, s0 or s1, src is l, r or a slot,\n\r"
+                                       " g is the linear gain x1000,\n\r"
+                                       " m is 2, 4 or 8 and sub is s0 or s1, the sub-chain run at 1/m rate\n\r"
+                                       " thresh and ceil are in dBFS, ceil defaults to 0 and ratio 0 limits,\n\r"
+                                       " freq is the NCO frequency in Hz\n\r"};
+const INT8C dspshCmdMsgChainErr[] = {"Chain error: "};
+const INT8C dspshCmdMsgBlkUsage[] = {"Usage: dsp_blk [n [blocks]]\n\r"
+                                     " where n is a power of two from 32 to 1024 and blocks is the\n\r"
+                                     " DMA ring depth, 2 to 8, with n*blocks*channels at most 4096\n\r"};
+const INT8C dspshCmdMsgXrunUsage[] = {"Usage: dsp_xrun [reset]\n\r"};
+const INT8C dspshCmdMsgProfUsage[] = {"Usage: dsp_prof [reset]\n\r"
+                                      "       dsp_prof ch stage\n\r"
+                                      " where ch is l, r, a TDM slot 0 to 7, s0 or s1\n\r"};
+const INT8C dspshCmdMsgIntDisUsage[] = {"Usage: dsp_intdis [reset]\n\r"};
+const INT8C dspshCmdMsgIntDisOff[] = {"CPU_CFG_INT_DIS_MEAS_EN is not defined in cpu_cfg.h\n\r"};
+const INT8C dspshCmdMsgUartUsage[] = {"Usage: dsp_uart [reset]\n\r"};
+const INT8C dspshCmdMsgNcoUsage[] = {"Usage: dsp_nco bench\n\r"
+                                     "       dsp_nco ch stage freq\n\r"
+                                     " where ch is l or r and stage is a mod chain stage\n\r"};
+const INT8C dspshCmdMsgToneUsage[] = {"Usage: dsp_tone [on buffer|off|reset|clear]\n\r"
+                                      "       dsp_tone add freq thresh\n\r"
+                                      "       dsp_tone del tone\n\r"
+                                      "       dsp_tone win n\n\r"
+                                      "       dsp_tone dtmf [thresh]\n\r"
+                                      " where buffer is l_in, r_in, l_out, r_out, freq is in Hz,\n\r"
+                                      " thresh is in dBFS and n is 32 to 4096 samples\n\r"};
+const INT8C dspshCmdMsgToneErr[] = {"Tone error: "};
+const INT8C dspshCmdMsgLatUsage[] = {"Usage: dsp_lat [impulse|mls] [l_in|r_in] [sim]\n\r"
+                                     " loop the line output back to the input, sim skips the cable.\n\r"
+                                     " burst defaults to mls and input to l_in. Outputs are muted meanwhile\n\r"};
+const INT8C dspshCmdMsgLatErr[] = {"Latency error: "};
+const INT8C dspshCmdMsgDynUsage[] = {"Usage: dsp_dyn ch stage [reset]\n\r"
+                                     " where ch is l or r and stage is a dyn chain stage\n\r"};
+const INT8C dspshCmdMsgCapUsage[] = {"Usage: dsp_cap [off]\n\r"
+                                     "       dsp_cap on buffer [buffer ...] [q15|q31]\n\r"
+                                     " where buffer is l_in, r_in, l_out, r_out, format defaults to q15\n\r"};
+const INT8C dspshCmdMsgPrecUsage[] = {"Usage: dsp_prec [q31|q31hp|f32|stereo on|stereo off]\n\r"};
+const INT8C dspshCmdMsgSpecUsage[] = {"Usage: dsp_spec [on buffer|off|avg shift|reset]\n\r"
+                                      " where buffer is l_in, r_in, l_out, r_out\n\r"};
+const INT8C dspshCmdMsgIirUsage[] = {"Usage: dsp_iir ch stage\n\r"
+                                     "       dsp_iir ch stage shift n\n\r"
+                                     "       dsp_iir ch stage section b0 b1 b2 a1 a2\n\r"
+                                     "       dsp_iir ch stage commit\n\r"
+                                     "       dsp_iir ch stage design section type fc q [db]\n\r"
+                                     " where ch is l or r and stage is a biquad chain stage\n\r"
+                                     " type is lp, hp, bp, notch, peak, lshelf or hshelf\n\r"};
 
 /*********************************************************************************************
 *                               COMMAND EXPLANATION MESSAGES
@@ -45,6 +117,89 @@ const INT8C dspshCmdMsgListN[] = {"dsp_n - display or set sample size in bits\n\
 const INT8C dspshCmdMsgListCRd[] = {"dsp_codec_rd - display the contents of a CODEC register\n\r"};
 const INT8C dspshCmdMsgListCWr[] = {"dsp_codec_wr - write to a CODEC register\n\r"};
 const INT8C dspshCmdMsgListLoad[] = {"dsp_load - load the contents of a buffer\n\r"};
+const INT8C dspshCmdMsgListBench[] = {"dsp_bench - display or reset block processing time\n\r"};
+const INT8C dspshCmdMsgListChain[] = {"dsp_chain - display or edit the processing chain\n\r"};
+const INT8C dspshCmdMsgListPrec[] = {"dsp_prec - display or set the biquad precision mode\n\r"};
+const INT8C dspshCmdMsgListSpec[] = {"dsp_spec - dump or configure the averaged power spectrum\n\r"};
+const INT8C dspshCmdMsgListIir[] = {"dsp_iir - display or retune a biquad stage while running\n\r"};
+const INT8C dspshCmdMsgListXrun[] = {"dsp_xrun - display or reset block overruns and underruns\n\r"};
+const INT8C dspshCmdMsgListProf[] = {"dsp_prof - display or reset block and stage cycle profiles\n\r"};
+const INT8C dspshCmdMsgListIntDis[] = {"dsp_intdis - display or reset the longest interrupt disable times\n\r"};
+const INT8C dspshCmdMsgListCap[] = {"dsp_cap - stream buffers as binary frames for dspcap2wav\n\r"};
+const INT8C dspshCmdMsgListUart[] = {"dsp_uart - display or reset terminal receive overruns\n\r"};
+const INT8C dspshCmdMsgListNco[] = {"dsp_nco - retune a modulator or benchmark the NCO\n\r"};
+const INT8C dspshCmdMsgListDyn[] = {"dsp_dyn - display the gain reduction and cost of a dynamics stage\n\r"};
+const INT8C dspshCmdMsgListTone[] = {"dsp_tone - display or configure the tone detector bank\n\r"};
+const INT8C dspshCmdMsgListLat[] = {"dsp_lat - measure the round trip latency through a loopback\n\r"};
+const INT8C dspshCmdMsgListBlk[] = {"dsp_blk - display or set the samples per block and ring depth\n\r"};
+
+/*********************************************************************************************
+*                                    REPORT LABELS
+*********************************************************************************************/
+const INT8C dspshBenchMsgLast[] = {"cycles/block last:   "};
+const INT8C dspshBenchMsgMax[] = {"cycles/block max:    "};
+const INT8C dspshBenchMsgDeadline[] = {"cycles/block budget: "};
+const INT8C dspshBenchMsgNs[] = {"ns/block max:        "};
+const INT8C dspshBenchMsgRate[] = {"samples/s capacity:  "};
+const INT8C dspshBenchMsgHeadroom[] = {"headroom %:          "};
+const INT8C dspshBenchMsgBlocks[] = {"blocks:              "};
+const INT8C *const dspshStageNames[] = {"bypass ", "biquad ", "fir    ", "gain   ", "mix    ", "conv   ", "rate   ",
+                                        "dyn    ", "mod    "};
+const INT8C *const dspshChNames[] = {"l ", "r ", "2 ", "3 ", "4 ", "5 ", "6 ", "7 "};
+const INT8C *const dspshSubNames[] = {"s0", "s1"};
+const INT8C *const dspshPrecNames[] = {"q31", "q31hp", "f32"};
+const INT8C dspshPrecMsgCycles[] = {"biquad cycles/sample x100: "};
+const INT8C dspshPrecMsgStereoOn[] = {"stereo kernel on\n\r"};
+const INT8C dspshPrecMsgStereoOff[] = {"stereo kernel off\n\r"};
+const INT8C dspshIirMsgShift[] = {"shift "};
+const INT8C *const dspshDesignNames[] = {"", "lp", "hp", "bp", "notch", "peak", "lshelf", "hshelf"};
+const INT8C dspshSpecMsgFs[] = {"% fs "};
+const INT8C dspshSpecMsgN[] = {" n "};
+const INT8C dspshSpecMsgBlocks[] = {" blocks "};
+const INT8C dspshBlkMsgSize[] = {"samples/block:  "};
+const INT8C dspshBlkMsgCount[] = {"blocks in ring: "};
+const INT8C dspshBlkMsgLatency[] = {"buffering us:   "};
+const INT8C dspshXrunMsgOver[] = {"overruns:    "};
+const INT8C dspshXrunMsgUnder[] = {"underruns:   "};
+const INT8C dspshXrunMsgLate[] = {"late blocks: "};
+const INT8C dspshNcoMsgNco[] = {"NCO cycles/sample x100:        "};
+const INT8C dspshNcoMsgCos[] = {"arm_cos_f32 cycles/sample x100: "};
+const INT8C *const dspshModNames[] = {"ring", "usb", "lsb"};
+const INT8C dspshToneMsgWindow[] = {"window samples: "};
+const INT8C dspshToneMsgWindows[] = {"windows:        "};
+const INT8C dspshToneMsgTones[] = {"tone  freq Hz    dBFS  thresh  on  events  on window\n\r"};
+const INT8C dspshToneMsgInvalid[] = {"      --"};
+const INT16U dspshToneDtmf[] = {697, 770, 852, 941, 1209, 1336, 1477, 1633};
+const INT8C dspshLatMsgSamples[] = {"round trip samples: "};
+const INT8C dspshLatMsgUs[] = {"round trip us:      "};
+const INT8C dspshLatMsgRing[] = {"ring samples:       "};
+const INT8C dspshLatMsgCodec[] = {"FIFO+CODEC samples: "};
+const INT8C dspshLatMsgRatio[] = {"peak/mean:          "};
+const INT8C dspshLatMsgSim[] = {"simulated loopback\n\r"};
+const INT8C dspshDynMsgReduction[] = {"max reduction dB x10: "};
+const INT8C dspshDynMsgCycles[] = {"cycles/sample x100:   "};
+const INT8C dspshXrunMsgBacklog[] = {"max backlog: "};
+const INT8C *const dspshXrunNames[] = {"over  seq ", "under seq "};
+const INT8C dspshXrunMsgTick[] = {" tick "};
+const INT8C dspshXrunMsgCount[] = {" blocks "};
+const INT8C dspshProfMsgMin[] = {"cycles min:  "};
+const INT8C dspshProfMsgMax[] = {"cycles max:  "};
+const INT8C dspshProfMsgMean[] = {"cycles mean: "};
+const INT8C dspshProfMsgCount[] = {"count:       "};
+const INT8C dspshProfMsgBin[] = {"  >= "};
+const INT8C dspshIntDisMsgMax[] = {"int dis cycles max: "};
+const INT8C dspshIntDisMsgNs[] = {"int dis ns max:     "};
+const INT8C dspshIntDisMsgTasks[] = {"task              cycles max\n\r"};
+const INT8C dspshUartMsgOverruns[] = {"rx overruns: "};
+const INT8C dspshUartMsgDropped[] = {"rx dropped:  "};
+const INT8C dspshCapMsgOn[] = {"capture on  "};
+const INT8C dspshCapMsgOff[] = {"capture off "};
+const INT8C *const dspshBuffNames[] = {"l_in ", "r_in ", "l_out ", "r_out "};
+const INT8C *const dspshCapFmtNames[] = {"q31\n\r", "q15\n\r"};
+const INT8C dspshCapMsgSent[] = {"frames sent:    "};
+const INT8C dspshCapMsgDropped[] = {"frames dropped: "};
+const INT8C dspshCapMsgRate[] = {"bytes/s needed: "};
+const INT8C dspshProfMsgStages[] = {"stage      min       max      mean\n\r"};
 
 /*********************************************************************************************
 *                                      LOCAL CONSTANTS
@@ -57,6 +212,7 @@ const INT8C dspshCmdMsgListLoad[] = {"dsp_load - load the contents of a buffer\n
 /*********************************************************************************************
 *                                   LOCAL GLOBAL VARIABLES
 *********************************************************************************************/
+static CPU_CHAR dspshLoadStrg[DSP_BLOCK_SIZE_MAX*(DSP_FMT_Q31_CHARS_MAX + 1) + 1];  //One block of text
 
 /*********************************************************************************************
 *                                 LOCAL FUNCTION PROTOTYPES
@@ -88,10 +244,76 @@ static CPU_INT16S dspshCodecRegWrite(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OU
 static CPU_INT16S dspshBufferLoad(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
                                      SHELL_CMD_PARAM *pcmd_param);
 
+static CPU_INT16S dspshBench(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                              SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshChain(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                              SHELL_CMD_PARAM *pcmd_param);
+
+static INT8U dspshChParse(CPU_CHAR *arg);
+static const INT8C *dspshChName(INT8U ch);
+
+static CPU_INT16S dspshPrec(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshIir(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                            SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshSpectrum(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                                 SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshBlockSize(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                                  SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshXrun(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshProf(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param);
+
+static void dspshProfOut(const DSP_PROF_T *prof, SHELL_OUT_FNCT out_fnct,
+                         SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshIntDis(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                               SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshCapture(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                                SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshUart(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshDyn(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                            SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshNco(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                            SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshTone(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param);
+
+static CPU_INT16S dspshLatency(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                                SHELL_CMD_PARAM *pcmd_param);
+
+static INT8U dspshBuffParse(CPU_CHAR *arg, BUFF_ID_T *buff_id);
+
+static void dspshOutNbr(INT32U nbr, SHELL_OUT_FNCT out_fnct, SHELL_CMD_PARAM *pcmd_param);
+
+static void dspshOutLabelNbr(const INT8C *label, INT32U nbr, SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param);
+
 static  SHELL_CMD  dspshCmdTbl[] = {
         {"dsp_help", DSPList}, {"dsp_fs", dspShellSampleRate},
         {"dsp_n", dspShellSampleSize}, {"dsp_codec_rd", dspshCodecRegRead},
         {"dsp_codec_wr", dspshCodecRegWrite},{"dsp_load", dspshBufferLoad},
+        {"dsp_bench", dspshBench}, {"dsp_chain", dspshChain},
+        {"dsp_prec", dspshPrec}, {"dsp_iir", dspshIir},
+        {"dsp_spec", dspshSpectrum}, {"dsp_blk", dspshBlockSize},
+        {"dsp_xrun", dspshXrun}, {"dsp_prof", dspshProf},
+        {"dsp_intdis", dspshIntDis}, {"dsp_cap", dspshCapture},
+        {"dsp_uart", dspshUart}, {"dsp_dyn", dspshDyn},
+        {"dsp_nco", dspshNco}, {"dsp_tone", dspshTone},
+        {"dsp_lat", dspshLatency},
         {0,         0           }
 };
 
@@ -153,6 +375,21 @@ static CPU_INT16S DSPList(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_
             (void)out_fnct((CPU_CHAR *)dspshCmdMsgListCRd,sizeof(dspshCmdMsgListCRd),pcmd_param->pout_opt);
             (void)out_fnct((CPU_CHAR *)dspshCmdMsgListCWr,sizeof(dspshCmdMsgListCWr),pcmd_param->pout_opt);
             (void)out_fnct((CPU_CHAR *)dspshCmdMsgListLoad,sizeof(dspshCmdMsgListLoad),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListBench,sizeof(dspshCmdMsgListBench),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListChain,sizeof(dspshCmdMsgListChain),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListPrec,sizeof(dspshCmdMsgListPrec),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListIir,sizeof(dspshCmdMsgListIir),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListSpec,sizeof(dspshCmdMsgListSpec),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListBlk,sizeof(dspshCmdMsgListBlk),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListXrun,sizeof(dspshCmdMsgListXrun),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListProf,sizeof(dspshCmdMsgListProf),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListIntDis,sizeof(dspshCmdMsgListIntDis),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListCap,sizeof(dspshCmdMsgListCap),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListUart,sizeof(dspshCmdMsgListUart),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListDyn,sizeof(dspshCmdMsgListDyn),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListNco,sizeof(dspshCmdMsgListNco),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListTone,sizeof(dspshCmdMsgListTone),pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgListLat,sizeof(dspshCmdMsgListLat),pcmd_param->pout_opt);
              break;
         case 2:
         default:
@@ -277,7 +514,8 @@ static CPU_INT16S dspShellSampleRate(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OU
 *
 * Caller(s)   : Shell, in response to command execution.
 *
-* Note(s)     : none.
+* Note(s)     : In a TDM build only 32 is accepted, and with no argument it also runs the
+*               DSPTdmCheck() bring-up check of the CODEC registers.
 *********************************************************************************************/
 
 static CPU_INT16S dspShellSampleSize(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
@@ -286,6 +524,8 @@ static CPU_INT16S dspShellSampleSize(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OU
     INT16U ssize;
     CPU_CHAR ssize_strg[6];
     INT8U size_err = 0;
+    INT8U set_err = DSP_SSIZE_ERR_NONE;
+    INT8U tdm_err;
 
     switch (argc) {
         case 1:         //if no argument return current sample size
@@ -293,21 +533,32 @@ static CPU_INT16S dspShellSampleSize(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OU
             (void)Str_FmtNbr_Int32U ((INT32U)ssize, 5, DEF_NBR_BASE_DEC,'\0', DEF_YES, DEF_YES, ssize_strg);
             (void)out_fnct((CPU_CHAR *)ssize_strg, 6, pcmd_param->pout_opt);
             (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+            if(DSP_TDM_SLOTS > I2S_STEREO_SLOTS){
+                tdm_err = DSPTdmCheck();
+                if(tdm_err == DSP_TDM_ERR_ASI){
+                    (void)out_fnct((CPU_CHAR *)dspshCmdMsgTdmAsi, sizeof(dspshCmdMsgTdmAsi), pcmd_param->pout_opt);
+                }else if(tdm_err == DSP_TDM_ERR_OFFSET){
+                    (void)out_fnct((CPU_CHAR *)dspshCmdMsgTdmOffset, sizeof(dspshCmdMsgTdmOffset), pcmd_param->pout_opt);
+                }else{
+                    (void)out_fnct((CPU_CHAR *)dspshCmdMsgTdmOk, sizeof(dspshCmdMsgTdmOk), pcmd_param->pout_opt);
+                }
+            }else{
+            }
             break;
         case 2:
             param1 = (CPU_CHAR *)argv[1];
 
             if(!Str_Cmp(param1,"16")){
-                DSPSampleSizeSet(DSP_SSIZE_CODE_16BIT);
+                set_err = DSPSampleSizeSet(DSP_SSIZE_CODE_16BIT);
                 ssize = DSPSampleSizeGet();
             }else if(!Str_Cmp(param1,"20")){
-                DSPSampleSizeSet(DSP_SSIZE_CODE_20BIT);
+                set_err = DSPSampleSizeSet(DSP_SSIZE_CODE_20BIT);
                 ssize = DSPSampleSizeGet();
             }else if(!Str_Cmp(param1,"24")){
-                DSPSampleSizeSet(DSP_SSIZE_CODE_24BIT);
+                set_err = DSPSampleSizeSet(DSP_SSIZE_CODE_24BIT);
                 ssize = DSPSampleSizeGet();
             }else if(!Str_Cmp(param1,"32")){
-                DSPSampleSizeSet(DSP_SSIZE_CODE_32BIT);
+                set_err = DSPSampleSizeSet(DSP_SSIZE_CODE_32BIT);
                 ssize = DSPSampleSizeGet();
             }else{
                 size_err = 1;
@@ -317,6 +568,10 @@ static CPU_INT16S dspShellSampleSize(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OU
                 (void)out_fnct(argv[1], (CPU_INT16U)Str_Len(argv[1]), pcmd_param->pout_opt);
                 (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
             }else{
+                if(set_err == DSP_SSIZE_ERR_TDM){
+                    (void)out_fnct((CPU_CHAR *)dspshCmdMsgSizeTdm, sizeof(dspshCmdMsgSizeTdm), pcmd_param->pout_opt);
+                }else{
+                }
                 (void)Str_FmtNbr_Int32U ((INT32U)ssize, 5, DEF_NBR_BASE_DEC,'\0', DEF_YES, DEF_YES, ssize_strg);
                 (void)out_fnct((CPU_CHAR *)ssize_strg, sizeof(ssize_strg), pcmd_param->pout_opt);
                 (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
@@ -493,7 +748,9 @@ static CPU_INT16S dspshCodecRegWrite(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OU
 /*********************************************************************************************
 *                                    dspshBufferLoad()
 *
-* Description : Sends contents of buffer to the terminal (load).
+* Description : Sends a snapshot of a buffer to the terminal (load). dspTask copies the
+*               requested number of consecutive samples at block boundaries so the DSP and
+*               CODEC keep running.
 *
 * Argument(s) : argc            The number of arguments.
 *
@@ -513,61 +770,1336 @@ static CPU_INT16S dspshCodecRegWrite(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OU
 
 static CPU_INT16S dspshBufferLoad(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
                                      SHELL_CMD_PARAM *pcmd_param) {
-    CPU_CHAR *param1;
-    INT8U load_err = 0;
+    BUFF_ID_T buff_id;
     OS_ERR os_err;
-    INT32S *buffer_ptr;
-    INT32U i;
-    CPU_CHAR sample_strg[14] = {"0000000000000"};
-    FP32 sample_float;
+    const q31_t *buffer_ptr;
+    INT32U num_samples;
+    INT32U chunk;
+    INT32U len;
+
+    if((argc < 2) || (argc > 3)){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgLoadUsage, sizeof(dspshCmdMsgLoadUsage), pcmd_param->pout_opt);
+    }else if(dspshBuffParse(argv[1], &buff_id) != 0){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgNotRec, sizeof(dspshCmdMsgNotRec), pcmd_param->pout_opt);
+        (void)out_fnct(argv[1], (CPU_INT16U)Str_Len(argv[1]), pcmd_param->pout_opt);
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+    }else{
+        if(argc == 3){
+            num_samples = (INT32U)atoi(argv[2]);
+        }else{
+            num_samples = (INT32U)DSPBlockCountGet()*DSPBlockSizeGet();
+        }
+        if(DSPSnapshotReq(buff_id, num_samples) != 0){
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgLoadUsage, sizeof(dspshCmdMsgLoadUsage), pcmd_param->pout_opt);
+            return (SHELL_ERR_NONE);
+        }else{
+        }
+        buffer_ptr = DSPSnapshotPend(DSP_SNAP_TOUT, &num_samples, &os_err);
+        if(buffer_ptr == (const q31_t *)0){
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgLoadTout, sizeof(dspshCmdMsgLoadTout), pcmd_param->pout_opt);
+            return (SHELL_ERR_NONE);
+        }else{
+        }
+        (void)out_fnct((CPU_CHAR *)"[",2,pcmd_param->pout_opt); //open with '[' for MATLAB
+        while(num_samples > 0){                                 //comma seperated, a block at a time
+            chunk = (num_samples > DSPBlockSizeGet()) ? DSPBlockSizeGet() : num_samples;
+            len = DSPFmtQ31Block(buffer_ptr, chunk, ',', dspshLoadStrg);
+            buffer_ptr += chunk;
+            num_samples -= chunk;
+            if(num_samples == 0){
+                dspshLoadStrg[len - 1] = ']';                   //closing ']' after the last sample
+            }else{
+            }
+            (void)out_fnct(dspshLoadStrg, (CPU_INT16U)len, pcmd_param->pout_opt);
+        }
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+    }
+    return (SHELL_ERR_NONE);
+}
+/*********************************************************************************************
+*                                    dspshBench()
+*
+* Description : Reports the block processing time measured with the DWT cycle counter and
+*               the headroom left against the block period at the current sample rate.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : 'dsp_bench reset' clears the maximum.
+*********************************************************************************************/
+
+static CPU_INT16S dspshBench(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                              SHELL_CMD_PARAM *pcmd_param) {
+    DSP_BENCH_T bench;
+    INT32U headroom;
 
     switch (argc) {
-        case 1:         //if no argument return usage
-            (void)out_fnct((CPU_CHAR *)dspshCmdMsgLoadUsage, sizeof(dspshCmdMsgCWrUsage), pcmd_param->pout_opt);
+        case 1:
+            DSPBenchGet(&bench);
+            if(bench.cycles_max < bench.cycles_deadline){
+                headroom = (INT32U)(((INT64U)(bench.cycles_deadline - bench.cycles_max)*100)/bench.cycles_deadline);
+            }else{
+                headroom = 0;
+            }
+            dspshOutLabelNbr(dspshBenchMsgLast, bench.cycles_last, out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshBenchMsgMax, bench.cycles_max, out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshBenchMsgDeadline, bench.cycles_deadline, out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshBenchMsgNs, (INT32U)(((INT64U)bench.cycles_max*1000000000u)/SYSTEM_CLOCK),
+                             out_fnct, pcmd_param);
+            if(bench.cycles_max != 0){
+                dspshOutLabelNbr(dspshBenchMsgRate,
+                                 (INT32U)(((INT64U)SYSTEM_CLOCK*DSPBlockSizeGet())/bench.cycles_max),
+                                 out_fnct, pcmd_param);
+            }else{
+            }
+            dspshOutLabelNbr(dspshBenchMsgHeadroom, headroom, out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshBenchMsgBlocks, bench.blocks, out_fnct, pcmd_param);
             break;
         case 2:
-            param1 = (CPU_CHAR *)argv[1];
-
-            if(!Str_Cmp(param1,"l_in")){
-                buffer_ptr = DSPBufferGet(LEFT_IN);
-            }else if(!Str_Cmp(param1,"r_in")){
-                buffer_ptr = DSPBufferGet(RIGHT_IN);
-            }else if(!Str_Cmp(param1,"l_out")){
-                buffer_ptr = DSPBufferGet(LEFT_OUT);
-            }else if(!Str_Cmp(param1,"r_out")){
-                buffer_ptr = DSPBufferGet(RIGHT_OUT);
+            if(!Str_Cmp(argv[1],"reset")){
+                DSPBenchReset();
             }else{
-                load_err = 1;
+                (void)out_fnct((CPU_CHAR *)dspshCmdMsgBenchUsage, sizeof(dspshCmdMsgBenchUsage), pcmd_param->pout_opt);
             }
-            if(load_err == 1){
-                (void)out_fnct((CPU_CHAR *)dspshCmdMsgNotRec, sizeof(dspshCmdMsgNotRec), pcmd_param->pout_opt);
-                (void)out_fnct(argv[1], (CPU_INT16U)Str_Len(argv[1]), pcmd_param->pout_opt);
+            break;
+        default:
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgBenchUsage, sizeof(dspshCmdMsgBenchUsage), pcmd_param->pout_opt);
+            break;
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshChain()
+*
+* Description : Lists the stages of each channel with their last and maximum cycles per
+*               block, or edits the chain of one channel.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : A 'fir' or 'conv' stage added from the shell is an N tap moving average, so
+*               the cycles of direct form and FFT convolution can be compared.
+*********************************************************************************************/
+
+static CPU_INT16S dspshChain(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                              SHELL_CMD_PARAM *pcmd_param) {
+    DSP_STAGE_INFO_T info;
+    CPU_CHAR nbr_strg[11];
+    q31_t fir_coeffs[DSP_CHAIN_MAX_FIR_TAPS];
+    static q31_t conv_ir[DSP_CONV_MAX_TAPS];
+    INT16U k;
+    INT8U ch;
+    INT8U i;
+    INT16U taps;
+    INT8U chain_err = DSP_CHAIN_ERR_PARAM;
+
+    if(argc == 1){
+        for(ch=0;ch<DSP_CHAIN_NUM_ROWS;ch++){
+            for(i=0;i<DSPChainLenGet(ch);i++){
+                if(DSPChainStageInfoGet(ch, i, &info) != DSP_CHAIN_ERR_NONE){
+                    break;
+                }else{
+                }
+                (void)out_fnct((CPU_CHAR *)dspshChName(ch), 2, pcmd_param->pout_opt);
+                (void)Str_FmtNbr_Int32U((INT32U)i, 1, DEF_NBR_BASE_DEC, '\0', DEF_NO, DEF_YES, nbr_strg);
+                (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+                (void)out_fnct((CPU_CHAR *)" ", 1, pcmd_param->pout_opt);
+                (void)out_fnct((CPU_CHAR *)dspshStageNames[info.type],
+                               (CPU_INT16U)Str_Len(dspshStageNames[info.type]), pcmd_param->pout_opt);
+                (void)out_fnct((CPU_CHAR *)((info.enabled != 0) ? "on  " : "off "), 4, pcmd_param->pout_opt);
+                (void)Str_FmtNbr_Int32U(info.cycles_last, 10, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+                (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+                (void)out_fnct((CPU_CHAR *)" ", 1, pcmd_param->pout_opt);
+                (void)Str_FmtNbr_Int32U(info.cycles_max, 10, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+                (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
                 (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+            }
+        }
+        return (SHELL_ERR_NONE);
+    }else if((argc == 2) && !Str_Cmp(argv[1],"reset")){
+        DSPChainCyclesReset();
+        return (SHELL_ERR_NONE);
+    }else if(argc < 3){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgChainUsage, sizeof(dspshCmdMsgChainUsage), pcmd_param->pout_opt);
+        return (SHELL_ERR_NONE);
+    }else{
+    }
+
+    ch = dspshChParse(argv[1]);
+    if(!Str_Cmp(argv[2],"clear") && (argc == 3)){
+        chain_err = DSPChainClear(ch);
+    }else if(!Str_Cmp(argv[2],"en") && (argc == 5)){
+        chain_err = DSPChainStageEnable(ch, (INT8U)atoi(argv[3]), (INT8U)atoi(argv[4]));
+    }else if(!Str_Cmp(argv[2],"add") && (argc >= 4)){
+        if(!Str_Cmp(argv[3],"bypass") && (argc == 4)){
+            chain_err = DSPChainBypassAdd(ch);
+        }else if(!Str_Cmp(argv[3],"biquad") && (argc == 4)){
+            chain_err = DSPIirDefaultAdd(ch);
+        }else if(!Str_Cmp(argv[3],"fir") && (argc == 5)){
+            taps = (INT16U)atoi(argv[4]);
+            if((taps > 0) && (taps <= DSP_CHAIN_MAX_FIR_TAPS)){
+                for(i=0;i<taps;i++){
+                    fir_coeffs[i] = (q31_t)(0x7FFFFFFF/taps);
+                }
+                chain_err = DSPChainFirAdd(ch, &fir_coeffs[0], taps);
             }else{
-                DSPStopReq();
-                DSPStopFullPend(0,&os_err);
-                CODECDisable();
-
-                (void)out_fnct((CPU_CHAR *)"[",2,pcmd_param->pout_opt); //open with '[' for MATLAB
-                for(i=0;i < (DSP_NUM_BLOCKS*DSP_SAMPLES_PER_BLOCK - 1);i++){
-                    sample_float = ((FP32)*buffer_ptr++)/2147483648;    //convert from q_31 to float
-                    (void)Str_FmtNbr_32(sample_float,2,9,'\0',DEF_YES, sample_strg);
-                    (void)out_fnct((CPU_CHAR *)sample_strg, sizeof(sample_strg), pcmd_param->pout_opt);
-                    (void)out_fnct((CPU_CHAR *)",",2,pcmd_param->pout_opt); //comma seperated
+            }
+        }else if(!Str_Cmp(argv[3],"conv") && (argc == 5)){
+            taps = (INT16U)atoi(argv[4]);
+            if((taps > 0) && (taps <= DSP_CONV_MAX_TAPS)){
+                for(k=0;k<taps;k++){
+                    conv_ir[k] = (q31_t)(0x7FFFFFFF/taps);
                 }
-                sample_float = ((FP32)*buffer_ptr)/2147483648;          //last sample and closing ']'
-                (void)Str_FmtNbr_32(sample_float,2,9,'\0',DEF_YES, sample_strg);
-                (void)out_fnct((CPU_CHAR *)sample_strg, sizeof(sample_strg), pcmd_param->pout_opt);
-                (void)out_fnct((CPU_CHAR *)"]",2,pcmd_param->pout_opt);
-                (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
-                DSPStartReq();
+                chain_err = DSPChainConvAdd(ch, &conv_ir[0], taps);
+            }else{
+            }
+        }else if(!Str_Cmp(argv[3],"gain") && (argc == 5)){
+            chain_err = DSPChainGainAdd(ch, (INT32U)atoi(argv[4]));
+        }else if(!Str_Cmp(argv[3],"mix") && (argc == 6)){
+            chain_err = DSPChainMixAdd(ch, dspshChParse(argv[4]), (INT32U)atoi(argv[5]));
+        }else if(!Str_Cmp(argv[3],"rate") && (argc == 6)){
+            chain_err = DSPChainMultirateAdd(ch, (INT8U)atoi(argv[4]),
+                                             (INT8U)(dspshChParse(argv[5]) - DSP_NUM_OUT_CHANNELS));
+        }else if(!Str_Cmp(argv[3],"mod") && (argc == 6)){
+            for(i=0;i<DSP_NCO_NUM_MODS;i++){
+                if(!Str_Cmp(argv[4],(CPU_CHAR *)dspshModNames[i])){
+                    break;
+                }else{
+                }
+            }
+            chain_err = DSPChainModAdd(ch, i, (INT32U)atoi(argv[5]));
+        }else if(!Str_Cmp(argv[3],"dyn") && ((argc == 6) || (argc == 7))){
+            chain_err = DSPChainDynAdd(ch, (INT8S)atoi(argv[4]), (INT8U)atoi(argv[5]),
+                                       (argc == 7) ? (INT8S)atoi(argv[6]) : 0);
+        }else{
+        }
+    }else{
+    }
+
+    if(chain_err != DSP_CHAIN_ERR_NONE){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgChainErr, sizeof(dspshCmdMsgChainErr), pcmd_param->pout_opt);
+        (void)Str_FmtNbr_Int32U((INT32U)chain_err, 1, DEF_NBR_BASE_DEC, '\0', DEF_NO, DEF_YES, nbr_strg);
+        (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgChainUsage, sizeof(dspshCmdMsgChainUsage), pcmd_param->pout_opt);
+    }else{
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshChParse()
+*
+* Description : Converts 'l', 'r', a TDM slot number, 's0' or 's1' to a chain number. Anything
+*               else returns an invalid chain so the DSP function reports the error.
+*********************************************************************************************/
+
+static INT8U dspshChParse(CPU_CHAR *arg){
+    INT8U ch;
+
+    if((arg[0] >= '0') && (arg[0] < ('0' + DSP_NUM_OUT_CHANNELS)) && (arg[1] == '\0')){
+        ch = (INT8U)(arg[0] - '0');
+    }else if(!Str_Cmp(arg,"l")){
+        ch = DSP_LEFT_CH;
+    }else if(!Str_Cmp(arg,"r")){
+        ch = DSP_RIGHT_CH;
+    }else if(!Str_Cmp(arg,"s0")){
+        ch = DSP_CHAIN_SUB_CH(0);
+    }else if(!Str_Cmp(arg,"s1")){
+        ch = DSP_CHAIN_SUB_CH(1);
+    }else{
+        ch = DSP_CHAIN_NUM_ROWS;
+    }
+    return ch;
+}
+
+/*********************************************************************************************
+*                                    dspshChName()
+*
+* Description : Returns the two character display name of a chain. The CODEC slots are l and
+*               r, other TDM slots are numbered and the sub-chains follow the slots.
+*********************************************************************************************/
+
+static const INT8C *dspshChName(INT8U ch){
+    if(ch < DSP_NUM_OUT_CHANNELS){
+        return dspshChNames[ch];
+    }else{
+        return dspshSubNames[ch - DSP_NUM_OUT_CHANNELS];
+    }
+}
+
+/*********************************************************************************************
+*                                    dspshPrec()
+*
+* Description : Displays or sets the biquad precision mode, and turns the stereo biquad
+*               kernel on or off. The display includes the measured cost of every biquad
+*               stage in the current mode, as the largest cycles per block over all channels
+*               divided by the block size.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : Setting a mode clears the biquad state and maximum cycle counts. Compare
+*               the stereo kernel against the CMSIS kernel with dsp_prof on a biquad stage.
+*********************************************************************************************/
+
+static CPU_INT16S dspshPrec(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param) {
+    DSP_STAGE_INFO_T info;
+    INT32U biquad_cycles = 0;
+    INT8U mode;
+    INT8U ch;
+    INT8U i;
+
+    switch (argc) {
+        case 1:
+            mode = DSPChainBiquadModeGet();
+            (void)out_fnct((CPU_CHAR *)dspshPrecNames[mode], (CPU_INT16U)Str_Len(dspshPrecNames[mode]),
+                           pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+            if(DSPChainStereoGet() != 0){
+                (void)out_fnct((CPU_CHAR *)dspshPrecMsgStereoOn, sizeof(dspshPrecMsgStereoOn), pcmd_param->pout_opt);
+            }else{
+                (void)out_fnct((CPU_CHAR *)dspshPrecMsgStereoOff, sizeof(dspshPrecMsgStereoOff), pcmd_param->pout_opt);
+            }
+            for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+                for(i=0;i<DSPChainLenGet(ch);i++){
+                    if((DSPChainStageInfoGet(ch, i, &info) == DSP_CHAIN_ERR_NONE) &&
+                       (info.type == DSP_STAGE_BIQUAD) && (info.cycles_max > biquad_cycles)){
+                        biquad_cycles = info.cycles_max;
+                    }else{
+                    }
+                }
+            }
+            dspshOutLabelNbr(dspshPrecMsgCycles, (biquad_cycles*100)/DSPBlockSizeGet(),
+                             out_fnct, pcmd_param);
+            break;
+        case 2:
+            for(mode=0;mode<DSP_BIQUAD_NUM_MODES;mode++){
+                if(!Str_Cmp(argv[1],dspshPrecNames[mode])){
+                    break;
+                }else{
+                }
+            }
+            if(mode < DSP_BIQUAD_NUM_MODES){
+                DSPChainBiquadModeSet(mode);
+            }else{
+                (void)out_fnct((CPU_CHAR *)dspshCmdMsgPrecUsage, sizeof(dspshCmdMsgPrecUsage), pcmd_param->pout_opt);
+            }
+            break;
+        case 3:
+            if(!Str_Cmp(argv[1],"stereo") && !Str_Cmp(argv[2],"on")){
+                DSPChainStereoSet(1);
+            }else if(!Str_Cmp(argv[1],"stereo") && !Str_Cmp(argv[2],"off")){
+                DSPChainStereoSet(0);
+            }else{
+                (void)out_fnct((CPU_CHAR *)dspshCmdMsgPrecUsage, sizeof(dspshCmdMsgPrecUsage), pcmd_param->pout_opt);
             }
             break;
         default:
-             (void)out_fnct((CPU_CHAR *)dspshCmdMsgNotRec, sizeof(dspshCmdMsgNotRec), pcmd_param->pout_opt);
-             (void)out_fnct(argv[1], (CPU_INT16U)Str_Len(argv[1]), pcmd_param->pout_opt);
-             (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
-             break;
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgPrecUsage, sizeof(dspshCmdMsgPrecUsage), pcmd_param->pout_opt);
+            break;
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshIir()
+*
+* Description : Displays or edits the coefficients of a biquad chain stage while audio runs.
+*               Edits go to the stage's idle coefficient bank. 'commit' swaps the banks at the
+*               next block boundary, keeping the filter state. 'design' computes one section
+*               from a cookbook shape at the current sample rate and commits it.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : Coefficients are entered and shown as real values, {b0, b1, b2, a1, a2} in the
+*               CMSIS sign convention. They must be below 2^shift in magnitude.
+*               A designed section picks its own shift, is shown with its type, fc, q and
+*               gain in dB, and is retuned when dsp_fs changes the rate. Entering its
+*               coefficients directly makes it a fixed section again.
+*********************************************************************************************/
+
+static CPU_INT16S dspshIir(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                            SHELL_CMD_PARAM *pcmd_param) {
+    q31_t coeffs[DSP_CHAIN_MAX_BIQUADS*5];
+    float32_t section[5];
+    CPU_CHAR coeff_strg[14];
+    DSP_DESIGN_T design;
+    INT8U num_stages;
+    INT8U post_shift;
+    INT8U ch;
+    INT8U index;
+    INT8U i;
+    INT8U k;
+    INT8U chain_err = DSP_CHAIN_ERR_PARAM;
+
+    if(argc < 3){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgIirUsage, sizeof(dspshCmdMsgIirUsage), pcmd_param->pout_opt);
+        return (SHELL_ERR_NONE);
+    }else{
+    }
+    ch = dspshChParse(argv[1]);
+    index = (INT8U)atoi(argv[2]);
+
+    if(argc == 3){
+        chain_err = DSPChainBiquadGet(ch, index, &coeffs[0], &num_stages, &post_shift);
+        if(chain_err == DSP_CHAIN_ERR_NONE){
+            dspshOutLabelNbr(dspshIirMsgShift, post_shift, out_fnct, pcmd_param);
+            for(i=0;i<(num_stages*5);i++){
+                (void)Str_FmtNbr_32(((FP32)coeffs[i]/2147483648)*(FP32)(1u << post_shift),
+                                    3,9,'\0',DEF_YES,coeff_strg);
+                (void)out_fnct(coeff_strg, (CPU_INT16U)Str_Len(coeff_strg), pcmd_param->pout_opt);
+                if((i % 5) == 4){
+                    (void)DSPChainBiquadDesignGet(ch, index, (INT8U)(i/5), &design);
+                    if(design.type != DSP_DESIGN_NONE){
+                        (void)out_fnct((CPU_CHAR *)" ", 1, pcmd_param->pout_opt);
+                        (void)out_fnct((CPU_CHAR *)dspshDesignNames[design.type],
+                                       (CPU_INT16U)Str_Len(dspshDesignNames[design.type]), pcmd_param->pout_opt);
+                        section[0] = design.fc;
+                        section[1] = design.q;
+                        section[2] = design.gain_db;
+                        for(k=0;k<3;k++){
+                            (void)Str_FmtNbr_32(section[k],5,3,'\0',DEF_YES,coeff_strg);
+                            (void)out_fnct((CPU_CHAR *)" ", 1, pcmd_param->pout_opt);
+                            (void)out_fnct(coeff_strg, (CPU_INT16U)Str_Len(coeff_strg), pcmd_param->pout_opt);
+                        }
+                    }else{
+                    }
+                    (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+                }else{
+                    (void)out_fnct((CPU_CHAR *)" ", 1, pcmd_param->pout_opt);
+                }
+            }
+        }else{
+        }
+    }else if((argc == 4) && !Str_Cmp(argv[3],"commit")){
+        chain_err = DSPChainBiquadCommit(ch, index);
+    }else if((argc == 5) && !Str_Cmp(argv[3],"shift")){
+        chain_err = DSPChainBiquadShiftSet(ch, index, (INT8U)atoi(argv[4]));
+    }else if(((argc == 8) || (argc == 9)) && !Str_Cmp(argv[3],"design")){
+        design.type = DSP_DESIGN_NONE;
+        for(k=1;k<DSP_DESIGN_NUM_TYPES;k++){
+            if(!Str_Cmp(argv[5],(CPU_CHAR *)dspshDesignNames[k])){
+                design.type = k;
+            }else{
+            }
+        }
+        design.fc = (float32_t)atof(argv[6]);
+        design.q = (float32_t)atof(argv[7]);
+        if(argc == 9){
+            design.gain_db = (float32_t)atof(argv[8]);
+        }else{
+            design.gain_db = 0.0f;
+        }
+        chain_err = DSPChainBiquadDesign(ch, index, (INT8U)atoi(argv[4]), &design);
+    }else if(argc == 9){
+        for(i=0;i<5;i++){
+            section[i] = (float32_t)atof(argv[4+i]);
+        }
+        chain_err = DSPChainBiquadSectionSet(ch, index, (INT8U)atoi(argv[3]), &section[0]);
+    }else{
+    }
+
+    if(chain_err != DSP_CHAIN_ERR_NONE){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgChainErr, sizeof(dspshCmdMsgChainErr), pcmd_param->pout_opt);
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgIirUsage, sizeof(dspshCmdMsgIirUsage), pcmd_param->pout_opt);
+    }else{
     }
     return (SHELL_ERR_NONE);
 }
+
+/*********************************************************************************************
+*                                    dspshSpectrum()
+*
+* Description : Dumps the averaged power spectrum in dB as a MATLAB array, or turns the
+*               analyzer on and off. The analyzer runs in dspTask so audio keeps running.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : The dump starts with a MATLAB comment line giving the sample rate, FFT length
+*               and number of blocks averaged. Bin k is at k*fs/n Hz.
+*********************************************************************************************/
+
+static CPU_INT16S dspshSpectrum(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                                 SHELL_CMD_PARAM *pcmd_param) {
+    static float32_t power[DSP_SPEC_BINS];
+    CPU_CHAR db_strg[10];
+    BUFF_ID_T buff_id;
+    INT32U frames;
+    INT32U k;
+    INT8U spec_err = 0;
+
+    if(argc == 1){
+        frames = DSPSpectrumGet(&power[0]);
+        (void)out_fnct((CPU_CHAR *)dspshSpecMsgFs, (CPU_INT16U)Str_Len(dspshSpecMsgFs), pcmd_param->pout_opt);
+        dspshOutNbr(DSPSampleRateGet(), out_fnct, pcmd_param);
+        (void)out_fnct((CPU_CHAR *)dspshSpecMsgN, (CPU_INT16U)Str_Len(dspshSpecMsgN), pcmd_param->pout_opt);
+        dspshOutNbr(FFT_LENGTH, out_fnct, pcmd_param);
+        (void)out_fnct((CPU_CHAR *)dspshSpecMsgBlocks, (CPU_INT16U)Str_Len(dspshSpecMsgBlocks), pcmd_param->pout_opt);
+        dspshOutNbr(frames, out_fnct, pcmd_param);
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+        (void)out_fnct((CPU_CHAR *)"[",1,pcmd_param->pout_opt);        //open with '[' for MATLAB
+        for(k=0;k<DSP_SPEC_BINS;k++){
+            (void)Str_FmtNbr_32(10.0f*log10f(power[k] + 1.0e-20f),4,1,'\0',DEF_YES,db_strg);
+            (void)out_fnct(db_strg, (CPU_INT16U)Str_Len(db_strg), pcmd_param->pout_opt);
+            if(k < (DSP_SPEC_BINS - 1)){
+                (void)out_fnct((CPU_CHAR *)",",1,pcmd_param->pout_opt);
+            }else{
+            }
+        }
+        (void)out_fnct((CPU_CHAR *)"]",1,pcmd_param->pout_opt);
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+    }else if((argc == 3) && !Str_Cmp(argv[1],"on")){
+        spec_err = dspshBuffParse(argv[2], &buff_id);
+        if(spec_err == 0){
+            DSPSpectrumEnable(buff_id);
+        }else{
+        }
+    }else if((argc == 2) && !Str_Cmp(argv[1],"off")){
+        DSPSpectrumDisable();
+    }else if((argc == 2) && !Str_Cmp(argv[1],"reset")){
+        DSPSpectrumReset();
+    }else if((argc == 3) && !Str_Cmp(argv[1],"avg")){
+        spec_err = DSPSpectrumAvgSet((INT8U)atoi(argv[2]));
+    }else{
+        spec_err = 1;
+    }
+    if(spec_err != 0){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgSpecUsage, sizeof(dspshCmdMsgSpecUsage), pcmd_param->pout_opt);
+    }else{
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshBlockSize()
+*
+* Description : Displays or sets the samples per block and the DMA ring depth. The display
+*               includes the buffering latency, one block period per block in the ring.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : Setting the block size restarts the DMA, so audio drops out briefly.
+*********************************************************************************************/
+
+static CPU_INT16S dspshBlockSize(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                                  SHELL_CMD_PARAM *pcmd_param) {
+    INT16U block_size;
+    INT8U num_blocks;
+    INT8U blk_err = DSP_BLOCK_ERR_NONE;
+
+    if(argc == 2){
+        blk_err = DSPBlockSizeSet((INT16U)atoi(argv[1]));
+    }else if(argc == 3){
+        blk_err = DSPBlockLayoutSet((INT16U)atoi(argv[1]), (INT8U)atoi(argv[2]));
+    }else if(argc != 1){
+        blk_err = DSP_BLOCK_ERR_SIZE;
+    }else{
+    }
+    if(blk_err != DSP_BLOCK_ERR_NONE){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgBlkUsage, sizeof(dspshCmdMsgBlkUsage), pcmd_param->pout_opt);
+        return (SHELL_ERR_NONE);
+    }else{
+    }
+    block_size = DSPBlockSizeGet();
+    num_blocks = DSPBlockCountGet();
+    dspshOutLabelNbr(dspshBlkMsgSize, block_size, out_fnct, pcmd_param);
+    dspshOutLabelNbr(dspshBlkMsgCount, num_blocks, out_fnct, pcmd_param);
+    dspshOutLabelNbr(dspshBlkMsgLatency,
+                     (INT32U)((1000000u*(INT32U)block_size*num_blocks)/DSPSampleRateGet()),
+                     out_fnct, pcmd_param);
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshXrun()
+*
+* Description : Reports the block overrun, underrun and late block counters and the last
+*               logged overruns and underruns, newest first.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : 'dsp_xrun reset' clears the counters and the log.
+*********************************************************************************************/
+
+static CPU_INT16S dspshXrun(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param) {
+    DSP_XRUN_T xrun;
+    DSP_XRUN_EVENT_T events[DSP_XRUN_LOG_LEN];
+    INT8U num_events;
+    INT8U i;
+
+    switch (argc) {
+        case 1:
+            DSPXrunGet(&xrun);
+            num_events = DSPXrunLogGet(&events[0]);
+            dspshOutLabelNbr(dspshXrunMsgOver, xrun.overruns, out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshXrunMsgUnder, xrun.underruns, out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshXrunMsgLate, xrun.late, out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshXrunMsgBacklog, xrun.backlog_max, out_fnct, pcmd_param);
+            for(i=0;i<num_events;i++){
+                (void)out_fnct((CPU_CHAR *)dspshXrunNames[events[i].type],
+                               (CPU_INT16U)Str_Len(dspshXrunNames[events[i].type]), pcmd_param->pout_opt);
+                dspshOutNbr(events[i].seq, out_fnct, pcmd_param);
+                (void)out_fnct((CPU_CHAR *)dspshXrunMsgTick, (CPU_INT16U)Str_Len(dspshXrunMsgTick), pcmd_param->pout_opt);
+                dspshOutNbr((INT32U)events[i].tick, out_fnct, pcmd_param);
+                dspshOutLabelNbr(dspshXrunMsgCount, events[i].count, out_fnct, pcmd_param);
+            }
+            break;
+        case 2:
+            if(!Str_Cmp(argv[1],"reset")){
+                DSPXrunReset();
+            }else{
+                (void)out_fnct((CPU_CHAR *)dspshCmdMsgXrunUsage, sizeof(dspshCmdMsgXrunUsage), pcmd_param->pout_opt);
+            }
+            break;
+        default:
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgXrunUsage, sizeof(dspshCmdMsgXrunUsage), pcmd_param->pout_opt);
+            break;
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshProf()
+*
+* Description : Reports the cycle profile of whole blocks followed by the minimum, maximum
+*               and mean cycles of every stage, or the full profile of one stage.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : 'dsp_prof reset' clears the block and stage profiles.
+*********************************************************************************************/
+
+static CPU_INT16S dspshProf(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param) {
+    DSP_PROF_T prof;
+    CPU_CHAR nbr_strg[11];
+    INT8U ch;
+    INT8U i;
+    INT8U chain_err;
+
+    switch (argc) {
+        case 1:
+            DSPProfBlockGet(&prof);
+            dspshProfOut(&prof, out_fnct, pcmd_param);
+            (void)out_fnct((CPU_CHAR *)dspshProfMsgStages, sizeof(dspshProfMsgStages), pcmd_param->pout_opt);
+            for(ch=0;ch<DSP_CHAIN_NUM_ROWS;ch++){
+                for(i=0;i<DSPChainLenGet(ch);i++){
+                    if(DSPChainStageProfGet(ch, i, &prof) != DSP_CHAIN_ERR_NONE){
+                        break;
+                    }else{
+                    }
+                    (void)out_fnct((CPU_CHAR *)dspshChName(ch), 2, pcmd_param->pout_opt);
+                    (void)Str_FmtNbr_Int32U((INT32U)i, 1, DEF_NBR_BASE_DEC, '\0', DEF_NO, DEF_YES, nbr_strg);
+                    (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+                    (void)Str_FmtNbr_Int32U((prof.count != 0) ? prof.min : 0, 10, DEF_NBR_BASE_DEC, ' ',
+                                            DEF_NO, DEF_YES, nbr_strg);
+                    (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+                    (void)Str_FmtNbr_Int32U(prof.max, 10, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+                    (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+                    (void)Str_FmtNbr_Int32U(DSPProfMeanGet(&prof), 10, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+                    (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+                    (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+                }
+            }
+            break;
+        case 2:
+            if(!Str_Cmp(argv[1],"reset")){
+                DSPProfBlockReset();
+                DSPChainCyclesReset();
+            }else{
+                (void)out_fnct((CPU_CHAR *)dspshCmdMsgProfUsage, sizeof(dspshCmdMsgProfUsage), pcmd_param->pout_opt);
+            }
+            break;
+        case 3:
+            chain_err = DSPChainStageProfGet(dspshChParse(argv[1]), (INT8U)atoi(argv[2]), &prof);
+            if(chain_err == DSP_CHAIN_ERR_NONE){
+                dspshProfOut(&prof, out_fnct, pcmd_param);
+            }else{
+                dspshOutLabelNbr(dspshCmdMsgChainErr, chain_err, out_fnct, pcmd_param);
+            }
+            break;
+        default:
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgProfUsage, sizeof(dspshCmdMsgProfUsage), pcmd_param->pout_opt);
+            break;
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshProfOut()
+*
+* Description : Sends the minimum, maximum, mean and count of a profile followed by the
+*               histogram bins that are not empty, each labeled with its lowest cycle count.
+*********************************************************************************************/
+
+static void dspshProfOut(const DSP_PROF_T *prof, SHELL_OUT_FNCT out_fnct,
+                         SHELL_CMD_PARAM *pcmd_param) {
+    INT8U bin;
+
+    dspshOutLabelNbr(dspshProfMsgMin, (prof->count != 0) ? prof->min : 0, out_fnct, pcmd_param);
+    dspshOutLabelNbr(dspshProfMsgMax, prof->max, out_fnct, pcmd_param);
+    dspshOutLabelNbr(dspshProfMsgMean, DSPProfMeanGet(prof), out_fnct, pcmd_param);
+    dspshOutLabelNbr(dspshProfMsgCount, prof->count, out_fnct, pcmd_param);
+    for(bin=0;bin<DSP_PROF_NUM_BINS;bin++){
+        if(prof->hist[bin] != 0){
+            (void)out_fnct((CPU_CHAR *)dspshProfMsgBin, (CPU_INT16U)Str_Len(dspshProfMsgBin), pcmd_param->pout_opt);
+            dspshOutNbr(DSPProfBinLowGet(bin), out_fnct, pcmd_param);
+            (void)out_fnct((CPU_CHAR *)": ", 2, pcmd_param->pout_opt);
+            dspshOutNbr(prof->hist[bin], out_fnct, pcmd_param);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+        }else{
+        }
+    }
+}
+
+/*********************************************************************************************
+*                                    dspshIntDis()
+*
+* Description : Reports the longest time interrupts were disabled since the last reset, for
+*               the whole system and for each task, in CPU cycles. The uC/CPU measurement
+*               overhead is already taken out. Any time interrupts are disabled adds directly
+*               to the latency of the DMA interrupts.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : 'dsp_intdis reset' clears the system and task maximums. The time of a task is
+*               charged when it is switched out, so the running shell task shows its time
+*               up to its last switch.
+*********************************************************************************************/
+
+static CPU_INT16S dspshIntDis(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                               SHELL_CMD_PARAM *pcmd_param) {
+#ifdef CPU_CFG_INT_DIS_MEAS_EN
+    OS_TCB *p_tcb;
+    CPU_TS int_dis_max;
+    CPU_CHAR *name;
+    CPU_CHAR nbr_strg[11];
+    INT16U name_len;
+    CPU_SR_ALLOC();
+
+    switch (argc) {
+        case 1:
+            int_dis_max = CPU_IntDisMeasMaxGet();
+            dspshOutLabelNbr(dspshIntDisMsgMax, int_dis_max, out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshIntDisMsgNs, (INT32U)(((INT64U)int_dis_max*1000000000u)/SYSTEM_CLOCK),
+                             out_fnct, pcmd_param);
+            (void)out_fnct((CPU_CHAR *)dspshIntDisMsgTasks, sizeof(dspshIntDisMsgTasks), pcmd_param->pout_opt);
+            CPU_CRITICAL_ENTER();
+            p_tcb = OSTaskDbgListPtr;
+            CPU_CRITICAL_EXIT();
+            while(p_tcb != (OS_TCB *)0){
+                CPU_CRITICAL_ENTER();
+                name = p_tcb->NamePtr;
+                int_dis_max = p_tcb->IntDisTimeMax;
+                CPU_CRITICAL_EXIT();
+                name_len = (INT16U)Str_Len(name);
+                if(name_len > 16){
+                    name_len = 16;
+                }else{
+                }
+                (void)out_fnct(name, name_len, pcmd_param->pout_opt);
+                (void)out_fnct((CPU_CHAR *)"                ", (CPU_INT16U)(16 - name_len), pcmd_param->pout_opt);
+                (void)Str_FmtNbr_Int32U((INT32U)int_dis_max, 10, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+                (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+                (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+                CPU_CRITICAL_ENTER();
+                p_tcb = p_tcb->DbgNextPtr;
+                CPU_CRITICAL_EXIT();
+            }
+            break;
+        case 2:
+            if(!Str_Cmp(argv[1],"reset")){
+                (void)CPU_IntDisMeasMaxCurReset();
+                CPU_CRITICAL_ENTER();
+                CPU_IntDisMeasMax_cnts = 0;
+                for(p_tcb=OSTaskDbgListPtr;p_tcb!=(OS_TCB *)0;p_tcb=p_tcb->DbgNextPtr){
+                    p_tcb->IntDisTimeMax = 0;
+                }
+                CPU_CRITICAL_EXIT();
+            }else{
+                (void)out_fnct((CPU_CHAR *)dspshCmdMsgIntDisUsage, sizeof(dspshCmdMsgIntDisUsage), pcmd_param->pout_opt);
+            }
+            break;
+        default:
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgIntDisUsage, sizeof(dspshCmdMsgIntDisUsage), pcmd_param->pout_opt);
+            break;
+    }
+#else
+    (void)argc;
+    (void)argv;
+    (void)out_fnct((CPU_CHAR *)dspshCmdMsgIntDisOff, sizeof(dspshCmdMsgIntDisOff), pcmd_param->pout_opt);
+#endif
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshUart()
+*
+* Description : Reports the terminal receive errors. An overrun is a character the UART lost
+*               because its RX interrupt was held off for a character time. A dropped
+*               character arrived while the receive ring was full.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : 'dsp_uart reset' clears the counts.
+*********************************************************************************************/
+
+static CPU_INT16S dspshUart(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param) {
+    BIO_RX_ERR_T rx_err;
+
+    switch (argc) {
+        case 1:
+            BIORxErrGet(&rx_err);
+            dspshOutLabelNbr(dspshUartMsgOverruns, rx_err.overruns, out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshUartMsgDropped, rx_err.dropped, out_fnct, pcmd_param);
+            break;
+        case 2:
+            if(!Str_Cmp(argv[1],"reset")){
+                BIORxErrReset();
+            }else{
+                (void)out_fnct((CPU_CHAR *)dspshCmdMsgUartUsage, sizeof(dspshCmdMsgUartUsage), pcmd_param->pout_opt);
+            }
+            break;
+        default:
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgUartUsage, sizeof(dspshCmdMsgUartUsage), pcmd_param->pout_opt);
+            break;
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshDyn()
+*
+* Description : Reports the deepest gain reduction of a dynamics stage since the last reset
+*               and its worst cost in cycles per sample.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : 'dsp_dyn ch stage reset' restarts the reduction after reporting it. The cost
+*               of a stereo-linked pair is shared between its two stages, so the pair costs
+*               twice the figure shown. 'dsp_chain reset' restarts the cycle count.
+*********************************************************************************************/
+
+static CPU_INT16S dspshDyn(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                            SHELL_CMD_PARAM *pcmd_param) {
+    DSP_STAGE_INFO_T info;
+    q31_t gain_min;
+    INT8U ch;
+    INT8U index;
+    INT8U chain_err;
+
+    if((argc == 3) || ((argc == 4) && !Str_Cmp(argv[3],"reset"))){
+        ch = dspshChParse(argv[1]);
+        index = (INT8U)atoi(argv[2]);
+        chain_err = DSPChainDynGainMinGet(ch, index, &gain_min, (INT8U)(argc == 4));
+        if(chain_err == DSP_CHAIN_ERR_NONE){
+            (void)DSPChainStageInfoGet(ch, index, &info);
+            dspshOutLabelNbr(dspshDynMsgReduction,
+                             (INT32U)(-200.0f*log10f((float32_t)gain_min/2147483648.0f) + 0.5f),
+                             out_fnct, pcmd_param);
+            dspshOutLabelNbr(dspshDynMsgCycles, (info.cycles_max*100)/DSPBlockSizeGet(),
+                             out_fnct, pcmd_param);
+        }else{
+            dspshOutLabelNbr(dspshCmdMsgChainErr, chain_err, out_fnct, pcmd_param);
+        }
+    }else{
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgDynUsage, sizeof(dspshCmdMsgDynUsage), pcmd_param->pout_opt);
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshNco()
+*
+* Description : Retunes a modulator stage, keeping the NCO phase, or times the NCO against
+*               a call to arm_cos_f32() per sample over one block.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : The benchmark runs in the shell task at the current block size. Each figure
+*               is the best of a few runs so preemption by dspTask does not count.
+*********************************************************************************************/
+
+static CPU_INT16S dspshNco(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                            SHELL_CMD_PARAM *pcmd_param) {
+    INT32U nco_cycles;
+    INT32U cos_cycles;
+    INT32U num_samples;
+    INT8U chain_err;
+
+    if((argc == 2) && !Str_Cmp(argv[1],"bench")){
+        num_samples = DSPBlockSizeGet();
+        DSPNcoBench(num_samples, &nco_cycles, &cos_cycles);
+        dspshOutLabelNbr(dspshNcoMsgNco, (nco_cycles*100)/num_samples, out_fnct, pcmd_param);
+        dspshOutLabelNbr(dspshNcoMsgCos, (cos_cycles*100)/num_samples, out_fnct, pcmd_param);
+    }else if(argc == 4){
+        chain_err = DSPChainModFreqSet(dspshChParse(argv[1]), (INT8U)atoi(argv[2]),
+                                       (INT32U)atoi(argv[3]));
+        if(chain_err != DSP_CHAIN_ERR_NONE){
+            dspshOutLabelNbr(dspshCmdMsgChainErr, chain_err, out_fnct, pcmd_param);
+        }else{
+        }
+    }else{
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgNcoUsage, sizeof(dspshCmdMsgNcoUsage), pcmd_param->pout_opt);
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshTone()
+*
+* Description : Displays the level and turn on events of each detector tone, or configures
+*               the tone detector bank.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : Levels are dBFS over the last window, 0 for a full scale sine. 'on window'
+*               is the window number of the last turn on. A tone past Nyquist for the
+*               current sample rate shows --. 'dsp_tone dtmf' replaces the tones with the
+*               eight DTMF frequencies, thresh defaults to -30 dBFS.
+*********************************************************************************************/
+
+static CPU_INT16S dspshTone(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param) {
+    static DSP_TONE_INFO_T tones[DSP_TONE_MAX_TONES];
+    CPU_CHAR nbr_strg[12];
+    BUFF_ID_T buff_id;
+    INT32U windows;
+    INT8S thresh_db;
+    INT8U num_tones;
+    INT8U t;
+    INT8U tone_err = DSP_TONE_ERR_NONE;
+    INT8U usage = 0;
+
+    if(argc == 1){
+        windows = DSPToneGet(&tones[0], &num_tones);
+        dspshOutLabelNbr(dspshToneMsgWindow, DSPToneWindowGet(), out_fnct, pcmd_param);
+        dspshOutLabelNbr(dspshToneMsgWindows, windows, out_fnct, pcmd_param);
+        (void)out_fnct((CPU_CHAR *)dspshToneMsgTones, sizeof(dspshToneMsgTones), pcmd_param->pout_opt);
+        for(t=0;t<num_tones;t++){
+            (void)Str_FmtNbr_Int32U((INT32U)t, 4, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+            (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+            (void)Str_FmtNbr_Int32U(tones[t].freq_hz, 9, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+            (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+            if(tones[t].valid != 0){
+                (void)Str_FmtNbr_32(10.0f*log10f(tones[t].power + 1.0e-20f),4,1,' ',DEF_YES,nbr_strg);
+                (void)out_fnct((CPU_CHAR *)"  ", 2, pcmd_param->pout_opt);
+                (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+            }else{
+                (void)out_fnct((CPU_CHAR *)dspshToneMsgInvalid, (CPU_INT16U)Str_Len(dspshToneMsgInvalid),
+                               pcmd_param->pout_opt);
+            }
+            (void)Str_FmtNbr_Int32S((INT32S)tones[t].thresh_db, 8, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+            (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+            (void)Str_FmtNbr_Int32U((INT32U)tones[t].on, 4, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+            (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+            (void)Str_FmtNbr_Int32U(tones[t].on_count, 8, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+            (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+            (void)Str_FmtNbr_Int32U(tones[t].on_window, 11, DEF_NBR_BASE_DEC, ' ', DEF_NO, DEF_YES, nbr_strg);
+            (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+        }
+    }else if((argc == 3) && !Str_Cmp(argv[1],"on")){
+        usage = dspshBuffParse(argv[2], &buff_id);
+        if(usage == 0){
+            DSPToneEnable(buff_id);
+        }else{
+        }
+    }else if((argc == 2) && !Str_Cmp(argv[1],"off")){
+        DSPToneDisable();
+    }else if((argc == 2) && !Str_Cmp(argv[1],"reset")){
+        DSPToneReset();
+    }else if((argc == 2) && !Str_Cmp(argv[1],"clear")){
+        DSPToneClear();
+    }else if((argc == 4) && !Str_Cmp(argv[1],"add")){
+        tone_err = DSPToneAdd((INT32U)atoi(argv[2]), (INT8S)atoi(argv[3]));
+    }else if((argc == 3) && !Str_Cmp(argv[1],"del")){
+        tone_err = DSPToneRemove((INT8U)atoi(argv[2]));
+    }else if((argc == 3) && !Str_Cmp(argv[1],"win")){
+        tone_err = DSPToneWindowSet((INT32U)atoi(argv[2]));
+    }else if(((argc == 2) || (argc == 3)) && !Str_Cmp(argv[1],"dtmf")){
+        thresh_db = (argc == 3) ? (INT8S)atoi(argv[2]) : -30;
+        DSPToneClear();
+        for(t=0;(t<(sizeof(dspshToneDtmf)/sizeof(dspshToneDtmf[0]))) && (tone_err == DSP_TONE_ERR_NONE);t++){
+            tone_err = DSPToneAdd(dspshToneDtmf[t], thresh_db);
+        }
+    }else{
+        usage = 1;
+    }
+    if(usage != 0){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgToneUsage, sizeof(dspshCmdMsgToneUsage), pcmd_param->pout_opt);
+    }else if(tone_err != DSP_TONE_ERR_NONE){
+        dspshOutLabelNbr(dspshCmdMsgToneErr, tone_err, out_fnct, pcmd_param);
+    }else{
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshLatency()
+*
+* Description : Plays a burst on the outputs, records it back through the loopback and
+*               reports the round trip latency for the current block size, ring depth and
+*               sample rate.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : The ring part is the buffering shown by dsp_blk, the rest is the I2S FIFOs
+*               and the CODEC filters. Any overrun or underrun during the recording shifts
+*               the blocks, so the result is thrown away.
+*********************************************************************************************/
+
+static CPU_INT16S dspshLatency(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                                SHELL_CMD_PARAM *pcmd_param) {
+    DSP_LAT_RESULT_T result;
+    DSP_XRUN_T xrun_start;
+    DSP_XRUN_T xrun_end;
+    BUFF_ID_T buff_id = LEFT_IN;
+    OS_ERR os_err;
+    INT32U ticks;
+    INT8U mode = DSP_LAT_MODE_MLS;
+    INT8U sim = 0;
+    INT8U lat_err = DSP_LAT_ERR_NONE;
+    INT8U i;
+
+    for(i=1;i<argc;i++){
+        if(!Str_Cmp(argv[i],"impulse")){
+            mode = DSP_LAT_MODE_IMPULSE;
+        }else if(!Str_Cmp(argv[i],"mls")){
+            mode = DSP_LAT_MODE_MLS;
+        }else if(!Str_Cmp(argv[i],"sim")){
+            sim = 1;
+        }else if(dspshBuffParse(argv[i], &buff_id) != 0){
+            lat_err = DSP_LAT_ERR_ARG;
+        }else{
+        }
+    }
+    if(lat_err == DSP_LAT_ERR_NONE){
+        DSPXrunGet(&xrun_start);
+        lat_err = DSPLatencyStart(mode, buff_id, sim);
+    }else{
+    }
+    if(lat_err == DSP_LAT_ERR_NONE){
+        for(ticks=0;(DSPLatencyIsDone() == 0) && (ticks < DSP_LAT_TOUT);ticks++){
+            OSTimeDly(1, OS_OPT_TIME_DLY, &os_err);
+        }
+        DSPXrunGet(&xrun_end);
+        if(DSPLatencyIsDone() == 0){
+            DSPLatencyCancel();
+            lat_err = DSP_LAT_ERR_TOUT;
+        }else if((xrun_end.overruns != xrun_start.overruns) ||
+                 (xrun_end.underruns != xrun_start.underruns)){
+            DSPLatencyCancel();
+            lat_err = DSP_LAT_ERR_XRUN;
+        }else{
+            lat_err = DSPLatencyResultGet(&result);
+        }
+    }else{
+    }
+    if(lat_err == DSP_LAT_ERR_NONE){
+        if(result.sim != 0){
+            (void)out_fnct((CPU_CHAR *)dspshLatMsgSim, sizeof(dspshLatMsgSim), pcmd_param->pout_opt);
+        }else{
+        }
+        dspshOutLabelNbr(dspshLatMsgSamples, result.lag, out_fnct, pcmd_param);
+        dspshOutLabelNbr(dspshLatMsgUs, (INT32U)(((INT64U)result.lag*1000000u)/DSPSampleRateGet()),
+                         out_fnct, pcmd_param);
+        dspshOutLabelNbr(dspshLatMsgRing, result.ring, out_fnct, pcmd_param);
+        dspshOutLabelNbr(dspshLatMsgCodec, (result.lag > result.ring) ? (result.lag - result.ring) : 0,
+                         out_fnct, pcmd_param);
+        dspshOutLabelNbr(dspshLatMsgRatio, result.peak_ratio, out_fnct, pcmd_param);
+    }else if(lat_err == DSP_LAT_ERR_ARG){
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgLatUsage, sizeof(dspshCmdMsgLatUsage), pcmd_param->pout_opt);
+    }else{
+        dspshOutLabelNbr(dspshCmdMsgLatErr, lat_err, out_fnct, pcmd_param);
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshCapture()
+*
+* Description : Starts or stops the binary capture stream, or reports its state. The frames
+*               go out on the terminal UART, so close the terminal and record the port on the
+*               host, then convert the recording with tools/dspcap2wav.
+*
+* Argument(s) : argc            The number of arguments.
+*
+*               argv            Array of arguments.
+*
+*               out_fnct        The output function.
+*
+*               pcmd_param      Pointer to the command parameters.
+*
+* Return(s)   : SHELL_EXEC_ERR, if an error is encountered.
+*               SHELL_ERR_NONE, otherwise.
+*
+* Caller(s)   : Shell, in response to command execution.
+*
+* Note(s)     : 'bytes/s needed' should stay under a tenth of the UART bit rate, or frames
+*               are dropped.
+*********************************************************************************************/
+
+static CPU_INT16S dspshCapture(CPU_INT16U argc, CPU_CHAR *argv[], SHELL_OUT_FNCT out_fnct,
+                                SHELL_CMD_PARAM *pcmd_param) {
+    DSP_CAP_STATUS_T status;
+    BUFF_ID_T buff_id;
+    INT8U mask = 0;
+    INT8U fmt = DSP_CAP_FMT_Q15;
+    INT8U cap_err = DSP_CAP_ERR_NONE;
+    INT8U i;
+
+    if(argc == 1){
+        DSPCaptureStatusGet(&status);
+        if(status.enabled != 0){
+            (void)out_fnct((CPU_CHAR *)dspshCapMsgOn, sizeof(dspshCapMsgOn), pcmd_param->pout_opt);
+        }else{
+            (void)out_fnct((CPU_CHAR *)dspshCapMsgOff, sizeof(dspshCapMsgOff), pcmd_param->pout_opt);
+        }
+        for(i=LEFT_IN;i<=RIGHT_OUT;i++){
+            if((status.mask & DSP_CAP_MASK(i)) != 0){
+                (void)out_fnct((CPU_CHAR *)dspshBuffNames[i], (CPU_INT16U)Str_Len(dspshBuffNames[i]),
+                               pcmd_param->pout_opt);
+            }else{
+            }
+        }
+        (void)out_fnct((CPU_CHAR *)dspshCapFmtNames[status.fmt], (CPU_INT16U)Str_Len(dspshCapFmtNames[status.fmt]),
+                       pcmd_param->pout_opt);
+        dspshOutLabelNbr(dspshCapMsgSent, status.frames_sent, out_fnct, pcmd_param);
+        dspshOutLabelNbr(dspshCapMsgDropped, status.frames_dropped, out_fnct, pcmd_param);
+        dspshOutLabelNbr(dspshCapMsgRate, status.bytes_per_s, out_fnct, pcmd_param);
+    }else if((argc == 2) && !Str_Cmp(argv[1],"off")){
+        DSPCaptureStop();
+    }else if((argc >= 3) && !Str_Cmp(argv[1],"on")){
+        for(i=2;i<argc;i++){
+            if(!Str_Cmp(argv[i],"q15") && (i == (argc - 1))){
+                fmt = DSP_CAP_FMT_Q15;
+            }else if(!Str_Cmp(argv[i],"q31") && (i == (argc - 1))){
+                fmt = DSP_CAP_FMT_Q31;
+            }else if(dspshBuffParse(argv[i], &buff_id) == 0){
+                mask |= (INT8U)DSP_CAP_MASK(buff_id);
+            }else{
+                cap_err = DSP_CAP_ERR_MASK;
+            }
+        }
+        if(cap_err == DSP_CAP_ERR_NONE){
+            cap_err = DSPCaptureStart(mask, fmt);
+        }else{
+        }
+        if(cap_err != DSP_CAP_ERR_NONE){
+            (void)out_fnct((CPU_CHAR *)dspshCmdMsgCapUsage, sizeof(dspshCmdMsgCapUsage), pcmd_param->pout_opt);
+        }else{
+        }
+    }else{
+        (void)out_fnct((CPU_CHAR *)dspshCmdMsgCapUsage, sizeof(dspshCmdMsgCapUsage), pcmd_param->pout_opt);
+    }
+    return (SHELL_ERR_NONE);
+}
+
+/*********************************************************************************************
+*                                    dspshBuffParse()
+*
+* Description : Converts a buffer name (l_in, r_in, l_out, r_out) to its BUFF_ID_T.
+*               Returns 1 if the name is not recognized.
+*********************************************************************************************/
+
+static INT8U dspshBuffParse(CPU_CHAR *arg, BUFF_ID_T *buff_id){
+    INT8U buff_err = 0;
+
+    if(!Str_Cmp(arg,"l_in")){
+        *buff_id = LEFT_IN;
+    }else if(!Str_Cmp(arg,"r_in")){
+        *buff_id = RIGHT_IN;
+    }else if(!Str_Cmp(arg,"l_out")){
+        *buff_id = LEFT_OUT;
+    }else if(!Str_Cmp(arg,"r_out")){
+        *buff_id = RIGHT_OUT;
+    }else{
+        buff_err = 1;
+    }
+    return buff_err;
+}
+
+/*********************************************************************************************
+*                                    dspshOutLabelNbr()
+*
+* Description : Sends a label followed by an unsigned decimal number and a new line.
+*********************************************************************************************/
+
+static void dspshOutLabelNbr(const INT8C *label, INT32U nbr, SHELL_OUT_FNCT out_fnct,
+                             SHELL_CMD_PARAM *pcmd_param) {
+
+    (void)out_fnct((CPU_CHAR *)label, (CPU_INT16U)Str_Len(label), pcmd_param->pout_opt);
+    dspshOutNbr(nbr, out_fnct, pcmd_param);
+    (void)out_fnct((CPU_CHAR *)dspshCmdMsgNL,sizeof(dspshCmdMsgNL),pcmd_param->pout_opt);
+}
+
+/*********************************************************************************************
+*                                    dspshOutNbr()
+*
+* Description : Sends an unsigned decimal number with no padding.
+*********************************************************************************************/
+
+static void dspshOutNbr(INT32U nbr, SHELL_OUT_FNCT out_fnct, SHELL_CMD_PARAM *pcmd_param) {
+    CPU_CHAR nbr_strg[11];
+
+    (void)Str_FmtNbr_Int32U(nbr, 10, DEF_NBR_BASE_DEC, '\0', DEF_NO, DEF_YES, nbr_strg);
+    (void)out_fnct(nbr_strg, (CPU_INT16U)Str_Len(nbr_strg), pcmd_param->pout_opt);
+}
@@ -0,0 +1,179 @@
+/*******************************************************************************************
+* DSPSpectrum.c
+* Real-time spectrum analyzer stage. When enabled, each block of the selected buffer is
+* converted to float, Hann windowed and transformed with the CMSIS real FFT. The power
+* spectrum |X[k]|^2 is averaged exponentially:
+*   avg[k] += (p[k] - avg[k])/2^avg_shift
+* The shell reads a copy of the average without stopping the DMA or the CODEC.
+* If the block is longer than FFT_LENGTH only the last FFT_LENGTH samples are analyzed.
+* Shorter blocks are collected until there are FFT_LENGTH samples to analyze.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPSpectrum.h"
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static arm_rfft_fast_instance_f32 dspSpecFft;
+static float32_t dspSpecWindow[FFT_LENGTH];
+static float32_t dspSpecTime[FFT_LENGTH];
+static float32_t dspSpecFreq[FFT_LENGTH];
+static float32_t dspSpecPower[DSP_SPEC_BINS];
+static float32_t dspSpecAvg[DSP_SPEC_BINS];
+static q31_t dspSpecCollect[FFT_LENGTH];        //Short blocks waiting for a full frame
+static INT32U dspSpecFill = 0;
+static BUFF_ID_T dspSpecBuffId = LEFT_OUT;
+static INT8U dspSpecEnabled = 0;
+static INT8U dspSpecAvgShift = 3;
+static INT32U dspSpecFrames = 0;
+
+/*******************************************************************************************
+* DSPSpectrumInit - Initializes the FFT instance and the Hann window. The analyzer starts
+* disabled.
+*******************************************************************************************/
+void DSPSpectrumInit(void){
+    INT32U i;
+
+    (void)arm_rfft_fast_init_f32(&dspSpecFft, FFT_LENGTH);
+    for(i=0;i<FFT_LENGTH;i++){
+        dspSpecWindow[i] = 0.5f - 0.5f*arm_cos_f32(2*PI*i/FFT_LENGTH);
+    }
+    dspSpecEnabled = 0;
+    DSPSpectrumReset();
+}
+
+/*******************************************************************************************
+* DSPSpectrumProcess - Analyzes one block of the selected buffer. in[] and out[] are the
+* block pointers of each input and output channel passed to the chain.
+*******************************************************************************************/
+void DSPSpectrumProcess(q31_t *const in[], q31_t *const out[], INT32U block_size){
+    q31_t *src;
+    float32_t weight;
+    INT32U k;
+    CPU_SR_ALLOC();
+
+    if(dspSpecEnabled == 0){
+        return;
+    }else{
+    }
+    switch(dspSpecBuffId){
+    case LEFT_IN:
+        src = in[DSP_LEFT_CH];
+        break;
+    case RIGHT_IN:
+        src = in[DSP_RIGHT_CH];
+        break;
+    case RIGHT_OUT:
+        src = out[DSP_RIGHT_CH];
+        break;
+    case LEFT_OUT:
+    default:
+        src = out[DSP_LEFT_CH];
+        break;
+    }
+    if(block_size < FFT_LENGTH){
+        arm_copy_q31(src, &dspSpecCollect[dspSpecFill], block_size);
+        dspSpecFill += block_size;
+        if(dspSpecFill < FFT_LENGTH){
+            return;
+        }else{
+        }
+        dspSpecFill = 0;
+        src = &dspSpecCollect[0];
+    }else{
+        src += block_size - FFT_LENGTH;
+    }
+
+    arm_q31_to_float(src, &dspSpecTime[0], FFT_LENGTH);
+    arm_mult_f32(&dspSpecTime[0], &dspSpecWindow[0], &dspSpecTime[0], FFT_LENGTH);
+    arm_rfft_fast_f32(&dspSpecFft, &dspSpecTime[0], &dspSpecFreq[0], 0);
+
+    //Bin 0 holds DC in the real part and Nyquist in the imaginary part. Keep DC.
+    arm_cmplx_mag_squared_f32(&dspSpecFreq[0], &dspSpecPower[0], DSP_SPEC_BINS);
+    dspSpecPower[0] = dspSpecFreq[0]*dspSpecFreq[0];
+
+    //The first frame seeds the average so it does not ramp up from zero
+    if(dspSpecFrames == 0){
+        weight = 1.0f;
+    }else{
+        weight = 1.0f/(float32_t)(1u << dspSpecAvgShift);
+    }
+    CPU_CRITICAL_ENTER();
+    for(k=0;k<DSP_SPEC_BINS;k++){
+        dspSpecAvg[k] += weight*(dspSpecPower[k] - dspSpecAvg[k]);
+    }
+    dspSpecFrames++;
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* DSPSpectrumEnable - Starts analyzing buff_id and restarts the average
+*******************************************************************************************/
+void DSPSpectrumEnable(BUFF_ID_T buff_id){
+    dspSpecEnabled = 0;
+    dspSpecBuffId = buff_id;
+    DSPSpectrumReset();
+    dspSpecEnabled = 1;
+}
+
+/*******************************************************************************************
+* DSPSpectrumDisable - Stops the analyzer. The last average is kept.
+*******************************************************************************************/
+void DSPSpectrumDisable(void){
+    dspSpecEnabled = 0;
+}
+
+/*******************************************************************************************
+* DSPSpectrumIsEnabled
+*******************************************************************************************/
+INT8U DSPSpectrumIsEnabled(void){
+    return dspSpecEnabled;
+}
+
+/*******************************************************************************************
+* DSPSpectrumAvgSet - Sets the averaging weight to 1/2^avg_shift. 0 disables averaging.
+*******************************************************************************************/
+INT8U DSPSpectrumAvgSet(INT8U avg_shift){
+    if(avg_shift > DSP_SPEC_AVG_SHIFT_MAX){
+        return 1;
+    }else{
+        dspSpecAvgShift = avg_shift;
+        return 0;
+    }
+}
+
+/*******************************************************************************************
+* DSPSpectrumReset - Clears the average and any partly collected frame
+*******************************************************************************************/
+void DSPSpectrumReset(void){
+    INT32U k;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    for(k=0;k<DSP_SPEC_BINS;k++){
+        dspSpecAvg[k] = 0.0f;
+    }
+    dspSpecFrames = 0;
+    dspSpecFill = 0;
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* DSPSpectrumGet - Copies the averaged power spectrum, DSP_SPEC_BINS values, and returns
+* the number of frames averaged. Bin k is at k*fs/FFT_LENGTH Hz.
+*******************************************************************************************/
+INT32U DSPSpectrumGet(float32_t *power){
+    INT32U frames;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    arm_copy_f32(&dspSpecAvg[0], power, DSP_SPEC_BINS);
+    frames = dspSpecFrames;
+    CPU_CRITICAL_EXIT();
+    return frames;
+}
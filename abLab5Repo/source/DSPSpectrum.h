@@ -0,0 +1,34 @@
+/*****************************************************************************************************
+* DSPSpectrum.h
+* Real-time spectrum analyzer. Runs a windowed real FFT on each block of one buffer and keeps
+* an exponentially averaged power spectrum that the shell can dump while audio runs.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_SPECTRUM_PRESENT
+#define  DSP_SPECTRUM_PRESENT
+
+/*****************************************************************************************************
+* Analyzer configuration constants
+*****************************************************************************************************/
+#define FFT_LENGTH      512
+//Supported Lengths: 32, 64, 128, 256, 512, 1024, 2048
+                                //Shorter blocks are collected into one frame
+#define DSP_SPEC_BINS           (FFT_LENGTH/2)
+#define DSP_SPEC_AVG_SHIFT_MAX  10              //Averaging weight is 1/2^shift
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPSpectrumInit(void);
+void DSPSpectrumProcess(q31_t *const in[], q31_t *const out[], INT32U block_size);
+void DSPSpectrumEnable(BUFF_ID_T buff_id);
+void DSPSpectrumDisable(void);
+INT8U DSPSpectrumIsEnabled(void);
+INT8U DSPSpectrumAvgSet(INT8U avg_shift);
+void DSPSpectrumReset(void);
+INT32U DSPSpectrumGet(float32_t *power);
+
+#endif
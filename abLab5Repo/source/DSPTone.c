@@ -0,0 +1,371 @@
+/*******************************************************************************************
+* DSPTone.c
+* Goertzel tone detector bank. When enabled, each block of the selected buffer is converted
+* to float and every tone runs the Goertzel recurrence
+*   s[n] = x[n] + c*s[n-1] - s[n-2],  c = 2*cos(2*pi*f/fs)
+* At the end of each window of N samples the level is
+*   |X(f)|^2 = s[N-1]^2 + s[N-2]^2 - c*s[N-1]*s[N-2]
+* scaled by (2/N)^2 so a full scale sine reads 1.0. The window is rectangular and may span
+* blocks. Each tone costs two floating point operations per sample against the
+* log2(FFT_LENGTH) butterflies per sample of DSPSpectrum, so a few tones are much cheaper.
+* The tones run two at a time in the sample loop. The M4F FPU has no SIMD, but the two
+* independent recurrences fill the multiply-accumulate latency of each other.
+* A tone turns on when its level reaches its threshold and off when it falls
+* DSP_TONE_HYST_DB under it. The shell reads a copy of the levels and the turn on events.
+*******************************************************************************************/
+/******************************************************************************************
+* Include files
+*******************************************************************************************/
+#include "MCUType.h"
+#include "app_cfg.h"
+#include "os.h"
+#include "math.h"
+#include "AppDSP.h"
+#include "DSPTone.h"
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static DSP_TONE_INFO_T dspTones[DSP_TONE_MAX_TONES];
+static float32_t dspToneCoeff[DSP_TONE_MAX_TONES];
+static float32_t dspToneS1[DSP_TONE_MAX_TONES];          //s[n-1] of each tone
+static float32_t dspToneS2[DSP_TONE_MAX_TONES];          //s[n-2] of each tone
+static float32_t dspToneOnLevel[DSP_TONE_MAX_TONES];
+static float32_t dspToneOffLevel[DSP_TONE_MAX_TONES];
+static float32_t dspToneData[DSP_BLOCK_SIZE_MAX];
+static INT8U dspToneNum = 0;
+static INT32U dspToneWindow = DSP_TONE_WINDOW_DEF;
+static INT32U dspToneFill = 0;                           //Samples in the current window
+static INT32U dspToneWindows = 0;
+static INT32U dspToneSrate = 0;
+static BUFF_ID_T dspToneBuffId = LEFT_IN;
+static INT8U dspToneEnabled = 0;
+
+/******************************************************************************************
+* Private function prototypes
+*******************************************************************************************/
+static void dspToneSetup(INT8U index);
+static void dspToneRun(const float32_t *data, INT32U num_samples, INT8U num_tones);
+static void dspToneWindowEnd(INT8U num_tones);
+
+/*******************************************************************************************
+* DSPToneInit - Starts with the 20 kHz carrier as the only tone. The detector starts
+* disabled and measures nothing until DSPToneRateSet() gives it the sample rate.
+*******************************************************************************************/
+void DSPToneInit(void){
+    dspToneEnabled = 0;
+    dspToneSrate = 0;
+    dspToneNum = 0;
+    dspTones[0].freq_hz = DSP_TONE_CARRIER_HZ;
+    dspTones[0].thresh_db = DSP_TONE_CARRIER_DB;
+    dspToneSetup(0);
+    dspToneNum = 1;
+    DSPToneReset();
+}
+
+/*******************************************************************************************
+* DSPToneProcess - Runs the tones over one block of the selected buffer. in[] and out[] are
+* the block pointers of each input and output channel passed to the chain.
+*******************************************************************************************/
+void DSPToneProcess(q31_t *const in[], q31_t *const out[], INT32U block_size){
+    q31_t *src;
+    INT32U pos = 0;
+    INT32U num_samples;
+    INT8U num_tones = dspToneNum;
+
+    if((dspToneEnabled == 0) || (num_tones == 0)){
+        return;
+    }else{
+    }
+    switch(dspToneBuffId){
+    case RIGHT_IN:
+        src = in[DSP_RIGHT_CH];
+        break;
+    case LEFT_OUT:
+        src = out[DSP_LEFT_CH];
+        break;
+    case RIGHT_OUT:
+        src = out[DSP_RIGHT_CH];
+        break;
+    case LEFT_IN:
+    default:
+        src = in[DSP_LEFT_CH];
+        break;
+    }
+    arm_q31_to_float(src, &dspToneData[0], block_size);
+    while(pos < block_size){
+        num_samples = dspToneWindow - dspToneFill;
+        if(num_samples > (block_size - pos)){
+            num_samples = block_size - pos;
+        }else{
+        }
+        dspToneRun(&dspToneData[pos], num_samples, num_tones);
+        pos += num_samples;
+        dspToneFill += num_samples;
+        if(dspToneFill >= dspToneWindow){
+            dspToneWindowEnd(num_tones);
+            dspToneFill = 0;
+        }else{
+        }
+    }
+}
+
+/*******************************************************************************************
+* dspToneRun - Advances the recurrence of every tone over num_samples samples, two tones
+* per pass over the samples.
+*******************************************************************************************/
+static void dspToneRun(const float32_t *data, INT32U num_samples, INT8U num_tones){
+    float32_t x;
+    float32_t c0, s0_1, s0_2, s0;
+    float32_t c1, s1_1, s1_2, s1;
+    INT32U i;
+    INT8U t;
+
+    for(t=0;(t + 1)<num_tones;t+=2){
+        c0 = dspToneCoeff[t];
+        s0_1 = dspToneS1[t];
+        s0_2 = dspToneS2[t];
+        c1 = dspToneCoeff[t + 1];
+        s1_1 = dspToneS1[t + 1];
+        s1_2 = dspToneS2[t + 1];
+        for(i=0;i<num_samples;i++){
+            x = data[i];
+            s0 = x + c0*s0_1 - s0_2;
+            s1 = x + c1*s1_1 - s1_2;
+            s0_2 = s0_1;
+            s0_1 = s0;
+            s1_2 = s1_1;
+            s1_1 = s1;
+        }
+        dspToneS1[t] = s0_1;
+        dspToneS2[t] = s0_2;
+        dspToneS1[t + 1] = s1_1;
+        dspToneS2[t + 1] = s1_2;
+    }
+    if(t < num_tones){
+        c0 = dspToneCoeff[t];
+        s0_1 = dspToneS1[t];
+        s0_2 = dspToneS2[t];
+        for(i=0;i<num_samples;i++){
+            s0 = data[i] + c0*s0_1 - s0_2;
+            s0_2 = s0_1;
+            s0_1 = s0;
+        }
+        dspToneS1[t] = s0_1;
+        dspToneS2[t] = s0_2;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* dspToneWindowEnd - Publishes the level of each tone at the end of a window, updates the
+* on/off state and restarts the recurrences.
+*******************************************************************************************/
+static void dspToneWindowEnd(INT8U num_tones){
+    float32_t scale = 4.0f/((float32_t)dspToneFill*(float32_t)dspToneFill);
+    float32_t power;
+    INT8U t;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    dspToneWindows++;
+    for(t=0;t<num_tones;t++){
+        if(dspTones[t].valid != 0){
+            power = scale*(dspToneS1[t]*dspToneS1[t] + dspToneS2[t]*dspToneS2[t]
+                           - dspToneCoeff[t]*dspToneS1[t]*dspToneS2[t]);
+            dspTones[t].power = power;
+            if((dspTones[t].on == 0) && (power >= dspToneOnLevel[t])){
+                dspTones[t].on = 1;
+                dspTones[t].on_count++;
+                dspTones[t].on_window = dspToneWindows;
+            }else if((dspTones[t].on != 0) && (power < dspToneOffLevel[t])){
+                dspTones[t].on = 0;
+            }else{
+            }
+        }else{
+        }
+        dspToneS1[t] = 0.0f;
+        dspToneS2[t] = 0.0f;
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* dspToneSetup - Computes the coefficient and threshold levels of one tone for the current
+* sample rate and clears its state. Call in a critical section once the tone is in use.
+*******************************************************************************************/
+static void dspToneSetup(INT8U index){
+    DSP_TONE_INFO_T *tone = &dspTones[index];
+
+    if((dspToneSrate != 0) && ((2*tone->freq_hz) < dspToneSrate)){
+        tone->valid = 1;
+        dspToneCoeff[index] = 2.0f*arm_cos_f32(2*PI*(float32_t)tone->freq_hz/(float32_t)dspToneSrate);
+    }else{
+        tone->valid = 0;
+        dspToneCoeff[index] = 0.0f;
+    }
+    dspToneOnLevel[index] = powf(10.0f, (float32_t)tone->thresh_db/10.0f);
+    dspToneOffLevel[index] = powf(10.0f, (float32_t)(tone->thresh_db - DSP_TONE_HYST_DB)/10.0f);
+    dspToneS1[index] = 0.0f;
+    dspToneS2[index] = 0.0f;
+    tone->on = 0;
+    tone->on_count = 0;
+    tone->on_window = 0;
+    tone->power = 0.0f;
+}
+
+/*******************************************************************************************
+* DSPToneEnable - Starts measuring buff_id and restarts the windows and events
+*******************************************************************************************/
+void DSPToneEnable(BUFF_ID_T buff_id){
+    dspToneEnabled = 0;
+    dspToneBuffId = buff_id;
+    DSPToneReset();
+    dspToneEnabled = 1;
+}
+
+/*******************************************************************************************
+* DSPToneDisable - Stops the detector. The last levels are kept.
+*******************************************************************************************/
+void DSPToneDisable(void){
+    dspToneEnabled = 0;
+}
+
+/*******************************************************************************************
+* DSPToneIsEnabled
+*******************************************************************************************/
+INT8U DSPToneIsEnabled(void){
+    return dspToneEnabled;
+}
+
+/*******************************************************************************************
+* DSPToneAdd - Adds a tone at freq_hz that turns on at thresh_db dBFS. The frequency must be
+* under Nyquist for the current sample rate. A tone past Nyquist after a later rate change
+* is kept but not measured.
+*******************************************************************************************/
+INT8U DSPToneAdd(INT32U freq_hz, INT8S thresh_db){
+    CPU_SR_ALLOC();
+
+    if(dspToneNum >= DSP_TONE_MAX_TONES){
+        return DSP_TONE_ERR_FULL;
+    }else if((freq_hz == 0) || ((2*freq_hz) >= dspToneSrate)){
+        return DSP_TONE_ERR_FREQ;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    dspTones[dspToneNum].freq_hz = freq_hz;
+    dspTones[dspToneNum].thresh_db = thresh_db;
+    dspToneSetup(dspToneNum);
+    dspToneNum++;
+    CPU_CRITICAL_EXIT();
+    return DSP_TONE_ERR_NONE;
+}
+
+/*******************************************************************************************
+* DSPToneRemove - Removes tone index. The tones after it move down one place.
+*******************************************************************************************/
+INT8U DSPToneRemove(INT8U index){
+    INT8U t;
+    CPU_SR_ALLOC();
+
+    if(index >= dspToneNum){
+        return DSP_TONE_ERR_INDEX;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    for(t=index;(t + 1)<dspToneNum;t++){
+        dspTones[t] = dspTones[t + 1];
+        dspToneCoeff[t] = dspToneCoeff[t + 1];
+        dspToneS1[t] = dspToneS1[t + 1];
+        dspToneS2[t] = dspToneS2[t + 1];
+        dspToneOnLevel[t] = dspToneOnLevel[t + 1];
+        dspToneOffLevel[t] = dspToneOffLevel[t + 1];
+    }
+    dspToneNum--;
+    CPU_CRITICAL_EXIT();
+    return DSP_TONE_ERR_NONE;
+}
+
+/*******************************************************************************************
+* DSPToneClear - Removes every tone
+*******************************************************************************************/
+void DSPToneClear(void){
+    dspToneNum = 0;
+}
+
+/*******************************************************************************************
+* DSPToneWindowSet - Sets the samples per window, DSP_TONE_WINDOW_MIN to
+* DSP_TONE_WINDOW_MAX, and restarts the windows.
+*******************************************************************************************/
+INT8U DSPToneWindowSet(INT32U window){
+    if((window < DSP_TONE_WINDOW_MIN) || (window > DSP_TONE_WINDOW_MAX)){
+        return DSP_TONE_ERR_WINDOW;
+    }else{
+        dspToneWindow = window;
+        DSPToneReset();
+        return DSP_TONE_ERR_NONE;
+    }
+}
+
+/*******************************************************************************************
+* DSPToneWindowGet
+*******************************************************************************************/
+INT32U DSPToneWindowGet(void){
+    return dspToneWindow;
+}
+
+/*******************************************************************************************
+* DSPToneRateSet - Retunes every tone for the sample rate srate in Hz. Called by
+* DSPSampleRateSet(). The tones keep their frequencies in Hz and their events restart.
+*******************************************************************************************/
+void DSPToneRateSet(INT32U srate){
+    INT8U t;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    dspToneSrate = srate;
+    for(t=0;t<dspToneNum;t++){
+        dspToneSetup(t);
+    }
+    dspToneFill = 0;
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* DSPToneReset - Clears the levels, events and the partly collected window
+*******************************************************************************************/
+void DSPToneReset(void){
+    INT8U t;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    for(t=0;t<dspToneNum;t++){
+        dspToneS1[t] = 0.0f;
+        dspToneS2[t] = 0.0f;
+        dspTones[t].on = 0;
+        dspTones[t].on_count = 0;
+        dspTones[t].on_window = 0;
+        dspTones[t].power = 0.0f;
+    }
+    dspToneFill = 0;
+    dspToneWindows = 0;
+    CPU_CRITICAL_EXIT();
+}
+
+/*******************************************************************************************
+* DSPToneGet - Copies the report of each tone, up to DSP_TONE_MAX_TONES, sets num_tones and
+* returns the number of windows measured.
+*******************************************************************************************/
+INT32U DSPToneGet(DSP_TONE_INFO_T *tones, INT8U *num_tones){
+    INT32U windows;
+    INT8U t;
+    CPU_SR_ALLOC();
+
+    CPU_CRITICAL_ENTER();
+    for(t=0;t<dspToneNum;t++){
+        tones[t] = dspTones[t];
+    }
+    *num_tones = dspToneNum;
+    windows = dspToneWindows;
+    CPU_CRITICAL_EXIT();
+    return windows;
+}
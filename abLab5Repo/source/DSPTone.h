@@ -0,0 +1,65 @@
+/*****************************************************************************************************
+* DSPTone.h
+* Goertzel tone detector bank. Measures the level of a few known frequencies in one buffer, e.g.
+* pilot tones, DTMF or the 20 kHz modulation carrier, for much less than a full FFT, and reports
+* when each tone rises above its threshold.
+*****************************************************************************************************/
+
+/*****************************************************************************************************
+* Module definition against multiple inclusion
+*****************************************************************************************************/
+#ifndef  DSP_TONE_PRESENT
+#define  DSP_TONE_PRESENT
+
+/*****************************************************************************************************
+* Detector configuration constants
+* The levels are measured over a window of samples collected across blocks. A window of N samples
+* resolves tones about 2*fs/N apart.
+*****************************************************************************************************/
+#define DSP_TONE_MAX_TONES      10          //DTMF plus a pilot and a carrier
+#define DSP_TONE_WINDOW_MIN     DSP_BLOCK_SIZE_MIN
+#define DSP_TONE_WINDOW_MAX     4096
+#define DSP_TONE_WINDOW_DEF     1024        //47 Hz resolution at 48 kHz
+#define DSP_TONE_HYST_DB        3           //A tone is off again this far under its threshold
+#define DSP_TONE_CARRIER_HZ     20000       //Default tone, the old cosineVals carrier
+#define DSP_TONE_CARRIER_DB     (-40)
+
+//Error codes
+#define DSP_TONE_ERR_NONE       0
+#define DSP_TONE_ERR_FULL       1
+#define DSP_TONE_ERR_FREQ       2
+#define DSP_TONE_ERR_INDEX      3
+#define DSP_TONE_ERR_WINDOW     4
+
+/*****************************************************************************************************
+* Tone report. power is the level over the last window, 1.0 for a full scale sine. A tone that is
+* at or above Nyquist for the current sample rate is not measured and has valid = 0.
+*****************************************************************************************************/
+typedef struct{
+    INT32U freq_hz;
+    INT8S thresh_db;
+    INT8U valid;
+    INT8U on;                   //At or above the threshold at the last window
+    INT32U on_count;            //Times the tone turned on since the last reset
+    INT32U on_window;           //Window number of the last turn on
+    float32_t power;
+} DSP_TONE_INFO_T;
+
+/*****************************************************************************************************
+* Declaration of project wide FUNCTIONS
+*****************************************************************************************************/
+void DSPToneInit(void);
+void DSPToneProcess(q31_t *const in[], q31_t *const out[], INT32U block_size);
+void DSPToneEnable(BUFF_ID_T buff_id);
+void DSPToneDisable(void);
+INT8U DSPToneIsEnabled(void);
+INT8U DSPToneAdd(INT32U freq_hz, INT8S thresh_db);
+INT8U DSPToneRemove(INT8U index);
+void DSPToneClear(void);
+INT8U DSPToneWindowSet(INT32U window);
+INT32U DSPToneWindowGet(void);
+void DSPToneRateSet(INT32U srate);
+void DSPToneReset(void);
+INT32U DSPToneGet(DSP_TONE_INFO_T *tones, INT8U *num_tones);
+
+#endif
@@ -6,6 +6,7 @@
 #include "MCUType.h"
 #include "app_cfg.h"
 #include "os.h"
+#include "os_app_hooks.h"
 #include "K65TWR_GPIO.h"
 #include "AppDSP.h"
 #include "K65TWR_ClkCfg.h"
@@ -34,7 +35,9 @@ void main(void) {
     OS_ERR  os_err;
 
     K65TWR_BootClock();
+    CPU_Init();                         /* Timestamps and interrupt disable measurement */
     OSInit(&os_err);                    /* Initialize uC/OS-III                         */
+    App_OS_SetAllHooks();               /* Stat hook keeps the 64-bit timestamp running */
 
     OSTaskCreate((OS_TCB     *)&appTaskStartTCB,            /* Create the start task    */
                  (CPU_CHAR   *)"Start Task",
@@ -68,6 +71,9 @@ static void appStartTask(void *p_arg) {
     (void)p_arg;                        /* Avoid compiler warning for unused variable   */
 
     OS_CPU_SysTickInitFreq(SYSTEM_CLOCK);
+#if (OS_CFG_STAT_TASK_EN == DEF_ENABLED)
+    OSStatTaskCPUUsageInit(&os_err);    /* Start the stat task before the other tasks   */
+#endif
     GpioDBugBitsInit();
     DSPInit();
     DSPShell_Init();
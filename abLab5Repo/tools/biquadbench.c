@@ -0,0 +1,224 @@
+/*******************************************************************************************
+* biquadbench.c
+* Host benchmark of the biquad precision modes (dsp_prec). Builds the firmware default
+* chain with DSPInit(), the four section 8748 Hz notch cascade on left and right, and runs
+* it in every DSP_BIQUAD_MODE_x over uniform noise through DSPChainProcess(). For each
+* mode it reports the host ns per sample and the SNR of the left output against a double
+* precision DF1 run of the same q31 coefficients on the same input:
+*   -6 dBFS     noise peaking at -6 dBFS, full q31 resolution
+*   -40 dBFS    the same 34 dB lower, where the filter's own noise floor shows
+*   16-bit      the -6 dBFS noise rounded to 16 bits, as the CODEC delivers it
+* The SNR counts every error of the mode: coefficient rounding, arithmetic rounding and
+* the q31/f32 conversions. The ns per sample include the copy of the input
+* block that DSPChainProcess() does for every channel, shown alone as "copy". Host times
+* only rank the modes on this CPU; the M4 cycles come from dsp_prec on the board.
+*
+* Build from tools/ with any C99 compiler and libm:
+*   cc -std=gnu99 -O2 -include host/MCUType.h -Ihost -I../source -I../board -I../uCOS/uC-CFG
+*      -o biquadbench biquadbench.c host/arm_math.c host/hostbsp.c
+*      ../source/AppDSP_byrne_lab5.c ../source/DSPBiquad.c ../source/DSPCapture.c
+*      ../source/DSPChain.c ../source/DSPConv.c ../source/DSPDesign.c ../source/DSPDyn.c
+*      ../source/DSPLatency.c ../source/DSPMultirate.c ../source/DSPNco.c
+*      ../source/DSPProf.c ../source/DSPSpectrum.c ../source/DSPTone.c -lm
+* Usage:  biquadbench [block_size]        block_size defaults to 512
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "MCUType.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPProf.h"
+#include "DSPDesign.h"
+#include "DSPChain.h"
+
+/******************************************************************************************
+* Benchmark constants
+*******************************************************************************************/
+#define BQB_NUM_SAMPLES     65536u
+#define BQB_BENCH_PASSES    20u         //Passes over the signal for the timing
+#define BQB_NUM_SIGNALS     3
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static const char *const bqbModeNames[DSP_BIQUAD_NUM_MODES] = {"q31", "q31hp", "f32"};
+static q31_t bqbIn[BQB_NUM_SIGNALS][BQB_NUM_SAMPLES];
+static q31_t bqbOut[BQB_NUM_SAMPLES];
+static double bqbRef[BQB_NUM_SAMPLES];
+static q31_t bqbChOut[DSP_NUM_OUT_CHANNELS][DSP_BLOCK_SIZE_MAX];
+static INT32U bqbRandState = 0x2545F491u;
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static INT32U bqbRand(void);
+static void bqbRun(const q31_t *signal, q31_t *left_out, INT32U block_size);
+static void bqbReference(const q31_t *signal, double *ref);
+static double bqbSnr(const q31_t *out, const double *ref);
+static double bqbTime(INT32U block_size);
+static double bqbNs(void);
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(int argc, char *argv[]){
+    INT32U block_size = 512;
+    double copy_ns;
+    double snr[BQB_NUM_SIGNALS];
+    double u;
+    INT32U n;
+    INT8U mode;
+    INT8U sig;
+
+    if(argc > 1){
+        block_size = (INT32U)strtoul(argv[1], 0, 0);
+    }else{
+    }
+    if((block_size < DSP_BLOCK_SIZE_MIN) || (block_size > DSP_BLOCK_SIZE_MAX) ||
+       ((BQB_NUM_SAMPLES % block_size) != 0)){
+        fprintf(stderr, "block_size must divide %u, %u to %u\n", (unsigned)BQB_NUM_SAMPLES,
+                (unsigned)DSP_BLOCK_SIZE_MIN, (unsigned)DSP_BLOCK_SIZE_MAX);
+        return 1;
+    }else{
+    }
+    for(n=0;n<BQB_NUM_SAMPLES;n++){
+        u = ((double)bqbRand()/4294967296.0)*2.0 - 1.0;
+        bqbIn[0][n] = (q31_t)(u*0.5*2147483647.0);
+        bqbIn[1][n] = (q31_t)(u*0.01*2147483647.0);
+        bqbIn[2][n] = (q31_t)(((INT32S)(u*0.5*32767.0 + ((u < 0) ? -0.5 : 0.5))) << 16);
+    }
+
+    DSPInit();
+    printf("default chain, block %u, SNR of the left output against double precision\n",
+           (unsigned)block_size);
+    printf("mode    ns/sample  SNR -6 dBFS  SNR -40 dBFS  SNR 16-bit\n");
+    for(mode=0;mode<DSP_BIQUAD_NUM_MODES;mode++){
+        for(sig=0;sig<BQB_NUM_SIGNALS;sig++){
+            DSPChainBiquadModeSet(mode);
+            bqbRun(bqbIn[sig], bqbOut, block_size);
+            bqbReference(bqbIn[sig], bqbRef);
+            snr[sig] = bqbSnr(bqbOut, bqbRef);
+        }
+        printf("%-6s  %9.2f  %8.1f dB  %9.1f dB  %7.1f dB\n", bqbModeNames[mode],
+               bqbTime(block_size), snr[0], snr[1], snr[2]);
+    }
+    (void)DSPChainClear(DSP_LEFT_CH);
+    (void)DSPChainClear(DSP_RIGHT_CH);
+    copy_ns = bqbTime(block_size);
+    printf("%-6s  %9.2f\n", "copy", copy_ns);
+    return 0;
+}
+
+/*******************************************************************************************
+* bqbRand - xorshift32
+*******************************************************************************************/
+static INT32U bqbRand(void){
+    bqbRandState ^= bqbRandState << 13;
+    bqbRandState ^= bqbRandState >> 17;
+    bqbRandState ^= bqbRandState << 5;
+    return bqbRandState;
+}
+
+/*******************************************************************************************
+* bqbRun - Runs the signal through the chain on every input channel, block by block, and
+* keeps the left output
+*******************************************************************************************/
+static void bqbRun(const q31_t *signal, q31_t *left_out, INT32U block_size){
+    q31_t *in[DSP_NUM_IN_CHANNELS];
+    q31_t *out[DSP_NUM_OUT_CHANNELS];
+    INT32U n;
+    INT8U ch;
+
+    for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+        out[ch] = bqbChOut[ch];
+    }
+    for(n=0;n<BQB_NUM_SAMPLES;n+=block_size){
+        for(ch=0;ch<DSP_NUM_IN_CHANNELS;ch++){
+            in[ch] = (q31_t *)&signal[n];
+        }
+        DSPChainProcess(in, out, block_size);
+        arm_copy_q31(out[DSP_LEFT_CH], &left_out[n], block_size);
+    }
+}
+
+/*******************************************************************************************
+* bqbReference - DF1 cascade in double with the left channel's q31 coefficients and post
+* shift, the coefficients every mode starts from
+*******************************************************************************************/
+static void bqbReference(const q31_t *signal, double *ref){
+    q31_t coeffs[DSP_CHAIN_MAX_BIQUADS*5];
+    double c[DSP_CHAIN_MAX_BIQUADS*5];
+    double state[DSP_CHAIN_MAX_BIQUADS*4] = {0};
+    double *st;
+    double x, y;
+    INT8U num_stages;
+    INT8U post_shift;
+    INT32U n;
+    INT8U s;
+
+    (void)DSPChainBiquadGet(DSP_LEFT_CH, 0, coeffs, &num_stages, &post_shift);
+    for(n=0;n<(INT32U)num_stages*5u;n++){
+        c[n] = (double)coeffs[n]*(double)(1u << post_shift)/2147483648.0;
+    }
+    for(n=0;n<BQB_NUM_SAMPLES;n++){
+        x = (double)signal[n]/2147483648.0;
+        for(s=0;s<num_stages;s++){
+            st = &state[s*4];
+            y = c[s*5]*x + c[s*5+1]*st[0] + c[s*5+2]*st[1] + c[s*5+3]*st[2] + c[s*5+4]*st[3];
+            st[1] = st[0];
+            st[0] = x;
+            st[3] = st[2];
+            st[2] = y;
+            x = y;
+        }
+        ref[n] = x;
+    }
+}
+
+/*******************************************************************************************
+* bqbSnr - Reference power over error power in dB
+*******************************************************************************************/
+static double bqbSnr(const q31_t *out, const double *ref){
+    double sig = 0.0;
+    double err = 0.0;
+    double e;
+    INT32U n;
+
+    for(n=0;n<BQB_NUM_SAMPLES;n++){
+        e = (double)out[n]/2147483648.0 - ref[n];
+        sig += ref[n]*ref[n];
+        err += e*e;
+    }
+    if(err == 0.0){
+        return 999.9;
+    }else{
+        return 10.0*log10(sig/err);
+    }
+}
+
+/*******************************************************************************************
+* bqbTime - Mean host ns per sample and channel of DSPChainProcess() on the -6 dBFS signal
+*******************************************************************************************/
+static double bqbTime(INT32U block_size){
+    double start;
+    INT32U pass;
+
+    start = bqbNs();
+    for(pass=0;pass<BQB_BENCH_PASSES;pass++){
+        bqbRun(bqbIn[0], bqbOut, block_size);
+    }
+    return (bqbNs() - start)/((double)BQB_BENCH_PASSES*BQB_NUM_SAMPLES*DSP_NUM_OUT_CHANNELS);
+}
+
+/*******************************************************************************************
+* bqbNs - Monotonic time in ns
+*******************************************************************************************/
+static double bqbNs(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1.0e9*(double)ts.tv_sec + (double)ts.tv_nsec;
+}
@@ -0,0 +1,306 @@
+/*******************************************************************************************
+* biquadtest.c
+* Host check of the stereo biquad kernel in source/DSPBiquad.c. Runs designed cascades of
+* 1 to 4 sections over pseudo-random left and right signals, in blocks of several sizes so
+* the state is carried across calls, and checks that DSPBiquadStereoQ31() is bit-exact with
+* arm_biquad_cascade_df1_q31() run on each channel. The host arm_math.c follows the CMSIS
+* reference arithmetic, see tools/host/arm_math.h.
+* When built with SSE4.1 it also checks an SSE version of the same kernel, with the left
+* and right channel in the two 64-bit lanes, and times all three. Host timings only show
+* how the loop structure compares on this CPU; the M4 answer comes from dsp_prof with
+* dsp_prec stereo on and off.
+*
+* Build from tools/:
+*   cc -std=gnu99 -O2 -msse4.1 -include host/MCUType.h -Ihost -I../source -I../board
+*      -I../uCOS/uC-CFG -o biquadtest biquadtest.c host/arm_math.c ../source/DSPBiquad.c
+*      ../source/DSPDesign.c -lm
+* Usage:  biquadtest        Exits with 1 if any output differs.
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include <time.h>
+#include "MCUType.h"
+#include "DSPDesign.h"
+#include "DSPBiquad.h"
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
+/******************************************************************************************
+* Test constants
+*******************************************************************************************/
+#define BQT_SRATE           48000u
+#define BQT_MAX_SECTIONS    4
+#define BQT_NUM_SAMPLES     4096u
+#define BQT_BENCH_BLOCK     512u
+#define BQT_BENCH_NS        200000000.0     //Time each kernel for about 0.2 s
+
+typedef void (*BQT_STEREO_FNCT)(const arm_biquad_casd_df1_inst_q31 *left,
+                                const arm_biquad_casd_df1_inst_q31 *right,
+                                const q31_t *left_src, q31_t *left_dst,
+                                const q31_t *right_src, q31_t *right_dst,
+                                INT32U block_size);
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static const DSP_DESIGN_T bqtDesigns[BQT_MAX_SECTIONS] = {
+    {DSP_DESIGN_LP, 1000.0f, 0.707f, 0.0f},
+    {DSP_DESIGN_PEAK, 3000.0f, 2.0f, 12.0f},
+    {DSP_DESIGN_NOTCH, 8748.0f, 10.0f, 0.0f},
+    {DSP_DESIGN_LSHELF, 200.0f, 0.707f, 6.0f}
+};
+static const INT32U bqtBlockSizes[] = {1u, 7u, 64u, 512u};
+static q31_t bqtCoeffs[BQT_MAX_SECTIONS*5];
+static INT8U bqtShift;
+static q31_t bqtInL[BQT_NUM_SAMPLES];
+static q31_t bqtInR[BQT_NUM_SAMPLES];
+static q31_t bqtRefL[BQT_NUM_SAMPLES];
+static q31_t bqtRefR[BQT_NUM_SAMPLES];
+static q31_t bqtOutL[BQT_NUM_SAMPLES];
+static q31_t bqtOutR[BQT_NUM_SAMPLES];
+static INT32U bqtRandState = 0x12345678u;
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static INT32U bqtRand(void);
+static void bqtDesign(INT8U num_sections);
+static void bqtTwoCmsis(const arm_biquad_casd_df1_inst_q31 *left,
+                        const arm_biquad_casd_df1_inst_q31 *right,
+                        const q31_t *left_src, q31_t *left_dst,
+                        const q31_t *right_src, q31_t *right_dst,
+                        INT32U block_size);
+static INT32U bqtCheck(const char *name, BQT_STEREO_FNCT kernel, INT8U num_sections,
+                       INT32U block_size);
+static double bqtBench(BQT_STEREO_FNCT kernel, INT8U num_sections);
+static double bqtNow(void);
+#ifdef __SSE4_1__
+static void bqtStereoSse(const arm_biquad_casd_df1_inst_q31 *left,
+                         const arm_biquad_casd_df1_inst_q31 *right,
+                         const q31_t *left_src, q31_t *left_dst,
+                         const q31_t *right_src, q31_t *right_dst,
+                         INT32U block_size);
+#endif
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(void){
+    INT32U fails = 0;
+    INT32U n;
+    INT8U sections;
+    INT8U b;
+
+    //Half scale keeps the five 64-bit products from overflowing the C accumulator
+    for(n=0;n<BQT_NUM_SAMPLES;n++){
+        bqtInL[n] = (q31_t)bqtRand() >> 1;
+        bqtInR[n] = (q31_t)bqtRand() >> 1;
+    }
+    for(sections=1;sections<=BQT_MAX_SECTIONS;sections++){
+        bqtDesign(sections);
+        for(b=0;b<(sizeof(bqtBlockSizes)/sizeof(bqtBlockSizes[0]));b++){
+            fails += bqtCheck("DSPBiquadStereoQ31", DSPBiquadStereoQ31, sections, bqtBlockSizes[b]);
+#ifdef __SSE4_1__
+            fails += bqtCheck("SSE4.1", bqtStereoSse, sections, bqtBlockSizes[b]);
+#endif
+        }
+    }
+    printf("bit-exact check: %s\n", (fails == 0) ? "pass" : "FAIL");
+
+    printf("ns per stereo sample, block %u:\n", (unsigned)BQT_BENCH_BLOCK);
+    printf("sections  2 x CMSIS  DSPBiquadStereoQ31  SSE4.1\n");
+    for(sections=1;sections<=BQT_MAX_SECTIONS;sections++){
+        bqtDesign(sections);
+        printf("%8u  %9.2f  %18.2f", (unsigned)sections, bqtBench(bqtTwoCmsis, sections),
+               bqtBench(DSPBiquadStereoQ31, sections));
+#ifdef __SSE4_1__
+        printf("  %6.2f\n", bqtBench(bqtStereoSse, sections));
+#else
+        printf("     n/a\n");
+#endif
+    }
+    return (fails == 0) ? 0 : 1;
+}
+
+/*******************************************************************************************
+* bqtRand - xorshift32
+*******************************************************************************************/
+static INT32U bqtRand(void){
+    bqtRandState ^= bqtRandState << 13;
+    bqtRandState ^= bqtRandState >> 17;
+    bqtRandState ^= bqtRandState << 5;
+    return bqtRandState;
+}
+
+/*******************************************************************************************
+* bqtDesign - Designs the first num_sections of bqtDesigns into bqtCoeffs the way the chain
+* does, with one post shift for the cascade
+*******************************************************************************************/
+static void bqtDesign(INT8U num_sections){
+    float32_t designed[BQT_MAX_SECTIONS*5];
+    INT8U shift;
+    INT8U s;
+
+    bqtShift = 0;
+    for(s=0;s<num_sections;s++){
+        (void)DSPDesignBiquad(&bqtDesigns[s], BQT_SRATE, &designed[s*5]);
+        shift = DSPDesignShiftGet(&designed[s*5], 5);
+        if(shift > bqtShift){
+            bqtShift = shift;
+        }else{
+        }
+    }
+    arm_scale_f32(designed, 1.0f/(float32_t)(1u << bqtShift), designed, num_sections*5u);
+    arm_float_to_q31(designed, bqtCoeffs, num_sections*5u);
+}
+
+/*******************************************************************************************
+* bqtTwoCmsis - The path the chain takes with the stereo kernel off
+*******************************************************************************************/
+static void bqtTwoCmsis(const arm_biquad_casd_df1_inst_q31 *left,
+                        const arm_biquad_casd_df1_inst_q31 *right,
+                        const q31_t *left_src, q31_t *left_dst,
+                        const q31_t *right_src, q31_t *right_dst,
+                        INT32U block_size){
+    arm_biquad_cascade_df1_q31(left, left_src, left_dst, block_size);
+    arm_biquad_cascade_df1_q31(right, right_src, right_dst, block_size);
+}
+
+/*******************************************************************************************
+* bqtCheck - Filters the whole signal in blocks with the kernel and with two CMSIS calls
+* and counts the samples that differ
+*******************************************************************************************/
+static INT32U bqtCheck(const char *name, BQT_STEREO_FNCT kernel, INT8U num_sections,
+                       INT32U block_size){
+    arm_biquad_casd_df1_inst_q31 ref_l, ref_r, l, r;
+    q31_t ref_l_state[BQT_MAX_SECTIONS*4], ref_r_state[BQT_MAX_SECTIONS*4];
+    q31_t l_state[BQT_MAX_SECTIONS*4], r_state[BQT_MAX_SECTIONS*4];
+    INT32U diffs = 0;
+    INT32U n;
+
+    arm_biquad_cascade_df1_init_q31(&ref_l, num_sections, bqtCoeffs, ref_l_state, (int8_t)bqtShift);
+    arm_biquad_cascade_df1_init_q31(&ref_r, num_sections, bqtCoeffs, ref_r_state, (int8_t)bqtShift);
+    arm_biquad_cascade_df1_init_q31(&l, num_sections, bqtCoeffs, l_state, (int8_t)bqtShift);
+    arm_biquad_cascade_df1_init_q31(&r, num_sections, bqtCoeffs, r_state, (int8_t)bqtShift);
+    for(n=0;(n+block_size)<=BQT_NUM_SAMPLES;n+=block_size){
+        bqtTwoCmsis(&ref_l, &ref_r, &bqtInL[n], &bqtRefL[n], &bqtInR[n], &bqtRefR[n], block_size);
+        //In place, as the chain runs it
+        arm_copy_q31(&bqtInL[n], &bqtOutL[n], block_size);
+        arm_copy_q31(&bqtInR[n], &bqtOutR[n], block_size);
+        kernel(&l, &r, &bqtOutL[n], &bqtOutL[n], &bqtOutR[n], &bqtOutR[n], block_size);
+    }
+    for(n=0;n<((BQT_NUM_SAMPLES/block_size)*block_size);n++){
+        if((bqtOutL[n] != bqtRefL[n]) || (bqtOutR[n] != bqtRefR[n])){
+            diffs++;
+        }else{
+        }
+    }
+    if(diffs != 0){
+        printf("%s: %u sections, block %u, %u samples differ\n", name, (unsigned)num_sections,
+               (unsigned)block_size, (unsigned)diffs);
+    }else{
+    }
+    return diffs;
+}
+
+/*******************************************************************************************
+* bqtBench - Returns the mean ns per stereo sample of a kernel over BQT_BENCH_BLOCK blocks
+*******************************************************************************************/
+static double bqtBench(BQT_STEREO_FNCT kernel, INT8U num_sections){
+    arm_biquad_casd_df1_inst_q31 l, r;
+    q31_t l_state[BQT_MAX_SECTIONS*4], r_state[BQT_MAX_SECTIONS*4];
+    INT32U blocks = 0;
+    double start;
+    double elapsed;
+
+    arm_biquad_cascade_df1_init_q31(&l, num_sections, bqtCoeffs, l_state, (int8_t)bqtShift);
+    arm_biquad_cascade_df1_init_q31(&r, num_sections, bqtCoeffs, r_state, (int8_t)bqtShift);
+    start = bqtNow();
+    do{
+        kernel(&l, &r, bqtInL, bqtOutL, bqtInR, bqtOutR, BQT_BENCH_BLOCK);
+        blocks++;
+        elapsed = bqtNow() - start;
+    }while(elapsed < BQT_BENCH_NS);
+    return elapsed/((double)blocks*BQT_BENCH_BLOCK);
+}
+
+/*******************************************************************************************
+* bqtNow - Monotonic time in ns
+*******************************************************************************************/
+static double bqtNow(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec*1e9 + (double)ts.tv_nsec;
+}
+
+#ifdef __SSE4_1__
+/*******************************************************************************************
+* bqtStereoSse - DSPBiquadStereoQ31() with left in lane 0 and right in lane 2, so one
+* _mm_mul_epi32() forms the 64-bit product for both channels. The 64-bit accumulators are
+* shifted logically: with a shift of at most 31 the low 32 bits are the same as for an
+* arithmetic shift, and the upper lanes are never read by the next multiply.
+*******************************************************************************************/
+static void bqtStereoSse(const arm_biquad_casd_df1_inst_q31 *left,
+                         const arm_biquad_casd_df1_inst_q31 *right,
+                         const q31_t *left_src, q31_t *left_dst,
+                         const q31_t *right_src, q31_t *right_dst,
+                         INT32U block_size){
+    const q31_t *coeffs = left->pCoeffs;
+    q31_t *l_state = left->pState;
+    q31_t *r_state = right->pState;
+    const q31_t *l_in = left_src;
+    const q31_t *r_in = right_src;
+    __m128i shift = _mm_cvtsi32_si128((int)(31u - (INT32U)left->postShift));
+    INT32U stage = left->numStages;
+    __m128i b0, b1, b2, a1, a2;
+    __m128i x, x1, x2, y1, y2, acc;
+    INT32U n;
+
+    do{
+        b0 = _mm_set1_epi32(coeffs[0]);
+        b1 = _mm_set1_epi32(coeffs[1]);
+        b2 = _mm_set1_epi32(coeffs[2]);
+        a1 = _mm_set1_epi32(coeffs[3]);
+        a2 = _mm_set1_epi32(coeffs[4]);
+        coeffs += 5;
+
+        x1 = _mm_set_epi32(0, r_state[0], 0, l_state[0]);
+        x2 = _mm_set_epi32(0, r_state[1], 0, l_state[1]);
+        y1 = _mm_set_epi32(0, r_state[2], 0, l_state[2]);
+        y2 = _mm_set_epi32(0, r_state[3], 0, l_state[3]);
+
+        for(n=0;n<block_size;n++){
+            x = _mm_set_epi32(0, r_in[n], 0, l_in[n]);
+            acc = _mm_mul_epi32(b0, x);
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(b1, x1));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(b2, x2));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(a1, y1));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(a2, y2));
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = _mm_srl_epi64(acc, shift);
+            left_dst[n] = _mm_cvtsi128_si32(y1);
+            right_dst[n] = _mm_extract_epi32(y1, 2);
+        }
+
+        l_state[0] = _mm_cvtsi128_si32(x1);
+        l_state[1] = _mm_cvtsi128_si32(x2);
+        l_state[2] = _mm_cvtsi128_si32(y1);
+        l_state[3] = _mm_cvtsi128_si32(y2);
+        r_state[0] = _mm_extract_epi32(x1, 2);
+        r_state[1] = _mm_extract_epi32(x2, 2);
+        r_state[2] = _mm_extract_epi32(y1, 2);
+        r_state[3] = _mm_extract_epi32(y2, 2);
+        l_state += 4;
+        r_state += 4;
+
+        l_in = left_dst;
+        r_in = right_dst;
+        stage--;
+    }while(stage > 0u);
+}
+#endif
@@ -0,0 +1,201 @@
+/*******************************************************************************************
+* convbench.c
+* Host benchmark of the partitioned FFT convolution in source/DSPConv.c against the direct
+* form FIR, arm_fir_q31(). For block sizes from DSP_BLOCK_SIZE_MIN to DSP_BLOCK_SIZE_MAX
+* and impulse responses from 16 to DSP_CONV_MAX_TAPS taps it runs -6 dBFS noise through
+* both, checks that they agree (SNR of the FFT output against the FIR output) and reports
+* the host ns per sample of each and the tap count where the FFT convolution becomes the
+* cheaper one. The FIR cost per sample grows with the taps; the FFT cost per sample grows
+* with log2(2L) and with the number of partitions, taps/L, so long responses favour large
+* blocks.
+* Both sides run on the plain C stand-ins in tools/host/arm_math.c, so the crossover is
+* for this host. On the M4 the CMSIS FIR and FFT are both tuned; measure there with
+* dsp_prof on a conv stage and on a FIR stage of the same length.
+*
+* Build from tools/:
+*   cc -std=gnu99 -O2 -include host/MCUType.h -Ihost -I../source -I../board -I../uCOS/uC-CFG
+*      -o convbench convbench.c host/arm_math.c host/hostbsp.c ../source/DSPConv.c -lm
+* Usage:  convbench        Exits with 1 if the FFT and FIR outputs disagree.
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include <time.h>
+#include "MCUType.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPConv.h"
+
+/******************************************************************************************
+* Benchmark constants
+*******************************************************************************************/
+#define CVB_NUM_SAMPLES     16384u
+#define CVB_BENCH_NS        50000000.0      //Time each case for about 50 ms
+#define CVB_MIN_SNR_DB      100.0           //f32 FFT against the q31 FIR
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static const INT16U cvbTaps[] = {16, 32, 64, 128, 256, 512, 1024, 2048};
+static q31_t cvbIr[DSP_CONV_MAX_TAPS];
+static q31_t cvbIrRev[DSP_CONV_MAX_TAPS];
+static q31_t cvbIn[CVB_NUM_SAMPLES];
+static q31_t cvbFir[CVB_NUM_SAMPLES];
+static q31_t cvbConv[CVB_NUM_SAMPLES];
+static q31_t cvbFirState[DSP_CONV_MAX_TAPS + DSP_BLOCK_SIZE_MAX - 1];
+static INT32U cvbRandState = 0x9E3779B9u;
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static INT32U cvbRand(void);
+static double cvbFirRun(INT16U num_taps, INT32U block_size, INT8U timed);
+static double cvbConvRun(INT16U num_taps, INT32U block_size, INT8U timed);
+static double cvbSnr(void);
+static double cvbNs(void);
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(void){
+    INT32U block_size;
+    INT32U fails = 0;
+    INT16U crossover;
+    double fir_ns;
+    double conv_ns;
+    double snr;
+    INT32U n;
+    INT8U t;
+
+    for(n=0;n<CVB_NUM_SAMPLES;n++){
+        cvbIn[n] = (q31_t)cvbRand() >> 1;
+    }
+    //Decaying noise scaled so the sum of |h| stays under one and nothing saturates
+    for(n=0;n<DSP_CONV_MAX_TAPS;n++){
+        cvbIr[n] = (q31_t)cvbRand() >> 12;
+        cvbIr[n] = (q31_t)((double)cvbIr[n]*exp(-4.0*(double)n/DSP_CONV_MAX_TAPS));
+    }
+
+    DSPConvInit();
+    for(block_size=DSP_BLOCK_SIZE_MIN;block_size<=DSP_BLOCK_SIZE_MAX;block_size*=2){
+        DSPConvBlockSizeSet(block_size);
+        crossover = 0;
+        printf("block %u\n", (unsigned)block_size);
+        printf("  taps  FIR ns/sample  FFT ns/sample  FFT SNR\n");
+        for(t=0;t<(sizeof(cvbTaps)/sizeof(cvbTaps[0]));t++){
+            (void)cvbFirRun(cvbTaps[t], block_size, 0);
+            (void)cvbConvRun(cvbTaps[t], block_size, 0);
+            snr = cvbSnr();
+            if(snr < CVB_MIN_SNR_DB){
+                fails++;
+            }else{
+            }
+            fir_ns = cvbFirRun(cvbTaps[t], block_size, 1);
+            conv_ns = cvbConvRun(cvbTaps[t], block_size, 1);
+            if((crossover == 0) && (conv_ns < fir_ns)){
+                crossover = cvbTaps[t];
+            }else{
+            }
+            printf("  %4u  %13.2f  %13.2f  %5.1f dB%s\n", (unsigned)cvbTaps[t], fir_ns, conv_ns,
+                   snr, (snr < CVB_MIN_SNR_DB) ? "  FAIL" : "");
+        }
+        if(crossover != 0){
+            printf("  FFT convolution is cheaper from %u taps\n", (unsigned)crossover);
+        }else{
+            printf("  FIR is cheaper up to %u taps\n", (unsigned)DSP_CONV_MAX_TAPS);
+        }
+    }
+    printf("FFT against FIR: %s\n", (fails == 0) ? "pass" : "FAIL");
+    return (fails == 0) ? 0 : 1;
+}
+
+/*******************************************************************************************
+* cvbRand - xorshift32
+*******************************************************************************************/
+static INT32U cvbRand(void){
+    cvbRandState ^= cvbRandState << 13;
+    cvbRandState ^= cvbRandState >> 17;
+    cvbRandState ^= cvbRandState << 5;
+    return cvbRandState;
+}
+
+/*******************************************************************************************
+* cvbFirRun - Filters the signal with arm_fir_q31() into cvbFir, block by block. If timed
+* it repeats for CVB_BENCH_NS and returns the mean ns per sample.
+*******************************************************************************************/
+static double cvbFirRun(INT16U num_taps, INT32U block_size, INT8U timed){
+    arm_fir_instance_q31 fir;
+    INT32U samples = 0;
+    double start;
+    double elapsed;
+    INT32U n;
+
+    //arm_fir_q31() takes the coefficients in time reversed order
+    for(n=0;n<num_taps;n++){
+        cvbIrRev[n] = cvbIr[num_taps - 1u - n];
+    }
+    arm_fir_init_q31(&fir, num_taps, cvbIrRev, cvbFirState, block_size);
+    start = cvbNs();
+    do{
+        for(n=0;n<CVB_NUM_SAMPLES;n+=block_size){
+            arm_fir_q31(&fir, &cvbIn[n], &cvbFir[n], block_size);
+        }
+        samples += CVB_NUM_SAMPLES;
+        elapsed = cvbNs() - start;
+    }while((timed != 0) && (elapsed < CVB_BENCH_NS));
+    return elapsed/(double)samples;
+}
+
+/*******************************************************************************************
+* cvbConvRun - Filters the signal with a DSPConv instance into cvbConv, as cvbFirRun()
+*******************************************************************************************/
+static double cvbConvRun(INT16U num_taps, INT32U block_size, INT8U timed){
+    INT32U samples = 0;
+    double start;
+    double elapsed;
+    INT32U n;
+    INT8U inst;
+
+    inst = DSPConvCreate(cvbIr, num_taps);
+    start = cvbNs();
+    do{
+        for(n=0;n<CVB_NUM_SAMPLES;n+=block_size){
+            DSPConvProcess(inst, &cvbIn[n], &cvbConv[n], block_size);
+        }
+        samples += CVB_NUM_SAMPLES;
+        elapsed = cvbNs() - start;
+    }while((timed != 0) && (elapsed < CVB_BENCH_NS));
+    DSPConvFree(inst);
+    return elapsed/(double)samples;
+}
+
+/*******************************************************************************************
+* cvbSnr - FIR output power over the power of the FFT output's difference from it, in dB
+*******************************************************************************************/
+static double cvbSnr(void){
+    double sig = 0.0;
+    double err = 0.0;
+    double e;
+    INT32U n;
+
+    for(n=0;n<CVB_NUM_SAMPLES;n++){
+        e = (double)cvbConv[n] - (double)cvbFir[n];
+        sig += (double)cvbFir[n]*(double)cvbFir[n];
+        err += e*e;
+    }
+    if(err == 0.0){
+        return 999.9;
+    }else{
+        return 10.0*log10(sig/err);
+    }
+}
+
+/*******************************************************************************************
+* cvbNs - Monotonic time in ns
+*******************************************************************************************/
+static double cvbNs(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1.0e9*(double)ts.tv_sec + (double)ts.tv_nsec;
+}
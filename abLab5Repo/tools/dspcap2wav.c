@@ -0,0 +1,290 @@
+/*******************************************************************************************
+* dspcap2wav.c
+* Host side decoder for the dsp_cap binary capture stream. Reads a raw recording of the
+* terminal UART, finds the frames described in source/DSPCapture.h, checks their CRC and
+* writes the samples to a WAV file, one WAV channel per captured buffer in l_in, r_in,
+* l_out, r_out order. q15 captures are written as 16-bit PCM, q31 as 32-bit PCM.
+* Frames missing from the sequence are filled with silence so the time base is kept.
+* Bytes that are not part of a good frame, such as shell echo, are skipped.
+*
+* Build with any C99 compiler:  cc -O2 -o dspcap2wav dspcap2wav.c
+* Usage:                        dspcap2wav capture.bin capture.wav
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/******************************************************************************************
+* Stream constants, must match DSPCapture.h
+*******************************************************************************************/
+#define CAP_SYNC            0x50414344u
+#define CAP_HEADER_BYTES    16
+#define CAP_CRC_BYTES       4
+#define CAP_FMT_Q31         0
+#define CAP_FMT_Q15         1
+#define CAP_MASK_ALL        0x0Fu
+#define CAP_GAP_MAX_S       10u     //Longer gaps are not filled, the stream restarted
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static uint32_t capCrcTable[256];
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static void capCrcInit(void);
+static uint32_t capCrc(const uint8_t *buf, size_t len);
+static uint32_t capRd16(const uint8_t *p);
+static uint32_t capRd32(const uint8_t *p);
+static void capWr16(FILE *f, uint32_t v);
+static void capWr32(FILE *f, uint32_t v);
+static void capWavHeader(FILE *f, uint32_t srate, uint32_t num_ch, uint32_t bits,
+                         uint32_t data_bytes);
+static uint8_t *capReadAll(const char *path, size_t *len);
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(int argc, char *argv[]){
+    uint8_t *buf;
+    size_t len;
+    size_t pos = 0;
+    FILE *wav;
+    uint32_t srate = 0;
+    uint32_t fmt = 0;
+    uint32_t mask = 0;
+    uint32_t samples = 0;
+    uint32_t num_ch = 0;
+    uint32_t bytes_per_sample = 0;
+    uint32_t payload;
+    uint32_t f_fmt;
+    uint32_t f_mask;
+    uint32_t f_samples;
+    uint32_t f_ch;
+    uint32_t seq;
+    uint32_t next_seq = 0;
+    uint32_t gap;
+    uint32_t data_bytes = 0;
+    uint32_t frames_ok = 0;
+    uint32_t frames_bad = 0;
+    uint32_t frames_filled = 0;
+    uint32_t frames_other = 0;
+    size_t skipped = 0;
+    uint32_t i;
+    int started = 0;
+
+    if(argc != 3){
+        fprintf(stderr, "Usage: %s capture.bin capture.wav\n", argv[0]);
+        return 1;
+    }
+    buf = capReadAll(argv[1], &len);
+    if(buf == NULL){
+        fprintf(stderr, "Cannot read %s\n", argv[1]);
+        return 1;
+    }
+    wav = fopen(argv[2], "wb");
+    if(wav == NULL){
+        fprintf(stderr, "Cannot write %s\n", argv[2]);
+        free(buf);
+        return 1;
+    }
+    capCrcInit();
+
+    while((pos + CAP_HEADER_BYTES + CAP_CRC_BYTES) <= len){
+        if(capRd32(&buf[pos]) != CAP_SYNC){
+            pos++;
+            skipped++;
+            continue;
+        }
+        //Frame length from the header, then the CRC decides if it is a frame at all
+        f_fmt = buf[pos + 10];
+        f_mask = buf[pos + 11];
+        f_samples = capRd16(&buf[pos + 12]);
+        f_ch = 0;
+        for(i=0;i<4;i++){
+            f_ch += (f_mask >> i) & 1u;
+        }
+        if(((f_mask & ~CAP_MASK_ALL) != 0) || (f_ch == 0) ||
+           ((f_fmt != CAP_FMT_Q31) && (f_fmt != CAP_FMT_Q15)) || (f_samples == 0)){
+            pos++;
+            skipped++;
+            continue;
+        }
+        payload = f_samples*f_ch*((f_fmt == CAP_FMT_Q31) ? 4u : 2u);
+        if((pos + CAP_HEADER_BYTES + payload + CAP_CRC_BYTES) > len){
+            break;
+        }
+        if(capCrc(&buf[pos], CAP_HEADER_BYTES + payload) !=
+           capRd32(&buf[pos + CAP_HEADER_BYTES + payload])){
+            frames_bad++;
+            pos++;
+            skipped++;
+            continue;
+        }
+        seq = capRd32(&buf[pos + 4]);
+        if(started == 0){
+            srate = capRd16(&buf[pos + 8]);
+            fmt = f_fmt;
+            mask = f_mask;
+            samples = f_samples;
+            num_ch = f_ch;
+            bytes_per_sample = (fmt == CAP_FMT_Q31) ? 4u : 2u;
+            capWavHeader(wav, srate, num_ch, bytes_per_sample*8u, 0);
+            next_seq = seq;
+            started = 1;
+        }else if((capRd16(&buf[pos + 8]) != srate) || (f_fmt != fmt) || (f_mask != mask) ||
+                 (f_samples != samples)){
+            //Settings changed during the recording, keep the first settings only
+            frames_other++;
+            pos += CAP_HEADER_BYTES + payload + CAP_CRC_BYTES;
+            continue;
+        }else{
+        }
+        gap = seq - next_seq;
+        if((gap != 0) && (gap <= ((CAP_GAP_MAX_S*srate)/samples))){
+            for(i=0;i<(gap*payload);i++){
+                (void)fputc(0, wav);
+            }
+            data_bytes += gap*payload;
+            frames_filled += gap;
+        }else{
+        }
+        //Samples are already interleaved little-endian PCM
+        (void)fwrite(&buf[pos + CAP_HEADER_BYTES], 1, payload, wav);
+        data_bytes += payload;
+        frames_ok++;
+        next_seq = seq + 1u;
+        pos += CAP_HEADER_BYTES + payload + CAP_CRC_BYTES;
+    }
+
+    if(started != 0){
+        (void)fseek(wav, 0, SEEK_SET);
+        capWavHeader(wav, srate, num_ch, bytes_per_sample*8u, data_bytes);
+    }else{
+    }
+    (void)fclose(wav);
+    free(buf);
+
+    printf("frames: %u good, %u bad CRC, %u filled, %u other settings\n",
+           frames_ok, frames_bad, frames_filled, frames_other);
+    printf("bytes skipped: %lu\n", (unsigned long)skipped);
+    if(started != 0){
+        printf("%u Hz, %u channels, %u bits, %.2f s\n", srate, num_ch, bytes_per_sample*8u,
+               (double)data_bytes/(double)(num_ch*bytes_per_sample)/(double)srate);
+        return 0;
+    }else{
+        fprintf(stderr, "No frames found\n");
+        return 2;
+    }
+}
+
+/*******************************************************************************************
+* capCrcInit - CRC-32 table, IEEE 802.3 reflected polynomial
+*******************************************************************************************/
+static void capCrcInit(void){
+    uint32_t crc;
+    uint32_t i;
+    int bit;
+
+    for(i=0;i<256;i++){
+        crc = i;
+        for(bit=0;bit<8;bit++){
+            crc = ((crc & 1u) != 0) ? ((crc >> 1) ^ 0xEDB88320u) : (crc >> 1);
+        }
+        capCrcTable[i] = crc;
+    }
+}
+
+/*******************************************************************************************
+* capCrc - CRC-32 of len bytes
+*******************************************************************************************/
+static uint32_t capCrc(const uint8_t *buf, size_t len){
+    uint32_t crc = 0xFFFFFFFFu;
+    size_t i;
+
+    for(i=0;i<len;i++){
+        crc = capCrcTable[(crc ^ buf[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/*******************************************************************************************
+* capRd16, capRd32 - Little-endian reads
+*******************************************************************************************/
+static uint32_t capRd16(const uint8_t *p){
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t capRd32(const uint8_t *p){
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*******************************************************************************************
+* capWr16, capWr32 - Little-endian writes
+*******************************************************************************************/
+static void capWr16(FILE *f, uint32_t v){
+    (void)fputc((int)(v & 0xFFu), f);
+    (void)fputc((int)((v >> 8) & 0xFFu), f);
+}
+
+static void capWr32(FILE *f, uint32_t v){
+    capWr16(f, v & 0xFFFFu);
+    capWr16(f, v >> 16);
+}
+
+/*******************************************************************************************
+* capWavHeader - Writes a 44 byte PCM WAV header for data_bytes of samples
+*******************************************************************************************/
+static void capWavHeader(FILE *f, uint32_t srate, uint32_t num_ch, uint32_t bits,
+                         uint32_t data_bytes){
+    (void)fwrite("RIFF", 1, 4, f);
+    capWr32(f, 36u + data_bytes);
+    (void)fwrite("WAVEfmt ", 1, 8, f);
+    capWr32(f, 16u);
+    capWr16(f, 1u);                                 //PCM
+    capWr16(f, num_ch);
+    capWr32(f, srate);
+    capWr32(f, srate*num_ch*(bits/8u));
+    capWr16(f, num_ch*(bits/8u));
+    capWr16(f, bits);
+    (void)fwrite("data", 1, 4, f);
+    capWr32(f, data_bytes);
+}
+
+/*******************************************************************************************
+* capReadAll - Reads a whole file into a malloc'd buffer
+*******************************************************************************************/
+static uint8_t *capReadAll(const char *path, size_t *len){
+    FILE *f;
+    uint8_t *buf = NULL;
+    uint8_t *grown;
+    size_t size = 0;
+    size_t cap = 0;
+    size_t got;
+
+    f = fopen(path, "rb");
+    if(f == NULL){
+        return NULL;
+    }
+    do{
+        if(size == cap){
+            cap = (cap == 0) ? 65536u : cap*2u;
+            grown = realloc(buf, cap);
+            if(grown == NULL){
+                free(buf);
+                (void)fclose(f);
+                return NULL;
+            }
+            buf = grown;
+        }
+        got = fread(&buf[size], 1, cap - size, f);
+        size += got;
+    }while(got != 0);
+    (void)fclose(f);
+    *len = size;
+    return buf;
+}
@@ -0,0 +1,410 @@
+/*******************************************************************************************
+* dsphost.c
+* Host harness for the block processing. Runs the firmware DSPInit() and DSPBlockProcess()
+* on a Linux host over a WAV file, with the DMA, uC/OS-III, I2S and the CODEC replaced by
+* the stand-ins in tools/host. The harness plays the DMA: it writes each input block into
+* the ring in the arena layout of AppDSP.h, calls DSPBlockProcess() for that ring block,
+* as dspTask() does after DMAInPend(), and collects the output block.
+* Each call is timed with the DWT cycle counter, as dspTask() does, and added to the
+* DSPProf block profile. The host DWT counts ns from clock_gettime() (tools/host), so the
+* results are in ns. They are compared with the block deadline, block_size/fs, and the
+* block and per-stage profiles are printed as dsp_prof shows them on the board. The numbers
+* are host times, they show whether a change makes the processing cheaper or dearer and
+* how the cost scales with the block size. The M4 numbers come from dsp_bench and dsp_prof
+* on the board.
+*
+* Build from tools/ with any C99 compiler and libm:
+*   cc -std=gnu99 -O2 -include host/MCUType.h -Ihost -I../source -I../board -I../uCOS/uC-CFG
+*      -o dsphost dsphost.c host/arm_math.c host/hostbsp.c ../source/AppDSP_byrne_lab5.c
+*      ../source/DSPBiquad.c ../source/DSPCapture.c ../source/DSPChain.c ../source/DSPConv.c
+*      ../source/DSPDesign.c ../source/DSPDyn.c ../source/DSPLatency.c
+*      ../source/DSPMultirate.c ../source/DSPNco.c ../source/DSPProf.c
+*      ../source/DSPSpectrum.c ../source/DSPTone.c -lm
+* Usage:
+*   dsphost [-b block_size] [-n num_blocks] [-x repeat] in.wav [out.wav]
+*   The input is 16, 24 or 32-bit PCM or 32-bit float at one of the CODEC sample rates.
+*   WAV channel ch feeds input channel ch, a mono file feeds every input. out.wav is
+*   32-bit PCM with one channel per output. -x runs the file repeat times for steadier
+*   timing, only the first pass is written.
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MCUType.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPProf.h"
+#include "DSPDesign.h"
+#include "DSPChain.h"
+#include "hostbsp.h"
+
+/******************************************************************************************
+* Private defines
+*******************************************************************************************/
+#define HOST_WAV_PCM        1
+#define HOST_WAV_FLOAT      3
+#define HOST_WAV_EXT        0xFFFE
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+//CODEC rate codes, the same order as dspCodeToRate[] in AppDSP_byrne_lab5.c
+static const INT32U hostRates[] = {48000, 32000, 24000, 19200, 16000, 13700,
+                                   12000, 10700, 9600, 8700, 8000};
+//DSP_STAGE_TYPE_T order
+static const char *const hostStageNames[] = {"bypass", "biquad", "fir", "gain", "mix", "conv",
+                                             "rate", "dyn", "mod"};
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static q31_t *hostWavRead(const char *path, INT32U *srate, INT32U *num_ch, INT32U *frames);
+static int hostWavWrite(const char *path, const q31_t *samples, INT32U srate, INT32U num_ch,
+                        INT32U frames);
+static INT32U hostRd16(const INT8U *p);
+static INT32U hostRd32(const INT8U *p);
+static void hostWr16(FILE *f, INT32U v);
+static void hostWr32(FILE *f, INT32U v);
+static void hostProfPrint(const char *label, const DSP_PROF_T *prof);
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(int argc, char *argv[]){
+    HOST_DMA_RING_T ring;
+    const char *in_path = NULL;
+    const char *out_path = NULL;
+    q31_t *in_wav;
+    q31_t *out_wav;
+    INT32U block_size = DSP_SAMPLES_PER_BLOCK;
+    INT32U num_blocks = DSP_NUM_BLOCKS;
+    INT32U repeat = 1;
+    INT32U srate = 0;
+    INT32U wav_ch;
+    INT32U frames;
+    INT32U num_full;
+    INT32U rate_code;
+    INT32U pass;
+    INT32U blk;
+    INT32U seq = 0;
+    INT32U i;
+    INT8U buffer_index;
+    INT8U ch;
+    INT8U err;
+    INT8U row;
+    INT8U stage;
+    DSP_PROF_T prof;
+    DSP_STAGE_INFO_T info;
+    char label[32];
+    INT32U start_cycles;
+    INT32U block_cycles;
+    double ns;
+    double ns_total = 0.0;
+    double ns_max = 0.0;
+    double deadline_ns;
+    int arg;
+
+    for(arg=1;arg<argc;arg++){
+        if((strcmp(argv[arg], "-b") == 0) && ((arg + 1) < argc)){
+            block_size = (INT32U)atoi(argv[++arg]);
+        }else if((strcmp(argv[arg], "-n") == 0) && ((arg + 1) < argc)){
+            num_blocks = (INT32U)atoi(argv[++arg]);
+        }else if((strcmp(argv[arg], "-x") == 0) && ((arg + 1) < argc)){
+            repeat = (INT32U)atoi(argv[++arg]);
+        }else if(in_path == NULL){
+            in_path = argv[arg];
+        }else if(out_path == NULL){
+            out_path = argv[arg];
+        }else{
+            in_path = NULL;
+            break;
+        }
+    }
+    if((in_path == NULL) || (repeat == 0)){
+        fprintf(stderr, "usage: dsphost [-b block_size] [-n num_blocks] [-x repeat] in.wav [out.wav]\n");
+        return 1;
+    }else{
+    }
+    in_wav = hostWavRead(in_path, &srate, &wav_ch, &frames);
+    if(in_wav == NULL){
+        return 1;
+    }else{
+    }
+    for(rate_code=0;rate_code<(sizeof(hostRates)/sizeof(hostRates[0]));rate_code++){
+        if(hostRates[rate_code] == srate){
+            break;
+        }else{
+        }
+    }
+    if(rate_code == (sizeof(hostRates)/sizeof(hostRates[0]))){
+        fprintf(stderr, "dsphost: %u Hz is not a CODEC sample rate\n", (unsigned)srate);
+        return 1;
+    }else{
+    }
+
+    //The firmware start up, then the rate and layout asked for
+    DSPInit();
+    DSPSampleRateSet((INT8U)rate_code);
+    err = DSPBlockLayoutSet((INT16U)block_size, (INT8U)num_blocks);
+    if(err != DSP_BLOCK_ERR_NONE){
+        fprintf(stderr, "dsphost: block layout %u x %u refused, error %u\n",
+                (unsigned)block_size, (unsigned)num_blocks, (unsigned)err);
+        return 1;
+    }else{
+    }
+    HostDmaRingGet(&ring);
+    num_full = frames/block_size;
+    out_wav = calloc((size_t)num_full*block_size*DSP_NUM_OUT_CHANNELS, sizeof(q31_t));
+    if(out_wav == NULL){
+        fprintf(stderr, "dsphost: out of memory\n");
+        return 1;
+    }else{
+    }
+
+    for(pass=0;pass<repeat;pass++){
+        for(blk=0;blk<num_full;blk++){
+            buffer_index = (INT8U)(seq % ring.num_blocks);
+            seq++;
+            for(ch=0;ch<DSP_NUM_IN_CHANNELS;ch++){
+                q31_t *dst = HostDmaInBlock(ch, buffer_index);
+                INT32U src_ch = (ch < wav_ch) ? ch : 0;
+                for(i=0;i<block_size;i++){
+                    dst[i] = in_wav[((INT64U)blk*block_size + i)*wav_ch + src_ch];
+                }
+            }
+            start_cycles = DWT->CYCCNT;
+            DSPBlockProcess(buffer_index);
+            block_cycles = DWT->CYCCNT - start_cycles;
+            DSPProfBlockAdd(block_cycles);
+            ns = (double)block_cycles;
+            ns_total += ns;
+            if(ns > ns_max){
+                ns_max = ns;
+            }else{
+            }
+            if(pass == 0){
+                for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+                    const q31_t *src = HostDmaOutBlock(ch, buffer_index);
+                    for(i=0;i<block_size;i++){
+                        out_wav[((INT64U)blk*block_size + i)*DSP_NUM_OUT_CHANNELS + ch] = src[i];
+                    }
+                }
+            }else{
+            }
+        }
+    }
+
+    if(seq == 0){
+        fprintf(stderr, "dsphost: %s is shorter than one block\n", in_path);
+        return 1;
+    }else{
+    }
+    deadline_ns = 1.0e9*block_size/srate;
+    printf("blocks:              %u of %u samples, ring of %u, %u Hz\n", (unsigned)seq,
+           (unsigned)block_size, (unsigned)ring.num_blocks, (unsigned)srate);
+    printf("ns/block mean:       %.0f\n", ns_total/seq);
+    printf("ns/block max:        %.0f\n", ns_max);
+    printf("samples/s:           %.3g per channel\n", 1.0e9*seq*block_size/ns_total);
+    printf("deadline ns:         %.0f\n", deadline_ns);
+    printf("headroom %% mean:     %.1f\n", 100.0*(1.0 - (ns_total/seq)/deadline_ns));
+    printf("headroom %% worst:    %.1f\n", 100.0*(1.0 - ns_max/deadline_ns));
+    printf("profile, ns:         min mean max\n");
+    DSPProfBlockGet(&prof);
+    hostProfPrint("block", &prof);
+    for(row=0;row<DSP_CHAIN_NUM_ROWS;row++){
+        for(stage=0;stage<DSPChainLenGet(row);stage++){
+            if((DSPChainStageInfoGet(row, stage, &info) == DSP_CHAIN_ERR_NONE) &&
+               (DSPChainStageProfGet(row, stage, &prof) == DSP_CHAIN_ERR_NONE)){
+                snprintf(label, sizeof(label), "%s %u %s", (row < DSP_NUM_OUT_CHANNELS) ? "ch" : "sub",
+                         (unsigned)((row < DSP_NUM_OUT_CHANNELS) ? row : (row - DSP_NUM_OUT_CHANNELS)),
+                         hostStageNames[info.type]);
+                hostProfPrint(label, &prof);
+            }else{
+            }
+        }
+    }
+    if(out_path != NULL){
+        if(hostWavWrite(out_path, out_wav, srate, DSP_NUM_OUT_CHANNELS, num_full*block_size) != 0){
+            return 1;
+        }else{
+        }
+    }else{
+    }
+    free(in_wav);
+    free(out_wav);
+    return 0;
+}
+
+/*******************************************************************************************
+* hostWavRead - Reads a PCM or float WAV file into interleaved q31 samples
+*******************************************************************************************/
+static q31_t *hostWavRead(const char *path, INT32U *srate, INT32U *num_ch, INT32U *frames){
+    FILE *f;
+    INT8U *buf;
+    long len;
+    INT32U pos = 12;
+    INT32U chunk;
+    INT32U fmt = 0;
+    INT32U bits = 0;
+    INT32U bytes;
+    const INT8U *data = NULL;
+    INT32U data_len = 0;
+    q31_t *samples;
+    INT32U i;
+    INT32U v;
+    float fv;
+
+    f = fopen(path, "rb");
+    if(f == NULL){
+        perror(path);
+        return NULL;
+    }else{
+    }
+    (void)fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    (void)fseek(f, 0, SEEK_SET);
+    buf = malloc((size_t)len + 1);
+    if((buf == NULL) || (fread(buf, 1, (size_t)len, f) != (size_t)len) || (len < 12) ||
+       (memcmp(buf, "RIFF", 4) != 0) || (memcmp(&buf[8], "WAVE", 4) != 0)){
+        fprintf(stderr, "dsphost: %s is not a WAV file\n", path);
+        fclose(f);
+        return NULL;
+    }else{
+    }
+    fclose(f);
+    *num_ch = 0;
+    while((pos + 8) <= (INT32U)len){
+        chunk = hostRd32(&buf[pos + 4]);
+        if((pos + 8 + chunk) > (INT32U)len){
+            chunk = (INT32U)len - pos - 8;
+        }else{
+        }
+        if((memcmp(&buf[pos], "fmt ", 4) == 0) && (chunk >= 16)){
+            fmt = hostRd16(&buf[pos + 8]);
+            *num_ch = hostRd16(&buf[pos + 10]);
+            *srate = hostRd32(&buf[pos + 12]);
+            bits = hostRd16(&buf[pos + 22]);
+            if((fmt == HOST_WAV_EXT) && (chunk >= 26)){
+                fmt = hostRd16(&buf[pos + 32]);
+            }else{
+            }
+        }else if(memcmp(&buf[pos], "data", 4) == 0){
+            data = &buf[pos + 8];
+            data_len = chunk;
+        }else{
+        }
+        pos += 8 + chunk + (chunk & 1u);
+    }
+    if((data == NULL) || (*num_ch == 0) ||
+       !(((fmt == HOST_WAV_PCM) && ((bits == 16) || (bits == 24) || (bits == 32))) ||
+         ((fmt == HOST_WAV_FLOAT) && (bits == 32)))){
+        fprintf(stderr, "dsphost: %s must be 16, 24 or 32-bit PCM or 32-bit float\n", path);
+        return NULL;
+    }else{
+    }
+    bytes = bits/8;
+    *frames = data_len/(bytes*(*num_ch));
+    samples = malloc(((size_t)*frames*(*num_ch) + 1)*sizeof(q31_t));
+    if(samples == NULL){
+        fprintf(stderr, "dsphost: out of memory\n");
+        return NULL;
+    }else{
+    }
+    for(i=0;i<(*frames*(*num_ch));i++){
+        if(bits == 16){
+            samples[i] = (q31_t)(hostRd16(&data[i*2]) << 16);
+        }else if(bits == 24){
+            samples[i] = (q31_t)(((INT32U)data[i*3] << 8) | ((INT32U)data[i*3 + 1] << 16) |
+                                 ((INT32U)data[i*3 + 2] << 24));
+        }else if(fmt == HOST_WAV_FLOAT){
+            v = hostRd32(&data[i*4]);
+            memcpy(&fv, &v, sizeof(fv));
+            arm_float_to_q31(&fv, &samples[i], 1);
+        }else{
+            samples[i] = (q31_t)hostRd32(&data[i*4]);
+        }
+    }
+    free(buf);
+    return samples;
+}
+
+/*******************************************************************************************
+* hostWavWrite - Writes interleaved q31 samples as a 32-bit PCM WAV file
+*******************************************************************************************/
+static int hostWavWrite(const char *path, const q31_t *samples, INT32U srate, INT32U num_ch,
+                        INT32U frames){
+    FILE *f;
+    INT32U data_bytes = frames*num_ch*4;
+    INT32U i;
+
+    f = fopen(path, "wb");
+    if(f == NULL){
+        perror(path);
+        return 1;
+    }else{
+    }
+    fwrite("RIFF", 1, 4, f);
+    hostWr32(f, 36 + data_bytes);
+    fwrite("WAVEfmt ", 1, 8, f);
+    hostWr32(f, 16);
+    hostWr16(f, HOST_WAV_PCM);
+    hostWr16(f, num_ch);
+    hostWr32(f, srate);
+    hostWr32(f, srate*num_ch*4);
+    hostWr16(f, num_ch*4);
+    hostWr16(f, 32);
+    fwrite("data", 1, 4, f);
+    hostWr32(f, data_bytes);
+    for(i=0;i<(frames*num_ch);i++){
+        hostWr32(f, (INT32U)samples[i]);
+    }
+    if(fclose(f) != 0){
+        perror(path);
+        return 1;
+    }else{
+        return 0;
+    }
+}
+
+/*******************************************************************************************
+* Little endian helpers
+*******************************************************************************************/
+static INT32U hostRd16(const INT8U *p){
+    return (INT32U)p[0] | ((INT32U)p[1] << 8);
+}
+
+static INT32U hostRd32(const INT8U *p){
+    return (INT32U)p[0] | ((INT32U)p[1] << 8) | ((INT32U)p[2] << 16) | ((INT32U)p[3] << 24);
+}
+
+static void hostWr16(FILE *f, INT32U v){
+    fputc((int)(v & 0xFFu), f);
+    fputc((int)((v >> 8) & 0xFFu), f);
+}
+
+static void hostWr32(FILE *f, INT32U v){
+    hostWr16(f, v & 0xFFFFu);
+    hostWr16(f, v >> 16);
+}
+
+/*******************************************************************************************
+* hostProfPrint - One profile line and its histogram bins that are not empty
+*******************************************************************************************/
+static void hostProfPrint(const char *label, const DSP_PROF_T *prof){
+    INT8U bin;
+
+    if(prof->count == 0){
+        return;
+    }else{
+    }
+    printf("  %-17s  %u %u %u\n", label, (unsigned)prof->min, (unsigned)DSPProfMeanGet(prof),
+           (unsigned)prof->max);
+    for(bin=0;bin<DSP_PROF_NUM_BINS;bin++){
+        if(prof->hist[bin] != 0){
+            printf("    from %-8u %u\n", (unsigned)DSPProfBinLowGet(bin), (unsigned)prof->hist[bin]);
+        }else{
+        }
+    }
+}
@@ -0,0 +1,242 @@
+/*******************************************************************************************
+* dyntest.c
+* Host check and benchmark of the look-ahead compressor/limiter in source/DSPDyn.c.
+*   ceiling     For ceilings of 0, -1, -20 and -40 dBFS, a left/right pair of limiters
+*               runs DYT_NUM_BLOCKS blocks of random runtime sizes. Each block is noise at a
+*               random level with full-scale spikes. The right channel is half the left or
+*               the most negative q31 value. Blocks alternate between linked and separate
+*               runs. No output sample may be above the ceiling.
+*   curve       A steady -6 dBFS sine through a -12 dBFS threshold at 4:1 must settle at
+*               -10.5 dBFS, within DYT_CURVE_TOL_DB.
+*   bench       Host ns per sample of DSPDynProcess() and DSPDynStereoProcess() at every
+*               block size, on noise that keeps the gain moving. The host figures only rank
+*               block sizes; on the board dsp_dyn reports the stage's cycles per sample.
+*
+* Build from tools/:
+*   cc -std=gnu99 -O2 -include host/MCUType.h -Ihost -I../source -I../board -I../uCOS/uC-CFG
+*      -o dyntest dyntest.c host/arm_math.c host/hostbsp.c
+*      ../source/AppDSP_byrne_lab5.c ../source/DSPBiquad.c ../source/DSPCapture.c
+*      ../source/DSPChain.c ../source/DSPConv.c ../source/DSPDesign.c ../source/DSPDyn.c
+*      ../source/DSPLatency.c ../source/DSPMultirate.c ../source/DSPNco.c
+*      ../source/DSPProf.c ../source/DSPSpectrum.c ../source/DSPTone.c -lm
+* Usage:  dyntest        Exits with 1 if a ceiling is exceeded or the curve is off.
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include <time.h>
+#include "MCUType.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPDyn.h"
+
+/******************************************************************************************
+* Test constants
+*******************************************************************************************/
+#define DYT_NUM_BLOCKS      60000u
+#define DYT_NUM_CEILS       4
+#define DYT_CURVE_BLOCKS    200u            //Blocks of the sine before it is measured
+#define DYT_CURVE_DB        (-10.5)         //-6 dBFS at -12 dBFS, 4:1
+#define DYT_CURVE_TOL_DB    0.5
+#define DYT_BENCH_NS        50000000.0      //Time each case for about 50 ms
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static const INT8S dytCeils[DYT_NUM_CEILS] = {0, -1, -20, -40};
+static q31_t dytLeft[DSP_BLOCK_SIZE_MAX];
+static q31_t dytRight[DSP_BLOCK_SIZE_MAX];
+static q31_t dytNoise[DSP_BLOCK_SIZE_MAX];
+static INT32U dytRandState = 0x85EBCA6Bu;
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static INT32U dytRand(void);
+static INT32U dytCeiling(INT8S ceil_db);
+static INT32U dytCurve(void);
+static double dytBench(INT32U block_size, INT8U linked);
+static double dytNs(void);
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(void){
+    INT32U fails = 0;
+    INT32U block_size;
+    INT32U n;
+    INT8U t;
+
+    DSPDynInit();
+    for(t=0;t<DYT_NUM_CEILS;t++){
+        fails += dytCeiling(dytCeils[t]);
+    }
+    fails += dytCurve();
+
+    for(n=0;n<DSP_BLOCK_SIZE_MAX;n++){
+        dytNoise[n] = (q31_t)dytRand();
+    }
+    printf("block  ns/sample  linked ns/sample\n");
+    for(block_size=DSP_BLOCK_SIZE_MIN;block_size<=DSP_BLOCK_SIZE_MAX;block_size*=2){
+        printf("%5u  %9.2f  %16.2f\n", (unsigned)block_size, dytBench(block_size, 0),
+               dytBench(block_size, 1));
+    }
+    printf("DSPDyn check: %s\n", (fails == 0) ? "pass" : "FAIL");
+    return (fails == 0) ? 0 : 1;
+}
+
+/*******************************************************************************************
+* dytRand - xorshift32
+*******************************************************************************************/
+static INT32U dytRand(void){
+    dytRandState ^= dytRandState << 13;
+    dytRandState ^= dytRandState >> 17;
+    dytRandState ^= dytRandState << 5;
+    return dytRandState;
+}
+
+/*******************************************************************************************
+* dytCeiling - Runs a limiter pair at ceil_db and returns 1 if any output went over it
+*******************************************************************************************/
+static INT32U dytCeiling(INT8S ceil_db){
+    INT64S ceil;
+    INT64S over = 0;
+    INT64S mag;
+    double amp;
+    double v;
+    INT32U block_size;
+    INT32U b;
+    INT32U n;
+    INT8U left;
+    INT8U right;
+
+    left = DSPDynCreate(0, DSP_DYN_RATIO_LIMIT, ceil_db);
+    right = DSPDynCreate(0, DSP_DYN_RATIO_LIMIT, ceil_db);
+    if((left == DSP_DYN_NONE) || (right == DSP_DYN_NONE)){
+        printf("ceiling %d dBFS: no free instance  FAIL\n", (int)ceil_db);
+        return 1;
+    }else{
+    }
+    if(ceil_db == 0){
+        ceil = 0x7FFFFFFF;
+    }else{
+        ceil = (INT64S)(pow(10.0, (double)ceil_db/20.0)*2147483648.0);
+    }
+    for(b=0;b<DYT_NUM_BLOCKS;b++){
+        block_size = DSP_BLOCK_SIZE_MIN << (dytRand() % 6u);
+        amp = ((dytRand() % 3u) == 0) ? 1.0 : (double)(dytRand() % 100u)/100.0;
+        for(n=0;n<block_size;n++){
+            v = amp*(((double)dytRand()/4294967296.0)*2.0 - 1.0);
+            if((dytRand() % 50u) == 0){
+                v = ((dytRand() & 1u) != 0) ? 1.0 : -1.0;
+            }else{
+            }
+            if(v >= 1.0){
+                dytLeft[n] = 0x7FFFFFFF;
+            }else{
+                dytLeft[n] = (q31_t)(v*2147483648.0);
+            }
+            dytRight[n] = ((dytRand() % 4u) != 0) ? (dytLeft[n]/2) : (q31_t)0x80000000;
+        }
+        if((b & 1u) != 0){
+            DSPDynStereoProcess(left, right, dytLeft, dytRight, block_size);
+        }else{
+            DSPDynProcess(left, dytLeft, block_size);
+            DSPDynProcess(right, dytRight, block_size);
+        }
+        for(n=0;n<block_size;n++){
+            mag = (dytLeft[n] < 0) ? -(INT64S)dytLeft[n] : (INT64S)dytLeft[n];
+            if((mag - ceil) > over){
+                over = mag - ceil;
+            }else{
+            }
+            mag = (dytRight[n] < 0) ? -(INT64S)dytRight[n] : (INT64S)dytRight[n];
+            if((mag - ceil) > over){
+                over = mag - ceil;
+            }else{
+            }
+        }
+    }
+    printf("ceiling %3d dBFS: deepest gain %.4f, %s\n", (int)ceil_db,
+           (double)DSPDynGainMinGet(left)/2147483648.0, (over > 0) ? "over it  FAIL" : "held");
+    DSPDynFree(left);
+    DSPDynFree(right);
+    return (over > 0) ? 1u : 0u;
+}
+
+/*******************************************************************************************
+* dytCurve - Settled level of a -6 dBFS 1 kHz sine through a -12 dBFS, 4:1 compressor
+*******************************************************************************************/
+static INT32U dytCurve(void){
+    double phase = 0.0;
+    double level;
+    q31_t peak = 0;
+    INT32U b;
+    INT32U n;
+    INT8U inst;
+
+    inst = DSPDynCreate(-12, 4, 0);
+    for(b=0;b<DYT_CURVE_BLOCKS;b++){
+        for(n=0;n<DSP_BLOCK_SIZE_MAX;n++){
+            dytLeft[n] = (q31_t)(0.5*sin(phase)*2147483647.0);
+            phase += 2.0*M_PI*1000.0/48000.0;
+        }
+        DSPDynProcess(inst, dytLeft, DSP_BLOCK_SIZE_MAX);
+    }
+    for(n=0;n<DSP_BLOCK_SIZE_MAX;n++){
+        if(dytLeft[n] > peak){
+            peak = dytLeft[n];
+        }else{
+        }
+    }
+    DSPDynFree(inst);
+    level = 20.0*log10((double)peak/2147483648.0);
+    if(fabs(level - DYT_CURVE_DB) > DYT_CURVE_TOL_DB){
+        printf("-6 dBFS sine at -12 dBFS 4:1: %.2f dBFS, expected %.1f  FAIL\n", level,
+               DYT_CURVE_DB);
+        return 1;
+    }else{
+        printf("-6 dBFS sine at -12 dBFS 4:1: %.2f dBFS\n", level);
+        return 0;
+    }
+}
+
+/*******************************************************************************************
+* dytBench - Mean host ns per sample and channel of one block size, separate or linked
+*******************************************************************************************/
+static double dytBench(INT32U block_size, INT8U linked){
+    INT32U samples = 0;
+    double start;
+    double elapsed;
+    INT8U left;
+    INT8U right;
+
+    left = DSPDynCreate(-20, 4, -1);
+    right = DSPDynCreate(-20, 4, -1);
+    start = dytNs();
+    do{
+        arm_copy_q31(dytNoise, dytLeft, block_size);
+        arm_copy_q31(dytNoise, dytRight, block_size);
+        if(linked != 0){
+            DSPDynStereoProcess(left, right, dytLeft, dytRight, block_size);
+        }else{
+            DSPDynProcess(left, dytLeft, block_size);
+            DSPDynProcess(right, dytRight, block_size);
+        }
+        samples += 2u*block_size;
+        elapsed = dytNs() - start;
+    }while(elapsed < DYT_BENCH_NS);
+    DSPDynFree(left);
+    DSPDynFree(right);
+    return elapsed/(double)samples;
+}
+
+/*******************************************************************************************
+* dytNs - Monotonic time in ns
+*******************************************************************************************/
+static double dytNs(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1.0e9*(double)ts.tv_sec + (double)ts.tv_nsec;
+}
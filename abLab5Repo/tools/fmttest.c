@@ -0,0 +1,188 @@
+/*******************************************************************************************
+* fmttest.c
+* Host check that DSPFmtQ31() in source/DSPFmt.c gives the same text as the dsp_load output
+* it replaced:
+*   Str_FmtNbr_32((FP32)sample/2147483648, 2, 9, '\0', DEF_YES, strg)
+* built from the real uCOS/uC-LIB/lib_str.c. Every step'th q31 value from -2^31 up, and the
+* edge cases around 0, +-1.0 and the FP32 rounding steps, must match character for
+* character. It then times both formatting a full block of random samples
+* per call, as dsp_load does, and reports the best of FMT_BENCH_PASSES passes of each.
+* The match depends on the host doing FP32 math in IEEE single precision as the M4 FPU
+* does, which x86-64 (SSE) and AArch64 do; an x87 build would not. The times only compare
+* the two on this host, not on the K65.
+*
+* Build from tools/:
+*   cc -std=gnu99 -O2 -include host/MCUType.h -Ihost -I../source -I../uCOS/uC-LIB
+*      -I../uCOS/uC-CPU -I../uCOS/uC-CFG -o fmttest fmttest.c ../source/DSPFmt.c
+*      ../uCOS/uC-LIB/lib_str.c ../uCOS/uC-LIB/lib_ascii.c
+* Usage:  fmttest [step]        step defaults to 97, 1 checks all 2^32 values (minutes).
+*                               Exits with 1 on any difference.
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "MCUType.h"
+#include "lib_str.h"
+#include "DSPFmt.h"
+
+/******************************************************************************************
+* Test constants
+*******************************************************************************************/
+#define FMT_DEFAULT_STEP    97u
+#define FMT_BENCH_SAMPLES   1024u       //DSP_BLOCK_SIZE_MAX in AppDSP.h
+#define FMT_BENCH_PASSES    400u
+#define FMT_STRG_SIZE       (DSP_FMT_Q31_CHARS_MAX + 1)
+#define FMT_BLOCK_SIZE      (FMT_BENCH_SAMPLES*(DSP_FMT_Q31_CHARS_MAX + 1) + 1)
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static const q31_t fmtEdges[] = {
+    0, 1, -1, 2, -2, 0x7FFFFFFF, (q31_t)0x80000000, 0x7FFFFFC0, 0x7FFFFFBF, 0x7FFFFF80,
+    -0x7FFFFFC0, -0x7FFFFFBF, 0x00FFFFFF, 0x01000000, 0x01000001, 0x01000003, 0x02000003,
+    -0x01000000, 0x40000000, -0x40000000, 0x0CCCCCCD, 0x00000100, 0x0000A7C6
+};
+static q31_t fmtBench[FMT_BENCH_SAMPLES];
+static CPU_CHAR fmtBlock[FMT_BLOCK_SIZE];
+static INT32U fmtRandState = 0x1B873593u;
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static INT32U fmtRand(void);
+static void fmtRef(q31_t sample, CPU_CHAR *strg);
+static INT32U fmtRefBlock(const q31_t *samples, INT32U num_samples, CPU_CHAR *strg);
+static INT32U fmtCompare(q31_t sample);
+static double fmtNs(void);
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(int argc, char *argv[]){
+    INT64U checked = 0;
+    INT64U q;
+    INT32U step = FMT_DEFAULT_STEP;
+    INT32U fails = 0;
+    INT32U sink = 0;
+    INT32U pass;
+    INT32U n;
+    double start;
+    double ns;
+    double ref_ns = 1.0e30;
+    double fmt_ns = 1.0e30;
+
+    if(argc > 1){
+        step = (INT32U)strtoul(argv[1], 0, 0);
+    }else{
+    }
+    if(step == 0){
+        fprintf(stderr, "step must be at least 1\n");
+        return 1;
+    }else{
+    }
+
+    for(q=0;q<0x100000000ull;q+=step){
+        fails += fmtCompare((q31_t)(INT32U)(q + 0x80000000u));
+        checked++;
+    }
+    for(n=0;n<(sizeof(fmtEdges)/sizeof(fmtEdges[0]));n++){
+        fails += fmtCompare(fmtEdges[n]);
+        checked++;
+    }
+    printf("%llu values, every %u and %u edge cases: %u differ\n", (unsigned long long)checked,
+           (unsigned)step, (unsigned)(sizeof(fmtEdges)/sizeof(fmtEdges[0])), (unsigned)fails);
+
+    for(n=0;n<FMT_BENCH_SAMPLES;n++){
+        fmtBench[n] = (q31_t)fmtRand();
+    }
+    for(pass=0;pass<FMT_BENCH_PASSES;pass++){  //Alternate so both see the same host load
+        start = fmtNs();
+        sink += fmtRefBlock(fmtBench, FMT_BENCH_SAMPLES, fmtBlock);
+        ns = fmtNs() - start;
+        ref_ns = (ns < ref_ns) ? ns : ref_ns;
+        start = fmtNs();
+        sink += DSPFmtQ31Block(fmtBench, FMT_BENCH_SAMPLES, ',', fmtBlock);
+        ns = fmtNs() - start;
+        fmt_ns = (ns < fmt_ns) ? ns : fmt_ns;
+    }
+    ref_ns /= FMT_BENCH_SAMPLES;
+    fmt_ns /= FMT_BENCH_SAMPLES;
+    printf("host ns/sample: Str_FmtNbr_32 %.1f, DSPFmtQ31 %.1f (%u)\n", ref_ns, fmt_ns,
+           (unsigned)(sink & 1u));
+    printf("DSPFmtQ31 against Str_FmtNbr_32: %s\n", (fails == 0) ? "pass" : "FAIL");
+    return (fails == 0) ? 0 : 1;
+}
+
+/*******************************************************************************************
+* fmtRand - xorshift32
+*******************************************************************************************/
+static INT32U fmtRand(void){
+    fmtRandState ^= fmtRandState << 13;
+    fmtRandState ^= fmtRandState >> 17;
+    fmtRandState ^= fmtRandState << 5;
+    return fmtRandState;
+}
+
+/*******************************************************************************************
+* fmtRef - The old dsp_load conversion
+*******************************************************************************************/
+static void fmtRef(q31_t sample, CPU_CHAR *strg){
+    FP32 sample_float;
+
+    sample_float = ((FP32)sample)/2147483648;
+    (void)Str_FmtNbr_32(sample_float, 2, 9, '\0', DEF_YES, strg);
+}
+
+/*******************************************************************************************
+* fmtRefBlock - The old dsp_load conversion into one comma separated string, for timing
+*******************************************************************************************/
+static INT32U fmtRefBlock(const q31_t *samples, INT32U num_samples, CPU_CHAR *strg){
+    INT32U len = 0;
+    INT32U i;
+
+    for(i=0;i<num_samples;i++){
+        fmtRef(samples[i], &strg[len]);
+        len += (INT32U)Str_Len(&strg[len]);
+        strg[len] = ',';
+        len++;
+    }
+    strg[len] = '\0';
+    return len;
+}
+
+/*******************************************************************************************
+* fmtCompare - Formats sample both ways, prints the first few differences
+*******************************************************************************************/
+static INT32U fmtCompare(q31_t sample){
+    static INT32U shown = 0;
+    CPU_CHAR ref[FMT_STRG_SIZE];
+    CPU_CHAR strg[FMT_STRG_SIZE];
+    INT8U len;
+
+    fmtRef(sample, ref);
+    len = DSPFmtQ31(sample, strg);
+    if((strcmp(ref, strg) != 0) || (len != strlen(ref))){
+        if(shown < 10){
+            printf("0x%08X: Str_FmtNbr_32 \"%s\", DSPFmtQ31 \"%s\"  FAIL\n", (unsigned)sample,
+                   ref, strg);
+            shown++;
+        }else{
+        }
+        return 1;
+    }else{
+        return 0;
+    }
+}
+
+/*******************************************************************************************
+* fmtNs - Monotonic time in ns
+*******************************************************************************************/
+static double fmtNs(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1.0e9*(double)ts.tv_sec + (double)ts.tv_nsec;
+}
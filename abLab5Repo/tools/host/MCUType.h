@@ -0,0 +1,154 @@
+/**********************************************************************************
+* MCUType.h - Host stand-in for source/MCUType.h
+*
+* Lets the firmware DSP modules build as a Linux program for the tools in tools/.
+* Force included with -include so it takes the place of source/MCUType.h, which
+* is then skipped by its MCU_TYPE_PRESENT guard. Provides the WWU and uC/CPU
+* types, the few K65 registers the DSP modules and BasicIO touch and the CMSIS-DSP
+* subset in arm_math.h. The WWU types keep their target widths, so INT32U is 32 bits here
+* too.
+*
+* Not part of the firmware build.
+**********************************************************************************
+* Make sure it is included only one time
+**********************************************************************************/
+#ifndef  MCU_TYPE_PRESENT
+#define  MCU_TYPE_PRESENT
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*********************************************************************************
+ * Standard WWU type definitions
+ *********************************************************************************/
+typedef char                INT8C;
+typedef uint8_t             INT8U;
+typedef int8_t              INT8S;
+typedef uint16_t            INT16U;
+typedef int16_t             INT16S;
+typedef uint32_t            INT32U;
+typedef int32_t             INT32S;
+typedef uint64_t            INT64U;
+typedef int64_t             INT64S;
+typedef float               FP32;
+typedef double              FP64;
+
+#define FALSE    0
+#define TRUE     1
+
+/*********************************************************************************
+ * uC/CPU types and critical sections. The host build is single threaded.
+ *********************************************************************************/
+typedef char                CPU_CHAR;
+typedef uint8_t             CPU_BOOLEAN;
+typedef uint8_t             CPU_INT08U;
+typedef int8_t              CPU_INT08S;
+typedef uint16_t            CPU_INT16U;
+typedef int16_t             CPU_INT16S;
+typedef uint32_t            CPU_INT32U;
+typedef int32_t             CPU_INT32S;
+typedef unsigned long long  CPU_INT64U;
+typedef long long           CPU_INT64S;
+typedef uint32_t            CPU_TS;
+typedef uint32_t            CPU_TS32;
+typedef uint32_t            CPU_STK;
+typedef uint32_t            CPU_STK_SIZE;
+typedef uint32_t            CPU_SR;
+typedef uint32_t            CPU_ADDR;
+typedef CPU_ADDR            CPU_SIZE_T;
+typedef uint32_t            CPU_DATA;
+
+#define CPU_SR_ALLOC()
+#define CPU_CRITICAL_ENTER()
+#define CPU_CRITICAL_EXIT()
+
+/*********************************************************************************
+ * The K65 registers the DSP modules use
+ *********************************************************************************/
+typedef struct{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} HOST_DWT_T;
+
+typedef struct{
+    volatile uint32_t DEMCR;
+} HOST_CORE_DEBUG_T;
+
+typedef struct{
+    volatile uint32_t PDOR;
+    volatile uint32_t PSOR;
+    volatile uint32_t PCOR;
+    volatile uint32_t PTOR;
+    volatile uint32_t PDIR;
+    volatile uint32_t PDDR;
+} HOST_GPIO_T;
+
+typedef struct{
+    volatile uint32_t TCSR;
+    volatile uint32_t RCSR;
+} HOST_I2S_T;
+
+//UART2 as BasicIO uses it. D is 16 bits so the model in tools/uarttest.c can tell a byte
+//BasicIO wrote (bit 8 clear) from the received byte it holds (bit 8 set).
+typedef struct{
+    volatile uint8_t BDH;
+    volatile uint8_t BDL;
+    volatile uint8_t C2;
+    volatile uint8_t S1;
+    volatile uint16_t D;
+    volatile uint8_t C4;
+} HOST_UART_T;
+
+typedef struct{
+    volatile uint32_t SCGC4;
+    volatile uint32_t SCGC5;
+} HOST_SIM_T;
+
+typedef struct{
+    volatile uint32_t PCR[32];
+} HOST_PORT_T;
+
+extern HOST_DWT_T HostDwt;
+HOST_DWT_T *HostDwtGet(void);
+extern HOST_CORE_DEBUG_T HostCoreDebug;
+extern HOST_GPIO_T HostGpio[5];
+extern HOST_I2S_T HostI2s;
+//Only tools/uarttest.c, which builds board/BasicIO.c, defines these
+HOST_UART_T *HostUartGet(void);
+extern HOST_SIM_T HostSim;
+extern HOST_PORT_T HostPorte;
+
+//Every access loads CYCCNT from clock_gettime(), so on the host one DWT cycle is one ns
+#define DWT                             (HostDwtGet())
+#define CoreDebug                       (&HostCoreDebug)
+#define GPIOA                           (&HostGpio[0])
+#define GPIOB                           (&HostGpio[1])
+#define GPIOC                           (&HostGpio[2])
+#define GPIOD                           (&HostGpio[3])
+#define GPIOE                           (&HostGpio[4])
+#define I2S0                            (&HostI2s)
+//Every access runs the UART model a step, see tools/uarttest.c
+#define UART2                           (HostUartGet())
+#define SIM                             (&HostSim)
+#define PORTE                           (&HostPorte)
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+#define I2S_TCSR_TE_MASK                0x80000000u
+#define I2S_RCSR_RE_MASK                0x80000000u
+#define UART_S1_TDRE_MASK               0x80u
+#define UART_S1_RDRF_MASK               0x20u
+#define UART_S1_OR_MASK                 0x08u
+#define UART_C2_TIE_MASK                0x80u
+#define UART_C2_RIE_MASK                0x20u
+#define UART_C2_TE_MASK                 0x08u
+#define UART_C2_RE_MASK                 0x04u
+#define SIM_SCGC4_UART2(x)              ((uint32_t)(x) << 12)
+#define SIM_SCGC5_PORTE(x)              ((uint32_t)(x) << 13)
+#define PORT_PCR_MUX(x)                 ((uint32_t)(x) << 8)
+#define UART2_RX_TX_IRQn                35
+#define NVIC_ClearPendingIRQ(irq)       ((void)(irq))
+#define NVIC_EnableIRQ(irq)             ((void)(irq))
+
+#include "arm_math.h"
+
+#endif
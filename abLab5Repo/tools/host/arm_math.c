@@ -0,0 +1,593 @@
+/*******************************************************************************************
+* arm_math.c - Host versions of the CMSIS-DSP functions in arm_math.h
+*
+* The q31 functions keep the CMSIS reference arithmetic: 64-bit accumulators,
+* the same post shifts, truncation where CMSIS truncates and saturation where it
+* saturates. arm_rfft_fast_f32() is the same split real FFT over a complex FFT of half
+* the length, with the CMSIS output packing and a 1/N inverse, but its own float rounding.
+*
+* Not part of the firmware build.
+*******************************************************************************************/
+#include "MCUType.h"
+
+/*******************************************************************************************
+* Private defines
+*******************************************************************************************/
+#define HOST_FFT_LEN_MIN    32
+#define HOST_FFT_LEN_MAX    8192
+#define HOST_PI             3.14159265358979323846
+
+/*******************************************************************************************
+* Private variables
+*******************************************************************************************/
+//cos and sin of 2*pi*k/HOST_FFT_LEN_MAX, shorter transforms step through them
+static float32_t hostTwCos[HOST_FFT_LEN_MAX/2];
+static float32_t hostTwSin[HOST_FFT_LEN_MAX/2];
+static int hostTwReady = 0;
+static float32_t hostFftBuf[HOST_FFT_LEN_MAX];
+
+/*******************************************************************************************
+* Private function prototypes
+*******************************************************************************************/
+static q31_t hostSat31(q63_t x);
+static q63_t hostMult32x64(q63_t x, q31_t y);
+static void hostTwInit(void);
+static void hostCfft(float32_t *buf, uint32_t len, int inverse);
+
+/*******************************************************************************************
+* hostSat31 - Saturates to q31
+*******************************************************************************************/
+static q31_t hostSat31(q63_t x){
+    if(x > INT32_MAX){
+        return INT32_MAX;
+    }else if(x < INT32_MIN){
+        return INT32_MIN;
+    }else{
+        return (q31_t)x;
+    }
+}
+
+/*******************************************************************************************
+* hostMult32x64 - q63 by q31 product as the CMSIS mult32x64() helper forms it
+*******************************************************************************************/
+static q63_t hostMult32x64(q63_t x, q31_t y){
+    return ((((q63_t)(x & 0x00000000FFFFFFFFLL))*y) >> 32) + ((x >> 32)*y);
+}
+
+/*******************************************************************************************
+* Biquad cascades
+*******************************************************************************************/
+void arm_biquad_cascade_df1_init_q31(arm_biquad_casd_df1_inst_q31 *S, uint8_t numStages,
+                                     const q31_t *pCoeffs, q31_t *pState, int8_t postShift){
+    S->numStages = numStages;
+    S->postShift = (uint8_t)postShift;
+    S->pCoeffs = pCoeffs;
+    memset(pState, 0, 4u*numStages*sizeof(q31_t));
+    S->pState = pState;
+}
+
+void arm_biquad_cascade_df1_q31(const arm_biquad_casd_df1_inst_q31 *S, const q31_t *pSrc,
+                                q31_t *pDst, uint32_t blockSize){
+    const q31_t *coeffs = S->pCoeffs;
+    q31_t *state = S->pState;
+    const q31_t *in = pSrc;
+    uint32_t lshift = 31u - S->postShift;
+    uint32_t stage;
+    uint32_t n;
+    q63_t acc;
+    q31_t x1, x2, y1, y2, xn;
+
+    for(stage=0;stage<S->numStages;stage++){
+        x1 = state[0];
+        x2 = state[1];
+        y1 = state[2];
+        y2 = state[3];
+        for(n=0;n<blockSize;n++){
+            xn = in[n];
+            acc = (q63_t)coeffs[0]*xn + (q63_t)coeffs[1]*x1 + (q63_t)coeffs[2]*x2 +
+                  (q63_t)coeffs[3]*y1 + (q63_t)coeffs[4]*y2;
+            x2 = x1;
+            x1 = xn;
+            y2 = y1;
+            y1 = (q31_t)(acc >> lshift);
+            pDst[n] = y1;
+        }
+        state[0] = x1;
+        state[1] = x2;
+        state[2] = y1;
+        state[3] = y2;
+        state += 4;
+        coeffs += 5;
+        in = pDst;
+    }
+}
+
+void arm_biquad_cas_df1_32x64_init_q31(arm_biquad_cas_df1_32x64_ins_q31 *S, uint8_t numStages,
+                                       const q31_t *pCoeffs, q63_t *pState, uint8_t postShift){
+    S->numStages = numStages;
+    S->postShift = postShift;
+    S->pCoeffs = pCoeffs;
+    memset(pState, 0, 4u*numStages*sizeof(q63_t));
+    S->pState = pState;
+}
+
+//Inputs are kept as q31 in the q63 state, outputs as q1.63
+void arm_biquad_cas_df1_32x64_q31(const arm_biquad_cas_df1_32x64_ins_q31 *S, q31_t *pSrc,
+                                  q31_t *pDst, uint32_t blockSize){
+    const q31_t *coeffs = S->pCoeffs;
+    q63_t *state = S->pState;
+    const q31_t *in = pSrc;
+    uint32_t shift = (uint32_t)S->postShift + 1u;
+    uint32_t stage;
+    uint32_t n;
+    q63_t acc;
+    q63_t x1, x2, y1, y2;
+    q31_t xn;
+
+    for(stage=0;stage<S->numStages;stage++){
+        x1 = state[0];
+        x2 = state[1];
+        y1 = state[2];
+        y2 = state[3];
+        for(n=0;n<blockSize;n++){
+            xn = in[n];
+            acc = (q63_t)xn*coeffs[0] + x1*coeffs[1] + x2*coeffs[2];
+            acc += hostMult32x64(y1, coeffs[3]);
+            acc += hostMult32x64(y2, coeffs[4]);
+            acc = (q63_t)((uint64_t)acc << shift);
+            x2 = x1;
+            x1 = xn;
+            y2 = y1;
+            y1 = acc;
+            pDst[n] = (q31_t)(acc >> 32);
+        }
+        state[0] = x1;
+        state[1] = x2;
+        state[2] = y1;
+        state[3] = y2;
+        state += 4;
+        coeffs += 5;
+        in = pDst;
+    }
+}
+
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S, uint8_t numStages,
+                                      const float32_t *pCoeffs, float32_t *pState){
+    S->numStages = numStages;
+    S->pCoeffs = pCoeffs;
+    memset(pState, 0, 2u*numStages*sizeof(float32_t));
+    S->pState = pState;
+}
+
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S,
+                                 const float32_t *pSrc, float32_t *pDst, uint32_t blockSize){
+    const float32_t *coeffs = S->pCoeffs;
+    float32_t *state = S->pState;
+    const float32_t *in = pSrc;
+    uint32_t stage;
+    uint32_t n;
+    float32_t d1, d2, xn, yn;
+
+    for(stage=0;stage<S->numStages;stage++){
+        d1 = state[0];
+        d2 = state[1];
+        for(n=0;n<blockSize;n++){
+            xn = in[n];
+            yn = coeffs[0]*xn + d1;
+            d1 = coeffs[1]*xn + coeffs[3]*yn + d2;
+            d2 = coeffs[2]*xn + coeffs[4]*yn;
+            pDst[n] = yn;
+        }
+        state[0] = d1;
+        state[1] = d2;
+        state += 2;
+        coeffs += 5;
+        in = pDst;
+    }
+}
+
+/*******************************************************************************************
+* FIR filters. Coefficients are in time reversed order as in CMSIS.
+*******************************************************************************************/
+void arm_fir_init_q31(arm_fir_instance_q31 *S, uint16_t numTaps, const q31_t *pCoeffs,
+                      q31_t *pState, uint32_t blockSize){
+    S->numTaps = numTaps;
+    S->pCoeffs = pCoeffs;
+    memset(pState, 0, ((uint32_t)numTaps + blockSize - 1u)*sizeof(q31_t));
+    S->pState = pState;
+}
+
+void arm_fir_q31(const arm_fir_instance_q31 *S, const q31_t *pSrc, q31_t *pDst,
+                 uint32_t blockSize){
+    uint32_t taps = S->numTaps;
+    q31_t *state = S->pState;
+    uint32_t n;
+    uint32_t k;
+    q63_t acc;
+
+    memcpy(&state[taps - 1u], pSrc, blockSize*sizeof(q31_t));
+    for(n=0;n<blockSize;n++){
+        acc = 0;
+        for(k=0;k<taps;k++){
+            acc += (q63_t)state[n + k]*S->pCoeffs[k];
+        }
+        pDst[n] = (q31_t)(acc >> 31);
+    }
+    memmove(&state[0], &state[blockSize], (taps - 1u)*sizeof(q31_t));
+}
+
+arm_status arm_fir_decimate_init_q31(arm_fir_decimate_instance_q31 *S, uint16_t numTaps,
+                                     uint8_t M, const q31_t *pCoeffs, q31_t *pState,
+                                     uint32_t blockSize){
+    if((blockSize % M) != 0u){
+        return ARM_MATH_LENGTH_ERROR;
+    }else{
+    }
+    S->numTaps = numTaps;
+    S->pCoeffs = pCoeffs;
+    memset(pState, 0, ((uint32_t)numTaps + blockSize - 1u)*sizeof(q31_t));
+    S->pState = pState;
+    S->M = M;
+    return ARM_MATH_SUCCESS;
+}
+
+void arm_fir_decimate_q31(const arm_fir_decimate_instance_q31 *S, const q31_t *pSrc,
+                          q31_t *pDst, uint32_t blockSize){
+    uint32_t taps = S->numTaps;
+    q31_t *state = S->pState;
+    uint32_t n;
+    uint32_t k;
+    q63_t acc;
+
+    memcpy(&state[taps - 1u], pSrc, blockSize*sizeof(q31_t));
+    for(n=0;n<(blockSize/S->M);n++){
+        acc = 0;
+        for(k=0;k<taps;k++){
+            acc += (q63_t)state[n*S->M + k]*S->pCoeffs[k];
+        }
+        pDst[n] = (q31_t)(acc >> 31);
+    }
+    memmove(&state[0], &state[blockSize], (taps - 1u)*sizeof(q31_t));
+}
+
+arm_status arm_fir_interpolate_init_q31(arm_fir_interpolate_instance_q31 *S, uint8_t L,
+                                        uint16_t numTaps, const q31_t *pCoeffs, q31_t *pState,
+                                        uint32_t blockSize){
+    if((numTaps % L) != 0u){
+        return ARM_MATH_LENGTH_ERROR;
+    }else{
+    }
+    S->pCoeffs = pCoeffs;
+    S->L = L;
+    S->phaseLength = (uint16_t)(numTaps/L);
+    memset(pState, 0, (blockSize + S->phaseLength - 1u)*sizeof(q31_t));
+    S->pState = pState;
+    return ARM_MATH_SUCCESS;
+}
+
+void arm_fir_interpolate_q31(const arm_fir_interpolate_instance_q31 *S, const q31_t *pSrc,
+                             q31_t *pDst, uint32_t blockSize){
+    uint32_t phase_len = S->phaseLength;
+    uint32_t L = S->L;
+    q31_t *state = S->pState;
+    uint32_t n;
+    uint32_t j;
+    uint32_t k;
+    q63_t acc;
+
+    memcpy(&state[phase_len - 1u], pSrc, blockSize*sizeof(q31_t));
+    for(n=0;n<blockSize;n++){
+        for(j=1;j<=L;j++){
+            acc = 0;
+            for(k=0;k<phase_len;k++){
+                acc += (q63_t)state[n + k]*S->pCoeffs[(L - j) + k*L];
+            }
+            *pDst++ = (q31_t)(acc >> 31);
+        }
+    }
+    memmove(&state[0], &state[blockSize], (phase_len - 1u)*sizeof(q31_t));
+}
+
+/*******************************************************************************************
+* Real FFT. Packed as CMSIS: [0] DC, [1] Nyquist, then re, im of bins 1 to N/2-1.
+*******************************************************************************************/
+static void hostTwInit(void){
+    uint32_t k;
+
+    for(k=0;k<(HOST_FFT_LEN_MAX/2);k++){
+        hostTwCos[k] = (float32_t)cos(2.0*HOST_PI*k/HOST_FFT_LEN_MAX);
+        hostTwSin[k] = (float32_t)sin(2.0*HOST_PI*k/HOST_FFT_LEN_MAX);
+    }
+    hostTwReady = 1;
+}
+
+//In place radix-2 complex FFT of len interleaved points, e^-j forward, unscaled
+static void hostCfft(float32_t *buf, uint32_t len, int inverse){
+    uint32_t i;
+    uint32_t j = 0;
+    uint32_t bit;
+    uint32_t half;
+    uint32_t k;
+    uint32_t step;
+    float32_t tr, ti, wr, wi, t;
+
+    for(i=1;i<len;i++){
+        bit = len >> 1;
+        while((j & bit) != 0u){
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+        if(i < j){
+            t = buf[2*i];       buf[2*i] = buf[2*j];         buf[2*j] = t;
+            t = buf[2*i + 1];   buf[2*i + 1] = buf[2*j + 1]; buf[2*j + 1] = t;
+        }else{
+        }
+    }
+    for(half=1;half<len;half<<=1){
+        step = HOST_FFT_LEN_MAX/(2*half);
+        for(i=0;i<len;i+=2*half){
+            for(k=0;k<half;k++){
+                wr = hostTwCos[k*step];
+                wi = inverse ? hostTwSin[k*step] : -hostTwSin[k*step];
+                tr = wr*buf[2*(i + k + half)] - wi*buf[2*(i + k + half) + 1];
+                ti = wr*buf[2*(i + k + half) + 1] + wi*buf[2*(i + k + half)];
+                buf[2*(i + k + half)] = buf[2*(i + k)] - tr;
+                buf[2*(i + k + half) + 1] = buf[2*(i + k) + 1] - ti;
+                buf[2*(i + k)] += tr;
+                buf[2*(i + k) + 1] += ti;
+            }
+        }
+    }
+}
+
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen){
+    if((fftLen < HOST_FFT_LEN_MIN) || (fftLen > (HOST_FFT_LEN_MAX/2)) ||
+       ((fftLen & (fftLen - 1u)) != 0u)){
+        return ARM_MATH_ARGUMENT_ERROR;
+    }else{
+    }
+    if(hostTwReady == 0){
+        hostTwInit();
+    }else{
+    }
+    S->fftLenRFFT = fftLen;
+    return ARM_MATH_SUCCESS;
+}
+
+void arm_rfft_fast_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut,
+                       uint8_t ifftFlag){
+    uint32_t n = S->fftLenRFFT;
+    uint32_t m = n/2;
+    uint32_t step = HOST_FFT_LEN_MAX/n;
+    uint32_t k;
+    float32_t *z = &hostFftBuf[0];
+    float32_t ar, ai, br, bi, er, ei, or_, oi, wr, wi;
+
+    if(ifftFlag == 0){
+        //Even samples as real, odd as imaginary, then split into the half spectrum
+        memcpy(z, p, n*sizeof(float32_t));
+        hostCfft(z, m, 0);
+        pOut[0] = z[0] + z[1];
+        pOut[1] = z[0] - z[1];
+        for(k=1;k<m;k++){
+            ar = z[2*k];
+            ai = z[2*k + 1];
+            br = z[2*(m - k)];
+            bi = -z[2*(m - k) + 1];
+            er = 0.5f*(ar + br);
+            ei = 0.5f*(ai + bi);
+            or_ = 0.5f*(ai - bi);
+            oi = -0.5f*(ar - br);
+            wr = hostTwCos[k*step];
+            wi = -hostTwSin[k*step];
+            pOut[2*k] = er + wr*or_ - wi*oi;
+            pOut[2*k + 1] = ei + wr*oi + wi*or_;
+        }
+    }else{
+        z[0] = 0.5f*(p[0] + p[1]);
+        z[1] = 0.5f*(p[0] - p[1]);
+        for(k=1;k<m;k++){
+            ar = p[2*k];
+            ai = p[2*k + 1];
+            br = p[2*(m - k)];
+            bi = -p[2*(m - k) + 1];
+            er = 0.5f*(ar + br);
+            ei = 0.5f*(ai + bi);
+            //O = (X[k] - conj(X[m-k]))/(2*W^k), W = e^-j2pi/n
+            wr = hostTwCos[k*step];
+            wi = hostTwSin[k*step];
+            or_ = 0.5f*((ar - br)*wr - (ai - bi)*wi);
+            oi = 0.5f*((ar - br)*wi + (ai - bi)*wr);
+            z[2*k] = er - oi;
+            z[2*k + 1] = ei + or_;
+        }
+        hostCfft(z, m, 1);
+        for(k=0;k<n;k++){
+            pOut[k] = z[k]/(float32_t)m;
+        }
+    }
+}
+
+void arm_cmplx_mag_squared_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples){
+    uint32_t i;
+
+    for(i=0;i<numSamples;i++){
+        pDst[i] = pSrc[2*i]*pSrc[2*i] + pSrc[2*i + 1]*pSrc[2*i + 1];
+    }
+}
+
+/*******************************************************************************************
+* Basic math
+*******************************************************************************************/
+void arm_abs_q31(const q31_t *pSrc, q31_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = (pSrc[i] > 0) ? pSrc[i] : ((pSrc[i] == INT32_MIN) ? INT32_MAX : -pSrc[i]);
+    }
+}
+
+void arm_add_q31(const q31_t *pSrcA, const q31_t *pSrcB, q31_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = hostSat31((q63_t)pSrcA[i] + pSrcB[i]);
+    }
+}
+
+void arm_sub_q31(const q31_t *pSrcA, const q31_t *pSrcB, q31_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = hostSat31((q63_t)pSrcA[i] - pSrcB[i]);
+    }
+}
+
+void arm_mult_q31(const q31_t *pSrcA, const q31_t *pSrcB, q31_t *pDst, uint32_t blockSize){
+    uint32_t i;
+    q63_t out;
+
+    for(i=0;i<blockSize;i++){
+        //__SSAT(out, 31) then << 1
+        out = ((q63_t)pSrcA[i]*pSrcB[i]) >> 32;
+        if(out > 0x3FFFFFFF){
+            out = 0x3FFFFFFF;
+        }else if(out < -0x40000000){
+            out = -0x40000000;
+        }else{
+        }
+        pDst[i] = (q31_t)(out*2);
+    }
+}
+
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst,
+                  uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = pSrcA[i]*pSrcB[i];
+    }
+}
+
+void arm_offset_q31(const q31_t *pSrc, q31_t offset, q31_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = hostSat31((q63_t)pSrc[i] + offset);
+    }
+}
+
+void arm_scale_q31(const q31_t *pSrc, q31_t scaleFract, int8_t shift, q31_t *pDst,
+                   uint32_t blockSize){
+    int32_t kshift = shift + 1;
+    uint32_t i;
+    q63_t in;
+
+    for(i=0;i<blockSize;i++){
+        if(kshift >= 0){
+            in = ((q63_t)pSrc[i]*scaleFract) >> 32;
+            pDst[i] = hostSat31(in*((q63_t)1 << kshift));
+        }else{
+            pDst[i] = (q31_t)(((q63_t)pSrc[i]*scaleFract) >> (32 - kshift));
+        }
+    }
+}
+
+void arm_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = pSrc[i]*scale;
+    }
+}
+
+void arm_shift_q31(const q31_t *pSrc, int8_t shiftBits, q31_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        if(shiftBits >= 0){
+            pDst[i] = hostSat31((q63_t)pSrc[i]*((q63_t)1 << shiftBits));
+        }else{
+            pDst[i] = pSrc[i] >> (-shiftBits);
+        }
+    }
+}
+
+void arm_dot_prod_q31(const q31_t *pSrcA, const q31_t *pSrcB, uint32_t blockSize, q63_t *result){
+    uint32_t i;
+    q63_t sum = 0;
+
+    for(i=0;i<blockSize;i++){
+        sum += ((q63_t)pSrcA[i]*pSrcB[i]) >> 14;
+    }
+    *result = sum;
+}
+
+void arm_max_q31(const q31_t *pSrc, uint32_t blockSize, q31_t *pResult, uint32_t *pIndex){
+    uint32_t i;
+
+    *pResult = pSrc[0];
+    *pIndex = 0;
+    for(i=1;i<blockSize;i++){
+        if(pSrc[i] > *pResult){
+            *pResult = pSrc[i];
+            *pIndex = i;
+        }else{
+        }
+    }
+}
+
+/*******************************************************************************************
+* Support functions
+*******************************************************************************************/
+void arm_copy_q31(const q31_t *pSrc, q31_t *pDst, uint32_t blockSize){
+    memmove(pDst, pSrc, blockSize*sizeof(q31_t));
+}
+
+void arm_copy_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize){
+    memmove(pDst, pSrc, blockSize*sizeof(float32_t));
+}
+
+void arm_fill_q31(q31_t value, q31_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = value;
+    }
+}
+
+void arm_fill_f32(float32_t value, float32_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = value;
+    }
+}
+
+void arm_float_to_q31(const float32_t *pSrc, q31_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = hostSat31((q63_t)(pSrc[i]*2147483648.0f));
+    }
+}
+
+void arm_q31_to_float(const q31_t *pSrc, float32_t *pDst, uint32_t blockSize){
+    uint32_t i;
+
+    for(i=0;i<blockSize;i++){
+        pDst[i] = (float32_t)pSrc[i]/2147483648.0f;
+    }
+}
+
+/*******************************************************************************************
+* Fast math. CMSIS interpolates a 512 point table, these are the libm values.
+*******************************************************************************************/
+float32_t arm_sin_f32(float32_t x){
+    return sinf(x);
+}
+
+float32_t arm_cos_f32(float32_t x){
+    return cosf(x);
+}
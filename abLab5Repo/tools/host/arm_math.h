@@ -0,0 +1,152 @@
+/*******************************************************************************************
+* arm_math.h - Host stand-in for the CMSIS-DSP functions the DSP modules use
+*
+* Same types, instance structures and prototypes as CMSIS/arm_math.h V1.6.0, implemented
+* in arm_math.c in plain C. The fixed-point functions follow the arithmetic of the CMSIS
+* reference code, the f32 functions and arm_rfft_fast_f32() agree with it to float
+* rounding. Only the functions used in source/ are provided.
+*
+* Not part of the firmware build.
+*******************************************************************************************/
+#ifndef _ARM_MATH_H
+#define _ARM_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+typedef int8_t   q7_t;
+typedef int16_t  q15_t;
+typedef int32_t  q31_t;
+typedef int64_t  q63_t;
+typedef float    float32_t;
+typedef double   float64_t;
+
+typedef enum{
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1,
+    ARM_MATH_LENGTH_ERROR = -2,
+    ARM_MATH_SIZE_MISMATCH = -3,
+    ARM_MATH_NANINF = -4,
+    ARM_MATH_SINGULAR = -5,
+    ARM_MATH_TEST_FAILURE = -6
+} arm_status;
+
+#ifndef PI
+#define PI               3.14159265358979f
+#endif
+
+//Count leading zeros, 32 for 0 as the M4 CLZ instruction
+#define __CLZ(x)         (((x) == 0u) ? 32u : (uint8_t)__builtin_clz((uint32_t)(x)))
+
+/*******************************************************************************************
+* Instance structures
+*******************************************************************************************/
+typedef struct{
+    uint32_t numStages;
+    q31_t *pState;
+    const q31_t *pCoeffs;
+    uint8_t postShift;
+} arm_biquad_casd_df1_inst_q31;
+
+typedef struct{
+    uint8_t numStages;
+    q63_t *pState;
+    const q31_t *pCoeffs;
+    uint8_t postShift;
+} arm_biquad_cas_df1_32x64_ins_q31;
+
+typedef struct{
+    uint8_t numStages;
+    float32_t *pState;
+    const float32_t *pCoeffs;
+} arm_biquad_cascade_df2T_instance_f32;
+
+typedef struct{
+    uint16_t numTaps;
+    q31_t *pState;
+    const q31_t *pCoeffs;
+} arm_fir_instance_q31;
+
+typedef struct{
+    uint8_t M;
+    uint16_t numTaps;
+    const q31_t *pCoeffs;
+    q31_t *pState;
+} arm_fir_decimate_instance_q31;
+
+typedef struct{
+    uint8_t L;
+    uint16_t phaseLength;
+    const q31_t *pCoeffs;
+    q31_t *pState;
+} arm_fir_interpolate_instance_q31;
+
+typedef struct{
+    uint16_t fftLenRFFT;
+} arm_rfft_fast_instance_f32;
+
+/*******************************************************************************************
+* Filters
+*******************************************************************************************/
+void arm_biquad_cascade_df1_init_q31(arm_biquad_casd_df1_inst_q31 *S, uint8_t numStages,
+                                     const q31_t *pCoeffs, q31_t *pState, int8_t postShift);
+void arm_biquad_cascade_df1_q31(const arm_biquad_casd_df1_inst_q31 *S, const q31_t *pSrc,
+                                q31_t *pDst, uint32_t blockSize);
+void arm_biquad_cas_df1_32x64_init_q31(arm_biquad_cas_df1_32x64_ins_q31 *S, uint8_t numStages,
+                                       const q31_t *pCoeffs, q63_t *pState, uint8_t postShift);
+void arm_biquad_cas_df1_32x64_q31(const arm_biquad_cas_df1_32x64_ins_q31 *S, q31_t *pSrc,
+                                  q31_t *pDst, uint32_t blockSize);
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S, uint8_t numStages,
+                                      const float32_t *pCoeffs, float32_t *pState);
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S,
+                                 const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_fir_init_q31(arm_fir_instance_q31 *S, uint16_t numTaps, const q31_t *pCoeffs,
+                      q31_t *pState, uint32_t blockSize);
+void arm_fir_q31(const arm_fir_instance_q31 *S, const q31_t *pSrc, q31_t *pDst,
+                 uint32_t blockSize);
+arm_status arm_fir_decimate_init_q31(arm_fir_decimate_instance_q31 *S, uint16_t numTaps,
+                                     uint8_t M, const q31_t *pCoeffs, q31_t *pState,
+                                     uint32_t blockSize);
+void arm_fir_decimate_q31(const arm_fir_decimate_instance_q31 *S, const q31_t *pSrc,
+                          q31_t *pDst, uint32_t blockSize);
+arm_status arm_fir_interpolate_init_q31(arm_fir_interpolate_instance_q31 *S, uint8_t L,
+                                        uint16_t numTaps, const q31_t *pCoeffs, q31_t *pState,
+                                        uint32_t blockSize);
+void arm_fir_interpolate_q31(const arm_fir_interpolate_instance_q31 *S, const q31_t *pSrc,
+                             q31_t *pDst, uint32_t blockSize);
+
+/*******************************************************************************************
+* Transforms
+*******************************************************************************************/
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen);
+void arm_rfft_fast_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut,
+                       uint8_t ifftFlag);
+void arm_cmplx_mag_squared_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+
+/*******************************************************************************************
+* Basic math, support and fast math
+*******************************************************************************************/
+void arm_abs_q31(const q31_t *pSrc, q31_t *pDst, uint32_t blockSize);
+void arm_add_q31(const q31_t *pSrcA, const q31_t *pSrcB, q31_t *pDst, uint32_t blockSize);
+void arm_sub_q31(const q31_t *pSrcA, const q31_t *pSrcB, q31_t *pDst, uint32_t blockSize);
+void arm_mult_q31(const q31_t *pSrcA, const q31_t *pSrcB, q31_t *pDst, uint32_t blockSize);
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst,
+                  uint32_t blockSize);
+void arm_offset_q31(const q31_t *pSrc, q31_t offset, q31_t *pDst, uint32_t blockSize);
+void arm_scale_q31(const q31_t *pSrc, q31_t scaleFract, int8_t shift, q31_t *pDst,
+                   uint32_t blockSize);
+void arm_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize);
+void arm_shift_q31(const q31_t *pSrc, int8_t shiftBits, q31_t *pDst, uint32_t blockSize);
+void arm_dot_prod_q31(const q31_t *pSrcA, const q31_t *pSrcB, uint32_t blockSize, q63_t *result);
+void arm_max_q31(const q31_t *pSrc, uint32_t blockSize, q31_t *pResult, uint32_t *pIndex);
+void arm_copy_q31(const q31_t *pSrc, q31_t *pDst, uint32_t blockSize);
+void arm_copy_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_fill_q31(q31_t value, q31_t *pDst, uint32_t blockSize);
+void arm_fill_f32(float32_t value, float32_t *pDst, uint32_t blockSize);
+void arm_float_to_q31(const float32_t *pSrc, q31_t *pDst, uint32_t blockSize);
+void arm_q31_to_float(const q31_t *pSrc, float32_t *pDst, uint32_t blockSize);
+float32_t arm_sin_f32(float32_t x);
+float32_t arm_cos_f32(float32_t x);
+
+#endif
@@ -0,0 +1,33 @@
+/*******************************************************************************************
+* cpu.h - Host stand-in for uCOS/uC-CPU/cpu.h
+*
+* uC-LIB reads the CPU word sizes and types from cpu.h. The target file also defines the
+* critical section macros in MCUType.h and declares the Cortex-M assembly, so the host
+* tools that build uC-LIB sources find this one first with -Ihost. The sizes are the
+* K65's, so the uC-LIB code takes the same paths as on the target.
+*
+* Not part of the firmware build.
+*******************************************************************************************/
+#ifndef  CPU_MODULE_PRESENT
+#define  CPU_MODULE_PRESENT
+
+#include "cpu_cfg.h"
+#include "cpu_def.h"
+
+typedef void                CPU_VOID;
+typedef float               CPU_FP32;
+typedef double              CPU_FP64;
+typedef CPU_DATA            CPU_ALIGN;
+typedef volatile CPU_INT08U CPU_REG08;
+typedef volatile CPU_INT16U CPU_REG16;
+typedef volatile CPU_INT32U CPU_REG32;
+typedef volatile CPU_INT64U CPU_REG64;
+typedef void                (*CPU_FNCT_VOID)(void);
+typedef void                (*CPU_FNCT_PTR)(void *p_obj);
+
+#define  CPU_CFG_ADDR_SIZE          CPU_WORD_SIZE_32
+#define  CPU_CFG_DATA_SIZE          CPU_WORD_SIZE_32
+#define  CPU_CFG_DATA_SIZE_MAX      CPU_WORD_SIZE_64
+#define  CPU_CFG_ENDIAN_TYPE        CPU_ENDIAN_TYPE_LITTLE
+
+#endif
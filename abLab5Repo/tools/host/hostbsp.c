@@ -0,0 +1,235 @@
+/*******************************************************************************************
+* hostbsp.c - Host stand-ins for uC/OS-III, the DMA ring, I2S, the CODEC and BasicIO
+*
+* Just enough for the DSP modules to link and run from main() on a Linux host. Nothing
+* here touches hardware: the CODEC and I2S calls are accepted and ignored, the DMA keeps
+* the ring layout for the tools (hostbsp.h) and BasicIO output is dropped.
+*
+* Not part of the firmware build.
+*******************************************************************************************/
+#include <time.h>
+#include "MCUType.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "K65DMA.h"
+#include "I2S.h"
+#include "TLV320AIC3007.h"
+#include "BasicIO.h"
+#include "hostbsp.h"
+
+/*******************************************************************************************
+* The K65 registers in MCUType.h
+*******************************************************************************************/
+HOST_DWT_T HostDwt;
+HOST_CORE_DEBUG_T HostCoreDebug;
+HOST_GPIO_T HostGpio[5];
+HOST_I2S_T HostI2s;
+
+/*******************************************************************************************
+* HostDwtGet - The DWT with CYCCNT loaded from the monotonic clock in ns. dspTask, the
+* chain and DSPProf take differences of CYCCNT, so their cycle counts and profiles read
+* as ns on the host. It wraps every 4.3 s, as the M4 counter does at 1 GHz.
+*******************************************************************************************/
+HOST_DWT_T *HostDwtGet(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    HostDwt.CYCCNT = (uint32_t)((uint64_t)ts.tv_sec*1000000000u + (uint64_t)ts.tv_nsec);
+    return &HostDwt;
+}
+
+/*******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static HOST_DMA_RING_T hostDmaRing;
+static INT32U hostDmaSeq = 0;
+static OS_TICK hostTick = 0;
+
+/*******************************************************************************************
+* uC/OS-III. Single threaded: tasks are not run and a pend never waits.
+*******************************************************************************************/
+void OSInit(OS_ERR *p_err){
+    *p_err = OS_ERR_NONE;
+}
+
+void OSStart(OS_ERR *p_err){
+    *p_err = OS_ERR_NONE;
+}
+
+void OSTaskCreate(OS_TCB *p_tcb, CPU_CHAR *p_name, OS_TASK_PTR p_task, void *p_arg,
+                  OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_limit,
+                  CPU_STK_SIZE stk_size, OS_MSG_QTY q_size, OS_TICK time_quanta,
+                  void *p_ext, OS_OPT opt, OS_ERR *p_err){
+    (void)p_name;
+    (void)p_arg;
+    (void)prio;
+    (void)p_stk_base;
+    (void)stk_limit;
+    (void)stk_size;
+    (void)q_size;
+    (void)time_quanta;
+    (void)p_ext;
+    (void)opt;
+    p_tcb->task = p_task;
+    *p_err = OS_ERR_NONE;
+}
+
+void OSTaskSuspend(OS_TCB *p_tcb, OS_ERR *p_err){
+    (void)p_tcb;
+    *p_err = OS_ERR_NONE;
+}
+
+void OSSemCreate(OS_SEM *p_sem, CPU_CHAR *p_name, OS_SEM_CTR cnt, OS_ERR *p_err){
+    (void)p_name;
+    p_sem->ctr = cnt;
+    *p_err = OS_ERR_NONE;
+}
+
+OS_SEM_CTR OSSemPend(OS_SEM *p_sem, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err){
+    (void)timeout;
+    (void)opt;
+    (void)p_ts;
+    if(p_sem->ctr == 0){
+        *p_err = OS_ERR_TIMEOUT;
+    }else{
+        p_sem->ctr--;
+        *p_err = OS_ERR_NONE;
+    }
+    return p_sem->ctr;
+}
+
+OS_SEM_CTR OSSemPost(OS_SEM *p_sem, OS_OPT opt, OS_ERR *p_err){
+    (void)opt;
+    p_sem->ctr++;
+    *p_err = OS_ERR_NONE;
+    return p_sem->ctr;
+}
+
+void OSSemSet(OS_SEM *p_sem, OS_SEM_CTR cnt, OS_ERR *p_err){
+    p_sem->ctr = cnt;
+    *p_err = OS_ERR_NONE;
+}
+
+void OSMutexCreate(OS_MUTEX *p_mutex, CPU_CHAR *p_name, OS_ERR *p_err){
+    (void)p_name;
+    p_mutex->nesting = 0;
+    *p_err = OS_ERR_NONE;
+}
+
+void OSMutexPend(OS_MUTEX *p_mutex, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err){
+    (void)timeout;
+    (void)opt;
+    (void)p_ts;
+    p_mutex->nesting++;
+    *p_err = OS_ERR_NONE;
+}
+
+void OSMutexPost(OS_MUTEX *p_mutex, OS_OPT opt, OS_ERR *p_err){
+    (void)opt;
+    p_mutex->nesting--;
+    *p_err = OS_ERR_NONE;
+}
+
+OS_TICK OSTimeGet(OS_ERR *p_err){
+    *p_err = OS_ERR_NONE;
+    return hostTick;
+}
+
+void OSTimeDly(OS_TICK dly, OS_OPT opt, OS_ERR *p_err){
+    (void)opt;
+    hostTick += dly;
+    *p_err = OS_ERR_NONE;
+}
+
+/*******************************************************************************************
+* DMA ring. The tools move the samples, see hostbsp.h.
+*******************************************************************************************/
+void DMAInit(q31_t *dsp_in_buf, q31_t *dsp_out_buf, INT32U block_size, INT8U num_blocks){
+    DMARingSet(dsp_in_buf, dsp_out_buf, block_size, num_blocks);
+}
+
+void DMAHalt(void){
+    hostDmaRing.running = 0;
+}
+
+void DMARingSet(q31_t *dsp_in_buf, q31_t *dsp_out_buf, INT32U block_size, INT8U num_blocks){
+    hostDmaRing.in = dsp_in_buf;
+    hostDmaRing.out = dsp_out_buf;
+    hostDmaRing.block_size = block_size;
+    hostDmaRing.num_blocks = num_blocks;
+    hostDmaRing.running = 1;
+}
+
+//Hands out the blocks in ring order, one block a call, never late
+INT8U DMAInPend(OS_TICK tout, DMA_IN_INFO_T *info, OS_ERR *os_err_ptr){
+    (void)tout;
+    info->seq = hostDmaSeq;
+    info->backlog = 1;
+    info->dropped = 0;
+    hostDmaSeq++;
+    *os_err_ptr = OS_ERR_NONE;
+    return (INT8U)(info->seq % hostDmaRing.num_blocks);
+}
+
+INT32U DMAInSeqGet(void){
+    return hostDmaSeq;
+}
+
+INT8U DMAInReadyGet(void){
+    return 0;
+}
+
+void HostDmaRingGet(HOST_DMA_RING_T *ring){
+    *ring = hostDmaRing;
+}
+
+q31_t *HostDmaInBlock(INT8U ch, INT8U buffer_index){
+    return &hostDmaRing.in[(ch*hostDmaRing.num_blocks + buffer_index)*hostDmaRing.block_size];
+}
+
+q31_t *HostDmaOutBlock(INT8U ch, INT8U buffer_index){
+    return &hostDmaRing.out[(ch*hostDmaRing.num_blocks + buffer_index)*hostDmaRing.block_size];
+}
+
+/*******************************************************************************************
+* I2S and CODEC, accepted and ignored
+*******************************************************************************************/
+void I2SInit(INT8U size_code, INT8U num_slots){
+    (void)size_code;
+    (void)num_slots;
+}
+
+void I2SWordSizeSet(INT8U size_code){
+    (void)size_code;
+}
+
+void CODECInit(void){
+}
+
+INT8U CODECSetSampleRate(INT8U rateCode){
+    (void)rateCode;
+    return 1;
+}
+
+INT8U CODECSetSampleSize(INT8U sizeCode){
+    (void)sizeCode;
+    return 1;
+}
+
+INT8U CODECSetTdm(INT8U enable){
+    (void)enable;
+    return 1;
+}
+
+INT8U CODECReadRegister(INT8U page, INT8U raddr){
+    (void)page;
+    (void)raddr;
+    return 0;
+}
+
+/*******************************************************************************************
+* BasicIO, the capture stream output is dropped
+*******************************************************************************************/
+void BIOWrite(INT8C c){
+    (void)c;
+}
@@ -0,0 +1,26 @@
+/*******************************************************************************************
+* hostbsp.h - Host stand-in for the DMA ring, for the tools that drive DSPBlockProcess()
+*
+* DSPInit() and DSPBlockLayoutSet() hand the sample arenas and the ring layout to the DMA
+* driver. The host DMA keeps them so a tool can play the role of the DMA: write the input
+* block, call DSPBlockProcess() and read the output block. Block b of channel ch starts at
+* sample (ch*num_blocks + b)*block_size of each arena, as in AppDSP.h.
+*
+* Not part of the firmware build.
+*******************************************************************************************/
+#ifndef  HOST_BSP_PRESENT
+#define  HOST_BSP_PRESENT
+
+typedef struct{
+    q31_t *in;                      //Input arena, DSP_NUM_IN_CHANNELS rings
+    q31_t *out;                     //Output arena, DSP_NUM_OUT_CHANNELS rings
+    INT32U block_size;
+    INT8U num_blocks;
+    INT8U running;                  //0 after DMAHalt() until the ring is set again
+} HOST_DMA_RING_T;
+
+void HostDmaRingGet(HOST_DMA_RING_T *ring);
+q31_t *HostDmaInBlock(INT8U ch, INT8U buffer_index);
+q31_t *HostDmaOutBlock(INT8U ch, INT8U buffer_index);
+
+#endif
@@ -0,0 +1,80 @@
+/*******************************************************************************************
+* os.h - Host stand-in for the uC/OS-III services the DSP modules use
+*
+* The host tools call the DSP functions directly from main(), so there is only one thread.
+* Tasks are never started, semaphores only count and a pend returns at once, with a
+* timeout error when the count is zero so a caller cannot wait forever. The tick only
+* advances in OSTimeDly().
+*
+* Not part of the firmware build.
+*******************************************************************************************/
+#ifndef  OS_H
+#define  OS_H
+
+typedef INT16U      OS_ERR;
+typedef INT16U      OS_OPT;
+typedef INT32U      OS_TICK;
+typedef INT32U      OS_SEM_CTR;
+typedef INT8U       OS_PRIO;
+typedef INT16U      OS_MSG_QTY;
+typedef INT8U       OS_STATE;
+typedef INT8U       OS_NESTING_CTR;
+typedef void        (*OS_TASK_PTR)(void *p_arg);
+
+typedef struct{
+    OS_SEM_CTR ctr;
+} OS_SEM;
+
+typedef struct{
+    INT32U nesting;
+} OS_MUTEX;
+
+typedef struct{
+    OS_TASK_PTR task;
+} OS_TCB;
+
+#define OS_ERR_NONE                 0u
+#define OS_ERR_TIMEOUT              29401u
+
+#define OS_OPT_NONE                 0x0000u
+#define OS_OPT_PEND_BLOCKING        0x0000u
+#define OS_OPT_PEND_NON_BLOCKING    0x8000u
+#define OS_OPT_POST_1               0x0000u
+#define OS_OPT_POST_NONE            0x0000u
+#define OS_OPT_POST_ALL             0x0200u
+#define OS_OPT_TASK_STK_CHK         0x0001u
+#define OS_OPT_TASK_STK_CLR         0x0002u
+#define OS_OPT_TIME_DLY             0x0000u
+
+#define OS_STATE_OS_STOPPED         0u
+#define OS_STATE_OS_RUNNING         1u
+
+//Kernel state BasicIO reads. Only tools/uarttest.c defines these and the task semaphore
+//and interrupt calls below.
+extern OS_STATE OSRunning;
+extern OS_NESTING_CTR OSIntNestingCtr;
+extern OS_NESTING_CTR OSSchedLockNestingCtr;
+extern OS_TCB *OSTCBCurPtr;
+
+void OSInit(OS_ERR *p_err);
+void OSStart(OS_ERR *p_err);
+void OSTaskCreate(OS_TCB *p_tcb, CPU_CHAR *p_name, OS_TASK_PTR p_task, void *p_arg,
+                  OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_limit,
+                  CPU_STK_SIZE stk_size, OS_MSG_QTY q_size, OS_TICK time_quanta,
+                  void *p_ext, OS_OPT opt, OS_ERR *p_err);
+void OSTaskSuspend(OS_TCB *p_tcb, OS_ERR *p_err);
+void OSSemCreate(OS_SEM *p_sem, CPU_CHAR *p_name, OS_SEM_CTR cnt, OS_ERR *p_err);
+OS_SEM_CTR OSSemPend(OS_SEM *p_sem, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err);
+OS_SEM_CTR OSSemPost(OS_SEM *p_sem, OS_OPT opt, OS_ERR *p_err);
+void OSSemSet(OS_SEM *p_sem, OS_SEM_CTR cnt, OS_ERR *p_err);
+void OSMutexCreate(OS_MUTEX *p_mutex, CPU_CHAR *p_name, OS_ERR *p_err);
+void OSMutexPend(OS_MUTEX *p_mutex, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err);
+void OSMutexPost(OS_MUTEX *p_mutex, OS_OPT opt, OS_ERR *p_err);
+OS_SEM_CTR OSTaskSemPend(OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err);
+OS_SEM_CTR OSTaskSemPost(OS_TCB *p_tcb, OS_OPT opt, OS_ERR *p_err);
+void OSIntEnter(void);
+void OSIntExit(void);
+OS_TICK OSTimeGet(OS_ERR *p_err);
+void OSTimeDly(OS_TICK dly, OS_OPT opt, OS_ERR *p_err);
+
+#endif
@@ -0,0 +1,194 @@
+/*******************************************************************************************
+* lattest.c
+* Host check of the round trip latency measurement in source/DSPLatency.c against a
+* simulated DMA loopback. The firmware DSPInit(), DSPBlockLayoutSet() and
+* DSPBlockProcess() run as on the board. This file plays the DMA and the cable: in block
+* period k the DMA plays output ring block k mod N and records input ring block k mod N
+* a sample at a time, and at the end of the period dspTask processes that block. Each
+* played sample comes back on the same channel's input a fixed cable delay later, the
+* stand-in for the I2S FIFOs and the CODEC, optionally inverted and with noise added.
+* With N blocks of B samples, output written for block k is played N periods later, so
+* the measured lag must be exactly
+*   N*B + cable delay       recording the input
+*   N*B                     with the simulated loopback, which ignores the input
+* for every layout, impulse and MLS, with the peak clear of the correlation floor. With
+* the cable unplugged the input is only noise and the result must be DSP_LAT_ERR_NO_PEAK.
+*
+* Build from tools/:
+*   cc -std=gnu99 -O2 -include host/MCUType.h -Ihost -I../source -I../board -I../uCOS/uC-CFG
+*      -o lattest lattest.c host/arm_math.c host/hostbsp.c
+*      ../source/AppDSP_byrne_lab5.c ../source/DSPBiquad.c ../source/DSPCapture.c
+*      ../source/DSPChain.c ../source/DSPConv.c ../source/DSPDesign.c ../source/DSPDyn.c
+*      ../source/DSPLatency.c ../source/DSPMultirate.c ../source/DSPNco.c
+*      ../source/DSPProf.c ../source/DSPSpectrum.c ../source/DSPTone.c -lm
+* Usage:  lattest        Exits with 1 on a wrong lag or a missed burst.
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include "MCUType.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPLatency.h"
+#include "hostbsp.h"
+
+/******************************************************************************************
+* Test constants
+*******************************************************************************************/
+#define LTT_CABLE_MAX       128u            //Longest simulated FIFO and CODEC delay
+#define LTT_UNPLUGGED       0xFFFFu         //Cable delay of a run with no loopback
+#define LTT_MAX_PERIODS     (DSP_LAT_CAPTURE/DSP_BLOCK_SIZE_MIN + 2u)   //Then it timed out
+
+typedef struct{
+    INT16U block_size;
+    INT8U num_blocks;
+    INT8U mode;
+    INT8U sim;
+    INT8U invert;
+    INT16U cable;                           //Samples below LTT_CABLE_MAX, or LTT_UNPLUGGED
+    INT32U noise;                           //Peak of the added noise, q31
+} LTT_CASE_T;
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static const LTT_CASE_T lttCases[] = {
+    {512, 2, DSP_LAT_MODE_MLS, 0, 0, 37, 0},
+    {512, 2, DSP_LAT_MODE_MLS, 0, 1, 37, 0x26666666},   //Inverted under -6 dBFS noise
+    {512, 2, DSP_LAT_MODE_IMPULSE, 0, 0, 37, 0},
+    {512, 2, DSP_LAT_MODE_IMPULSE, 0, 0, 37, 0x00400000},
+    {512, 2, DSP_LAT_MODE_MLS, 1, 0, 37, 0},
+    {32, 2, DSP_LAT_MODE_MLS, 0, 0, 5, 0x04000000},
+    {32, 8, DSP_LAT_MODE_IMPULSE, 0, 0, 0, 0},
+    {128, 4, DSP_LAT_MODE_MLS, 0, 0, 61, 0x10000000},
+    {256, 8, DSP_LAT_MODE_MLS, 0, 0, 0, 0},
+    {256, 8, DSP_LAT_MODE_MLS, 1, 0, 23, 0},
+    {1024, 2, DSP_LAT_MODE_MLS, 0, 0, 127, 0x04000000},
+    {1024, 2, DSP_LAT_MODE_IMPULSE, 1, 0, 127, 0},
+    {512, 2, DSP_LAT_MODE_MLS, 0, 0, LTT_UNPLUGGED, 0x04000000},
+    {512, 2, DSP_LAT_MODE_IMPULSE, 0, 0, LTT_UNPLUGGED, 0x04000000}
+};
+static const char *const lttModeNames[] = {"impulse", "MLS"};
+static q31_t lttCable[DSP_NUM_OUT_CHANNELS][LTT_CABLE_MAX];
+static INT32U lttRandState = 0xC2B2AE35u;
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static INT32U lttRand(void);
+static INT32U lttRun(const LTT_CASE_T *tc);
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(void){
+    INT32U fails = 0;
+    INT32U n;
+
+    DSPInit();
+    for(n=0;n<(sizeof(lttCases)/sizeof(lttCases[0]));n++){
+        fails += lttRun(&lttCases[n]);
+    }
+    printf("latency against the simulated DMA loopback: %s\n", (fails == 0) ? "pass" : "FAIL");
+    return (fails == 0) ? 0 : 1;
+}
+
+/*******************************************************************************************
+* lttRand - xorshift32
+*******************************************************************************************/
+static INT32U lttRand(void){
+    lttRandState ^= lttRandState << 13;
+    lttRandState ^= lttRandState >> 17;
+    lttRandState ^= lttRandState << 5;
+    return lttRandState;
+}
+
+/*******************************************************************************************
+* lttRun - Runs one measurement through the simulated DMA and cable and checks the lag
+*******************************************************************************************/
+static INT32U lttRun(const LTT_CASE_T *tc){
+    DSP_LAT_RESULT_T result;
+    HOST_DMA_RING_T ring;
+    q31_t *in_blk;
+    q31_t *out_blk;
+    INT64S v;
+    INT32U expect;
+    INT32U fail;
+    INT32U period;
+    INT32U tap = 0;
+    INT32U i;
+    INT8U buffer_index;
+    INT8U err;
+    INT8U ch;
+
+    err = DSPBlockLayoutSet(tc->block_size, tc->num_blocks);
+    if(err != DSP_BLOCK_ERR_NONE){
+        printf("%u x %u: layout refused, error %u  FAIL\n", (unsigned)tc->block_size,
+               (unsigned)tc->num_blocks, (unsigned)err);
+        return 1;
+    }else{
+    }
+    HostDmaRingGet(&ring);
+    for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+        for(i=0;i<LTT_CABLE_MAX;i++){
+            lttCable[ch][i] = 0;
+        }
+    }
+    (void)DSPLatencyStart(tc->mode, LEFT_IN, tc->sim);
+
+    for(period=0;(period < LTT_MAX_PERIODS) && (DSPLatencyIsDone() == 0);period++){
+        buffer_index = (INT8U)(period % ring.num_blocks);
+        for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+            out_blk = HostDmaOutBlock(ch, buffer_index);
+            in_blk = HostDmaInBlock(ch, buffer_index);
+            for(i=0;i<ring.block_size;i++){
+                //The cable is a delay line of tc->cable samples, tap is shared by the channels
+                if(tc->cable != LTT_UNPLUGGED){
+                    lttCable[ch][(tap + i + tc->cable) % LTT_CABLE_MAX] = out_blk[i];
+                    v = lttCable[ch][(tap + i) % LTT_CABLE_MAX];
+                }else{
+                    v = 0;
+                }
+                if(tc->invert != 0){
+                    v = -v;
+                }else{
+                }
+                if(tc->noise != 0){
+                    v += (INT64S)(q31_t)lttRand() % (INT64S)tc->noise;
+                }else{
+                }
+                if(v > 0x7FFFFFFF){
+                    v = 0x7FFFFFFF;
+                }else if(v < -0x7FFFFFFF){
+                    v = -0x7FFFFFFF;
+                }else{
+                }
+                in_blk[i] = (q31_t)v;
+            }
+        }
+        tap += ring.block_size;
+        DSPBlockProcess(buffer_index);
+    }
+
+    err = DSPLatencyResultGet(&result);
+    printf("%4u x %u %-7s %s ", (unsigned)tc->block_size, (unsigned)tc->num_blocks,
+           lttModeNames[tc->mode], (tc->sim != 0) ? "sim " : "wire");
+    if(tc->cable == LTT_UNPLUGGED){
+        fail = (INT32U)(err != DSP_LAT_ERR_NO_PEAK);
+        printf("unplugged%s: peak %3u x floor, error %u", (tc->noise != 0) ? " noisy" : "",
+               (unsigned)result.peak_ratio, (unsigned)err);
+    }else{
+        expect = (INT32U)ring.num_blocks*ring.block_size + ((tc->sim != 0) ? 0u : tc->cable);
+        printf("cable %3u%s%s: lag %4u, expected %4u, peak %3u x floor", (unsigned)tc->cable,
+               (tc->invert != 0) ? " inverted" : "", (tc->noise != 0) ? " noisy" : "",
+               (unsigned)result.lag, (unsigned)expect, (unsigned)result.peak_ratio);
+        fail = (INT32U)((err != DSP_LAT_ERR_NONE) || (result.lag != expect));
+    }
+    if((fail != 0) || (result.ring != ((INT32U)ring.num_blocks*ring.block_size))){
+        printf("  FAIL\n");
+        return 1;
+    }else{
+        printf("\n");
+        return 0;
+    }
+}
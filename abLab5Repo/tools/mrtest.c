@@ -0,0 +1,199 @@
+/*******************************************************************************************
+* mrtest.c
+* Host check that a chain with multirate stages gives the same output no matter where
+* the block boundaries fall, as DSPMultirate.c promises. The left channel decimates by 4
+* and runs sub-chain 0 (a designed biquad cascade, a gain and a 32 tap FIR), the right
+* channel has a full rate biquad and decimates by 8 into sub-chain 1. The whole signal is
+* run once in blocks of DSP_BLOCK_SIZE_MAX, the longest one call takes, and again split
+* into every smaller runtime block size and into random mixes of them, rebuilding the
+* chain each time. Every split must be bit-exact with the whole run. Adding a third
+* multirate stage that reuses sub-chain 0 must be refused with DSP_CHAIN_ERR_PARAM.
+*
+* Build from tools/:
+*   cc -std=gnu99 -O2 -include host/MCUType.h -Ihost -I../source -I../board -I../uCOS/uC-CFG
+*      -o mrtest mrtest.c host/arm_math.c host/hostbsp.c
+*      ../source/AppDSP_byrne_lab5.c ../source/DSPBiquad.c ../source/DSPCapture.c
+*      ../source/DSPChain.c ../source/DSPConv.c ../source/DSPDesign.c ../source/DSPDyn.c
+*      ../source/DSPLatency.c ../source/DSPMultirate.c ../source/DSPNco.c
+*      ../source/DSPProf.c ../source/DSPSpectrum.c ../source/DSPTone.c -lm
+* Usage:  mrtest        Exits with 1 on any difference.
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include "MCUType.h"
+#include "os.h"
+#include "AppDSP.h"
+#include "DSPProf.h"
+#include "DSPDesign.h"
+#include "DSPChain.h"
+
+/******************************************************************************************
+* Test constants
+*******************************************************************************************/
+#define MRT_NUM_SAMPLES     (16u*DSP_BLOCK_SIZE_MAX)
+#define MRT_NUM_RANDOM      8u              //Runs with a random mix of block sizes
+#define MRT_FIR_TAPS        32u
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static const DSP_DESIGN_T mrtSubDesign[2] = {
+    {DSP_DESIGN_LP, 2000.0f, 0.707f, 0.0f},
+    {DSP_DESIGN_PEAK, 800.0f, 1.5f, 6.0f}
+};
+static const DSP_DESIGN_T mrtFullDesign[1] = {
+    {DSP_DESIGN_HP, 150.0f, 0.707f, 0.0f}
+};
+static q31_t mrtFir[MRT_FIR_TAPS];
+static q31_t mrtIn[2][MRT_NUM_SAMPLES];
+static q31_t mrtRef[2][MRT_NUM_SAMPLES];
+static q31_t mrtOut[2][MRT_NUM_SAMPLES];
+static q31_t mrtChOut[DSP_NUM_OUT_CHANNELS][DSP_BLOCK_SIZE_MAX];
+static INT32U mrtRandState = 0xB5297A4Du;
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static INT32U mrtRand(void);
+static INT8U mrtBuild(void);
+static void mrtRun(q31_t out[2][MRT_NUM_SAMPLES], INT32U fixed_size);
+static INT32U mrtCompare(void);
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(void){
+    INT32U fails = 0;
+    INT32U block_size;
+    INT32U n;
+    INT8U err;
+
+    for(n=0;n<MRT_NUM_SAMPLES;n++){
+        mrtIn[0][n] = (q31_t)mrtRand() >> 1;
+        mrtIn[1][n] = (q31_t)mrtRand() >> 1;
+    }
+    for(n=0;n<MRT_FIR_TAPS;n++){
+        mrtFir[n] = (q31_t)mrtRand() >> 6;
+    }
+
+    DSPInit();
+    if(mrtBuild() != DSP_CHAIN_ERR_NONE){
+        printf("chain build failed\n");
+        return 1;
+    }else{
+    }
+    err = DSPChainMultirateAdd(DSP_LEFT_CH, 2, 0);
+    if(err != DSP_CHAIN_ERR_PARAM){
+        printf("shared sub-chain: got error %u, expected %u  FAIL\n", (unsigned)err,
+               (unsigned)DSP_CHAIN_ERR_PARAM);
+        fails++;
+    }else{
+        printf("shared sub-chain refused: pass\n");
+    }
+
+    mrtRun(mrtRef, DSP_BLOCK_SIZE_MAX);
+    for(block_size=DSP_BLOCK_SIZE_MIN;block_size<DSP_BLOCK_SIZE_MAX;block_size*=2){
+        (void)mrtBuild();
+        mrtRun(mrtOut, block_size);
+        printf("block %4u: ", (unsigned)block_size);
+        fails += mrtCompare();
+    }
+    for(n=0;n<MRT_NUM_RANDOM;n++){
+        (void)mrtBuild();
+        mrtRun(mrtOut, 0);
+        printf("random mix: ");
+        fails += mrtCompare();
+    }
+    printf("block boundary check: %s\n", (fails == 0) ? "pass" : "FAIL");
+    return (fails == 0) ? 0 : 1;
+}
+
+/*******************************************************************************************
+* mrtRand - xorshift32
+*******************************************************************************************/
+static INT32U mrtRand(void){
+    mrtRandState ^= mrtRandState << 13;
+    mrtRandState ^= mrtRandState >> 17;
+    mrtRandState ^= mrtRandState << 5;
+    return mrtRandState;
+}
+
+/*******************************************************************************************
+* mrtBuild - Clears every chain row and builds the test chain with zero state
+*******************************************************************************************/
+static INT8U mrtBuild(void){
+    INT8U err = DSP_CHAIN_ERR_NONE;
+    INT8U ch;
+
+    for(ch=0;ch<DSP_CHAIN_NUM_ROWS;ch++){
+        (void)DSPChainClear(ch);
+    }
+    err |= DSPChainMultirateAdd(DSP_LEFT_CH, 4, 0);
+    err |= DSPChainBiquadDesignAdd(DSP_CHAIN_SUB_CH(0), mrtSubDesign, 2);
+    err |= DSPChainGainAdd(DSP_CHAIN_SUB_CH(0), 1500);
+    err |= DSPChainFirAdd(DSP_CHAIN_SUB_CH(0), mrtFir, MRT_FIR_TAPS);
+    err |= DSPChainBiquadDesignAdd(DSP_RIGHT_CH, mrtFullDesign, 1);
+    err |= DSPChainMultirateAdd(DSP_RIGHT_CH, 8, 1);
+    err |= DSPChainBiquadDesignAdd(DSP_CHAIN_SUB_CH(1), mrtSubDesign, 1);
+    return err;
+}
+
+/*******************************************************************************************
+* mrtRun - Runs the whole signal through the chain in blocks of fixed_size, or of random
+* runtime block sizes if fixed_size is 0, and keeps the left and right outputs
+*******************************************************************************************/
+static void mrtRun(q31_t out[2][MRT_NUM_SAMPLES], INT32U fixed_size){
+    q31_t *in_blk[DSP_NUM_IN_CHANNELS];
+    q31_t *out_blk[DSP_NUM_OUT_CHANNELS];
+    INT32U block_size;
+    INT32U n = 0;
+    INT8U ch;
+
+    for(ch=0;ch<DSP_NUM_OUT_CHANNELS;ch++){
+        out_blk[ch] = mrtChOut[ch];
+    }
+    while(n < MRT_NUM_SAMPLES){
+        if(fixed_size != 0){
+            block_size = fixed_size;
+        }else{
+            block_size = DSP_BLOCK_SIZE_MIN << (mrtRand() % 6u);
+            while((n + block_size) > MRT_NUM_SAMPLES){
+                block_size /= 2;
+            }
+        }
+        for(ch=0;ch<DSP_NUM_IN_CHANNELS;ch++){
+            in_blk[ch] = &mrtIn[(ch == DSP_RIGHT_CH) ? 1 : 0][n];
+        }
+        DSPChainProcess(in_blk, out_blk, block_size);
+        arm_copy_q31(out_blk[DSP_LEFT_CH], &out[0][n], block_size);
+        arm_copy_q31(out_blk[DSP_RIGHT_CH], &out[1][n], block_size);
+        n += block_size;
+    }
+}
+
+/*******************************************************************************************
+* mrtCompare - Counts the output samples that differ from the whole run
+*******************************************************************************************/
+static INT32U mrtCompare(void){
+    INT32U diffs = 0;
+    INT32U first = MRT_NUM_SAMPLES;
+    INT32U n;
+
+    for(n=0;n<MRT_NUM_SAMPLES;n++){
+        if((mrtOut[0][n] != mrtRef[0][n]) || (mrtOut[1][n] != mrtRef[1][n])){
+            if(diffs == 0){
+                first = n;
+            }else{
+            }
+            diffs++;
+        }else{
+        }
+    }
+    if(diffs == 0){
+        printf("bit-exact\n");
+    }else{
+        printf("%u samples differ, first at %u  FAIL\n", (unsigned)diffs, (unsigned)first);
+    }
+    return (diffs != 0) ? 1u : 0u;
+}
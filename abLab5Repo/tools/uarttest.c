@@ -0,0 +1,395 @@
+/*******************************************************************************************
+* uarttest.c
+* Host check of the BasicIO transmit ring and the UART2 interrupt in board/BasicIO.c. The
+* board file is built unchanged against a model of the UART2 registers and of the few
+* uC/OS-III calls it makes:
+*   - Every UART2 access is one step of model time. A byte written to D clears TDRE and
+*     goes out on the wire UAT_BYTE_STEPS steps later, when TDRE sets again. The data
+*     register is one deep, so a write while TDRE is clear is counted as a lost byte.
+*   - A received byte sets RDRF and holds D. The access after the one that saw RDRF (the
+*     read of D that follows the read of S1) clears it.
+*   - The interrupt runs whenever the task side lets time pass and TIE with TDRE or RIE
+*     with RDRF is set. Time passes between writes, in OSTimeDly() and while a task is
+*     pended in OSSemPend() or OSTaskSemPend(). A pend that is not posted within
+*     UAT_PEND_STEPS is a lost wakeup.
+* The checks:
+*   polled      before OSStart() BIOWrite() polls TDRE, the ring and TIE are not used
+*   ring        a task writes UAT_NUM_TX bytes, more than the ring holds, in random
+*               bursts while bytes are also received. Every byte must reach the wire in
+*               order, the writer must pend on a full ring and only be woken once
+*               UAT_SPACE_POST bytes are free, and TIE must be off once it is empty
+*   no pend     the same from an ISR and with the scheduler locked, where BIOWrite() has
+*               to drain the full ring itself and must not pend
+* This is a model of the K65 UART as BasicIO uses it, not of its FIFO or its timing on
+* the wire, so it checks the ring and interrupt logic, not the board.
+*
+* Build from tools/:
+*   cc -std=gnu99 -O2 -include host/MCUType.h -Ihost -I../board -I../source
+*      -o uarttest uarttest.c ../board/BasicIO.c
+* Usage:  uarttest        Exits with 1 on any failure.
+*
+* This file is not part of the firmware build.
+*******************************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "MCUType.h"
+#include "os.h"
+#include "BasicIO.h"
+
+/******************************************************************************************
+* Test constants
+*******************************************************************************************/
+#define UAT_BYTE_STEPS      4u              //Model steps for one byte to leave the UART
+#define UAT_TICK_STEPS      200u            //Model steps in one OSTimeDly() tick
+#define UAT_PEND_STEPS      100000u         //Longest a pend may wait for its post
+#define UAT_NUM_TX          (5u*BIO_TX_RING_SIZE)
+#define UAT_NUM_RX          (BIO_RX_RING_SIZE/2)
+#define UAT_WIRE_MAX        (8u*BIO_TX_RING_SIZE)
+#define UAT_D_IDLE          0x100u          //D bit 8: no byte written by BasicIO
+#define UAT_SPACE_POST      (BIO_TX_RING_SIZE/4)    //BIO_TX_SPACE_POST in BasicIO.c
+
+/******************************************************************************************
+* UART2, SIM and PORTE for BasicIO.c, and the kernel state it reads
+*******************************************************************************************/
+HOST_SIM_T HostSim;
+HOST_PORT_T HostPorte;
+OS_STATE OSRunning = OS_STATE_OS_STOPPED;
+OS_NESTING_CTR OSIntNestingCtr = 0;
+OS_NESTING_CTR OSSchedLockNestingCtr = 0;
+OS_TCB *OSTCBCurPtr;
+void UART2_RX_TX_IRQHandler(void);      //In the vector table on the K65
+
+/******************************************************************************************
+* Private variables
+*******************************************************************************************/
+static HOST_UART_T uatUart;
+static OS_TCB uatTask;
+static OS_SEM_CTR uatTaskSem = 0;
+static INT32U uatStep = 0;
+static INT32U uatTxStart = 0;
+static INT8U uatRxData = 0;
+static INT8U uatRdrfSeen = 0;
+static INT8U uatWire[UAT_WIRE_MAX];
+static INT32U uatWireLen = 0;
+static INT8U uatTx[UAT_NUM_TX];
+static INT8U uatRx[UAT_NUM_RX];
+static INT32U uatRandState = 0x6C078965u;
+
+//Faults seen by the model
+static INT32U uatLost = 0;          //Bytes written to D while TDRE was clear
+static INT32U uatBadPends = 0;      //Pends from an ISR or with the scheduler locked
+static INT32U uatLostWakeups = 0;   //Pends never posted
+static INT32U uatEarlyWakeups = 0;  //Writers woken before UAT_SPACE_POST were free
+static INT32U uatPends = 0;
+
+/******************************************************************************************
+* Private Function Prototypes
+*******************************************************************************************/
+static INT32U uatRand(void);
+static void uatTick(void);
+static void uatRun(INT32U steps);
+static void uatRxByte(INT8U c);
+static INT32U uatCheck(const char *name, const INT8U *sent, INT32U len);
+
+/*******************************************************************************************
+* main
+*******************************************************************************************/
+int main(void){
+    static const char polled[] = "written before OSStart\r\n";
+    BIO_RX_ERR_T rx_err;
+    INT32U fails = 0;
+    INT32U rx_sent = 0;
+    INT32U rx_got = 0;
+    INT32U n;
+    INT8U mode;
+    INT8C c;
+
+    for(n=0;n<UAT_NUM_TX;n++){
+        uatTx[n] = (INT8U)uatRand();
+    }
+    for(n=0;n<UAT_NUM_RX;n++){
+        uatRx[n] = (INT8U)((uatRand() % 94u) + 33u);    //Printable, BIORead() returns 0 for none
+    }
+    uatUart.S1 = UART_S1_TDRE_MASK;
+    uatUart.D = UAT_D_IDLE;
+    OSTCBCurPtr = &uatTask;
+
+    //Before OSStart(): polled, nothing queued and no TX interrupt
+    BIOOpen(BIO_BIT_RATE_115200);
+    if((uatUart.C2 & (UART_C2_TE_MASK | UART_C2_RE_MASK | UART_C2_RIE_MASK | UART_C2_TIE_MASK))
+       != (UART_C2_TE_MASK | UART_C2_RE_MASK | UART_C2_RIE_MASK)){
+        printf("BIOOpen: C2 0x%02X  FAIL\n", (unsigned)uatUart.C2);
+        fails++;
+    }else{
+    }
+    BIOPutStrg(polled);
+    uatRun(2u*UAT_BYTE_STEPS);
+    fails += uatCheck("polled", (const INT8U *)polled, (INT32U)strlen(polled));
+
+    //A task writes more than the ring holds in random bursts while bytes arrive
+    OSRunning = OS_STATE_OS_RUNNING;
+    n = 0;
+    while(n < UAT_NUM_TX){
+        BIOWrite((INT8C)uatTx[n]);
+        n++;
+        if((uatRand() % 64u) == 0){
+            uatRun(uatRand() % (4u*UAT_BYTE_STEPS));
+        }else{
+        }
+        if((rx_sent < UAT_NUM_RX) && ((uatRand() % 32u) == 0)){
+            uatRxByte(uatRx[rx_sent]);
+            rx_sent++;
+        }else{
+        }
+    }
+    BIOTxFlush();
+    uatRun(2u*UAT_BYTE_STEPS);
+    fails += uatCheck("ring", uatTx, UAT_NUM_TX);
+    printf("  writer pended %u times\n", (unsigned)uatPends);
+    if(uatPends == 0){
+        printf("  a full ring did not pend the writer  FAIL\n");
+        fails++;
+    }else{
+    }
+    while((c = BIORead()) != '\0'){
+        if((rx_got >= rx_sent) || ((INT8U)c != uatRx[rx_got])){
+            break;
+        }else{
+        }
+        rx_got++;
+    }
+    BIORxErrGet(&rx_err);
+    printf("  received %u of %u bytes, %u overruns, %u dropped\n", (unsigned)rx_got,
+           (unsigned)rx_sent, (unsigned)rx_err.overruns, (unsigned)rx_err.dropped);
+    if((rx_got != rx_sent) || (rx_err.overruns != 0) || (rx_err.dropped != 0)){
+        printf("  receive alongside transmit  FAIL\n");
+        fails++;
+    }else{
+    }
+
+    //From an ISR and with the scheduler locked the writer drains the ring itself
+    for(mode=0;mode<2;mode++){
+        if(mode == 0){
+            OSIntNestingCtr = 1;
+        }else{
+            OSSchedLockNestingCtr = 1;
+        }
+        for(n=0;n<(2u*BIO_TX_RING_SIZE);n++){
+            BIOWrite((INT8C)uatTx[n]);
+        }
+        BIOTxFlush();
+        uatRun(2u*UAT_BYTE_STEPS);
+        OSIntNestingCtr = 0;
+        OSSchedLockNestingCtr = 0;
+        fails += uatCheck((mode == 0) ? "ISR" : "sched lock", uatTx, 2u*BIO_TX_RING_SIZE);
+    }
+
+    if((uatLost != 0) || (uatBadPends != 0) || (uatLostWakeups != 0) || (uatEarlyWakeups != 0)){
+        printf("lost bytes %u, bad pends %u, lost wakeups %u, early wakeups %u  FAIL\n",
+               (unsigned)uatLost, (unsigned)uatBadPends, (unsigned)uatLostWakeups,
+               (unsigned)uatEarlyWakeups);
+        fails++;
+    }else{
+    }
+    printf("BasicIO UART model check: %s\n", (fails == 0) ? "pass" : "FAIL");
+    return (fails == 0) ? 0 : 1;
+}
+
+/*******************************************************************************************
+* HostUartGet - UART2 for BasicIO.c. Each access is a step of model time and clears RDRF
+* on the read of D after S1.
+*******************************************************************************************/
+HOST_UART_T *HostUartGet(void){
+    uatTick();
+    if(uatRdrfSeen != 0){
+        uatUart.S1 &= (uint8_t)~(UART_S1_RDRF_MASK | UART_S1_OR_MASK);
+        uatRdrfSeen = 0;
+    }else if((uatUart.S1 & UART_S1_RDRF_MASK) != 0){
+        uatRdrfSeen = 1;
+    }else{
+    }
+    return &uatUart;
+}
+
+/*******************************************************************************************
+* uatTick - One step of model time. Takes a byte written to D since the last step and
+* sends the byte in the transmitter once it has had UAT_BYTE_STEPS.
+*******************************************************************************************/
+static void uatTick(void){
+    uatStep++;
+    if((uatUart.D & UAT_D_IDLE) == 0){
+        if((uatUart.S1 & UART_S1_TDRE_MASK) == 0){
+            uatLost++;
+        }else{
+            uatUart.S1 &= (uint8_t)~UART_S1_TDRE_MASK;
+            uatWire[uatWireLen % UAT_WIRE_MAX] = (INT8U)uatUart.D;
+            uatTxStart = uatStep;
+        }
+        uatUart.D = UAT_D_IDLE | uatRxData;
+    }else{
+    }
+    if(((uatUart.S1 & UART_S1_TDRE_MASK) == 0) && ((uatStep - uatTxStart) >= UAT_BYTE_STEPS)){
+        uatWireLen++;
+        uatUart.S1 |= UART_S1_TDRE_MASK;
+    }else{
+    }
+}
+
+/*******************************************************************************************
+* uatRun - Lets steps of model time pass outside any critical section, running the UART2
+* interrupt whenever it is enabled and pending
+*******************************************************************************************/
+static void uatRun(INT32U steps){
+    INT32U n;
+
+    for(n=0;n<steps;n++){
+        uatTick();
+        if((((uatUart.C2 & UART_C2_TIE_MASK) != 0) && ((uatUart.S1 & UART_S1_TDRE_MASK) != 0)) ||
+           (((uatUart.C2 & UART_C2_RIE_MASK) != 0) && ((uatUart.S1 & UART_S1_RDRF_MASK) != 0))){
+            UART2_RX_TX_IRQHandler();
+        }else{
+        }
+    }
+}
+
+/*******************************************************************************************
+* uatRxByte - A byte arrives and its interrupt runs
+*******************************************************************************************/
+static void uatRxByte(INT8U c){
+    uatRxData = c;
+    uatUart.D = UAT_D_IDLE | c;
+    uatUart.S1 |= UART_S1_RDRF_MASK;
+    uatRun(1);
+}
+
+/*******************************************************************************************
+* uatCheck - Compares the wire with what was sent and starts a new wire
+*******************************************************************************************/
+static INT32U uatCheck(const char *name, const INT8U *sent, INT32U len){
+    INT32U fail = 0;
+    INT32U n;
+
+    if(uatWireLen != len){
+        printf("%s: %u bytes on the wire, %u sent  FAIL\n", name, (unsigned)uatWireLen,
+               (unsigned)len);
+        fail = 1;
+    }else if((uatUart.C2 & UART_C2_TIE_MASK) != 0){
+        printf("%s: TIE still set with the ring empty  FAIL\n", name);
+        fail = 1;
+    }else{
+        for(n=0;n<len;n++){
+            if(uatWire[n] != sent[n]){
+                printf("%s: byte %u differs  FAIL\n", name, (unsigned)n);
+                fail = 1;
+                break;
+            }else{
+            }
+        }
+        if(fail == 0){
+            printf("%s: %u bytes in order, TIE off: pass\n", name, (unsigned)len);
+        }else{
+        }
+    }
+    uatWireLen = 0;
+    return fail;
+}
+
+/*******************************************************************************************
+* uatRand - xorshift32
+*******************************************************************************************/
+static INT32U uatRand(void){
+    uatRandState ^= uatRandState << 13;
+    uatRandState ^= uatRandState >> 17;
+    uatRandState ^= uatRandState << 5;
+    return uatRandState;
+}
+
+/*******************************************************************************************
+* uC/OS-III calls BasicIO makes. A pend lets model time pass until it is posted. A writer
+* pended on a full ring must find UAT_SPACE_POST bytes gone when it is woken; the byte
+* still in the transmitter has left the ring but is not on the wire yet.
+*******************************************************************************************/
+void OSSemCreate(OS_SEM *p_sem, CPU_CHAR *p_name, OS_SEM_CTR cnt, OS_ERR *p_err){
+    (void)p_name;
+    p_sem->ctr = cnt;
+    *p_err = OS_ERR_NONE;
+}
+
+OS_SEM_CTR OSSemPend(OS_SEM *p_sem, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err){
+    INT32U wire_start = uatWireLen;
+    INT32U n = 0;
+
+    (void)timeout;
+    (void)opt;
+    (void)p_ts;
+    uatPends++;
+    if((OSIntNestingCtr != 0) || (OSSchedLockNestingCtr != 0)){
+        uatBadPends++;
+    }else{
+    }
+    while((p_sem->ctr == 0) && (n < UAT_PEND_STEPS)){
+        uatRun(1);
+        n++;
+    }
+    if(p_sem->ctr == 0){
+        uatLostWakeups++;
+        *p_err = OS_ERR_TIMEOUT;
+    }else{
+        if((uatWireLen - wire_start + 1u) < UAT_SPACE_POST){
+            uatEarlyWakeups++;
+        }else{
+        }
+        p_sem->ctr--;
+        *p_err = OS_ERR_NONE;
+    }
+    return p_sem->ctr;
+}
+
+OS_SEM_CTR OSSemPost(OS_SEM *p_sem, OS_OPT opt, OS_ERR *p_err){
+    (void)opt;
+    p_sem->ctr++;
+    *p_err = OS_ERR_NONE;
+    return p_sem->ctr;
+}
+
+OS_SEM_CTR OSTaskSemPend(OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err){
+    INT32U n = 0;
+
+    (void)timeout;
+    (void)opt;
+    (void)p_ts;
+    while((uatTaskSem == 0) && (n < UAT_PEND_STEPS)){
+        uatRun(1);
+        n++;
+    }
+    if(uatTaskSem == 0){
+        uatLostWakeups++;
+        *p_err = OS_ERR_TIMEOUT;
+    }else{
+        uatTaskSem--;
+        *p_err = OS_ERR_NONE;
+    }
+    return uatTaskSem;
+}
+
+OS_SEM_CTR OSTaskSemPost(OS_TCB *p_tcb, OS_OPT opt, OS_ERR *p_err){
+    (void)p_tcb;
+    (void)opt;
+    uatTaskSem++;
+    *p_err = OS_ERR_NONE;
+    return uatTaskSem;
+}
+
+void OSIntEnter(void){
+    OSIntNestingCtr++;
+}
+
+void OSIntExit(void){
+    OSIntNestingCtr--;
+}
+
+void OSTimeDly(OS_TICK dly, OS_OPT opt, OS_ERR *p_err){
+    (void)opt;
+    uatRun(dly*UAT_TICK_STEPS);
+    *p_err = OS_ERR_NONE;
+}
@@ -48,6 +48,7 @@
 
 #define APP_CFG_TASK_START_PRIO         2u
 #define APP_CFG_DSP_TASK_PRIO           4u
+#define APP_CFG_CAP_TASK_PRIO           20u     //Below the shell, polls the UART
 /*
 *********************************************************************************************************
 *                                            TASK STACK SIZES
@@ -55,5 +56,6 @@
 */
 
 #define APP_CFG_TASK_START_STK_SIZE         128u
-#define APP_CFG_DSP_TASK_STK_SIZE           128u
+#define APP_CFG_DSP_TASK_STK_SIZE           256u
+#define APP_CFG_CAP_TASK_STK_SIZE           128u
 #endif
@@ -98,8 +98,8 @@
 */
 
                                                                 /* Configure CPU timestamp features (see Note #1) :     */
-#define  CPU_CFG_TS_32_EN                       DEF_DISABLED
-#define  CPU_CFG_TS_64_EN                       DEF_DISABLED
+#define  CPU_CFG_TS_32_EN                       DEF_ENABLED     /* DWT cycle counter, see K65TWR_ClkCfg.c               */
+#define  CPU_CFG_TS_64_EN                       DEF_ENABLED
                                                                 /*   DEF_DISABLED  CPU timestamps DISABLED              */
                                                                 /*   DEF_ENABLED   CPU timestamps ENABLED               */
 
@@ -128,7 +128,7 @@
 *********************************************************************************************************
 */
 
-#if 0                                                           /* Configure CPU interrupts disabled time ...           */
+#if 1                                                           /* Configure CPU interrupts disabled time ...           */
 #define  CPU_CFG_INT_DIS_MEAS_EN                                /* ... measurements feature (see Note #1a).             */
 #endif
 
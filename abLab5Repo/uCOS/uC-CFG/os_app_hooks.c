@@ -165,13 +165,14 @@ void  App_OS_RedzoneHitHook (OS_TCB  *p_tcb)
 *
 * Arguments  : none
 *
-* Note(s)    : none
+* Note(s)    : The statistics task only runs once appStartTask() has called OSStatTaskCPUUsageInit().  It then
+*              runs at OS_CFG_STAT_TASK_RATE_HZ, well inside the DWT wrap, so CPU_TS_Get64() stays 64 bits.
 ************************************************************************************************************************
 */
 
 void  App_OS_StatTaskHook (void)
 {
-
+    CPU_TS_Update();                                            /* Extend the 32-bit DWT count, wraps every 23.9 s      */
 }
 
 
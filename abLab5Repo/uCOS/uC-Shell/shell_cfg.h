@@ -60,7 +60,7 @@
 */
 
 #define  SHELL_CFG_CMD_TBL_SIZE                            3    /* Cfg Shell cmd tbl size  (see Note #1).               */
-#define  SHELL_CFG_CMD_ARG_NBR_MAX                         5    /* Cfg cmd max nbr of arg  (see Note #2).               */
+#define  SHELL_CFG_CMD_ARG_NBR_MAX                        10    /* Cfg cmd max nbr of arg  (see Note #2).               */
 
 #define  SHELL_CFG_MODULE_CMD_NAME_LEN_MAX                 8    /* Cfg module cmd name len (See Note #3).               */
 
@@ -68,3 +68,7 @@
 #define  TERMINAL_CFG_HISTORY_EN                 DEF_ENABLED    /* En/dis history           (see Note #3).              */
 #define  TERMINAL_CFG_HISTORY_ITEMS_NBR                   16u   /* Cfg nbr history items    (see Note #4).              */
 #define  TERMINAL_CFG_HISTORY_ITEM_LEN                    64u   /* Cfg history item len     (see Note #5).              */
+
+                                                                /* Terminal UART rate, a BIO_BIT_RATE_ value. dsp_cap   */
+                                                                /* needs more than 115200 for more than one buffer.     */
+#define  TERMINAL_SERIAL_CFG_BIT_RATE            BIO_BIT_RATE_115200
@@ -75,7 +75,7 @@
 */
 
 CPU_BOOLEAN  TerminalSerial_Init (void){
-    BIOOpen(BIO_BIT_RATE_115200);
+    BIOOpen(TERMINAL_SERIAL_CFG_BIT_RATE);
     return (DEF_OK);
 }
 
@@ -142,12 +142,14 @@ CPU_INT16S  TerminalSerial_Wr (void *pbuf, CPU_SIZE_T buf_len){
 * Caller(s)   : various.
 *
 * Note(s)     : Reads only ASCII chars right now. TDM
+*               Blocks in BIOGetChar(), which pends on the UART2 RX interrupt, so the terminal
+*               task uses no CPU until a character arrives.
 *********************************************************************************************************
 */
 
 CPU_INT08U TerminalSerial_RdByte(void){
     INT8C rd_char;
-    rd_char = BIORead();
+    rd_char = BIOGetChar();
     return((CPU_INT08U)rd_char);
 }
 